@@ -1,10 +1,10 @@
 #include "assembler.h"
+#include "assemblylexer.h"
 #include "binutils.h"
 #include "defines.h"
-#include "lexerutilities.h"
 #include "processorhandler.h"
 
-#include <QRegularExpression>
+#include <QSet>
 #include <QTextBlock>
 
 #define DATA_START 0x10000000
@@ -13,119 +13,95 @@ namespace Ripes {
 
 namespace {
 // Instruction groupings needed for various identification operations
-const QStringList pseudoOps = QStringList() << "nop"
-                                            << "la"
-                                            << "nop"
-                                            << "li"
-                                            << "mv"
-                                            << "not"
-                                            << "neg"
-                                            << "seqz"
-                                            << "snez"
-                                            << "sltz"
-                                            << "sgtz"
-                                            << "beqz"
-                                            << "bgez"
-                                            << "bnez"
-                                            << "blez"
-                                            << "bltz"
-                                            << "bgtz"
-                                            << "bgt"
-                                            << "ble"
-                                            << "bgtu"
-                                            << "bleu"
-                                            << "j"
-                                            << "jal"
-                                            << "jr"
-                                            << "jalr"
-                                            << "ret"
-                                            << "call"
-                                            << "tail"
-                                            << "lb"
-                                            << "lh"
-                                            << "lw"
-                                            << "sb"
-                                            << "sh"
-                                            << "sw";
-
-const QStringList opsWithOffsets = QStringList() << "beq"
-                                                 << "bne"
-                                                 << "bge"
-                                                 << "blt"
-                                                 << "bltu"
-                                                 << "bgeu"
-                                                 << "jal"
-                                                 << "auipc"
-                                                 << "jalr";
-
-// Grouping of instructions that require the same format
-const QStringList opImmInstructions = QStringList() << "addi"
-                                                    << "slli"
-                                                    << "slti"
-                                                    << "xori"
-                                                    << "sltiu"
-                                                    << "srli"
-                                                    << "srai"
-                                                    << "ori"
-                                                    << "andi";
-
-const QStringList opInstructions = QStringList() << "add"
-                                                 << "sub"
-                                                 << "mul"
-                                                 << "mulh"
-                                                 << "sll"
-                                                 << "mulhsu"
-                                                 << "slt"
-                                                 << "mulhu"
-                                                 << "sltu"
-                                                 << "div"
-                                                 << "xor"
-                                                 << "srl"
-                                                 << "sra"
-                                                 << "divu"
-                                                 << "rem"
-                                                 << "or"
-                                                 << "remu"
-                                                 << "and";
-
-const QStringList storeInstructions = QStringList() << "sb"
-                                                    << "sh"
-                                                    << "sw";
-
-const QStringList loadInstructions = QStringList() << "lb"
-                                                   << "lh"
-                                                   << "lw"
-                                                   << "lbu"
-                                                   << "lhu";
-
-const QStringList branchInstructions = QStringList() << "beq"
-                                                     << "bne"
-                                                     << "blt"
-                                                     << "bge"
-                                                     << "bltu"
-                                                     << "bgeu";
-const QStringList DataAssemblerDirectives = QStringList() << ".word"
-                                                          << ".half"
-                                                          << ".short"
-                                                          << ".byte"
-                                                          << ".2byte"
-                                                          << ".4byte"
-                                                          << ".long";
-const static QMap<QString, size_t> DataAssemblerSizes{{".word", 4},  {".half", 2},  {".short", 2}, {".byte", 1},
-                                                      {".2byte", 2}, {".4byte", 4}, {".long", 4}};
+const static QSet<QString> pseudoOps{"nop",  "la",   "li",   "mv",   "not",  "neg",  "seqz", "snez", "sltz", "sgtz",
+                                     "beqz", "bgez", "bnez", "blez", "bltz", "bgtz", "bgt",  "ble",  "bgtu", "bleu",
+                                     "j",    "jal",  "jr",   "jalr", "ret",  "call", "tail", "lb",   "lh",   "lw",
+                                     "sb",   "sh",   "sw"};
+
+const static QSet<QString> opsWithOffsets{"beq", "bne", "bge", "blt", "bltu", "bgeu", "jal", "auipc", "jalr"};
+
+using Format = InstrEncoding::Format;
+
+// Encoding table of all base (non-pseudo) instructions supported by the assembler
+const static QHash<QString, InstrEncoding> instrEncodings{
+    {"lui", {Format::Lui, instrType::LUI, 0, 0}},
+    {"auipc", {Format::Auipc, instrType::AUIPC, 0, 0}},
+    {"jal", {Format::Jal, instrType::JAL, 0, 0}},
+    {"jalr", {Format::Jalr, instrType::JALR, 0b000, 0}},
+    {"ecall", {Format::Ecall, instrType::ECALL, 0, 0}},
+
+    {"beq", {Format::Branch, instrType::BRANCH, 0b000, 0}},
+    {"bne", {Format::Branch, instrType::BRANCH, 0b001, 0}},
+    {"blt", {Format::Branch, instrType::BRANCH, 0b100, 0}},
+    {"bge", {Format::Branch, instrType::BRANCH, 0b101, 0}},
+    {"bltu", {Format::Branch, instrType::BRANCH, 0b110, 0}},
+    {"bgeu", {Format::Branch, instrType::BRANCH, 0b111, 0}},
+
+    {"lb", {Format::Load, instrType::LOAD, 0b000, 0}},
+    {"lh", {Format::Load, instrType::LOAD, 0b001, 0}},
+    {"lw", {Format::Load, instrType::LOAD, 0b010, 0}},
+    {"lbu", {Format::Load, instrType::LOAD, 0b100, 0}},
+    {"lhu", {Format::Load, instrType::LOAD, 0b101, 0}},
+
+    {"sb", {Format::Store, instrType::STORE, 0b000, 0}},
+    {"sh", {Format::Store, instrType::STORE, 0b001, 0}},
+    {"sw", {Format::Store, instrType::STORE, 0b010, 0}},
+
+    {"addi", {Format::OpImm, instrType::OP_IMM, 0b000, 0}},
+    {"slli", {Format::OpImm, instrType::OP_IMM, 0b001, 0}},
+    {"slti", {Format::OpImm, instrType::OP_IMM, 0b010, 0}},
+    {"sltiu", {Format::OpImm, instrType::OP_IMM, 0b011, 0}},
+    {"xori", {Format::OpImm, instrType::OP_IMM, 0b100, 0}},
+    {"srli", {Format::OpImm, instrType::OP_IMM, 0b101, 0}},
+    {"srai", {Format::OpImm, instrType::OP_IMM, 0b101, 0b0100000}},
+    {"ori", {Format::OpImm, instrType::OP_IMM, 0b110, 0}},
+    {"andi", {Format::OpImm, instrType::OP_IMM, 0b111, 0}},
+
+    {"add", {Format::Op, instrType::OP, 0b000, 0}},
+    {"sub", {Format::Op, instrType::OP, 0b000, 0b0100000}},
+    {"sll", {Format::Op, instrType::OP, 0b001, 0}},
+    {"slt", {Format::Op, instrType::OP, 0b010, 0}},
+    {"sltu", {Format::Op, instrType::OP, 0b011, 0}},
+    {"xor", {Format::Op, instrType::OP, 0b100, 0}},
+    {"srl", {Format::Op, instrType::OP, 0b101, 0}},
+    {"sra", {Format::Op, instrType::OP, 0b101, 0b0100000}},
+    {"or", {Format::Op, instrType::OP, 0b110, 0}},
+    {"and", {Format::Op, instrType::OP, 0b111, 0}},
+    {"mul", {Format::Op, instrType::OP, 0b000, 0b0000001}},
+    {"mulh", {Format::Op, instrType::OP, 0b001, 0b0000001}},
+    {"mulhsu", {Format::Op, instrType::OP, 0b010, 0b0000001}},
+    {"mulhu", {Format::Op, instrType::OP, 0b011, 0b0000001}},
+    {"div", {Format::Op, instrType::OP, 0b100, 0b0000001}},
+    {"divu", {Format::Op, instrType::OP, 0b101, 0b0000001}},
+    {"rem", {Format::Op, instrType::OP, 0b110, 0b0000001}},
+    {"remu", {Format::Op, instrType::OP, 0b111, 0b0000001}},
+
+    // Atomics; funct7 holds funct5, with the aq and rl bits cleared
+    {"lr.w", {Format::Amo, instrType::AMO, 0b010, 0b00010 << 2}},
+    {"sc.w", {Format::Amo, instrType::AMO, 0b010, 0b00011 << 2}},
+    {"amoswap.w", {Format::Amo, instrType::AMO, 0b010, 0b00001 << 2}},
+    {"amoadd.w", {Format::Amo, instrType::AMO, 0b010, 0b00000 << 2}},
+    {"amoxor.w", {Format::Amo, instrType::AMO, 0b010, 0b00100 << 2}},
+    {"amoand.w", {Format::Amo, instrType::AMO, 0b010, 0b01100 << 2}},
+    {"amoor.w", {Format::Amo, instrType::AMO, 0b010, 0b01000 << 2}},
+    {"amomin.w", {Format::Amo, instrType::AMO, 0b010, 0b10000 << 2}},
+    {"amomax.w", {Format::Amo, instrType::AMO, 0b010, 0b10100 << 2}},
+    {"amominu.w", {Format::Amo, instrType::AMO, 0b010, 0b11000 << 2}},
+    {"amomaxu.w", {Format::Amo, instrType::AMO, 0b010, 0b11100 << 2}}};
+
+const static QHash<QString, size_t> DataAssemblerSizes{{".word", 4},  {".half", 2},  {".short", 2}, {".byte", 1},
+                                                       {".2byte", 2}, {".4byte", 4}, {".long", 4}};
 }  // namespace
 
 Assembler::Assembler() {}
 
 uint32_t Assembler::getRegisterNumber(const QString& reg) {
     // Converts a textual representation of a register to its numeric value
-    QString regRes = reg;
     if (reg[0] == 'x') {
-        regRes.remove('x');
-        return regRes.toInt(nullptr, 10);
+        return reg.midRef(1).toInt(nullptr, 10);
     } else {
         Q_ASSERT(ABInames.contains(reg));
-        return ABInames[reg];
+        return ABInames.value(reg);
     }
 }
 
@@ -152,127 +128,27 @@ int Assembler::getImmediate(QString string, bool& canConvert) {
     return sign * immediate;
 }
 
-QByteArray Assembler::assembleOpImmInstruction(const QStringList& fields, int row) {
-    Q_UNUSED(row);
-    uint32_t funct3 = 0;
-    bool hasFunct7 = false;
-    uint32_t funct7 = 0;
+uint32_t Assembler::assembleOpImmInstruction(const QStringList& fields, int row, const InstrEncoding& enc) {
     bool canConvert;
     int imm = getImmediate(fields[3], canConvert);
-    if (fields[0] == "addi") {
+    if (!canConvert && fields[0] == QLatin1String("addi")) {
         // Requires assembler-level support for labels (for pseudo-op 'la')
-        if (canConvert) {
-            // An immediate value as been provided
-        } else {
-            // An offset value has been provided ( unfolded pseudo-op)
-            m_error |= !m_labelPosMap.count(fields[3]);
-            // calculate offset 31:12 bits - we -1 to get the row of the previois auipc op
-            imm = m_labelPosMap[fields[3]] - (row - 1) * 4;
-        }
-        funct3 = 0b000;
-    } else if (fields[0] == "slli") {
-        funct3 = 0b001;
-    } else if (fields[0] == "slti") {
-        funct3 = 0b010;
-    } else if (fields[0] == "xori") {
-        funct3 = 0b100;
-    } else if (fields[0] == "sltiu") {
-        funct3 = 0b011;
-    } else if (fields[0] == "srli") {
-        funct3 = 0b101;
-    } else if (fields[0] == "srai") {
-        hasFunct7 = true;
-        funct3 = 0b101;
-        funct7 = 0b0100000;
-    } else if (fields[0] == "ori") {
-        funct3 = 0b110;
-    } else if (fields[0] == "andi") {
-        funct3 = 0b111;
-    } else {
-        m_error = true;
-        Q_ASSERT(false);
+        // An offset value has been provided ( unfolded pseudo-op)
+        m_error |= !m_labelPosMap.count(fields[3]);
+        // calculate offset 31:12 bits - we -1 to get the row of the previois auipc op
+        imm = m_labelPosMap[fields[3]] - (row - 1) * 4;
     }
 
-    if (hasFunct7) {
-        return uintToByteArr(instrType::OP_IMM | funct3 << 12 | getRegisterNumber(fields[1]) << 7 |
-                             getRegisterNumber(fields[2]) << 15 | funct7 << 25 | imm << 20);
-    } else {
-        return uintToByteArr(instrType::OP_IMM | funct3 << 12 | getRegisterNumber(fields[1]) << 7 |
-                             getRegisterNumber(fields[2]) << 15 | imm << 20);
-    }
+    return enc.opcode | enc.funct3 << 12 | getRegisterNumber(fields[1]) << 7 | getRegisterNumber(fields[2]) << 15 |
+           enc.funct7 << 25 | imm << 20;
 }
 
-QByteArray Assembler::assembleOpInstruction(const QStringList& fields, int row) {
-    Q_UNUSED(row);
-    uint32_t funct3 = 0;
-    uint32_t funct7 = 0;
-    if (fields[0] == "add") {
-        funct3 = 0b000;
-    } else if (fields[0] == "sub") {
-        funct3 = 0b000;
-        funct7 = 0b0100000;
-    } else if (fields[0] == "mul") {
-        funct3 = 0b000;
-        funct7 = 0b0000001;
-    } else if (fields[0] == "mulh") {
-        funct3 = 0b001;
-        funct7 = 0b0000001;
-    } else if (fields[0] == "sll") {
-        funct3 = 0b001;
-    } else if (fields[0] == "mulhsu") {
-        funct3 = 0b010;
-        funct7 = 0b0000001;
-    } else if (fields[0] == "slt") {
-        funct3 = 0b010;
-    } else if (fields[0] == "mulhu") {
-        funct3 = 0b011;
-        funct7 = 0b0000001;
-    } else if (fields[0] == "sltu") {
-        funct3 = 0b011;
-    } else if (fields[0] == "div") {
-        funct3 = 0b100;
-        funct7 = 0b0000001;
-    } else if (fields[0] == "xor") {
-        funct3 = 0b100;
-    } else if (fields[0] == "srl") {
-        funct3 = 0b101;
-    } else if (fields[0] == "sra") {
-        funct3 = 0b101;
-        funct7 = 0b0100000;
-    } else if (fields[0] == "divu") {
-        funct3 = 0b101;
-        funct7 = 0b0000001;
-    } else if (fields[0] == "rem") {
-        funct3 = 0b110;
-        funct7 = 0b0000001;
-    } else if (fields[0] == "or") {
-        funct3 = 0b110;
-    } else if (fields[0] == "remu") {
-        funct3 = 0b111;
-        funct7 = 0b0000001;
-    } else if (fields[0] == "and") {
-        funct3 = 0b111;
-    } else {
-        m_error = true;
-        Q_ASSERT(false);
-    }
-    return uintToByteArr(instrType::OP | funct3 << 12 | funct7 << 25 | getRegisterNumber(fields[1]) << 7 |
-                         getRegisterNumber(fields[2]) << 15 | getRegisterNumber(fields[3]) << 20);
+uint32_t Assembler::assembleOpInstruction(const QStringList& fields, const InstrEncoding& enc) {
+    return enc.opcode | enc.funct3 << 12 | enc.funct7 << 25 | getRegisterNumber(fields[1]) << 7 |
+           getRegisterNumber(fields[2]) << 15 | getRegisterNumber(fields[3]) << 20;
 }
 
-QByteArray Assembler::assembleStoreInstruction(const QStringList& fields, int row) {
-    Q_UNUSED(row);
-    uint32_t funct3 = 0;
-    if (fields[0] == "sb") {
-        funct3 = 0b000;
-    } else if (fields[0] == "sh") {
-        funct3 = 0b001;
-    } else if (fields[0] == "sw") {
-        funct3 = 0b010;
-    } else {
-        m_error = true;
-        Q_ASSERT(false);
-    }
+uint32_t Assembler::assembleStoreInstruction(const QStringList& fields, int row, const InstrEncoding& enc) {
     bool canConvert;
     int imm = getImmediate(fields[2], canConvert);
     if (canConvert) {
@@ -284,26 +160,11 @@ QByteArray Assembler::assembleStoreInstruction(const QStringList& fields, int ro
         imm = m_labelPosMap[fields[2]] - (row - 1) * 4;
     }
 
-    return uintToByteArr(instrType::STORE | getRegisterNumber(fields[3]) << 15 | getRegisterNumber(fields[1]) << 20 |
-                         funct3 << 12 | (imm & 0b11111) << 7 | (imm & 0xFE0) << 20);
+    return enc.opcode | getRegisterNumber(fields[3]) << 15 | getRegisterNumber(fields[1]) << 20 | enc.funct3 << 12 |
+           (imm & 0b11111) << 7 | (imm & 0xFE0) << 20;
 }
 
-QByteArray Assembler::assembleLoadInstruction(const QStringList& fields, int row) {
-    uint32_t funct3 = 0;
-    if (fields[0] == "lb") {
-        funct3 = 0b000;
-    } else if (fields[0] == "lh") {
-        funct3 = 0b001;
-    } else if (fields[0] == "lw") {
-        funct3 = 0b010;
-    } else if (fields[0] == "lbu") {
-        funct3 = 0b100;
-    } else if (fields[0] == "lhu") {
-        funct3 = 0b101;
-    } else {
-        m_error = true;
-        Q_ASSERT(false);
-    }
+uint32_t Assembler::assembleLoadInstruction(const QStringList& fields, int row, const InstrEncoding& enc) {
     bool canConvert;
     int imm = getImmediate(fields[2], canConvert);
     if (canConvert) {
@@ -314,39 +175,22 @@ QByteArray Assembler::assembleLoadInstruction(const QStringList& fields, int row
         imm = (m_labelPosMap[fields[2]] & 0xfff) - (row - 1) * 4;
     }
 
-    return uintToByteArr(instrType::LOAD | funct3 << 12 | getRegisterNumber(fields[1]) << 7 | imm << 20 |
-                         getRegisterNumber(fields[3]) << 15);
+    return enc.opcode | enc.funct3 << 12 | getRegisterNumber(fields[1]) << 7 | imm << 20 |
+           getRegisterNumber(fields[3]) << 15;
 }
 
-QByteArray Assembler::assembleBranchInstruction(const QStringList& fields, int row) {
+uint32_t Assembler::assembleBranchInstruction(const QStringList& fields, int row, const InstrEncoding& enc) {
     // calculate offset
     Q_ASSERT(m_labelPosMap.count(fields[3]));
     int offset = m_labelPosMap[fields[3]];
     offset = offset - row * 4;  // byte-wize addressing
-    uint32_t funct3 = 0;
-    if (fields[0] == "beq") {
-        funct3 = 0b000;
-    } else if (fields[0] == "bne") {
-        funct3 = 0b001;
-    } else if (fields[0] == "blt") {
-        funct3 = 0b100;
-    } else if (fields[0] == "bge") {
-        funct3 = 0b101;
-    } else if (fields[0] == "bltu") {
-        funct3 = 0b110;
-    } else if (fields[0] == "bgeu") {
-        funct3 = 0b111;
-    } else {
-        m_error = true;
-        Q_ASSERT(false);
-    }
 
-    return uintToByteArr(instrType::BRANCH | getRegisterNumber(fields[1]) << 15 | getRegisterNumber(fields[2]) << 20 |
-                         (offset & 0b11110) << 7 | (offset & 0x800) >> 4 | (offset & 0x7E0) << 20 |
-                         (offset & 0x1000) << 19 | funct3 << 12);
+    return enc.opcode | getRegisterNumber(fields[1]) << 15 | getRegisterNumber(fields[2]) << 20 |
+           (offset & 0b11110) << 7 | (offset & 0x800) >> 4 | (offset & 0x7E0) << 20 | (offset & 0x1000) << 19 |
+           enc.funct3 << 12;
 }
 
-QByteArray Assembler::assembleAuipcInstruction(const QStringList& fields, int) {
+uint32_t Assembler::assembleAuipcInstruction(const QStringList& fields, const InstrEncoding& enc) {
     bool canConvert;
     int imm = getImmediate(fields[2], canConvert) << 12;
     if (canConvert) {
@@ -363,10 +207,10 @@ QByteArray Assembler::assembleAuipcInstruction(const QStringList& fields, int) {
         }
     }
 
-    return uintToByteArr(instrType::AUIPC | getRegisterNumber(fields[1]) << 7 | (imm & 0xfffff000));
+    return enc.opcode | getRegisterNumber(fields[1]) << 7 | (imm & 0xfffff000);
 }
 
-QByteArray Assembler::assembleJalrInstruction(const QStringList& fields, int row) {
+uint32_t Assembler::assembleJalrInstruction(const QStringList& fields, int row, const InstrEncoding& enc) {
     bool canConvert;
     int imm = getImmediate(fields[3], canConvert);
     if (canConvert) {
@@ -378,58 +222,108 @@ QByteArray Assembler::assembleJalrInstruction(const QStringList& fields, int row
         imm = m_labelPosMap[fields[3]] - (row - 1) * 4;
     }
 
-    return uintToByteArr(instrType::JALR | getRegisterNumber(fields[1]) << 7 | getRegisterNumber(fields[2]) << 15 |
-                         (imm & 0xfff) << 20);
+    return enc.opcode | enc.funct3 << 12 | getRegisterNumber(fields[1]) << 7 | getRegisterNumber(fields[2]) << 15 |
+           (imm & 0xfff) << 20;
+}
+
+uint32_t Assembler::assembleJalInstruction(const QStringList& fields, int row, const InstrEncoding& enc) {
+    Q_ASSERT(m_labelPosMap.count(fields[2]));
+    int32_t imm = m_labelPosMap[fields[2]];
+    imm = imm - row * 4;
+    imm = (imm & 0x7fe) << 20 | (imm & 0x800) << 9 | (imm & 0xff000) | (imm & 0x100000) << 11;
+    return enc.opcode | getRegisterNumber(fields[1]) << 7 | imm;
+}
+
+uint32_t Assembler::assembleAmoInstruction(const QStringList& fields, const InstrEncoding& enc) {
+    // The address register is the last field, ie. 'lr.w rd, (rs1)' and 'amoadd.w rd, rs2, (rs1)'. LR has no rs2.
+    const uint32_t rs2 = fields.size() == 4 ? getRegisterNumber(fields[2]) : 0;
+    return enc.opcode | enc.funct3 << 12 | enc.funct7 << 25 | getRegisterNumber(fields[1]) << 7 |
+           getRegisterNumber(fields.last()) << 15 | rs2 << 20;
 }
 
-void Assembler::assembleInstruction(const QStringList& fields, int row) {
+uint32_t Assembler::assembleInstruction(const QStringList& fields, int row) {
     // Translates a single assembly instruction into binary
-    QString instruction = fields[0];
-    if (opImmInstructions.contains(instruction)) {
-        m_textSegment.append(assembleOpImmInstruction(fields, row));
-    } else if (opInstructions.contains(instruction)) {
-        m_textSegment.append(assembleOpInstruction(fields, row));
-    } else if (storeInstructions.contains(instruction)) {
-        m_textSegment.append(assembleStoreInstruction(fields, row));
-    } else if (loadInstructions.contains(instruction)) {
-        m_textSegment.append(assembleLoadInstruction(fields, row));
-    } else if (branchInstructions.contains(instruction)) {
-        m_textSegment.append(assembleBranchInstruction(fields, row));
-    } else if (instruction == "jalr") {
-        m_textSegment.append(assembleJalrInstruction(fields, row));
-    } else if (instruction == "lui") {
-        bool canConvert;
-        m_textSegment.append(uintToByteArr(instrType::LUI | getRegisterNumber(fields[1]) << 7 |
-                                           getImmediate(fields[2], canConvert) << 12));
-        m_error |= !canConvert;
-    } else if (instruction == "auipc") {
-        m_textSegment.append(assembleAuipcInstruction(fields, row));
-    } else if (instruction == "jal") {
-        Q_ASSERT(m_labelPosMap.count(fields[2]));
-        int32_t imm = m_labelPosMap[fields[2]];
-        imm = imm - row * 4;
-        imm = (imm & 0x7fe) << 20 | (imm & 0x800) << 9 | (imm & 0xff000) | (imm & 0x100000) << 11;
-        m_textSegment.append(uintToByteArr(instrType::JAL | getRegisterNumber(fields[1]) << 7 | imm));
-    } else if (instruction == "ecall") {
-        m_textSegment.append(uintToByteArr(instrType::ECALL));
-    } else {
+    const auto encIt = instrEncodings.constFind(fields[0]);
+    if (encIt == instrEncodings.constEnd()) {
         //  Unknown instruction
         m_error = true;
         Q_ASSERT(false);
+        return 0;
     }
+
+    const InstrEncoding& enc = *encIt;
+    uint32_t instr = 0;
+    switch (enc.format) {
+        case Format::OpImm:
+            instr = assembleOpImmInstruction(fields, row, enc);
+            break;
+        case Format::Op:
+            instr = assembleOpInstruction(fields, enc);
+            break;
+        case Format::Store:
+            instr = assembleStoreInstruction(fields, row, enc);
+            break;
+        case Format::Load:
+            instr = assembleLoadInstruction(fields, row, enc);
+            break;
+        case Format::Branch:
+            instr = assembleBranchInstruction(fields, row, enc);
+            break;
+        case Format::Jalr:
+            instr = assembleJalrInstruction(fields, row, enc);
+            break;
+        case Format::Lui: {
+            bool canConvert;
+            instr = enc.opcode | getRegisterNumber(fields[1]) << 7 | getImmediate(fields[2], canConvert) << 12;
+            m_error |= !canConvert;
+            break;
+        }
+        case Format::Auipc:
+            instr = assembleAuipcInstruction(fields, enc);
+            break;
+        case Format::Jal:
+            instr = assembleJalInstruction(fields, row, enc);
+            break;
+        case Format::Ecall:
+            instr = enc.opcode;
+            break;
+        case Format::Amo:
+            instr = assembleAmoInstruction(fields, enc);
+            break;
+    }
+    return instr;
+}
+
+QString Assembler::getLabelOperand(const QStringList& fields) {
+    // Operands which are neither registers nor immediates refer to labels
+    for (int i = 1; i < fields.size(); i++) {
+        const QString& field = fields[i];
+        if (ABInames.contains(field)) {
+            continue;
+        }
+        bool canConvert;
+        if (field.startsWith('x')) {
+            field.midRef(1).toInt(&canConvert, 10);
+        } else {
+            getImmediate(field, canConvert);
+        }
+        if (!canConvert) {
+            return field;
+        }
+    }
+    return QString();
 }
 
-void Assembler::unpackPseudoOp(const QStringList& fields, int& pos) {
+void Assembler::unpackPseudoOp(const QStringList& fields, int& pos, BlockAssembly& block) {
     if (fields.first() == "la") {
-        m_instructionsMap[pos] = QStringList() << "auipc" << fields[1] << fields[2];
-        m_instructionsMap[pos + 1] = QStringList() << "addi" << fields[1] << fields[1] << fields[2];
-        m_lineLabelUsageMap[pos] = fields[2];
+        block.instructions[pos] = QStringList() << "auipc" << fields[1] << fields[2];
+        block.instructions[pos + 1] = QStringList() << "addi" << fields[1] << fields[1] << fields[2];
         pos += 2;
     } else if (fields.first() == "nop") {
-        m_instructionsMap[pos] = QStringList() << "addi"
-                                               << "x0"
-                                               << "x0"
-                                               << "0";
+        block.instructions[pos] = QStringList() << "addi"
+                                                << "x0"
+                                                << "x0"
+                                                << "0";
         pos++;
     } else if (fields.first() == "li") {
         // Determine whether an ADDI or LUI instruction is sufficient, or if both LUI and ADDI is needed, by analysing
@@ -441,136 +335,127 @@ void Assembler::unpackPseudoOp(const QStringList& fields, int& pos) {
 
         if (isInt<12>(immediate)) {
             // immediate can be represented by 12 bits, ADDI is sufficient
-            m_instructionsMap[pos] = QStringList() << "addi" << fields[1] << "x0" << QString::number(immediate);
+            block.instructions[pos] = QStringList() << "addi" << fields[1] << "x0" << QString::number(immediate);
             pos++;
         } else {
             const int lower12Signed = signextend<int32_t, 12>(immediate & 0xFFF);
             int signOffset = lower12Signed < 0 ? 1 : 0;
 
-            m_instructionsMap[pos] = QStringList()
-                                     << "lui" << fields[1]
-                                     << QString::number((static_cast<uint32_t>(immediate) >> 12) + signOffset);
+            block.instructions[pos] = QStringList()
+                                      << "lui" << fields[1]
+                                      << QString::number((static_cast<uint32_t>(immediate) >> 12) + signOffset);
             pos++;
             if ((immediate & 0xFFF) != 0) {
-                m_instructionsMap[pos] = QStringList()
-                                         << "addi" << fields[1] << fields[1] << QString::number(lower12Signed);
+                block.instructions[pos] = QStringList()
+                                          << "addi" << fields[1] << fields[1] << QString::number(lower12Signed);
                 pos++;
             }
         }
     } else if (fields.first() == "mv") {
-        m_instructionsMap[pos] = QStringList() << "addi" << fields[1] << fields[2] << "0";
+        block.instructions[pos] = QStringList() << "addi" << fields[1] << fields[2] << "0";
         pos++;
     } else if (fields.first() == "not") {
-        m_instructionsMap[pos] = QStringList() << "xori" << fields[1] << fields[2] << "-1";
+        block.instructions[pos] = QStringList() << "xori" << fields[1] << fields[2] << "-1";
         pos++;
     } else if (fields.first() == "neg") {
-        m_instructionsMap[pos] = QStringList() << "sub" << fields[1] << "x0" << fields[2];
+        block.instructions[pos] = QStringList() << "sub" << fields[1] << "x0" << fields[2];
         pos++;
     } else if (fields.first() == "seqz") {
-        m_instructionsMap[pos] = QStringList() << "sltiu" << fields[1] << fields[2] << "1";
+        block.instructions[pos] = QStringList() << "sltiu" << fields[1] << fields[2] << "1";
         pos++;
     } else if (fields.first() == "snez") {
-        m_instructionsMap[pos] = QStringList() << "sltu" << fields[1] << "x0" << fields[2];
+        block.instructions[pos] = QStringList() << "sltu" << fields[1] << "x0" << fields[2];
         pos++;
     } else if (fields.first() == "sltz") {
-        m_instructionsMap[pos] = QStringList() << "slt" << fields[1] << fields[2] << "x0";
+        block.instructions[pos] = QStringList() << "slt" << fields[1] << fields[2] << "x0";
         pos++;
     } else if (fields.first() == "sgtz") {
-        m_instructionsMap[pos] = QStringList() << "slt" << fields[1] << "x0" << fields[2];
+        block.instructions[pos] = QStringList() << "slt" << fields[1] << "x0" << fields[2];
         pos++;
     } else if (fields.first() == "beqz") {
-        m_instructionsMap[pos] = QStringList() << "beq" << fields[1] << "x0" << fields[2];
+        block.instructions[pos] = QStringList() << "beq" << fields[1] << "x0" << fields[2];
         pos++;
     } else if (fields.first() == "bnez") {
-        m_instructionsMap[pos] = QStringList() << "bne" << fields[1] << "x0" << fields[2];
+        block.instructions[pos] = QStringList() << "bne" << fields[1] << "x0" << fields[2];
         pos++;
     } else if (fields.first() == "blez") {
-        m_instructionsMap[pos] = QStringList() << "bge"
-                                               << "x0" << fields[1] << fields[2];
+        block.instructions[pos] = QStringList() << "bge"
+                                                << "x0" << fields[1] << fields[2];
         pos++;
     } else if (fields.first() == "bgez") {
-        m_instructionsMap[pos] = QStringList() << "bge" << fields[1] << "x0" << fields[2];
+        block.instructions[pos] = QStringList() << "bge" << fields[1] << "x0" << fields[2];
         pos++;
     } else if (fields.first() == "bltz") {
-        m_instructionsMap[pos] = QStringList() << "blt" << fields[1] << "x0" << fields[2];
+        block.instructions[pos] = QStringList() << "blt" << fields[1] << "x0" << fields[2];
         pos++;
     } else if (fields.first() == "bgtz") {
-        m_instructionsMap[pos] = QStringList() << "blt"
-                                               << "x0" << fields[1] << fields[2];
+        block.instructions[pos] = QStringList() << "blt"
+                                                << "x0" << fields[1] << fields[2];
         pos++;
     } else if (fields.first() == "bgt") {
-        m_instructionsMap[pos] = QStringList() << "blt" << fields[2] << fields[1] << fields[3];
+        block.instructions[pos] = QStringList() << "blt" << fields[2] << fields[1] << fields[3];
         pos++;
     } else if (fields.first() == "ble") {
-        m_instructionsMap[pos] = QStringList() << "bge" << fields[2] << fields[1] << fields[3];
+        block.instructions[pos] = QStringList() << "bge" << fields[2] << fields[1] << fields[3];
         pos++;
     } else if (fields.first() == "bgtu") {
-        m_instructionsMap[pos] = QStringList() << "bltu" << fields[2] << fields[1] << fields[3];
+        block.instructions[pos] = QStringList() << "bltu" << fields[2] << fields[1] << fields[3];
         pos++;
     } else if (fields.first() == "bleu") {
-        m_instructionsMap[pos] = QStringList() << "bgeu" << fields[2] << fields[1] << fields[3];
+        block.instructions[pos] = QStringList() << "bgeu" << fields[2] << fields[1] << fields[3];
         pos++;
     } else if (fields.first() == "j") {
-        m_instructionsMap[pos] = QStringList() << "jal"
-                                               << "x0" << fields[1];
-        m_lineLabelUsageMap[pos] = fields[1];
+        block.instructions[pos] = QStringList() << "jal"
+                                                << "x0" << fields[1];
         pos++;
     } else if (fields.first() == "jal") {
         if (fields.length() == 3) {
             // Non-pseudo op JAL
-            m_instructionsMap[pos] = fields;
-            m_lineLabelUsageMap[pos] = fields[2];
+            block.instructions[pos] = fields;
         } else {
             // Pseudo op JAL
-            m_instructionsMap[pos] = QStringList() << "jal"
-                                                   << "x1" << fields[1];
-            m_lineLabelUsageMap[pos] = fields[1];
+            block.instructions[pos] = QStringList() << "jal"
+                                                    << "x1" << fields[1];
         }
         pos++;
     } else if (fields.first() == "jr") {
-        m_instructionsMap[pos] = QStringList() << "jalr"
-                                               << "x0" << fields[1] << "0";
+        block.instructions[pos] = QStringList() << "jalr"
+                                                << "x0" << fields[1] << "0";
         pos++;
     } else if (fields.first() == "jalr") {
         if (fields.length() == 4) {
             // Non-pseudo op JALR
-            m_instructionsMap[pos] = fields;
+            block.instructions[pos] = fields;
         } else {
             // Pseudo op JALR
-            m_instructionsMap[pos] = QStringList() << "jalr"
-                                                   << "x1" << fields[1] << "0";
+            block.instructions[pos] = QStringList() << "jalr"
+                                                    << "x1" << fields[1] << "0";
         }
         pos++;
     } else if (fields.first() == "ret") {
-        m_instructionsMap[pos] = QStringList() << "jalr"
-                                               << "x0"
-                                               << "x1"
-                                               << "0";
+        block.instructions[pos] = QStringList() << "jalr"
+                                                << "x0"
+                                                << "x1"
+                                                << "0";
         pos++;
     } else if (fields.first() == "call") {
-        m_instructionsMap[pos] = QStringList() << "auipc"
-                                               << "x6" << fields[1];
-        m_instructionsMap[pos + 1] = QStringList() << "jalr"
-                                                   << "x1"
-                                                   << "x6" << fields[1];
-        m_lineLabelUsageMap[pos] = fields[1];
-        m_lineLabelUsageMap[pos + 1] = fields[1];
+        block.instructions[pos] = QStringList() << "auipc"
+                                                << "x6" << fields[1];
+        block.instructions[pos + 1] = QStringList() << "jalr"
+                                                    << "x1"
+                                                    << "x6" << fields[1];
         pos += 2;
     } else if (fields.first() == "tail") {
-        m_instructionsMap[pos] = QStringList() << "auipc"
-                                               << "x6" << fields[1];
-        m_instructionsMap[pos + 1] = QStringList() << "jalr"
-                                                   << "x0"
-                                                   << "x6" << fields[1];
-        m_lineLabelUsageMap[pos] = fields[1];
-        m_lineLabelUsageMap[pos + 1] = fields[1];
+        block.instructions[pos] = QStringList() << "auipc"
+                                                << "x6" << fields[1];
+        block.instructions[pos + 1] = QStringList() << "jalr"
+                                                    << "x0"
+                                                    << "x6" << fields[1];
 
         pos += 2;
     } else if (fields.first() == "la") {
-        m_instructionsMap[pos] = QStringList() << "auipc" << fields[1] << fields[2];
-        m_instructionsMap[pos + 1] = QStringList() << "addi" << fields[1] << fields[1] << fields[2];
-        m_lineLabelUsageMap[pos] = fields[1];
-        m_lineLabelUsageMap[pos + 1] = fields[1];
+        block.instructions[pos] = QStringList() << "auipc" << fields[1] << fields[2];
+        block.instructions[pos + 1] = QStringList() << "addi" << fields[1] << fields[1] << fields[2];
 
         pos += 2;
     } else if (fields.first() == "lb" || fields.first() == "lh" || fields.first() == "lw") {
@@ -579,14 +464,12 @@ void Assembler::unpackPseudoOp(const QStringList& fields, int& pos) {
             // convert immediate value
             bool canConvert;
             int imm = getImmediate(fields[2], canConvert);
-            m_instructionsMap[pos] = QStringList() << fields[0] << fields[1] << QString::number(imm) << fields[3];
+            block.instructions[pos] = QStringList() << fields[0] << fields[1] << QString::number(imm) << fields[3];
             pos++;
         } else {
             // Pseudo op load
-            m_instructionsMap[pos] = QStringList() << "auipc" << fields[1] << fields[2];
-            m_instructionsMap[pos + 1] = QStringList() << fields.first() << fields[1] << fields[2] << fields[1];
-            m_lineLabelUsageMap[pos] = fields[1];
-            m_lineLabelUsageMap[pos + 1] = fields[1];
+            block.instructions[pos] = QStringList() << "auipc" << fields[1] << fields[2];
+            block.instructions[pos + 1] = QStringList() << fields.first() << fields[1] << fields[2] << fields[1];
             pos += 2;
         }
     } else if (fields.first() == "sb" || fields.first() == "sh" || fields.first() == "sw") {
@@ -595,15 +478,13 @@ void Assembler::unpackPseudoOp(const QStringList& fields, int& pos) {
         int imm = getImmediate(fields[2], canConvert);
         if (canConvert) {
             // Non-pseudo op store
-            m_instructionsMap[pos] = fields;
+            block.instructions[pos] = fields;
             pos++;
         } else {
             // Pseudo op store
-            m_instructionsMap[pos] = QStringList() << "auipc" << fields[3] << fields[2];
-            m_instructionsMap[pos + 1] = QStringList()
-                                         << fields.first() << fields[1] << QString::number(imm) << fields[3];
-            m_lineLabelUsageMap[pos] = fields[1];
-            m_lineLabelUsageMap[pos + 1] = fields[1];
+            block.instructions[pos] = QStringList() << "auipc" << fields[3] << fields[2];
+            block.instructions[pos + 1] = QStringList()
+                                          << fields.first() << fields[1] << QString::number(imm) << fields[3];
             pos += 2;
         }
     } else {
@@ -633,7 +514,7 @@ void Assembler::assembleZeroArray(QByteArray& byteArray, size_t size) {
     }
 }
 
-void Assembler::assembleAssemblerDirective(const QStringList& fields) {
+void Assembler::assembleAssemblerDirective(const QStringList& fields, BlockAssembly& block) {
     QByteArray byteArray;
     if (fields[0] == QString(".string") || fields[0] == QString(".asciz")) {
         QString string;
@@ -646,7 +527,7 @@ void Assembler::assembleAssemblerDirective(const QStringList& fields) {
         string.remove('\"');
         string.append('\0');
         byteArray = string.toUtf8();
-    } else if (DataAssemblerDirectives.contains(fields[0])) {
+    } else if (DataAssemblerSizes.contains(fields[0])) {
         assembleWords(fields, byteArray, DataAssemblerSizes.value(fields[0]));
     } else if (fields[0] == QString(".zero")) {
         bool canConvert;
@@ -668,13 +549,13 @@ void Assembler::assembleAssemblerDirective(const QStringList& fields) {
         for (int i = 0; i < padding; i++)
             byteArray.append('\0');
     }
-    m_dataSegment.append(byteArray);
+    block.data.append(byteArray);
 
     // Set hasData flag to trigger data segment insertion into simulator memory
-    m_hasData = true;
+    block.hasData = true;
 }
 
-void Assembler::unpackOp(const QStringList& _fields, int& pos) {
+void Assembler::unpackOp(const QStringList& _fields, int& pos, BlockAssembly& block) {
     // unpackOp
     // All pseudo-instructions will be converted to their corresponding sequence of operations
     // All hex- and binary immediate values will be converted to integer values, suitable for the assembly stage
@@ -695,14 +576,11 @@ void Assembler::unpackOp(const QStringList& _fields, int& pos) {
             fields[0] = splitFirst[1];
         }
 
-        // Update map entries at given block
+        // Record the label at its position within the block
         if (m_inDataSegment) {
-            m_labelPosMap[string] =
-                // Offset label by data segment position and length of the data segment
-                m_dataSegment.length() + DATA_START;
+            block.dataLabels.push_back({string, block.data.length()});
         } else {
-            // The label is in the text segment. Label is defined without an offset
-            m_labelPosMap[string] = pos * 4;
+            block.textLabels.push_back({string, pos * 4});
         }
         if (fields.isEmpty()) {
             return;
@@ -712,101 +590,122 @@ void Assembler::unpackOp(const QStringList& _fields, int& pos) {
     // Unpack operations
     if (pseudoOps.contains(fields[0])) {
         // A pseudo-operation is detected - unpack using unpackPseudoOp
-        unpackPseudoOp(fields, pos);
+        unpackPseudoOp(fields, pos, block);
     } else {
         if (fields[0][0] == '.') {
             // Assembler directive detected - handle directive (ie. setting data segment) POS is NOT incremented
-            assembleAssemblerDirective(fields);
+            assembleAssemblerDirective(fields, block);
             return;
-        } else if (opsWithOffsets.contains(fields[0])) {
-            m_lineLabelUsageMap[pos] =
-                fields.last();  // All offset using instructions have their offset as the last field value
         }
         // Add instruction to map and increment line counter by 1
-        m_instructionsMap[pos] = fields;
+        block.instructions[pos] = fields;
         pos++;
     }
 }
 
-inline QByteArray Assembler::uintToByteArr(uint32_t in) {
-    QByteArray out;
-    for (int i = 0; i < 4; i++) {
-        out.append((in)&0xff);
-        in >>= 8;
-    }
-    return out;
-}
-
 void Assembler::restart() {
     m_error = false;
     m_hasData = false;
-    m_instructionsMap.clear();
+    m_inDataSegment = false;
     m_lineLabelUsageMap.clear();
     m_labelPosMap.clear();
     m_textSegment.clear();
     m_dataSegment.clear();
 }
 
-namespace {
-inline QStringList splitColon(const QString& string) {
-    QStringList out = string.split(':');
-    for (int i = 0; i < out.length() - 1; i++) {
-        out[i].append(':');
+std::shared_ptr<const Assembler::BlockAssembly> Assembler::assembleBlock(const QTextBlock& block) {
+    QStringList fields;
+    if (const auto* lexed = AsmBlockData::get(block)) {
+        // The block was lexed by the highlighter of the document
+        fields = lexed->fields;
+    } else {
+        fields = tokenizeAssemblyLine(block.text());
     }
-    out.removeAll("");
-    return out;
+
+    // Errors are recorded with the block, such that they are reported again whenever the block is reused
+    const bool error = m_error;
+    m_error = false;
+
+    auto assembly = std::make_shared<BlockAssembly>();
+    /* UnpackOp will:
+     *  -unpack & convert pseudo operations into its required number of operations
+     * - Record label positioning
+     * - add instructions to the block
+     */
+    int pos = 0;
+    if (fields.length() > 0) {
+        unpackOp(fields, pos, *assembly);
+    }
+
+    // Instructions which do not depend on any labels or their own position are encoded right away. The remaining
+    // instructions are left as zero words, to be fixed up once all labels of the program are known.
+    for (const auto& item : assembly->instructions) {
+        const QStringList& instrFields = item.second;
+        const QString label = getLabelOperand(instrFields);
+        uint32_t instr = 0;
+        if (!label.isEmpty() || opsWithOffsets.contains(instrFields[0])) {
+            // All offset using instructions have their offset as the last field value
+            assembly->labelUsages[item.first] = label.isEmpty() ? instrFields.last() : label;
+        } else {
+            instr = assembleInstruction(instrFields, item.first);
+        }
+        // Little-endian insertion into the text of the block
+        for (int i = 0; i < 4; i++) {
+            assembly->text.append(static_cast<char>(instr & 0xff));
+            instr >>= 8;
+        }
+    }
+    assembly->endsInDataSegment = m_inDataSegment;
+    assembly->error = m_error;
+    m_error = error;
+    return assembly;
 }
-}  // namespace
 
 const QByteArray& Assembler::assemble(const QTextDocument& doc) {
     // Called by codeEditor when syntax has been accepted, and the document should be assembled into binary
     // Because of the previously accepted syntax, !no! error handling will be done, to ensure a fast execution
-    int line = 0;
     restart();
 
-    QStringList fields;
+    // Only blocks which were not part of the previous assembly are unpacked and encoded. All blocks are then placed
+    // in the program, recording the label positions and the lines which refer to labels.
+    BlockCache textBlocks;
+    BlockCache dataBlocks;
+    int row = 0;
     for (QTextBlock block = doc.begin(); block != doc.end(); block = block.next()) {
-        if (!block.text().isEmpty()) {
-            // Split input into fields
-            fields = block.text().split(splitter);
-            fields.removeAll("");
-            fields = splitQuotes(fields);
-            if (!fields.isEmpty()) {
-                // Split label fields, and keep separator ':'
-                if (fields[0].contains(':')) {
-                    auto firstFields = splitColon(fields.takeAt(0));
-                    fields = firstFields + fields;
-                }
-
-                // Remove comments from syntax evaluation
-                const static auto commentRegEx = QRegularExpression("[#](.*)");
-                int commentIndex = fields.indexOf(commentRegEx);
-                if (commentIndex != -1) {
-                    int index = fields.length();
-                    while (index >= commentIndex) {
-                        fields.removeAt(index);
-                        index--;
-                    }
-                }
-
-                /* UnpackOp will:
-                 *  -unpack & convert pseudo operations into its required number of operations
-                 * - Record label positioning
-                 * - Reord position of instructions which use labels
-                 * - add instructions to m_instructionsMap
-                 */
-                if (fields.length() > 0) {
-                    unpackOp(fields, line);
-                }
-            }
+        const QString text = block.text();
+        const BlockCache& prevBlocks = m_inDataSegment ? m_dataBlockCache : m_textBlockCache;
+        const auto cachedIt = prevBlocks.constFind(text);
+        const auto assembly = cachedIt != prevBlocks.constEnd() ? *cachedIt : assembleBlock(block);
+        (m_inDataSegment ? dataBlocks : textBlocks).insert(text, assembly);
+
+        for (const auto& label : assembly->textLabels) {
+            m_labelPosMap[label.first] = row * 4 + label.second;
         }
-    }
+        for (const auto& label : assembly->dataLabels) {
+            // Offset label by data segment position and length of the data segment
+            m_labelPosMap[label.first] = DATA_START + m_dataSegment.length() + label.second;
+        }
+        for (const auto& usage : assembly->labelUsages) {
+            m_lineLabelUsageMap[row + usage.first] = assembly->instructions.at(usage.first);
+        }
+        m_textSegment.append(assembly->text);
+        m_dataSegment.append(assembly->data);
+        row += assembly->instructions.size();
 
-    // Assemble instruction(s)
-    // Since the keys (line numbers) are sorted, we iterate straight over the map when inserting into the output
-    // bytearray
-    for (auto item : m_instructionsMap) {
-        assembleInstruction(item.second, item.first);
+        m_hasData |= assembly->hasData;
+        m_error |= assembly->error;
+        m_inDataSegment = assembly->endsInDataSegment;
+    }
+    m_textBlockCache.swap(textBlocks);
+    m_dataBlockCache.swap(dataBlocks);
+
+    // Label fixups
+    for (const auto& usage : m_lineLabelUsageMap) {
+        uint32_t instr = assembleInstruction(usage.second, usage.first);
+        for (int i = 0; i < 4; i++) {
+            m_textSegment[usage.first * 4 + i] = static_cast<char>(instr & 0xff);
+            instr >>= 8;
+        }
     }
 
     return m_textSegment;
@@ -1,14 +1,29 @@
 #pragma once
 
 #include <QByteArray>
+#include <QHash>
+#include <QTextBlock>
 #include <QTextDocument>
 
 #include <memory>
+#include <vector>
 
 #include "program.h"
 
 namespace Ripes {
 
+/**
+ * @brief The InstrEncoding struct
+ * Entry of the assembler encoding table. The format determines which of the instruction fields are encoded, and how.
+ */
+struct InstrEncoding {
+    enum class Format { OpImm, Op, Store, Load, Branch, Jalr, Lui, Auipc, Jal, Ecall, Amo };
+    Format format;
+    uint32_t opcode;
+    uint32_t funct3;
+    uint32_t funct7;
+};
+
 class Assembler {
 public:
     Assembler();
@@ -22,37 +37,69 @@ public:
     std::shared_ptr<Program> getProgram();
 
 private:
+    /**
+     * @brief The BlockAssembly struct
+     * Unpacked and encoded instructions and data of a single block (line) of a document. The result only depends on
+     * the text of the block and on whether the block starts in the data segment; rows and offsets are relative to the
+     * start of the block within the text and data segments. Instructions which refer to labels or to their own
+     * position are encoded as zero words, which are fixed up when the block is placed in a program.
+     */
+    struct BlockAssembly {
+        std::map<int, QStringList> instructions;
+        std::map<int, QString> labelUsages;  // Rows of instructions to fix up => referred label
+        std::vector<std::pair<QString, int>> textLabels;
+        std::vector<std::pair<QString, int>> dataLabels;
+        QByteArray text;
+        QByteArray data;
+        bool hasData = false;
+        bool error = false;
+        bool endsInDataSegment = false;
+    };
+    using BlockCache = QHash<QString, std::shared_ptr<const BlockAssembly>>;
+
     uint32_t getRegisterNumber(const QString& reg);
-    void unpackPseudoOp(const QStringList& fields, int& pos);
-    void unpackOp(const QStringList& fields, int& pos);
-    void assembleAssemblerDirective(const QStringList& fields);
+    QString getLabelOperand(const QStringList& fields);
+    void unpackPseudoOp(const QStringList& fields, int& pos, BlockAssembly& block);
+    void unpackOp(const QStringList& fields, int& pos, BlockAssembly& block);
+    void assembleAssemblerDirective(const QStringList& fields, BlockAssembly& block);
     void assembleWords(const QStringList& fields, QByteArray& byteArr, size_t size);
     void assembleZeroArray(QByteArray& byteArray, size_t size);
     void restart();
+    std::shared_ptr<const BlockAssembly> assembleBlock(const QTextBlock& block);
     int getImmediate(QString string, bool& canConvert);
-    QByteArray uintToByteArr(uint32_t);
 
     std::map<QString, int> m_labelPosMap;  // Map storing unpacked label
 
-    std::map<int, QString>
+    std::map<int, QStringList>
         m_lineLabelUsageMap;  // Lines that need to be updated with label values (offsets) after unpacking is finished
-    std::map<int, QStringList> m_instructionsMap;  // Map containing unpacked and offset-modified instruction
 
     QByteArray m_textSegment;
     QByteArray m_dataSegment;
+
+    /**
+     * Blocks of the previous assembly by their text, for blocks starting in the text and data segment respectively.
+     * Only blocks which are not found here are unpacked and encoded; all other blocks are reused, and only their
+     * instructions which refer to labels are re-encoded. The caches are rebuilt on each assembly to only contain the
+     * blocks of the current program.
+     */
+    BlockCache m_textBlockCache;
+    BlockCache m_dataBlockCache;
+
     bool m_error = false;
     bool m_hasData = false;
     bool m_inDataSegment = false;  // Set when stating .data directive. Following instructions will be added to the data
                                    // segment of the program
 
     // Assembler functions
-    void assembleInstruction(const QStringList& fields, int row);
-    QByteArray assembleOpImmInstruction(const QStringList& fields, int row);
-    QByteArray assembleOpInstruction(const QStringList& fields, int row);
-    QByteArray assembleStoreInstruction(const QStringList& fields, int row);
-    QByteArray assembleLoadInstruction(const QStringList& fields, int row);
-    QByteArray assembleBranchInstruction(const QStringList& fields, int row);
-    QByteArray assembleAuipcInstruction(const QStringList& fields, int row);
-    QByteArray assembleJalrInstruction(const QStringList& fields, int row);
+    uint32_t assembleInstruction(const QStringList& fields, int row);
+    uint32_t assembleOpImmInstruction(const QStringList& fields, int row, const InstrEncoding& enc);
+    uint32_t assembleOpInstruction(const QStringList& fields, const InstrEncoding& enc);
+    uint32_t assembleStoreInstruction(const QStringList& fields, int row, const InstrEncoding& enc);
+    uint32_t assembleLoadInstruction(const QStringList& fields, int row, const InstrEncoding& enc);
+    uint32_t assembleBranchInstruction(const QStringList& fields, int row, const InstrEncoding& enc);
+    uint32_t assembleAuipcInstruction(const QStringList& fields, const InstrEncoding& enc);
+    uint32_t assembleJalrInstruction(const QStringList& fields, int row, const InstrEncoding& enc);
+    uint32_t assembleJalInstruction(const QStringList& fields, int row, const InstrEncoding& enc);
+    uint32_t assembleAmoInstruction(const QStringList& fields, const InstrEncoding& enc);
 };
 }  // namespace Ripes
@@ -0,0 +1,113 @@
+#include "assemblylexer.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "lexerutilities.h"
+
+namespace Ripes {
+
+namespace {
+/**
+ * @brief splitColon
+ * Splits @p field at ':' characters, keeping the separator with the preceding piece, and appends the non-empty pieces
+ * to @p out.
+ */
+void splitColon(const QStringRef& field, QVector<QStringRef>& out) {
+    int start = 0;
+    int colon;
+    while ((colon = field.indexOf(':', start)) != -1) {
+        out.append(field.mid(start, colon + 1 - start));
+        start = colon + 1;
+    }
+    if (start < field.size()) {
+        out.append(field.mid(start));
+    }
+}
+
+inline bool isWordChar(QChar c) {
+    return c.isLetterOrNumber() || c == '_' || c == '.';
+}
+}  // namespace
+
+QStringList tokenizeAssemblyLine(const QString& line) {
+    const QVector<QStringRef> lineFields = tokenizeLineRefs(line);
+    if (lineFields.isEmpty()) {
+        return {};
+    }
+
+    // Split label fields, and keep separator ':'
+    QVector<QStringRef> refs;
+    refs.reserve(lineFields.size() + 1);
+    splitColon(lineFields.front(), refs);
+    std::copy(lineFields.begin() + 1, lineFields.end(), std::back_inserter(refs));
+
+    // Remove comments from syntax evaluation, and only copy the remaining fields out of the line
+    QStringList fields;
+    for (const auto& ref : refs) {
+        if (ref.startsWith('#')) {
+            break;
+        }
+        fields.append(ref.toString());
+    }
+    return fields;
+}
+
+std::vector<AsmToken> lexAssemblyLine(const QString& line) {
+    std::vector<AsmToken> tokens;
+    const int n = line.length();
+    int i = 0;
+    while (i < n) {
+        const QChar c = line.at(i);
+        if (c == '#') {
+            tokens.push_back({AsmToken::Kind::Comment, i, n - i});
+            break;
+        }
+
+        if (c == '"') {
+            const int closing = line.indexOf('"', i + 1);
+            const int end = closing == -1 ? n : closing + 1;
+            tokens.push_back({AsmToken::Kind::String, i, end - i});
+            i = end;
+            continue;
+        }
+
+        const bool signedNumber = (c == '-' || c == '+') && i + 1 < n && line.at(i + 1).isDigit();
+        if (isWordChar(c) || signedNumber) {
+            int end = i + 1;
+            while (end < n && isWordChar(line.at(end))) {
+                end++;
+            }
+            if (end < n && line.at(end) == ':') {
+                tokens.push_back({AsmToken::Kind::Label, i, end + 1 - i});
+                i = end + 1;
+            } else {
+                const auto kind = signedNumber || c.isDigit() ? AsmToken::Kind::Immediate : AsmToken::Kind::Word;
+                tokens.push_back({kind, i, end - i});
+                i = end;
+            }
+            continue;
+        }
+        i++;
+    }
+    return tokens;
+}
+
+AsmBlockData::AsmBlockData(const QString& _text)
+    : text(_text), tokens(lexAssemblyLine(_text)), fields(tokenizeAssemblyLine(_text)) {}
+
+AsmBlockData::AsmBlockData(const AsmBlockData& other)
+    : QTextBlockUserData(), text(other.text), tokens(other.tokens), fields(other.fields) {}
+
+AsmBlockData::~AsmBlockData() {
+    if (onDestroyed) {
+        onDestroyed(this);
+    }
+}
+
+AsmBlockData* AsmBlockData::get(const QTextBlock& block) {
+    auto* data = dynamic_cast<AsmBlockData*>(block.userData());
+    return data && data->text == block.text() ? data : nullptr;
+}
+
+}  // namespace Ripes
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QStringList>
+#include <QTextBlock>
+#include <QTextBlockUserData>
+
+#include <functional>
+#include <vector>
+
+namespace Ripes {
+
+/**
+ * @brief tokenizeAssemblyLine
+ * Splits a line of assembly into the fields consumed by the assembler and syntax checker: instruction/directive,
+ * operands and string literals. Label definitions are split into separate fields which retain their ':', and
+ * comments are removed.
+ */
+QStringList tokenizeAssemblyLine(const QString& line);
+
+struct AsmToken {
+    enum class Kind { Label, Word, Immediate, String, Comment };
+    Kind kind;
+    int start;
+    int length;
+};
+
+/**
+ * @brief lexAssemblyLine
+ * Hand-written lexer producing the highlighting tokens of a line of assembly, in order of appearance. Words are not
+ * classified further; it is up to the consumer to determine whether a word is an instruction, register or label.
+ */
+std::vector<AsmToken> lexAssemblyLine(const QString& line);
+
+/**
+ * @brief The AsmBlockData class
+ * Lexing and syntax checking results of a single block (line) of an assembly document. The data is attached to its
+ * block by the assembly highlighter whenever the block is (re)highlighted, which QSyntaxHighlighter only does for
+ * blocks that were changed. All consumers of the document (highlighting, error tooltips, the assembler) share these
+ * results in place of lexing the document themselves.
+ */
+class AsmBlockData : public QTextBlockUserData {
+public:
+    explicit AsmBlockData(const QString& text);
+    /** Copies the lexing results of @p other, but not its syntax checking results */
+    explicit AsmBlockData(const AsmBlockData& other);
+    ~AsmBlockData() override;
+
+    /**
+     * @brief get
+     * @returns the data of @p block, or nullptr if the block has not been lexed in its current state.
+     */
+    static AsmBlockData* get(const QTextBlock& block);
+
+    QString text;
+    std::vector<AsmToken> tokens;
+    QStringList fields;
+
+    /** Label defined by the line, if any */
+    QString label;
+    /** Labels referenced by the operands of the line */
+    QStringList labelRefs;
+    /** Syntax error of the line; empty if the line is valid */
+    QString error;
+
+    /** Called upon destruction, ie. when the data is replaced or its block is removed from the document */
+    std::function<void(AsmBlockData*)> onDestroyed;
+};
+
+}  // namespace Ripes
@@ -60,6 +60,7 @@ void CacheConfigWidget::setCache(CacheSim* cache) {
     connect(m_cache, &CacheSim::configurationChanged, this, &CacheConfigWidget::handleConfigurationChanged);
     connect(m_cache, &CacheSim::configurationChanged, [=] { emit configurationChanged(); });
     connect(m_cache, &CacheSim::hitrateChanged, this, &CacheConfigWidget::updateHitrate);
+    connect(m_cache, &CacheSim::liveStatsChanged, this, &CacheConfigWidget::updateLiveHitrate);
 
     setupPresets();
     handleConfigurationChanged();
@@ -135,6 +136,14 @@ void CacheConfigWidget::updateHitrate() {
     m_ui->writebacks->setText(QString::number(m_cache->getWritebacks()));
 }
 
+void CacheConfigWidget::updateLiveHitrate() {
+    const auto& stats = m_cache->getLiveStats();
+    m_ui->hitrate->setText(QString::number(stats.hitRate(), 'G', 4));
+    m_ui->hits->setText(QString::number(stats.hits));
+    m_ui->misses->setText(QString::number(stats.misses));
+    m_ui->writebacks->setText(QString::number(stats.writebacks));
+}
+
 void CacheConfigWidget::showSizeBreakdown() {
     QString sizeText;
 
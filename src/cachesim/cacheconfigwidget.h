@@ -23,6 +23,7 @@ signals:
 
 public slots:
     void updateHitrate();
+    void updateLiveHitrate();
     void handleConfigurationChanged();
     void showCachePlot();
 
@@ -2,6 +2,7 @@
 #include "binutils.h"
 
 #include "processorhandler.h"
+#include "selfprofiler.h"
 
 #include <QApplication>
 #include <QThread>
@@ -13,11 +14,28 @@ namespace Ripes {
 CacheSim::CacheSim(QObject* parent) : QObject(parent) {
     connect(ProcessorHandler::get(), &ProcessorHandler::reqProcessorReset, this, &CacheSim::processorReset);
 
-    connect(ProcessorHandler::get(), &ProcessorHandler::runFinished, this, [=] {
+    const auto reloadView = [=] {
         // Given that we are not updating the graphical state of the cache simulator whilst the processor is running,
         // once running is finished, the entirety of the cache view should be reloaded in the graphical view.
         emit hitrateChanged();
         emit cacheInvalidated();
+    };
+    connect(ProcessorHandler::get(), &ProcessorHandler::runFinished, this, reloadView);
+    connect(ProcessorHandler::get(), &ProcessorHandler::animationFrame, this, reloadView);
+
+    // Live statistics whilst running. Statistics are published from the simulation thread, and consumed in the GUI
+    // thread.
+    connect(
+        ProcessorHandler::get(), &ProcessorHandler::takingSnapshot, this,
+        [=] {
+            m_liveStats.back() = {getHits(), getMisses(), getWritebacks()};
+            m_liveStats.publish();
+        },
+        Qt::DirectConnection);
+    connect(ProcessorHandler::get(), &ProcessorHandler::snapshotUpdated, this, [=] {
+        if (m_liveStats.update()) {
+            emit liveStatsChanged();
+        }
     });
 
     updateConfiguration();
@@ -262,6 +280,7 @@ void CacheSim::popAccessTrace() {
 }
 
 void CacheSim::access(uint32_t address, AccessType type) {
+    RIPES_PROFILE_SCOPE(CacheSim);
     address = address & ~0b11;  // Disregard unaligned accesses
     CacheTrace trace;
     CacheWay oldWay;
@@ -451,11 +470,26 @@ void CacheSim::processorWasClocked() {
                     // Nothing to do
                     return;
                 }
+            case MemOp::SC:
+            case MemOp::AMOSWAP:
+            case MemOp::AMOADD:
+            case MemOp::AMOXOR:
+            case MemOp::AMOAND:
+            case MemOp::AMOOR:
+            case MemOp::AMOMIN:
+            case MemOp::AMOMAX:
+            case MemOp::AMOMINU:
+            case MemOp::AMOMAXU:
+                // Atomics read the old value and write the new value within the same cycle. A failing SC.W does not
+                // write, but still accesses the cache.
+                type = m_memory.rw->mem_wr_en->out.uValue() == 1 ? AccessType::Write : AccessType::Read;
+                break;
             case MemOp::LB:
             case MemOp::LBU:
             case MemOp::LH:
             case MemOp::LHU:
             case MemOp::LW:
+            case MemOp::LR:
                 type = AccessType::Read;
                 break;
             case MemOp::NOP:
@@ -8,6 +8,7 @@
 
 #include "../external/VSRTL/core/vsrtl_register.h"
 #include "processors/RISC-V/rv_memory.h"
+#include "snapshotbuffer.h"
 
 using RWMemory = vsrtl::core::RVMemory<32, 32>;
 using ROMMemory = vsrtl::core::ROM<32, 32>;
@@ -114,6 +115,19 @@ public:
     unsigned getWritebacks() const;
     CacheSize getCacheSize() const;
 
+    struct Stats {
+        unsigned hits = 0;
+        unsigned misses = 0;
+        unsigned writebacks = 0;
+        double hitRate() const { return hits + misses == 0 ? 0 : static_cast<double>(hits) / (hits + misses); }
+    };
+    /**
+     * @brief getLiveStats
+     * @returns the cache statistics as of the most recent live snapshot taken while the processor is running
+     * asynchronously. Valid upon liveStatsChanged being emitted.
+     */
+    const Stats& getLiveStats() const { return m_liveStats.front(); }
+
     uint32_t buildAddress(unsigned tag, unsigned lineIdx, unsigned blockIdx) const;
 
     int getBlockBits() const { return m_blocks; }
@@ -151,6 +165,7 @@ signals:
     void configurationChanged();
     void dataChanged(const CacheTransaction* transaction);
     void hitrateChanged();
+    void liveStatsChanged();
 
     // Signals that the entire cache line @p
     /**
@@ -238,6 +253,13 @@ private:
      */
     std::map<unsigned, CacheAccessTrace> m_accessTrace;
 
+    /**
+     * @brief m_liveStats
+     * Statistics published from the simulation thread upon live snapshots, given that m_accessTrace may not be accessed
+     * by the GUI while the processor is running asynchronously.
+     */
+    SnapshotBuffer<Stats> m_liveStats;
+
     /**
      * @brief m_traceStack
      * The following information is used to track all most-recent modifications made to the stack. The stack is of a
@@ -0,0 +1,127 @@
+#include "coherentcaches.h"
+
+namespace Ripes {
+
+CoherentCaches::CoherentCaches(const Config& config) : m_config(config) {
+    reset();
+}
+
+void CoherentCaches::reset() {
+    m_caches.assign(m_config.cores, std::vector<Line>(1u << m_config.lines, Line(1u << m_config.ways)));
+    m_coreStats.assign(m_config.cores, CoreStats());
+    m_busStats = BusStats();
+    m_time = 0;
+}
+
+uint32_t CoherentCaches::lineIdx(uint32_t address) const {
+    return (address >> (2 + m_config.blocks)) & ((1u << m_config.lines) - 1);
+}
+
+uint32_t CoherentCaches::tag(uint32_t address) const {
+    return address >> (2 + m_config.blocks + m_config.lines);
+}
+
+CoherentCaches::Way* CoherentCaches::find(unsigned core, uint32_t address) {
+    for (auto& way : m_caches.at(core).at(lineIdx(address))) {
+        if (way.state != State::Invalid && way.tag == tag(address)) {
+            return &way;
+        }
+    }
+    return nullptr;
+}
+
+const CoherentCaches::Way* CoherentCaches::find(unsigned core, uint32_t address) const {
+    return const_cast<CoherentCaches*>(this)->find(core, address);
+}
+
+CoherentCaches::State CoherentCaches::state(unsigned core, uint32_t address) const {
+    const Way* way = find(core, address);
+    return way ? way->state : State::Invalid;
+}
+
+CoherentCaches::Way& CoherentCaches::allocate(unsigned core, uint32_t address) {
+    Line& line = m_caches.at(core).at(lineIdx(address));
+    Way* victim = &line.front();
+    for (auto& way : line) {
+        if (way.state == State::Invalid) {
+            victim = &way;
+            break;
+        }
+        if (way.lastUse < victim->lastUse) {
+            victim = &way;
+        }
+    }
+
+    if (victim->state == State::Modified) {
+        m_coreStats.at(core).writebacks++;
+        m_busStats.memoryWrites++;
+    }
+    victim->tag = tag(address);
+    return *victim;
+}
+
+bool CoherentCaches::snoop(unsigned requester, uint32_t address, bool exclusive, bool& flushed) {
+    bool held = false;
+    flushed = false;
+    for (unsigned core = 0; core < m_config.cores; core++) {
+        Way* way = core == requester ? nullptr : find(core, address);
+        if (!way) {
+            continue;
+        }
+        held = true;
+        if (way->state == State::Modified) {
+            // The modified line is flushed to the requester and to memory
+            flushed = true;
+            m_coreStats.at(core).interventions++;
+            m_busStats.cacheToCache++;
+            m_busStats.memoryWrites++;
+        }
+        if (exclusive) {
+            way->state = State::Invalid;
+            m_coreStats.at(core).invalidations++;
+        } else {
+            way->state = State::Shared;
+        }
+    }
+    return held;
+}
+
+void CoherentCaches::access(unsigned core, uint32_t address, bool write) {
+    auto& stats = m_coreStats.at(core);
+    (write ? stats.writes : stats.reads)++;
+    m_time++;
+
+    bool flushed;
+    if (Way* way = find(core, address)) {
+        stats.hits++;
+        way->lastUse = m_time;
+        if (write && way->state == State::Shared) {
+            // Invalidate all other copies; the data is already present
+            m_busStats.busUpgr++;
+            snoop(core, address, true, flushed);
+        }
+        if (write) {
+            way->state = State::Modified;
+        }
+        return;
+    }
+
+    stats.misses++;
+    Way& way = allocate(core, address);
+    way.lastUse = m_time;
+    (write ? m_busStats.busRdX : m_busStats.busRd)++;
+    const bool shared = snoop(core, address, write, flushed);
+    if (!flushed) {
+        m_busStats.memoryReads++;
+    }
+
+    if (write) {
+        way.state = State::Modified;
+    } else if (shared || m_config.protocol == Protocol::MSI) {
+        way.state = State::Shared;
+    } else {
+        way.state = State::Exclusive;
+    }
+}
+
+}  // namespace Ripes
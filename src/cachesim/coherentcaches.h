@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Ripes {
+
+/**
+ * @brief The CoherentCaches class
+ * Model of the private L1 data caches of a multi-core system, kept coherent through a snooping bus by either the MSI or
+ * the MESI protocol. Caches are write-back, write-allocate and LRU-replaced, and are configured as CacheSim, through
+ * the number of words per block and the number of lines and ways, each given as a power of 2.
+ * As CacheSim, only the tags and states of cache lines are modelled; data remains in memory.
+ *
+ * A modified line is flushed when another core requests it, which supplies the requester directly (a cache-to-cache
+ * transfer) and updates memory. All other misses are supplied by memory. Under MESI, a line read while no other cache
+ * holds it is installed in the exclusive state, and may subsequently be written without a bus transaction; under MSI,
+ * such a write requires a bus upgrade.
+ * Atomic read-modify-write accesses are modelled as writes, which acquire the line in the modified state.
+ */
+class CoherentCaches {
+public:
+    enum class Protocol { MSI, MESI };
+    enum class State { Invalid, Shared, Exclusive, Modified };
+
+    struct Config {
+        unsigned cores = 1;
+        Protocol protocol = Protocol::MESI;
+        int blocks = 2;
+        int lines = 5;
+        int ways = 0;
+    };
+
+    struct CoreStats {
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        /** Modified lines written back to memory upon eviction */
+        uint64_t writebacks = 0;
+        /** Lines invalidated by the writes of other cores */
+        uint64_t invalidations = 0;
+        /** Modified lines flushed to other cores */
+        uint64_t interventions = 0;
+        double hitRate() const { return hits + misses == 0 ? 0 : static_cast<double>(hits) / (hits + misses); }
+    };
+
+    struct BusStats {
+        uint64_t busRd = 0;
+        uint64_t busRdX = 0;
+        uint64_t busUpgr = 0;
+        uint64_t cacheToCache = 0;
+        uint64_t memoryReads = 0;
+        uint64_t memoryWrites = 0;
+        uint64_t transactions() const { return busRd + busRdX + busUpgr; }
+    };
+
+    explicit CoherentCaches(const Config& config);
+
+    void access(unsigned core, uint32_t address, bool write);
+    void reset();
+
+    /** @returns the state of the line containing @p address in the cache of @p core */
+    State state(unsigned core, uint32_t address) const;
+
+    const Config& config() const { return m_config; }
+    const CoreStats& coreStats(unsigned core) const { return m_coreStats.at(core); }
+    const BusStats& busStats() const { return m_busStats; }
+
+private:
+    struct Way {
+        uint32_t tag = 0;
+        State state = State::Invalid;
+        /** Time of the most recent access, for LRU replacement */
+        uint64_t lastUse = 0;
+    };
+    using Line = std::vector<Way>;
+
+    uint32_t lineIdx(uint32_t address) const;
+    uint32_t tag(uint32_t address) const;
+    /** @returns the valid way holding @p address in the cache of @p core, if any */
+    Way* find(unsigned core, uint32_t address);
+    const Way* find(unsigned core, uint32_t address) const;
+
+    /**
+     * @brief allocate
+     * Installs the line containing @p address in the cache of @p core, evicting the least recently used way.
+     */
+    Way& allocate(unsigned core, uint32_t address);
+
+    /**
+     * @brief snoop
+     * Applies a bus transaction of @p requester to the caches of all other cores; an @p exclusive transaction
+     * invalidates all other copies of the line. @returns true if any other cache held the line. @p flushed is set if
+     * another cache supplied the line.
+     */
+    bool snoop(unsigned requester, uint32_t address, bool exclusive, bool& flushed);
+
+    Config m_config;
+    /** Per core, the lines of its cache */
+    std::vector<std::vector<Line>> m_caches;
+    std::vector<CoreStats> m_coreStats;
+    BusStats m_busStats;
+    uint64_t m_time = 0;
+};
+
+}  // namespace Ripes
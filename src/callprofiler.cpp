@@ -0,0 +1,269 @@
+#include "callprofiler.h"
+
+#include <QFile>
+
+#include "processorhandler.h"
+#include "ripessettings.h"
+
+namespace Ripes {
+
+namespace {
+constexpr uint32_t c_opcodeMask = 0b1111111;
+constexpr uint32_t c_jalOpcode = 0b1101111;
+constexpr uint32_t c_jalrOpcode = 0b1100111;
+
+inline bool isLinkRegister(unsigned reg) {
+    return reg == 1 || reg == 5;
+}
+
+inline QString hexAddress(uint32_t address) {
+    return "0x" + QString::number(address, 16);
+}
+}  // namespace
+
+CallProfiler::CallProfiler() {
+    connect(ProcessorHandler::get(), &ProcessorHandler::reqProcessorReset, this, &CallProfiler::processorReset);
+    connect(RipesSettings::getObserver(RIPES_SETTING_REWINDSTACKSIZE), &SettingObserver::modified,
+            [=](const auto& size) { m_maxRecords = size.toUInt(); });
+    m_maxRecords = RipesSettings::value(RIPES_SETTING_REWINDSTACKSIZE).toUInt();
+    processorReset();
+}
+
+void CallProfiler::setEnabled(bool enabled) {
+    m_enabled = enabled;
+    clear();
+}
+
+void CallProfiler::processorReset() {
+    // The processor might have changed. As in CacheSim, (re)connect to the VSRTL design update signals.
+    auto* proc = ProcessorHandler::get()->getProcessorNonConst();
+    proc->designWasClocked.Connect(this, &CallProfiler::processorWasClocked);
+    proc->designWasReversed.Connect(this, &CallProfiler::processorWasReversed);
+    proc->designWasReset.Connect(this, &CallProfiler::processorReset);
+    clear();
+}
+
+void CallProfiler::clear() {
+    m_functions.clear();
+    m_functionIds.clear();
+    m_stack.clear();
+    m_records.clear();
+    m_total = Cost();
+    m_hasPendingCall = false;
+    m_retiring = StageInfo();
+
+    if (m_enabled) {
+        // The root frame is the function which is currently being fetched
+        const auto* proc = ProcessorHandler::get()->getProcessor();
+        m_lastRetireCycle = proc->getCycleCount();
+        m_stack.push_back({functionFor(proc->getPcForStage(0)), 0, Cost()});
+        m_retiring = proc->stageInfo(proc->stageCount() - 1);
+    }
+    emit profileChanged();
+}
+
+CallProfiler::FnId CallProfiler::functionFor(uint32_t address) {
+    // Locate the closest symbol at or below the address
+    uint32_t fnAddress = address;
+    QString name;
+    if (auto program = ProcessorHandler::get()->getProgram().lock()) {
+        auto it = program->symbols.upper_bound(address);
+        if (it != program->symbols.begin()) {
+            it--;
+            fnAddress = it->first;
+            name = it->second;
+        }
+    }
+
+    auto idIt = m_functionIds.find(fnAddress);
+    if (idIt != m_functionIds.end()) {
+        return idIt->second;
+    }
+
+    const FnId id = m_functions.size();
+    m_functions.push_back({name.isEmpty() ? hexAddress(fnAddress) : name, fnAddress, {}, {}});
+    m_functionIds[fnAddress] = id;
+    return id;
+}
+
+CallProfiler::ControlFlow CallProfiler::decodeControlFlow(uint32_t instr) const {
+    const unsigned opcode = instr & c_opcodeMask;
+    const unsigned rd = (instr >> 7) & 0b11111;
+    const unsigned rs1 = (instr >> 15) & 0b11111;
+
+    if (opcode == c_jalOpcode) {
+        return isLinkRegister(rd) ? ControlFlow::Call : ControlFlow::None;
+    } else if (opcode == c_jalrOpcode) {
+        // Return address stack hints, as specified in table 2.1 of the RISC-V unprivileged specification
+        const bool rdLink = isLinkRegister(rd);
+        const bool rs1Link = isLinkRegister(rs1);
+        if (rdLink && rs1Link) {
+            return rd == rs1 ? ControlFlow::Call : ControlFlow::ReturnCall;
+        } else if (rdLink) {
+            return ControlFlow::Call;
+        } else if (rs1Link) {
+            return ControlFlow::Return;
+        }
+    }
+    return ControlFlow::None;
+}
+
+void CallProfiler::retire(uint32_t pc, uint64_t cycle, ClockRecord& record) {
+    // A call instruction was the previously retired instruction; this instruction is the first of the callee
+    if (m_hasPendingCall) {
+        m_hasPendingCall = false;
+        const FnId caller = m_stack.back().fn;
+        m_stack.push_back({functionFor(pc), m_pendingCallSite, m_total});
+        m_functions.at(caller).calls[{m_pendingCallSite, m_stack.back().fn}].calls++;
+        record.pushedFrame = true;
+    }
+
+    // Exclusive cost of the instruction
+    Cost cost;
+    cost.cycles = cycle - m_lastRetireCycle;
+    cost.instructions = 1;
+    m_lastRetireCycle = cycle;
+    m_total += cost;
+
+    record.retired = true;
+    record.pc = pc;
+    record.fn = m_stack.back().fn;
+    record.cost = cost;
+    m_functions.at(record.fn).selfCost[pc] += cost;
+
+    const auto flow = decodeControlFlow(ProcessorHandler::get()->getMemory().readMemConst(pc));
+    if ((flow == ControlFlow::Return || flow == ControlFlow::ReturnCall) && m_stack.size() > 1) {
+        // The returning instruction is accounted for in the inclusive cost of the callee
+        const Frame frame = m_stack.back();
+        m_stack.pop_back();
+        m_functions.at(m_stack.back().fn).calls[{frame.callSite, frame.fn}].inclusive += m_total - frame.entry;
+        record.poppedFrames.push_back(frame);
+    }
+    if (flow == ControlFlow::Call || flow == ControlFlow::ReturnCall) {
+        m_hasPendingCall = true;
+        m_pendingCallSite = pc;
+    }
+}
+
+void CallProfiler::processorWasClocked() {
+    if (!m_enabled) {
+        return;
+    }
+
+    const auto* proc = ProcessorHandler::get()->getProcessor();
+    ClockRecord record;
+    record.prevRetiring = m_retiring;
+    record.prevLastRetireCycle = m_lastRetireCycle;
+    record.prevHasPendingCall = m_hasPendingCall;
+    record.prevPendingCallSite = m_pendingCallSite;
+
+    // The instruction which was present in the last stage has now been retired
+    if (m_retiring.stage_valid && m_retiring.state == StageInfo::State::None &&
+        ProcessorHandler::get()->isExecutableAddress(m_retiring.pc)) {
+        retire(m_retiring.pc, proc->getCycleCount(), record);
+    }
+    m_retiring = proc->stageInfo(proc->stageCount() - 1);
+
+    // Only keep as many records as the processor is able to reverse
+    m_records.push_back(std::move(record));
+    while (m_records.size() > m_maxRecords) {
+        m_records.pop_front();
+    }
+}
+
+void CallProfiler::processorWasReversed() {
+    if (!m_enabled || m_records.empty()) {
+        return;
+    }
+
+    // Undo the changes of the most recent clock cycle, in reverse order of application
+    const ClockRecord& record = m_records.back();
+    if (record.retired) {
+        for (auto it = record.poppedFrames.rbegin(); it != record.poppedFrames.rend(); it++) {
+            m_functions.at(m_stack.back().fn).calls[{it->callSite, it->fn}].inclusive -= m_total - it->entry;
+            m_stack.push_back(*it);
+        }
+
+        auto& selfCost = m_functions.at(record.fn).selfCost;
+        selfCost[record.pc] -= record.cost;
+        if (selfCost[record.pc].instructions == 0) {
+            selfCost.erase(record.pc);
+        }
+        m_total -= record.cost;
+
+        if (record.pushedFrame) {
+            const Frame frame = m_stack.back();
+            m_stack.pop_back();
+            auto& calls = m_functions.at(m_stack.back().fn).calls;
+            const auto key = std::make_pair(frame.callSite, frame.fn);
+            if (--calls[key].calls == 0) {
+                calls.erase(key);
+            }
+        }
+    }
+
+    m_retiring = record.prevRetiring;
+    m_lastRetireCycle = record.prevLastRetireCycle;
+    m_hasPendingCall = record.prevHasPendingCall;
+    m_pendingCallSite = record.prevPendingCallSite;
+    m_records.pop_back();
+}
+
+void CallProfiler::writeCallgrind(QTextStream& out) const {
+    // Account for the cost of frames which have yet to return
+    std::vector<std::map<std::pair<uint32_t, FnId>, CallCost>> calls;
+    for (const auto& fn : m_functions) {
+        calls.push_back(fn.calls);
+    }
+    for (unsigned i = 1; i < m_stack.size(); i++) {
+        const auto& frame = m_stack.at(i);
+        calls.at(m_stack.at(i - 1).fn)[{frame.callSite, frame.fn}].inclusive += m_total - frame.entry;
+    }
+
+    out << "# callgrind format\n";
+    out << "version: 1\n";
+    out << "creator: Ripes\n";
+    out << "positions: instr\n";
+    out << "events: Cycles Instructions\n";
+    out << "summary: " << m_total.cycles << " " << m_total.instructions << "\n";
+
+    // Callgrind name compression; a function name is only written upon its first occurrence
+    std::vector<bool> named(m_functions.size(), false);
+    const auto fnName = [&](FnId id) {
+        QString s = "(" + QString::number(id + 1) + ")";
+        if (!named.at(id)) {
+            named.at(id) = true;
+            s += " " + m_functions.at(id).name;
+        }
+        return s;
+    };
+
+    for (FnId id = 0; id < m_functions.size(); id++) {
+        const auto& fn = m_functions.at(id);
+        out << "\nfn=" << fnName(id) << "\n";
+        for (const auto& pcCost : fn.selfCost) {
+            out << hexAddress(pcCost.first) << " " << pcCost.second.cycles << " " << pcCost.second.instructions
+                << "\n";
+        }
+        for (const auto& call : calls.at(id)) {
+            const auto& callee = m_functions.at(call.first.second);
+            out << "cfn=" << fnName(call.first.second) << "\n";
+            out << "calls=" << call.second.calls << " " << hexAddress(callee.address) << "\n";
+            out << hexAddress(call.first.first) << " " << call.second.inclusive.cycles << " "
+                << call.second.inclusive.instructions << "\n";
+        }
+    }
+    out << "\ntotals: " << m_total.cycles << " " << m_total.instructions << "\n";
+}
+
+bool CallProfiler::exportCallgrind(const QString& filename) const {
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        return false;
+    }
+    QTextStream out(&file);
+    writeCallgrind(out);
+    return true;
+}
+
+}  // namespace Ripes
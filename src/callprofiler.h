@@ -0,0 +1,158 @@
+#pragma once
+
+#include <QObject>
+#include <QTextStream>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "processors/ripesprocessor.h"
+
+namespace Ripes {
+
+/**
+ * @brief The CallProfiler class
+ * Function-level profiler for the currently loaded processor. Calls and returns are detected when jal/jalr
+ * instructions retire, using the return-address-stack hints of the RISC-V specification (rd/rs1 being a link register,
+ * x1 or x5). A shadow call stack is maintained through which retired instructions and the cycles spent retiring them
+ * are attributed to the function on top of the stack. Function names are taken from the symbols of the currently
+ * loaded program.
+ * Clock cycles are attributed to the instruction which retires at the end of them, ie. stall cycles are accounted to
+ * the instruction which was stalled.
+ * The collected profile may be exported in the callgrind format, for inspection in ie. KCachegrind.
+ */
+class CallProfiler : public QObject {
+    Q_OBJECT
+
+public:
+    using FnId = unsigned;
+
+    struct Cost {
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+
+        Cost& operator+=(const Cost& rhs) {
+            cycles += rhs.cycles;
+            instructions += rhs.instructions;
+            return *this;
+        }
+        Cost& operator-=(const Cost& rhs) {
+            cycles -= rhs.cycles;
+            instructions -= rhs.instructions;
+            return *this;
+        }
+        Cost operator-(const Cost& rhs) const {
+            Cost c = *this;
+            c -= rhs;
+            return c;
+        }
+    };
+
+    struct CallCost {
+        uint64_t calls = 0;
+        Cost inclusive;
+    };
+
+    struct FunctionStats {
+        QString name;
+        uint32_t address;
+        /** Exclusive cost of each retired instruction within the function */
+        std::map<uint32_t, Cost> selfCost;
+        /** Calls made from this function, keyed by call site address and callee */
+        std::map<std::pair<uint32_t, FnId>, CallCost> calls;
+    };
+
+    static CallProfiler* get() {
+        static auto* profiler = new CallProfiler;
+        return profiler;
+    }
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    const std::vector<FunctionStats>& functions() const { return m_functions; }
+
+    /**
+     * @brief writeCallgrind
+     * Writes the current profile to @p out in the callgrind format. Functions which are currently on the shadow stack
+     * have their inclusive cost accounted for up until the most recently retired instruction.
+     */
+    void writeCallgrind(QTextStream& out) const;
+
+    /**
+     * @brief exportCallgrind
+     * Convenience wrapper around writeCallgrind, writing the profile to @p filename.
+     * @returns whether the file could be written.
+     */
+    bool exportCallgrind(const QString& filename) const;
+
+public slots:
+    void processorReset();
+
+signals:
+    /**
+     * @brief profileChanged
+     * Emitted whenever the profile was enabled, disabled or cleared.
+     */
+    void profileChanged();
+
+private:
+    CallProfiler();
+
+    struct Frame {
+        FnId fn;
+        uint32_t callSite;
+        /** Total cost accumulated at the point of entering the frame */
+        Cost entry;
+    };
+
+    enum class ControlFlow { None, Call, Return, ReturnCall };
+
+    /**
+     * @brief The ClockRecord struct
+     * Contains the changes made to the profile within a single clock cycle, such that the cycle may be undone when the
+     * processor is reversed.
+     */
+    struct ClockRecord {
+        StageInfo prevRetiring;
+        uint64_t prevLastRetireCycle;
+        bool prevHasPendingCall;
+        uint32_t prevPendingCallSite;
+
+        bool retired = false;
+        uint32_t pc;
+        FnId fn;
+        Cost cost;
+        bool pushedFrame = false;
+        std::vector<Frame> poppedFrames;
+    };
+
+    void processorWasClocked();
+    void processorWasReversed();
+    void clear();
+
+    void retire(uint32_t pc, uint64_t cycle, ClockRecord& record);
+    ControlFlow decodeControlFlow(uint32_t instr) const;
+    FnId functionFor(uint32_t address);
+
+    bool m_enabled = false;
+
+    std::vector<FunctionStats> m_functions;
+    std::map<uint32_t, FnId> m_functionIds;
+    std::vector<Frame> m_stack;
+    Cost m_total;
+
+    /** The instruction currently in the last stage of the processor, which retires upon the next clock edge */
+    StageInfo m_retiring;
+    uint64_t m_lastRetireCycle = 0;
+
+    /** Set when a call instruction retired. The callee is resolved by the next retired instruction. */
+    bool m_hasPendingCall = false;
+    uint32_t m_pendingCallSite = 0;
+
+    std::deque<ClockRecord> m_records;
+    unsigned m_maxRecords = 0;
+};
+
+}  // namespace Ripes
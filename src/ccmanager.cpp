@@ -4,16 +4,31 @@
 #include "processorhandler.h"
 #include "ripessettings.h"
 
+#include <QCryptographicHash>
+#include <QDir>
 #include <QProcess>
 #include <QProgressDialog>
 
+#include <algorithm>
+
 namespace Ripes {
 
 const static std::vector<QString> s_validAutodetectedCCs = {"riscv64-unknown-elf-gcc", "riscv64-unknown-elf-g++",
                                                             "riscv64-unknown-elf-c++"};
 const static QString s_testprogram = "int main() { return 0; }";
+/** Maximum number of compiled programs retained in the compilation cache */
+constexpr int s_maxCacheEntries = 16;
 
 CCManager::CCManager() {
+    connect(&m_asyncProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            &CCManager::asyncProcessFinished);
+    connect(&m_asyncProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        // A process which failed to start will not emit finished()
+        if (error == QProcess::FailedToStart) {
+            asyncProcessFinished();
+        }
+    });
+
     if (RipesSettings::value(RIPES_SETTING_CCPATH) == "") {
         // No previous compiler path has been set. Try to autodetect a valid compiler within the current path
         const auto CCPath = tryAutodetectCC();
@@ -59,7 +74,7 @@ bool CCManager::trySetCC(const QString& CC) {
     return res.success;
 }
 
-CCManager::CCRes CCManager::compileRaw(const QString& rawsource, QString outname, bool showProgressdiag) {
+QString CCManager::writeTempSource(const QString& rawsource) const {
     // Write program to temporary file with a .c extension
     const auto tempFileTemplate =
         QString(QDir::tempPath() + QDir::separator() + QCoreApplication::applicationName() + ".XXXXXX.c");
@@ -70,7 +85,123 @@ CCManager::CCRes CCManager::compileRaw(const QString& rawsource, QString outname
         stream << rawsource;
     }
     Q_ASSERT(!tmpSrcFile.fileName().isEmpty());
-    return compile(tmpSrcFile.fileName(), outname, showProgressdiag);
+    return tmpSrcFile.fileName();
+}
+
+CCManager::CCRes CCManager::compileRaw(const QString& rawsource, QString outname, bool showProgressdiag) {
+    return compile(writeTempSource(rawsource), outname, showProgressdiag);
+}
+
+namespace {
+QString cacheDir() {
+    return QDir::tempPath() + QDir::separator() + QCoreApplication::applicationName() + "-cc-cache";
+}
+
+QString tempOutFile() {
+    QTemporaryFile tmpOutFile(QDir::tempPath() + QDir::separator() + QCoreApplication::applicationName() +
+                              ".XXXXXX.out");
+    tmpOutFile.setAutoRemove(false);
+    tmpOutFile.open();
+    return tmpOutFile.fileName();
+}
+}  // namespace
+
+QByteArray CCManager::cacheKey(const QString& rawsource) const {
+    // The compile command covers the compiler path, -march/-mabi and the user compiler and linker arguments
+    const auto [cc, args] = createCompileCommand("${input}", "${output}");
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(rawsource.toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData((cc + " " + args.join(" ")).toUtf8());
+    return hash.result().toHex();
+}
+
+void CCManager::compileAsync(const QString& rawsource) {
+    abortAsync();
+
+    const QByteArray key = cacheKey(rawsource);
+    const auto entry =
+        std::find_if(m_cache.begin(), m_cache.end(), [&key](const CacheEntry& e) { return e.key == key; });
+    if (entry != m_cache.end()) {
+        // Cache hit; hand out a copy of the cached program, given that the receiver cleans up the output file
+        CCRes res;
+        res.inFile = entry->inFile;
+        res.outFile = tempOutFile();
+        QFile::remove(res.outFile);
+        res.success = QFile::copy(entry->outFile, res.outFile);
+        res.cached = true;
+        if (res.success) {
+            m_cache.move(std::distance(m_cache.begin(), entry), 0);
+            // compileFinished is always emitted asynchronously, as for a program which is compiled
+            QMetaObject::invokeMethod(
+                this, [=] { finishAsync(res); }, Qt::QueuedConnection);
+            return;
+        }
+        // The cached program was removed behind our back
+        QFile::remove(res.outFile);
+        m_cache.erase(entry);
+    }
+
+    m_asyncKey = key;
+    m_asyncRes = CCRes();
+    m_asyncRes.inFile = writeTempSource(rawsource);
+    m_asyncRes.outFile = tempOutFile();
+    QFile::remove(m_asyncRes.outFile);
+
+    const auto [cc, args] = createCompileCommand(m_asyncRes.inFile, m_asyncRes.outFile);
+    CCStatusManager::setStatus("Compiling...");
+    m_asyncProcess.start(cc, args);
+}
+
+void CCManager::abortAsync() {
+    if (m_asyncKey.isEmpty()) {
+        return;
+    }
+    m_asyncRes.aborted = true;
+    if (isCompiling()) {
+        m_asyncProcess.kill();
+        // finished() is emitted from within waitForFinished, which finishes the aborted compilation
+        m_asyncProcess.waitForFinished();
+    }
+}
+
+void CCManager::asyncProcessFinished() {
+    if (m_asyncKey.isEmpty()) {
+        return;
+    }
+
+    CCRes res = m_asyncRes;
+    if (!res.aborted) {
+        res.errorMessage = m_asyncProcess.readAllStandardError();
+        res.success = LoadDialog::validateELFFile(QFile(res.outFile)).valid;
+    }
+
+    if (res.success) {
+        // Retain a copy of the compiled program in the cache
+        QDir().mkpath(cacheDir());
+        const QString cachedOutFile = cacheDir() + QDir::separator() + m_asyncKey + ".out";
+        QFile::remove(cachedOutFile);
+        if (QFile::copy(res.outFile, cachedOutFile)) {
+            m_cache.prepend({m_asyncKey, res.inFile, cachedOutFile});
+            while (m_cache.size() > s_maxCacheEntries) {
+                QFile::remove(m_cache.takeLast().outFile);
+            }
+        }
+    }
+
+    m_asyncKey.clear();
+    finishAsync(res);
+}
+
+void CCManager::finishAsync(CCRes res) {
+    if (res.aborted) {
+        CCStatusManager::clearStatus();
+    } else if (res.success) {
+        CCStatusManager::setStatus(res.cached ? "Compiled (cached)" : "Compiled");
+    } else {
+        CCStatusManager::setStatus("Compilation failed");
+    }
+    emit compileFinished(res);
 }
 
 CCManager::CCRes CCManager::compile(const QTextDocument* source, QString outname, bool showProgressdiag) {
@@ -151,13 +282,14 @@ std::pair<QString, QStringList> CCManager::createCompileCommand(const QString& f
      * - %1: path to compiler executable
      * - %2: machine architecture
      * - %3: machine ABI
+     * - -g: emit debug line information
      * - %4: user compiler arguments
      * - -x c: Enforce compilation as C language (allows us to use C++ compilers)
      * - %5: input source file
      * - %6: output executable
      * - %7: user linker arguments
      */
-    const static QString s_baseCC = "%1 -march=%2 -mabi=%3 %4 -x c %5 -o %6 %7";
+    const static QString s_baseCC = "%1 -march=%2 -mabi=%3 -g %4 -x c %5 -o %6 %7";
 
     QStringList compileCommand;
 
@@ -170,6 +302,9 @@ std::pair<QString, QStringList> CCManager::createCompileCommand(const QString& f
     // Substitute machine ABI
     compileCommand << (QString("-mabi=") + currentISA->CCmabi());
 
+    // Always emit line information, which is used for source-level attribution of execution statistics
+    compileCommand << "-g";
+
     // Substitute additional CC arguments
     compileCommand << sanitizedArguments(RipesSettings::value(RIPES_SETTING_CCARGS).toString());
 
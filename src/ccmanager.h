@@ -1,13 +1,18 @@
 #pragma once
 
 #include <QFile>
+#include <QList>
 #include <QObject>
 #include <QProcess>
 #include <QString>
 #include <QTextDocument>
 
+#include "statusmanager.h"
+
 namespace Ripes {
 
+StatusManager(CC);
+
 /**
  * @brief The CCManager class
  * Manages the detection, verification and execution of a valid C/C++ compiler suitable for the ISAs targetted by the
@@ -22,6 +27,8 @@ public:
         QString errorMessage;
         bool success = false;
         bool aborted = false;
+        /** The output file is a copy of a previously compiled program with identical source and compile command */
+        bool cached = false;
 
         void clean() {
             QFile::remove(inFile);
@@ -49,6 +56,17 @@ public:
     CCRes compile(const QTextDocument* source, QString outname = QString(), bool showProgressdiag = true);
     CCRes compileRaw(const QString& rawsource, QString outname = QString(), bool showProgressdiag = true);
 
+    /**
+     * @brief compileAsync
+     * Compiles @p rawsource without blocking, whereafter compileFinished() is emitted with the result. Results are
+     * cached by a hash of the source, the compiler path and the compile command (including -march/-mabi and the user
+     * compiler and linker arguments), so compiling an unchanged program completes immediately. A compilation which is
+     * still in progress is aborted by subsequent calls.
+     */
+    void compileAsync(const QString& rawsource);
+    void abortAsync();
+    bool isCompiling() const { return m_asyncProcess.state() != QProcess::NotRunning; }
+
     std::pair<QString, QStringList> createCompileCommand(const QString& filename, const QString& outname) const;
 
 signals:
@@ -58,6 +76,13 @@ signals:
      */
     void ccChanged(CCRes res);
 
+    /**
+     * @brief compileFinished
+     * Emitted when a compilation started through compileAsync() finished or was aborted. The receiver is responsible
+     * for cleaning up the files of @param res.
+     */
+    void compileFinished(CCRes res);
+
 public slots:
     /**
      * @brief trySetCC
@@ -80,11 +105,29 @@ private:
      */
     CCRes verifyCC(const QString& CC);
 
+    QString writeTempSource(const QString& rawsource) const;
+    QByteArray cacheKey(const QString& rawsource) const;
+    void asyncProcessFinished();
+    void finishAsync(CCRes res);
+
     CCManager();
     QString m_currentCC;
     QProcess m_process;
     bool m_errored = false;
     bool m_aborted = false;
+
+    struct CacheEntry {
+        QByteArray key;
+        /** Path of the source file which the program was compiled from, as recorded in its debug information */
+        QString inFile;
+        QString outFile;
+    };
+    /** Compiled programs, most recently used first */
+    QList<CacheEntry> m_cache;
+
+    QProcess m_asyncProcess;
+    CCRes m_asyncRes;
+    QByteArray m_asyncKey;
 };
 
 }  // namespace Ripes
@@ -0,0 +1,133 @@
+#include "commitlogger.h"
+
+#include <cstdio>
+
+#include "processorhandler.h"
+
+namespace Ripes {
+
+CommitLogger::CommitLogger() : m_buffer(s_bufferSize) {
+    connect(ProcessorHandler::get(), &ProcessorHandler::reqProcessorReset, this, &CommitLogger::processorReset);
+    processorReset();
+}
+
+bool CommitLogger::start(const QString& filename) {
+    stop();
+
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    m_bufferUsed = 0;
+    m_fileSize = 0;
+    m_lines.clear();
+    m_commits.clear();
+    capture();
+    return true;
+}
+
+void CommitLogger::stop() {
+    if (!isLogging()) {
+        return;
+    }
+    // The pending instruction has not retired, and is not logged
+    m_hasPending = false;
+    flushBuffer();
+    m_file.close();
+    emit logStopped();
+}
+
+void CommitLogger::processorReset() {
+    // The processor might have changed. As in CacheSim, (re)connect to the VSRTL design update signals.
+    auto* proc = ProcessorHandler::get()->getProcessorNonConst();
+    proc->designWasClocked.Connect(this, &CommitLogger::processorWasClocked);
+    proc->designWasReversed.Connect(this, &CommitLogger::processorWasReversed);
+    proc->designWasReset.Connect(this, &CommitLogger::processorReset);
+
+    if (isLogging()) {
+        m_commits.clear();
+        m_lines.clear();
+        capture();
+    }
+}
+
+void CommitLogger::processorWasClocked() {
+    if (isLogging()) {
+        writePending();
+        capture();
+    }
+}
+
+void CommitLogger::processorWasReversed() {
+    if (!isLogging()) {
+        return;
+    }
+    // Remove the lines of the instructions which retired in the reversed cycles; they are logged again once they
+    // retire anew.
+    const long long cycle = ProcessorHandler::get()->getProcessor()->getCycleCount();
+    std::optional<qint64> position;
+    while (!m_lines.empty() && m_lines.back().first >= cycle) {
+        position = m_lines.back().second;
+        m_lines.pop_back();
+    }
+    if (position) {
+        truncate(*position);
+    }
+    m_commits.rollback(cycle);
+    capture();
+}
+
+void CommitLogger::truncate(qint64 position) {
+    if (position >= m_fileSize) {
+        m_bufferUsed = static_cast<size_t>(position - m_fileSize);
+        return;
+    }
+    m_bufferUsed = 0;
+    m_file.resize(position);
+    m_file.seek(position);
+    m_fileSize = position;
+}
+
+void CommitLogger::capture() {
+    const auto* proc = ProcessorHandler::get()->getProcessor();
+    m_pendingCycle = proc->getCycleCount();
+    m_hasPending = m_commits.nextEdge(*proc, m_pending, m_pendingCommit);
+    if (m_hasPending) {
+        m_pendingInstr = ProcessorHandler::get()->getMemory().readMemConst(m_pending.pc);
+    }
+}
+
+void CommitLogger::writePending() {
+    if (!m_hasPending) {
+        return;
+    }
+    if (m_bufferUsed + s_maxLineLength > s_bufferSize) {
+        flushBuffer();
+    }
+
+    m_lines.push_back({m_pendingCycle, logPosition()});
+    if (m_lines.size() > vsrtl::core::ClockedComponent::reverseStackSize()) {
+        m_lines.pop_front();
+    }
+
+    char* line = m_buffer.data() + m_bufferUsed;
+    int n = std::snprintf(line, s_maxLineLength, "core   0: 3 0x%08x (0x%08x)", m_pending.pc, m_pendingInstr);
+    if (m_pending.regWrite) {
+        n += std::snprintf(line + n, s_maxLineLength - n, " x%-2u 0x%08x", m_pending.reg, m_pending.regValue);
+    }
+    if (m_pendingCommit) {
+        n += std::snprintf(line + n, s_maxLineLength - n, " mem 0x%08x 0x%0*x", m_pendingCommit->address,
+                           static_cast<int>(m_pendingCommit->size * 2), m_pendingCommit->value);
+    }
+    line[n++] = '\n';
+    m_bufferUsed += n;
+    m_hasPending = false;
+}
+
+void CommitLogger::flushBuffer() {
+    m_file.write(m_buffer.data(), m_bufferUsed);
+    m_fileSize += m_bufferUsed;
+    m_bufferUsed = 0;
+}
+
+}  // namespace Ripes
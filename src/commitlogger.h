@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QFile>
+#include <QObject>
+
+#include <deque>
+#include <optional>
+#include <vector>
+
+#include "committracker.h"
+
+namespace Ripes {
+
+/**
+ * @brief The CommitLogger class
+ * Streams a log of retired instructions in the format of Spike's --log-commits, such that executions may be diffed
+ * against Spike (or any other simulator emitting the same format) offline. Each retired instruction is logged as
+ *   core   0: 3 0x<pc> (0x<instruction>) [x<rd> 0x<value>] [mem 0x<address> 0x<value>]
+ * where the register write is omitted for instructions not writing a register (or writing x0), and the memory write is
+ * omitted for instructions other than stores. As Spike, the privilege level is logged as machine mode. Memory reads
+ * and the register effects of system calls are not logged.
+ *
+ * Lines are formatted into a fixed-size buffer which is written to the log file whenever full, bounding the memory
+ * used by the logger regardless of the length of the execution.
+ * Reversing the processor truncates the log to the cycle reversed to, and rolls back the memory writes of the
+ * instructions in flight; the log thereby always matches the forward execution of the program.
+ */
+class CommitLogger : public QObject {
+    Q_OBJECT
+
+public:
+    static CommitLogger* get() {
+        static auto* logger = new CommitLogger;
+        return logger;
+    }
+
+    /**
+     * @brief start
+     * Starts logging to @p filename, truncating any existing file. @returns false if the file could not be opened.
+     */
+    bool start(const QString& filename);
+    void stop();
+    bool isLogging() const { return m_file.isOpen(); }
+
+signals:
+    void logStopped();
+
+public slots:
+    void processorReset();
+
+private:
+    CommitLogger();
+
+    void processorWasClocked();
+    void processorWasReversed();
+
+    /**
+     * @brief capture
+     * Records the instruction which retires on the next clock edge, and any memory write committed on it. The
+     * instruction is logged once the processor has been clocked.
+     */
+    void capture();
+    void writePending();
+    void flushBuffer();
+    /** @returns the position in the log at which the next line is written */
+    qint64 logPosition() const { return m_fileSize + static_cast<qint64>(m_bufferUsed); }
+    void truncate(qint64 position);
+
+    QFile m_file;
+
+    static constexpr size_t s_bufferSize = 1 << 16;
+    static constexpr size_t s_maxLineLength = 128;
+    std::vector<char> m_buffer;
+    size_t m_bufferUsed = 0;
+    qint64 m_fileSize = 0;
+
+    /** Cycle in which each logged instruction retired, and the log position of its line; within the reverse stack */
+    std::deque<std::pair<long long, qint64>> m_lines;
+
+    bool m_hasPending = false;
+    long long m_pendingCycle = 0;
+    Retirement m_pending;
+    uint32_t m_pendingInstr = 0;
+    std::optional<MemoryCommit> m_pendingCommit;
+
+    CommitTracker m_commits;
+};
+
+}  // namespace Ripes
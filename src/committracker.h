@@ -0,0 +1,98 @@
+#pragma once
+
+#include <deque>
+#include <optional>
+
+#include "processors/ripesprocessor.h"
+
+namespace Ripes {
+
+/**
+ * @brief The CommitTracker class
+ * Pairs the memory writes of a processor with the instructions which commit them. In pipelined processors, memory is
+ * written before the writing instruction retires; writes are therefore queued until the instruction at their PC
+ * retires. Each edge is journaled, such that the queue may be rolled back when the processor is reversed.
+ */
+class CommitTracker {
+public:
+    /**
+     * @brief nextEdge
+     * Records the memory write which @p proc performs on its next clock edge.
+     * @returns true if an instruction retires on the next clock edge, in which case @p retirement describes the
+     * instruction and @p commit holds the memory write committed by it, if any.
+     */
+    bool nextEdge(const vsrtl::core::RipesProcessor& proc, Retirement& retirement, std::optional<MemoryCommit>& commit) {
+        Edge edge;
+        edge.cycle = proc.getCycleCount();
+        if (m_journal.empty()) {
+            m_journalValidFrom = edge.cycle;
+        }
+
+        MemoryCommit write;
+        if (proc.committingMemoryWrite(write)) {
+            m_pending.push_back(write);
+            edge.pushed = true;
+        }
+
+        commit.reset();
+        const bool retiring = proc.retiringInstruction(retirement);
+        if (retiring && !m_pending.empty() && m_pending.front().pc == retirement.pc) {
+            commit = m_pending.front();
+            edge.popped = commit;
+            m_pending.pop_front();
+        }
+
+        m_journal.push_back(edge);
+        if (m_journal.size() > vsrtl::core::ClockedComponent::reverseStackSize() + 1) {
+            m_journalValidFrom = m_journal.front().cycle + 1;
+            m_journal.pop_front();
+        }
+        return retiring;
+    }
+
+    /**
+     * @brief rollback
+     * Restores the queue to its state before the edge recorded at @p cycle, ie. after the processor has been reversed
+     * to @p cycle. If the journal does not reach back to @p cycle, the queue is cleared.
+     */
+    void rollback(long long cycle) {
+        if (cycle < m_journalValidFrom) {
+            clear();
+            return;
+        }
+        while (!m_journal.empty() && m_journal.back().cycle >= cycle) {
+            const Edge& edge = m_journal.back();
+            if (edge.popped) {
+                m_pending.push_front(*edge.popped);
+            }
+            if (edge.pushed) {
+                m_pending.pop_back();
+            }
+            m_journal.pop_back();
+        }
+    }
+
+    /**
+     * @brief clear
+     * Drops the memory writes of instructions which have yet to retire, ie. after the processor has been reset.
+     */
+    void clear() {
+        m_pending.clear();
+        m_journal.clear();
+    }
+
+private:
+    /** The modifications of the queue by the edge of a cycle */
+    struct Edge {
+        long long cycle;
+        bool pushed = false;
+        std::optional<MemoryCommit> popped;
+    };
+
+    /** Memory writes committed by instructions which have yet to retire, oldest first */
+    std::deque<MemoryCommit> m_pending;
+    std::deque<Edge> m_journal;
+    long long m_journalValidFrom = 0;
+};
+
+}  // namespace Ripes
@@ -40,11 +40,25 @@ Console::Console(QWidget* parent) : QPlainTextEdit(parent) {
 }
 
 void Console::putData(const QByteArray& data) {
+    // Output which exceeds the scrollback on its own would never be visible
+    QString text = QString::fromUtf8(data);
+    if (text.size() > s_maxScrollback) {
+        text = text.right(s_maxScrollback);
+    }
+
     // Text can always only be inserted at the end of the console
     auto cursorAtEnd = QTextCursor(document());
     cursorAtEnd.movePosition(QTextCursor::End);
     setTextCursor(cursorAtEnd);
-    insertPlainText(data);
+    insertPlainText(text);
+
+    // Trim the oldest output exceeding the scrollback
+    const int excess = document()->characterCount() - s_maxScrollback;
+    if (excess > 0) {
+        auto cursorAtStart = QTextCursor(document());
+        cursorAtStart.setPosition(excess, QTextCursor::KeepAnchor);
+        cursorAtStart.removeSelectedText();
+    }
 
     QScrollBar* bar = verticalScrollBar();
     bar->setValue(bar->maximum());
@@ -22,6 +22,12 @@ protected:
 private:
     void backspace();
 
+    /**
+     * Maximum number of characters retained in the console. In addition to the maximum block count, this bounds the
+     * scrollback of output containing few line breaks.
+     */
+    static constexpr int s_maxScrollback = 1 << 16;
+
     bool m_localEchoEnabled = false;
     QFont m_font;
     QString m_buffer;
@@ -0,0 +1,357 @@
+#include "debuglineinfo.h"
+
+#include <QFileInfo>
+
+#include <algorithm>
+#include <map>
+
+namespace Ripes {
+
+namespace {
+
+// DWARF constants, as specified in the DWARF 5 standard, section 7.22
+enum LineOpcode : uint8_t {
+    DW_LNS_copy = 0x01,
+    DW_LNS_advance_pc = 0x02,
+    DW_LNS_advance_line = 0x03,
+    DW_LNS_set_file = 0x04,
+    DW_LNS_const_add_pc = 0x08,
+    DW_LNS_fixed_advance_pc = 0x09
+};
+enum LineExtendedOpcode : uint8_t { DW_LNE_end_sequence = 0x01, DW_LNE_set_address = 0x02, DW_LNE_define_file = 0x03 };
+enum LineContentType : uint64_t { DW_LNCT_path = 0x1, DW_LNCT_directory_index = 0x2 };
+enum Form : uint64_t {
+    DW_FORM_block = 0x09,
+    DW_FORM_data1 = 0x0b,
+    DW_FORM_data2 = 0x05,
+    DW_FORM_data4 = 0x06,
+    DW_FORM_data8 = 0x07,
+    DW_FORM_data16 = 0x1e,
+    DW_FORM_string = 0x08,
+    DW_FORM_strp = 0x0e,
+    DW_FORM_line_strp = 0x1f,
+    DW_FORM_udata = 0x0f
+};
+
+/**
+ * @brief The Reader class
+ * Bounds checked little-endian reader of a DWARF section. Reading past the end of the section marks the reader as
+ * failed, and yields zero-valued results.
+ */
+class Reader {
+public:
+    Reader(const QByteArray& data, size_t pos = 0, size_t end = ~0ULL)
+        : m_data(data), m_pos(pos), m_end(std::min<size_t>(end, data.size())) {}
+
+    bool failed() const { return m_failed; }
+    bool atEnd() const { return m_failed || m_pos >= m_end; }
+    size_t pos() const { return m_pos; }
+    void seek(size_t pos) { m_pos = pos; }
+
+    uint64_t u(unsigned bytes) {
+        if (m_pos + bytes > m_end) {
+            m_failed = true;
+            m_pos = m_end;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (unsigned i = 0; i < bytes; i++) {
+            v |= static_cast<uint64_t>(static_cast<uint8_t>(m_data.at(m_pos + i))) << (i * 8);
+        }
+        m_pos += bytes;
+        return v;
+    }
+    uint8_t u8() { return static_cast<uint8_t>(u(1)); }
+    uint16_t u16() { return static_cast<uint16_t>(u(2)); }
+
+    uint64_t uleb() {
+        uint64_t v = 0;
+        unsigned shift = 0;
+        uint8_t byte;
+        do {
+            byte = u8();
+            if (shift < 64) {
+                v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            }
+            shift += 7;
+        } while (byte & 0x80);
+        return v;
+    }
+
+    int64_t sleb() {
+        int64_t v = 0;
+        unsigned shift = 0;
+        uint8_t byte;
+        do {
+            byte = u8();
+            if (shift < 64) {
+                v |= static_cast<int64_t>(byte & 0x7f) << shift;
+            }
+            shift += 7;
+        } while (byte & 0x80);
+        if (shift < 64 && (byte & 0x40)) {
+            v |= -(static_cast<int64_t>(1) << shift);
+        }
+        return v;
+    }
+
+    QString cstr() {
+        const size_t start = m_pos;
+        while (m_pos < m_end && m_data.at(m_pos) != '\0') {
+            m_pos++;
+        }
+        if (m_pos >= m_end) {
+            m_failed = true;
+            return QString();
+        }
+        return QString::fromUtf8(m_data.constData() + start, static_cast<int>(m_pos++ - start));
+    }
+
+private:
+    const QByteArray& m_data;
+    size_t m_pos;
+    size_t m_end;
+    bool m_failed = false;
+};
+
+QString stringAt(const QByteArray& section, uint64_t offset) {
+    if (offset >= static_cast<uint64_t>(section.size())) {
+        return QString();
+    }
+    return Reader(section, offset).cstr();
+}
+
+QString joinPath(const QString& dir, const QString& file) {
+    if (dir.isEmpty() || QFileInfo(file).isAbsolute()) {
+        return file;
+    }
+    return dir + "/" + file;
+}
+
+struct EntryFormat {
+    uint64_t contentType;
+    uint64_t form;
+};
+
+}  // namespace
+
+DebugLineInfo DebugLineInfo::parse(const QByteArray& debugLine, const QByteArray& debugLineStr,
+                                   const QByteArray& debugStr) {
+    DebugLineInfo info;
+    std::map<QString, uint16_t> fileIndices;
+    const auto indexOfFile = [&](const QString& path) {
+        auto it = fileIndices.find(path);
+        if (it == fileIndices.end()) {
+            it = fileIndices.emplace(path, static_cast<uint16_t>(info.m_files.size())).first;
+            info.m_files.push_back(path);
+        }
+        return it->second;
+    };
+
+    size_t unitOffset = 0;
+    while (unitOffset < static_cast<size_t>(debugLine.size())) {
+        // Unit header
+        Reader lengthReader(debugLine, unitOffset);
+        unsigned offsetSize = 4;
+        uint64_t unitLength = lengthReader.u(4);
+        if (unitLength == 0xffffffff) {
+            offsetSize = 8;
+            unitLength = lengthReader.u(8);
+        }
+        const size_t unitEnd = lengthReader.pos() + unitLength;
+        if (lengthReader.failed() || unitEnd > static_cast<size_t>(debugLine.size())) {
+            break;
+        }
+        unitOffset = unitEnd;
+        Reader r(debugLine, lengthReader.pos(), unitEnd);
+
+        const uint16_t version = r.u16();
+        if (version < 2 || version > 5) {
+            continue;
+        }
+        unsigned addressSize = 4;
+        if (version >= 5) {
+            addressSize = r.u8();
+            r.u8();  // segment selector size
+        }
+        const uint64_t headerLength = r.u(offsetSize);
+        const size_t programStart = r.pos() + headerLength;
+        const uint8_t minInstrLength = r.u8();
+        if (version >= 4) {
+            r.u8();  // maximum operations per instruction; VLIW is not supported
+        }
+        r.u8();  // default is_stmt; statement boundaries are not distinguished
+        const int8_t lineBase = static_cast<int8_t>(r.u8());
+        const uint8_t lineRange = r.u8();
+        const uint8_t opcodeBase = r.u8();
+        std::vector<uint8_t> standardOpcodeLengths;
+        for (unsigned i = 1; i < opcodeBase; i++) {
+            standardOpcodeLengths.push_back(r.u8());
+        }
+        if (r.failed() || lineRange == 0 || opcodeBase == 0) {
+            continue;
+        }
+
+        // Directory and file tables. Files are mapped to indices within the shared file table of the DebugLineInfo.
+        std::vector<QString> dirs;
+        std::vector<uint16_t> files;
+        if (version >= 5) {
+            bool supported = true;
+            const auto readEntries = [&](auto handler) {
+                std::vector<EntryFormat> formats(r.u8());
+                for (auto& format : formats) {
+                    format.contentType = r.uleb();
+                    format.form = r.uleb();
+                }
+                const uint64_t count = r.uleb();
+                for (uint64_t i = 0; i < count && !r.failed() && supported; i++) {
+                    QString path;
+                    uint64_t dirIndex = 0;
+                    for (const auto& format : formats) {
+                        QString str;
+                        uint64_t value = 0;
+                        switch (format.form) {
+                            case DW_FORM_string: str = r.cstr(); break;
+                            case DW_FORM_line_strp: str = stringAt(debugLineStr, r.u(offsetSize)); break;
+                            case DW_FORM_strp: str = stringAt(debugStr, r.u(offsetSize)); break;
+                            case DW_FORM_udata: value = r.uleb(); break;
+                            case DW_FORM_data1: value = r.u(1); break;
+                            case DW_FORM_data2: value = r.u(2); break;
+                            case DW_FORM_data4: value = r.u(4); break;
+                            case DW_FORM_data8: value = r.u(8); break;
+                            case DW_FORM_data16: r.u(8); r.u(8); break;
+                            case DW_FORM_block: r.seek(r.pos() + r.uleb()); break;
+                            default: supported = false; break;
+                        }
+                        if (format.contentType == DW_LNCT_path) {
+                            path = str;
+                        } else if (format.contentType == DW_LNCT_directory_index) {
+                            dirIndex = value;
+                        }
+                    }
+                    handler(path, dirIndex);
+                }
+            };
+            readEntries([&](const QString& path, uint64_t) { dirs.push_back(path); });
+            readEntries([&](const QString& path, uint64_t dirIndex) {
+                files.push_back(indexOfFile(joinPath(dirIndex < dirs.size() ? dirs.at(dirIndex) : QString(), path)));
+            });
+            if (!supported) {
+                continue;
+            }
+        } else {
+            // Pre-DWARF 5 tables are 1-indexed, with index 0 referring to the compilation directory
+            dirs.push_back(QString());
+            for (QString dir = r.cstr(); !dir.isEmpty() && !r.failed(); dir = r.cstr()) {
+                dirs.push_back(dir);
+            }
+            files.push_back(indexOfFile(QString()));
+            for (QString file = r.cstr(); !file.isEmpty() && !r.failed(); file = r.cstr()) {
+                const uint64_t dirIndex = r.uleb();
+                r.uleb();  // modification time
+                r.uleb();  // file length
+                files.push_back(indexOfFile(joinPath(dirIndex < dirs.size() ? dirs.at(dirIndex) : QString(), file)));
+            }
+        }
+        if (r.failed() || files.empty()) {
+            continue;
+        }
+
+        // Line number program state machine
+        r.seek(programStart);
+        uint64_t address = 0;
+        // The file register starts at 1 for all versions; under DWARF 5, file 0 is only used when set explicitly
+        uint64_t file = 1;
+        int64_t line = 1;
+        const auto emitRow = [&](bool endSequence) {
+            const uint16_t fileIndex = file < files.size() ? files.at(file) : files.front();
+            info.m_rows.push_back(
+                {static_cast<uint32_t>(address), static_cast<uint32_t>(std::max<int64_t>(line, 0)), fileIndex,
+                 endSequence});
+        };
+
+        while (!r.atEnd()) {
+            const uint8_t opcode = r.u8();
+            if (opcode >= opcodeBase) {
+                // Special opcode
+                const unsigned adjusted = opcode - opcodeBase;
+                address += (adjusted / lineRange) * minInstrLength;
+                line += lineBase + static_cast<int>(adjusted % lineRange);
+                emitRow(false);
+            } else if (opcode == 0) {
+                // Extended opcode
+                const uint64_t length = r.uleb();
+                const size_t next = r.pos() + length;
+                if (length == 0) {
+                    continue;
+                }
+                switch (r.u8()) {
+                    case DW_LNE_end_sequence:
+                        emitRow(true);
+                        address = 0;
+                        file = 1;
+                        line = 1;
+                        break;
+                    case DW_LNE_set_address:
+                        address = r.u(std::min<unsigned>(length - 1, version >= 5 ? addressSize : 8));
+                        break;
+                    case DW_LNE_define_file: {
+                        const QString name = r.cstr();
+                        const uint64_t dirIndex = r.uleb();
+                        files.push_back(
+                            indexOfFile(joinPath(dirIndex < dirs.size() ? dirs.at(dirIndex) : QString(), name)));
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                r.seek(next);
+            } else {
+                // Standard opcode
+                switch (opcode) {
+                    case DW_LNS_copy: emitRow(false); break;
+                    case DW_LNS_advance_pc: address += r.uleb() * minInstrLength; break;
+                    case DW_LNS_advance_line: line += r.sleb(); break;
+                    case DW_LNS_set_file: file = r.uleb(); break;
+                    case DW_LNS_const_add_pc: address += ((255 - opcodeBase) / lineRange) * minInstrLength; break;
+                    case DW_LNS_fixed_advance_pc: address += r.u16(); break;
+                    default:
+                        // Skip the operands of opcodes which do not affect the address to line mapping
+                        for (unsigned i = 0; i < standardOpcodeLengths.at(opcode - 1); i++) {
+                            r.uleb();
+                        }
+                        break;
+                }
+            }
+        }
+    }
+
+    // Rows terminating a sequence are placed before any rows starting at the same address, such that a lookup will
+    // find the start of the next sequence.
+    std::stable_sort(info.m_rows.begin(), info.m_rows.end(), [](const Row& lhs, const Row& rhs) {
+        return lhs.address < rhs.address || (lhs.address == rhs.address && lhs.endSequence && !rhs.endSequence);
+    });
+    return info;
+}
+
+const DebugLineInfo::Row* DebugLineInfo::lookup(uint32_t address) const {
+    auto it = std::upper_bound(m_rows.begin(), m_rows.end(), address,
+                               [](uint32_t addr, const Row& row) { return addr < row.address; });
+    if (it == m_rows.begin()) {
+        return nullptr;
+    }
+    --it;
+    return it->endSequence ? nullptr : &*it;
+}
+
+int DebugLineInfo::findFile(const QString& path) const {
+    const QString name = QFileInfo(path).fileName();
+    for (unsigned i = 0; i < m_files.size(); i++) {
+        if (QFileInfo(m_files.at(i)).fileName() == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+}  // namespace Ripes
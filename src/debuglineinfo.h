@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <vector>
+
+namespace Ripes {
+
+/**
+ * @brief The DebugLineInfo class
+ * Compact address to source file:line index, built from the DWARF .debug_line section of an executable. Rows of the
+ * DWARF line programs are stored sorted by address; a row covers the address range up until the address of the next
+ * row. Rows terminating a line sequence do not map to any source line.
+ */
+class DebugLineInfo {
+public:
+    struct Row {
+        uint32_t address;
+        uint32_t line;
+        uint16_t file;
+        bool endSequence;
+    };
+
+    /**
+     * @brief parse
+     * Parses the DWARF (version 2 to 5) line number programs contained in @p debugLine. @p debugLineStr and
+     * @p debugStr are the contents of the .debug_line_str and .debug_str sections, which DWARF 5 line tables may refer
+     * to for file and directory names. Malformed line number programs are skipped.
+     */
+    static DebugLineInfo parse(const QByteArray& debugLine, const QByteArray& debugLineStr = QByteArray(),
+                               const QByteArray& debugStr = QByteArray());
+
+    /**
+     * @brief lookup
+     * @returns the row covering @p address, or nullptr if @p address is not covered by any line sequence.
+     */
+    const Row* lookup(uint32_t address) const;
+
+    /**
+     * @brief findFile
+     * @returns the index of the file with the same file name as @p path, or -1 if no such file is referenced.
+     */
+    int findFile(const QString& path) const;
+
+    const QString& fileName(unsigned index) const { return m_files.at(index); }
+    bool isEmpty() const { return m_rows.empty(); }
+
+private:
+    std::vector<QString> m_files;
+    std::vector<Row> m_rows;
+};
+
+}  // namespace Ripes
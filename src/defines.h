@@ -81,6 +81,7 @@ enum {
     OP = 0b0110011,
     ECALL = 0b1110011,
     AUIPC = 0b0010111,
+    AMO = 0b0101111,
     INVALID = 0b0
 };
 }
@@ -0,0 +1,65 @@
+#include "disassemblycache.h"
+
+#include <QMutexLocker>
+
+namespace Ripes {
+
+namespace {
+/** Instructions are word aligned; entries are keyed by the address of their first byte */
+constexpr uint32_t s_instrBytes = 4;
+}  // namespace
+
+bool DisassemblyCache::lookup(uint32_t address, uint32_t word, QString& disassembly) const {
+    QMutexLocker locker(&m_lock);
+    const auto it = m_entries.constFind(address);
+    if (it == m_entries.constEnd() || it->word != word) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    disassembly = it->disassembly;
+    return true;
+}
+
+void DisassemblyCache::insert(uint32_t address, uint32_t word, const QString& disassembly) {
+    QMutexLocker locker(&m_lock);
+    if (m_entries.size() >= s_maxEntries) {
+        m_entries.clear();
+    }
+    m_entries.insert(address, {word, disassembly});
+}
+
+void DisassemblyCache::invalidate(uint32_t address, unsigned size) {
+    QMutexLocker locker(&m_lock);
+    if (m_entries.isEmpty()) {
+        return;
+    }
+    const uint32_t first = address - address % s_instrBytes;
+    if (size / s_instrBytes > static_cast<unsigned>(m_entries.size())) {
+        // Large (block) writes; visit the entries rather than the written addresses
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            it = it.key() >= first && it.key() < address + size ? m_entries.erase(it) : std::next(it);
+        }
+        return;
+    }
+    for (uint32_t addr = first; addr < address + size; addr += s_instrBytes) {
+        m_entries.remove(addr);
+    }
+}
+
+void DisassemblyCache::clear() {
+    QMutexLocker locker(&m_lock);
+    m_entries.clear();
+}
+
+double DisassemblyCache::hitRate() const {
+    const uint64_t lookups = hits() + misses();
+    return lookups == 0 ? 0.0 : static_cast<double>(hits()) / lookups;
+}
+
+void DisassemblyCache::resetStatistics() {
+    m_hits.store(0, std::memory_order_relaxed);
+    m_misses.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace Ripes
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+
+namespace Ripes {
+
+/**
+ * @brief The DisassemblyCache class
+ * Memoizes the disassembly of instruction words by address. An entry is only valid for the instruction word it was
+ * disassembled from, so words which are overwritten (ie. through self-modifying code) are never served stale; entries
+ * are furthermore dropped explicitly when their address is written, and the cache is cleared whenever the program (and
+ * thereby its symbols) changes.
+ * The cache may be accessed from both the GUI and the simulation thread.
+ */
+class DisassemblyCache {
+public:
+    /**
+     * @brief lookup
+     * @returns true and sets @p disassembly if a disassembly of @p word at @p address is cached.
+     */
+    bool lookup(uint32_t address, uint32_t word, QString& disassembly) const;
+    void insert(uint32_t address, uint32_t word, const QString& disassembly);
+
+    /** Drops the entries overlapping the @p size bytes at @p address */
+    void invalidate(uint32_t address, unsigned size);
+    void clear();
+
+    uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return m_misses.load(std::memory_order_relaxed); }
+    /** @returns the fraction of lookups which were served from the cache, since the last call to resetStatistics() */
+    double hitRate() const;
+    void resetStatistics();
+
+private:
+    struct Entry {
+        uint32_t word;
+        QString disassembly;
+    };
+
+    /** The cache is cleared when exceeding this number of entries, which bounds memory use for programs that are
+     * disassembled outside of their text segment */
+    static constexpr int s_maxEntries = 1 << 16;
+
+    mutable QMutex m_lock;
+    QHash<uint32_t, Entry> m_entries;
+    mutable std::atomic<uint64_t> m_hits{0};
+    mutable std::atomic<uint64_t> m_misses{0};
+};
+
+}  // namespace Ripes
@@ -58,6 +58,13 @@ void CodeEditor::setupChangedTimer() {
     connect(m_changeTimer, &QTimer::timeout, this, &CodeEditor::timedTextChanged);
 }
 
+namespace {
+int cycleAnnotationWidth(const QFontMetrics& metrics, uint64_t maxCycles) {
+    const int padding = 6;
+    return maxCycles == 0 ? 0 : padding + metrics.width(QString::number(maxCycles));
+}
+}  // namespace
+
 int CodeEditor::lineNumberAreaWidth() {
     int digits = 1;
     int rightPadding = 6;
@@ -67,7 +74,22 @@ int CodeEditor::lineNumberAreaWidth() {
         ++digits;
     }
     int space = rightPadding + fontMetrics().width(QString("1")) * digits;
-    return space;
+    return space + cycleAnnotationWidth(fontMetrics(), m_maxLineCycles);
+}
+
+void CodeEditor::setLineCycleCounts(const std::map<int, uint64_t>& cycles) {
+    if (cycles == m_lineCycles)
+        return;
+
+    m_lineCycles = cycles;
+    m_maxLineCycles = 0;
+    for (const auto& lineCycles : m_lineCycles) {
+        m_maxLineCycles = qMax(m_maxLineCycles, lineCycles.second);
+    }
+    updateSidebarWidth(0);
+    m_lineNumberArea->setGeometry(QRect(contentsRect().left(), contentsRect().top(), lineNumberAreaWidth(),
+                                        contentsRect().height()));
+    m_lineNumberArea->update();
 }
 
 void CodeEditor::updateSidebarWidth(int /* newBlockCount */) {
@@ -107,8 +129,7 @@ bool CodeEditor::event(QEvent* event) {
         // Tooltips are updated through slot handler updateTooltip
         auto* helpEvent = static_cast<QHelpEvent*>(event);
         QTextCursor textAtCursor = cursorForPosition(helpEvent->pos());
-        const int row = textAtCursor.block().firstLineNumber();
-        const QString tooltip = m_highlighter->getTooltipForLine(row);
+        const QString tooltip = m_highlighter->getTooltipForBlock(textAtCursor.block());
         if (tooltip != QString()) {
             QToolTip::showText(helpEvent->globalPos(), tooltip);
         } else {
@@ -183,8 +204,22 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent* event) {
     int top = static_cast<int>(blockBoundingGeometry(block).translated(contentOffset()).top());
     int bottom = top + static_cast<int>(blockBoundingRect(block).height());
 
+    // Cycle annotations are drawn to the left of the line numbers, with a background intensity relative to the most
+    // expensive line
+    const int annotationWidth = cycleAnnotationWidth(fontMetrics(), m_maxLineCycles);
+
     while (block.isValid() && top <= event->rect().bottom()) {
         if (block.isVisible() && bottom >= event->rect().top()) {
+            auto cyclesIt = m_lineCycles.find(blockNumber);
+            if (cyclesIt != m_lineCycles.end() && cyclesIt->second != 0) {
+                QColor heat = QColor(Qt::red);
+                heat.setAlphaF(0.1 + 0.6 * static_cast<double>(cyclesIt->second) / m_maxLineCycles);
+                painter.fillRect(0, top, annotationWidth, bottom - top, heat);
+                painter.setPen(QColor(Qt::black));
+                painter.drawText(0, top, annotationWidth - 3, fontMetrics().height(), Qt::AlignRight,
+                                 QString::number(cyclesIt->second));
+            }
+
             QString number = QString::number(blockNumber + 1);
             painter.setPen(QColor(Qt::gray).darker(130));
             painter.drawText(0, top, m_lineNumberArea->width() - 3, fontMetrics().height(), Qt::AlignRight, number);
@@ -8,6 +8,7 @@
 #include "assembler.h"
 #include "syntaxhighlighter.h"
 
+#include <map>
 #include <memory>
 #include <set>
 
@@ -29,6 +30,13 @@ public:
     void setupChangedTimer();
     bool syntaxAccepted() const { return m_highlighter->acceptsSyntax(); }
 
+    /**
+     * @brief setLineCycleCounts
+     * Annotates the sidebar with the number of cycles which have been attributed to each (0-indexed) line of the
+     * document, as given by @p cycles. An empty map removes all annotations.
+     */
+    void setLineCycleCounts(const std::map<int, uint64_t>& cycles);
+
 signals:
     /**
      * @brief timedTextChanged
@@ -54,6 +62,9 @@ private:
     LineNumberArea* m_lineNumberArea;
     int m_sidebarWidth;
 
+    std::map<int, uint64_t> m_lineCycles;
+    uint64_t m_maxLineCycles = 0;
+
     bool m_syntaxChecking = false;
     bool m_breakpointAreaEnabled = false;
 
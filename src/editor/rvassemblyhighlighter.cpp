@@ -1,11 +1,13 @@
 #include "rvassemblyhighlighter.h"
 
 #include <QList>
-#include <QRegularExpressionMatchIterator>
+#include <QPointer>
+#include <QSet>
 #include <QTextDocument>
 
+#include <algorithm>
+
 #include "defines.h"
-#include "lexerutilities.h"
 
 namespace Ripes {
 
@@ -67,7 +69,7 @@ QString FieldType::validateField(const QString& field) const {
         case Type::Offset: {
             // Check if label is defined in highlighter
             Q_ASSERT(m_highlighter != nullptr);
-            if (m_highlighter->m_labelPosMap.contains(field)) {
+            if (m_highlighter->m_labelDefinitions.value(field) > 0) {
                 return QString();
             } else {
                 return QString("label \"%1\" is undefined").arg(field);
@@ -89,174 +91,59 @@ RVAssemblyHighlighter::RVAssemblyHighlighter(QTextDocument* parent) : SyntaxHigh
     errorFormat.setUnderlineStyle(QTextCharFormat::WaveUnderline);
     errorFormat.setUnderlineColor(Qt::red);
 
-    // The highlighting is reset upon line count changes, to detect label invalidation
-    connect(parent, &QTextDocument::cursorPositionChanged, this, &RVAssemblyHighlighter::invalidateLabels);
-
-    HighlightingRule rule;
-
-    // Create rules for name-specific registers
     regFormat.setForeground(QColor(0x800000));
-    QStringList registerPatterns;
-    registerPatterns << "\\bzero\\b"
-                     << "\\bra\\b"
-                     << "\\bsp\\b"
-                     << "\\bgp\\b"
-                     << "\\btp\\b"
-                     << "\\bfp\\b";
-    for (const auto& pattern : registerPatterns) {
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = regFormat;
-        m_highlightingRules.append(rule);
-    }
-
-    // Create rules for registers that can easily be regex matched
-    // (saved, temporary and argument registers)
-    rule.pattern = QRegularExpression("\\b[(a|s|t|x)][0-9]{1,2}");
-    rule.format = regFormat;
-    m_highlightingRules.append(rule);
-
-    // Create match cases for instructions
-    QStringList instructionPatterns;
-    instructionPatterns << "\\bla\\b"
-                        << "\\brd\\b"
-                        << "\\blw\\b"
-                        << "\\blh\\b"
-                        << "\\blui\\b"
-                        << "\\blb\\b"
-                        << "\\bsb\\b"
-                        << "\\bsh\\b"
-                        << "\\bsw\\b"
-                        << "\\bnop\\b"
-                        << "\\bli\\b"
-                        << "\\bmv\\b"
-                        << "\\bnot\\b"
-                        << "\\bneg\\b"
-                        << "\\bnegw\\b"
-                        << "\\bsext.w\\b"
-                        << "\\bseqz\\b"
-                        << "\\bsnez\\b"
-                        << "\\bsltz\\b"
-                        << "\\bsgtz\\b"
-                        << "\\bbeqz\\b"
-                        << "\\bbnez\\b"
-                        << "\\bblez\\b"
-                        << "\\bbgez\\b"
-                        << "\\bbltz\\b"
-                        << "\\bbgtz\\b"
-                        << "\\bbgt\\b"
-                        << "\\bble\\b"
-                        << "\\bbgtu\\b"
-                        << "\\bbleu\\b"
-                        << "\\bj\\b"
-                        << "\\bjal\\b"
-                        << "\\bjr\\b"
-                        << "\\bjalr\\b"
-                        << "\\bret\\b"
-                        << "\\bcall\\b"
-                        << "\\btail\\b"
-                        /*
-                        << "\\bfence\\b"
-                        << "\\brdinstret\\b"
-                        << "\\brdcycle\\b"
-                        << "\\brdtime\\b"
-                        << "\\bcsrr\\b"
-                        << "\\bcsrw\\b"
-                        << "\\bcsrs\\b"
-                        << "\\bcsrc\\b"
-                        << "\\bcsrwi\\b"
-                        << "\\bcsrsi\\b"
-                        << "\\bcsrci\\b"
-                                               */
-                        << "\\bauipc\\b"
-                        << "\\badd\\b"
-                        << "\\baddi\\b"
-                        << "\\bxor\\b"
-                        << "\\bxori\\b"
-                        << "\\bsub\\b"
-                        << "\\bsubw\\b"
-                        << "\\baddiw\\b"
-                        << "\\bsltiu\\b"
-                        << "\\bsltu\\b"
-                        << "\\bslt\\b"
-                        << "\\bbeq\\b"
-                        << "\\bbne\\b"
-                        << "\\bbge\\b"
-                        << "\\bblt\\b"
-                        << "\\bbltu\\b"
-                        << "\\bbgeu\\b"
-                        << "\\bsrl\\b"
-                        << "\\bsrli\\b"
-                        << "\\bsll\\b"
-                        << "\\bslli\\b"
-                        << "\\bsra\\b"
-                        << "\\bsrai\\b"
-                        << "\\bor\\b"
-                        << "\\bori\\b"
-                        << "\\band\\b"
-                        << "\\bandi\\b"
-                        << "\\becall\\b"
-
-                        << "\\bmul\\b"
-                        << "\\bmulh\\b"
-                        << "\\bmulhu\\b"
-                        << "\\bmulhsu\\b"
-
-                        << "\\bdiv\\b"
-                        << "\\bdivu\\b"
-                        << "\\brem\\b"
-                        << "\\bremu\\b";
-
     instrFormat.setForeground(QColor(Colors::BerkeleyBlue));
-    for (const auto& pattern : instructionPatterns) {
-        rule.pattern = QRegularExpression(pattern);
-        rule.format = instrFormat;
-        m_highlightingRules.append(rule);
-    }
-
-    // Create immediate hightlighting rule
-    immFormat.setForeground(QColor(Qt::darkGreen));
-    rule.pattern = QRegularExpression("\\b(?<![A-Za-z])[-+]?\\d+");
-    rule.format = immFormat;
-    m_highlightingRules.append(rule);
-
-    // Create immediate highlighting rule for prefixed numbers (0x, 0b)
     immFormat.setForeground(QColor(Qt::darkGreen));
-    rule.pattern = QRegularExpression("([-+]?0[xX][0-9a-fA-F]+|[-+]?0[bB][0-1]+)");
-    rule.format = immFormat;
-    m_highlightingRules.append(rule);
-
-    // Create comment highlighting rule
-    commentFormat.setForeground(QColor(Colors::Medalist));
-    rule.pattern = QRegularExpression("[#]+.*");
-    rule.format = commentFormat;
-    m_highlightingRules.append(rule);
-
-    // Create label highlighting rule
     commentFormat.setForeground(QColor(Colors::Medalist));
-    rule.pattern = QRegularExpression("(.*?[:])");
-    rule.format = commentFormat;
-    m_highlightingRules.append(rule);
-
-    // Create string highlighting rule
     stringFormat.setForeground(QColor(0x800000));
-    rule.pattern = QRegularExpression(R"("(?:[^"]|\.)*")");
-    rule.format = stringFormat;
-    m_highlightingRules.append(rule);
 }
 
 void RVAssemblyHighlighter::highlightBlock(const QString& text) {
-    QString tooltip = checkSyntax(text);
-    int row = currentBlock().firstLineNumber();
-    if (tooltip != QString()) {
-        setFormat(0, text.length(), errorFormat);
-        setTooltip(row, tooltip);
-    } else {
-        clearTooltip(row);
-        for (const HighlightingRule& rule : m_highlightingRules) {
-            QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
-            while (matchIterator.hasNext()) {
-                QRegularExpressionMatch match = matchIterator.next();
-                setFormat(match.capturedStart(), match.capturedLength(), rule.format);
+    // Lexing results are reused if the block is rehighlighted without having changed, ie. when a label it depends on
+    // was (un)defined.
+    const auto* prev = dynamic_cast<const AsmBlockData*>(currentBlockUserData());
+    auto* data = prev && prev->text == text ? new AsmBlockData(*prev) : new AsmBlockData(text);
+
+    // Discarding the previous data releases the label which it defined, before the new data is checked
+    setCurrentBlockUserData(nullptr);
+    data->error = checkSyntax(*data);
+    // The block data may outlive the highlighter, ie. when the source type of the document changes
+    data->onDestroyed = [highlighter = QPointer<RVAssemblyHighlighter>(this)](AsmBlockData* destroyed) {
+        if (highlighter && !destroyed->label.isEmpty()) {
+            highlighter->defineLabel(destroyed->label, -1);
+        }
+    };
+    setCurrentBlockUserData(data);
+
+    applyFormats(*data);
+}
+
+void RVAssemblyHighlighter::applyFormats(const AsmBlockData& data) {
+    if (!data.error.isEmpty()) {
+        setFormat(0, data.text.length(), errorFormat);
+        return;
+    }
+
+    for (const auto& token : data.tokens) {
+        switch (token.kind) {
+            case AsmToken::Kind::Label:
+            case AsmToken::Kind::Comment:
+                setFormat(token.start, token.length, commentFormat);
+                break;
+            case AsmToken::Kind::Immediate:
+                setFormat(token.start, token.length, immFormat);
+                break;
+            case AsmToken::Kind::String:
+                setFormat(token.start, token.length, stringFormat);
+                break;
+            case AsmToken::Kind::Word: {
+                const QString word = data.text.mid(token.start, token.length).toLower();
+                if (ABInames.contains(word) || RegNames.contains(word)) {
+                    setFormat(token.start, token.length, regFormat);
+                } else if (!word.startsWith('.') && m_syntaxRules.contains(word)) {
+                    setFormat(token.start, token.length, instrFormat);
+                }
+                break;
             }
         }
     }
@@ -511,6 +398,35 @@ void RVAssemblyHighlighter::createSyntaxRules() {
         m_syntaxRules.insert(name, QList<SyntaxRule>() << rule);
     }
 
+    // Load-reserved; the address register is written as (rs1)
+    types.clear();
+    types << FieldType(Type::Register) << FieldType(Type::Register);
+    rule.instr = "lr.w";
+    rule.fields = 3;
+    rule.inputs = types;
+    m_syntaxRules.insert(rule.instr, QList<SyntaxRule>() << rule);
+
+    // Store-conditional and atomic memory operations
+    types.clear();
+    names.clear();
+    types << FieldType(Type::Register) << FieldType(Type::Register) << FieldType(Type::Register);
+    names << "sc.w"
+          << "amoswap.w"
+          << "amoadd.w"
+          << "amoxor.w"
+          << "amoand.w"
+          << "amoor.w"
+          << "amomin.w"
+          << "amomax.w"
+          << "amominu.w"
+          << "amomaxu.w";
+    for (const auto& name : names) {
+        rule.instr = name;
+        rule.fields = 4;
+        rule.inputs = types;
+        m_syntaxRules.insert(name, QList<SyntaxRule>() << rule);
+    }
+
     // S type instructions
     QMap<QString, QList<SyntaxRule>> storeRules;
     types.clear();
@@ -604,71 +520,32 @@ namespace {
     return QString("Unknown operation");
 }  // namespace
 
-QString RVAssemblyHighlighter::checkSyntax(const QString& input) {
-    QStringList fields = input.split(splitter);
-    fields.removeAll("");
-    fields = splitQuotes(fields);
-
+QString RVAssemblyHighlighter::checkSyntax(AsmBlockData& data) {
     // Empty fields? return
-    if (fields.isEmpty())
+    if (data.fields.isEmpty())
         return QString();
 
     // Throw away case information
+    QStringList fields = data.fields;
     std::transform(fields.begin(), fields.end(), fields.begin(), [](const QString& s) { return s.toLower(); });
 
-    int pos = currentBlock().firstLineNumber();
-
-    // check for labels
-    QString string = fields[0];
-    if (string.contains(':')) {
-        if (string.count(':') > 1) {
-            return QString("Multiple instances of ':' in label");
-        }
-        // Label detected - check if already defined, else add to label definitions
-        QStringList splitFirst = string.split(':');
-        string = splitFirst[0];  // get label
-        if (string.isEmpty()) {
+    // check for labels. Label fields retain their ':' separator.
+    if (fields[0].endsWith(':')) {
+        QString label = fields.takeFirst();
+        label.chop(1);
+        if (label.isEmpty()) {
             return QString("Empty label name");
         }
-        // Update map entries at given block
-        if (m_labelPosMap.contains(string) && m_labelPosMap[string] != pos) {
-            // duplicate label found
-            if (pos < m_labelPosMap[string]) {
-                // Label is redefined before previous use of label
-                m_posLabelMap.remove(m_labelPosMap[string]);
-                m_labelPosMap[string] = pos;
-                m_posLabelMap[pos] = string;
-            } else {
-                return QString("Multiple definitions of label %1").arg(string);
-            }
-        } else {
-            // no duplicates, update label at given pos
-            m_labelPosMap.remove(m_posLabelMap[pos]);
-            m_labelPosMap[string] = pos;
-            m_posLabelMap[pos] = string;
+        if (!fields.isEmpty() && fields[0].endsWith(':')) {
+            return QString("Multiple instances of ':' in label");
         }
-        // Remove label from fields vector
-        if (splitFirst.size() > 1) {
-            fields[0] = splitFirst[1];
-        } else {
-            fields.removeAt(0);
+        // Record the label definition, and check whether the label is defined by other blocks as well
+        data.label = label;
+        defineLabel(label, 1);
+        if (m_labelDefinitions.value(label) > 1) {
+            return QString("Multiple definitions of label %1").arg(label);
         }
         // Return if empty fields vector
-        fields.removeAll("");
-        if (fields.isEmpty())
-            return QString();
-    }
-
-    // Remove comments from syntax evaluation
-    const static auto commentRegEx = QRegularExpression("[#](.*)");
-    int commentIndex = fields.indexOf(commentRegEx);
-    if (commentIndex != -1) {
-        int index = fields.length();
-        while (index >= commentIndex) {
-            fields.removeAt(index);
-            index--;
-        }
-        // Empty fields? return
         if (fields.isEmpty())
             return QString();
     }
@@ -698,10 +575,10 @@ QString RVAssemblyHighlighter::checkSyntax(const QString& input) {
 
                         auto inputRule = rule.skipFirstField && nFields == rule.fields2 ? rule.inputs[ruleIndex]
                                                                                         : rule.inputs[ruleIndex - 1];
-                        // If an offset is used, store line number, to re-update after all variable declarations have
-                        // been mapped (after syntax checking the entire document)
+                        // If an offset is used, record the label, such that the line is rechecked whenever the label is
+                        // (un)defined
                         if (inputRule.m_type == Type::Offset) {
-                            m_rowsUsingLabels << pos;
+                            data.labelRefs << fields[index];
                         }
                         // Validation for the current rule continues if res is still an empty string. If not, the string
                         // in res is kept, which will prompt the algorithm to either return res or validate subsequent
@@ -735,30 +612,85 @@ QString RVAssemblyHighlighter::checkSyntax(const QString& input) {
 }
 
 bool RVAssemblyHighlighter::acceptsSyntax() const {
-    return m_tooltipForLine.empty();
+    for (QTextBlock block = document()->begin(); block != document()->end(); block = block.next()) {
+        const auto* data = AsmBlockData::get(block);
+        if (data && !data->error.isEmpty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QString RVAssemblyHighlighter::getTooltipForBlock(const QTextBlock& block) const {
+    const auto* data = AsmBlockData::get(block);
+    return data ? data->error : QString();
 }
 
 void RVAssemblyHighlighter::reset() {
-    m_labelPosMap.clear();
-    m_posLabelMap.clear();
-    m_rowsUsingLabels.clear();
+    m_changedLabels.clear();
     SyntaxHighlighter::reset();
 }
 
 void RVAssemblyHighlighter::clearAndRehighlight() {
     reset();
     rehighlight();
-    for (const auto& row : m_rowsUsingLabels) {
-        // Rehighlight rows which use labels, now that all labels have been recorded
-        rehighlightBlock(document()->findBlockByLineNumber(row));
+    // Rehighlight rows which use labels, now that all labels have been recorded
+    rehighlightLabelDependents();
+}
+
+namespace {
+int definitionState(int definitions) {
+    return std::min(definitions, 2);
+}
+}  // namespace
+
+void RVAssemblyHighlighter::defineLabel(const QString& label, int delta) {
+    auto it = m_labelDefinitions.find(label);
+    const int definitions = it == m_labelDefinitions.end() ? 0 : *it;
+    if (!m_changedLabels.contains(label)) {
+        m_changedLabels[label] = definitionState(definitions);
+    }
+    if (definitions + delta <= 0) {
+        if (it != m_labelDefinitions.end()) {
+            m_labelDefinitions.erase(it);
+        }
+    } else {
+        m_labelDefinitions[label] = definitions + delta;
+    }
+
+    // Blocks depending on the label cannot be rehighlighted whilst highlighting, or whilst the document is being
+    // modified; defer until control returns to the event loop.
+    if (!m_dependentsRehighlightQueued) {
+        m_dependentsRehighlightQueued = true;
+        QMetaObject::invokeMethod(this, &RVAssemblyHighlighter::rehighlightLabelDependents, Qt::QueuedConnection);
     }
 }
 
-void RVAssemblyHighlighter::invalidateLabels(const QTextCursor& cursor) {
-    if (m_posLabelMap.contains(cursor.block().firstLineNumber())) {
-        // a current label exists at the cursor position - if current action was a newline event, we need to reset
-        // resets label mapping and rehighlights required lines
-        clearAndRehighlight();
+void RVAssemblyHighlighter::rehighlightLabelDependents() {
+    m_dependentsRehighlightQueued = false;
+
+    QSet<QString> changed;
+    for (auto it = m_changedLabels.constBegin(); it != m_changedLabels.constEnd(); ++it) {
+        if (definitionState(m_labelDefinitions.value(it.key())) != it.value()) {
+            changed.insert(it.key());
+        }
+    }
+    m_changedLabels.clear();
+    if (changed.isEmpty()) {
+        return;
+    }
+
+    for (QTextBlock block = document()->begin(); block != document()->end(); block = block.next()) {
+        const auto* data = AsmBlockData::get(block);
+        if (!data) {
+            continue;
+        }
+        const bool dependsOnLabel =
+            changed.contains(data->label) || std::any_of(data->labelRefs.begin(), data->labelRefs.end(),
+                                                         [&](const QString& label) { return changed.contains(label); });
+        if (dependsOnLabel) {
+            rehighlightBlock(block);
+        }
     }
 }
 }  // namespace Ripes
@@ -1,7 +1,9 @@
 #pragma once
 
-#include <QRegularExpression>
+#include <QHash>
+#include <QMap>
 
+#include "assemblylexer.h"
 #include "syntaxhighlighter.h"
 
 namespace Ripes {
@@ -9,8 +11,10 @@ namespace Ripes {
 /* Class for highlighting RISC-V assembly code Based on QT's rich text syntax highlighter example.
  http://doc.qt.io/qt-5/qtwidgets-richtext-syntaxhighlighter-example.html
 
- Matches instruction names directly, and register aliases/true name.
- Matches immediate values by regex*/
+ Each block is lexed once per change, and its tokens, fields and syntax checking results are attached to the block as
+ AsmBlockData. Words are highlighted as instructions or registers by direct lookup.
+ Label definitions are reference counted across blocks, such that only the blocks depending on a label are rechecked
+ when the label is (un)defined.*/
 enum class Type { Immediate, Register, Offset, String };
 
 class RVAssemblyHighlighter;
@@ -37,13 +41,11 @@ public:
     void highlightBlock(const QString& text) override;
     void reset() override;
     bool acceptsSyntax() const override;
+    QString getTooltipForBlock(const QTextBlock& block) const override;
 
 private:
-    QString checkSyntax(const QString& line);
-    struct HighlightingRule {
-        QRegularExpression pattern;
-        QTextCharFormat format;
-    };
+    QString checkSyntax(AsmBlockData& data);
+    void applyFormats(const AsmBlockData& data);
 
     struct SyntaxRule {
         QString instr;
@@ -59,8 +61,6 @@ private:
 
     QMap<QString, QList<SyntaxRule>> m_syntaxRules;  // Maps instruction names to syntax rule(s)
 
-    QVector<HighlightingRule> m_highlightingRules;
-
     // Format type for each matching case
     QTextCharFormat regFormat;
     QTextCharFormat instrFormat;
@@ -69,13 +69,20 @@ private:
     QTextCharFormat stringFormat;
     QTextCharFormat errorFormat;
 
-    QMap<QString, int> m_labelPosMap;
-    QMap<int, QString> m_posLabelMap;
-    QSet<int> m_rowsUsingLabels;  // List of lines that are rehighlighted once the main syntax checking is done -
-                                  // needed for supporting labels that are declared after usage
+    void defineLabel(const QString& label, int delta);
+    void rehighlightLabelDependents();
+
+    /** Number of blocks defining each label */
+    QHash<QString, int> m_labelDefinitions;
+    /**
+     * Labels whose number of definitions changed since blocks depending on them were last rehighlighted, mapped to
+     * their definition state (undefined, defined, multiply defined) at that time. Needed for supporting labels that
+     * are declared after usage.
+     */
+    QHash<QString, int> m_changedLabels;
+    bool m_dependentsRehighlightQueued = false;
 
 public slots:
-    void invalidateLabels(const QTextCursor&);
     void clearAndRehighlight() override;
 };
 
@@ -10,7 +10,12 @@ class SyntaxHighlighter : public QSyntaxHighlighter {
 public:
     SyntaxHighlighter(QTextDocument* parent = nullptr);
 
-    QString getTooltipForLine(int index) const;
+    /**
+     * @brief getTooltipForBlock
+     * The syntax highlighter may provide a tooltip for each block in the current text document. These tooltips will be
+     * displayed by the codeeditor when a relevant tooltip event occurs.
+     */
+    virtual QString getTooltipForBlock(const QTextBlock& block) const;
 
     virtual void highlightBlock(const QString& text) = 0;
     virtual void reset();
@@ -21,17 +26,5 @@ signals:
 
 public slots:
     virtual void clearAndRehighlight() = 0;
-
-protected:
-    void handleBlockCountChanged();
-
-    void setTooltip(int line, QString tooltip);
-    void clearTooltip(int line);
-    /**
-     * @brief m_tooltipForLine
-     * The syntax highlighter may provide a tooltip for each line in the current text document. These tooltips will be
-     * displayed by the codeeditor when a relevant tooltip event occurs.
-     */
-    std::map<int, QString> m_tooltipForLine;
 };
 }  // namespace Ripes
@@ -1,17 +1,17 @@
 #include "edittab.h"
 #include "ui_edittab.h"
 
-#include "elfio/elfio.hpp"
-
 #include <QCheckBox>
 #include <QLabel>
 #include <QLineEdit>
 #include <QMessageBox>
 #include <QPushButton>
 
+#include "callprofiler.h"
 #include "ccmanager.h"
 #include "compilererrordialog.h"
 #include "editor/codeeditor.h"
+#include "elfloader.h"
 #include "parser.h"
 #include "processorhandler.h"
 #include "program.h"
@@ -50,8 +50,6 @@ EditTab::EditTab(QToolBar* toolbar, QWidget* parent) : RipesTab(toolbar, parent)
     connect(m_ui->enableEditor, &QPushButton::clicked, this, &EditTab::enableAssemblyInput);
     connect(m_ui->codeEditor, &CodeEditor::timedTextChanged, this, &EditTab::sourceCodeChanged);
 
-    m_ui->programViewer->setReadOnly(true);
-
     m_assembler = std::make_unique<Assembler>();
 
     connect(m_ui->setAssemblyInput, &QRadioButton::toggled, this, &EditTab::sourceTypeChanged);
@@ -65,6 +63,8 @@ EditTab::EditTab(QToolBar* toolbar, QWidget* parent) : RipesTab(toolbar, parent)
         }
     });
 
+    connect(&CCManager::get(), &CCManager::compileFinished, this, &EditTab::compileFinished);
+
     // During processor running, it should not be possible to build the program
     connect(ProcessorHandler::get(), &ProcessorHandler::runStarted, [=] { m_buildAction->setEnabled(false); });
     connect(ProcessorHandler::get(), &ProcessorHandler::runFinished,
@@ -75,7 +75,7 @@ EditTab::EditTab(QToolBar* toolbar, QWidget* parent) : RipesTab(toolbar, parent)
 }
 
 void EditTab::showSymbolNavigator() {
-    SymbolNavigator nav(m_ui->programViewer->addressOffsetMap(), this);
+    SymbolNavigator nav(m_ui->programViewer->programIndex().symbols(), this);
     if (nav.exec()) {
         m_ui->programViewer->setCenterAddress(nav.getSelectedSymbolAddress());
     }
@@ -127,6 +127,7 @@ void EditTab::loadFile(const LoadFileParams& fileParams) {
     }
 
     if (success) {
+        loadedProgram->syscallABI = fileParams.syscallABI;
         // Move the shared pointer to be the current active program
         m_activeProgram = loadedProgram;
         emitProgramChanged();
@@ -155,6 +156,29 @@ void EditTab::updateProgramViewerHighlighting() {
     }
 }
 
+void EditTab::updateSourceLineCycles() {
+    if (!isVisible()) {
+        return;
+    }
+
+    std::map<int, uint64_t> lineCycles;
+    if (m_currentSourceType == SourceType::C && m_activeProgram && CallProfiler::get()->isEnabled()) {
+        const auto& lineInfo = m_activeProgram->lineInfo;
+        const int sourceFile = lineInfo.findFile(m_compiledSourceFile);
+        if (sourceFile >= 0) {
+            for (const auto& function : CallProfiler::get()->functions()) {
+                for (const auto& pcCost : function.selfCost) {
+                    const auto* row = lineInfo.lookup(pcCost.first);
+                    if (row && row->file == sourceFile && row->line > 0) {
+                        lineCycles[row->line - 1] += pcCost.second.cycles;
+                    }
+                }
+            }
+        }
+    }
+    m_ui->codeEditor->setLineCycleCounts(lineCycles);
+}
+
 void EditTab::sourceTypeChanged() {
     if (!m_editorEnabled) {
         // Do nothing; editor is currently disabled so we should not care about updating our source type being the code
@@ -193,9 +217,14 @@ void EditTab::sourceCodeChanged() {
         case SourceType::Assembly:
             assemble();
             break;
+        case SourceType::C:
+            // Unless background compilation is enabled, the user shall manually select to build
+            if (RipesSettings::value(RIPES_SETTING_CCBACKGROUND).toBool()) {
+                compileInBackground();
+            }
+            break;
         default:
-            // Do nothing, either some external program is loaded or, if compiling from C, the user shall manually
-            // select to build
+            // Do nothing, some external program is loaded
             break;
     }
 }
@@ -204,7 +233,16 @@ void EditTab::assemble() {
     if (m_ui->codeEditor->syntaxAccepted()) {
         m_assembler->assemble(*m_ui->codeEditor->document());
         if (!m_assembler->hasError()) {
-            m_activeProgram = m_assembler->getProgram();
+            // If the processor is still executing the previously assembled program, and only instruction words changed,
+            // the changed instructions are patched into the processor memory in place of resetting the processor.
+            const bool patchable = m_activeProgram && ProcessorHandler::get()->getProgram().lock() == m_activeProgram;
+            auto program = m_assembler->getProgram();
+            if (patchable && ProcessorHandler::get()->patchProgram(program)) {
+                m_activeProgram = program;
+                updateProgramViewer();
+                return;
+            }
+            m_activeProgram = program;
             emitProgramChanged();
         } else {
             QMessageBox err;
@@ -216,20 +254,37 @@ void EditTab::assemble() {
 
 void EditTab::compile() {
     // We don't care about asking our editor for syntax accepted, since there is no C-syntax checking in Ripes.
-    auto res = CCManager::get().compile(m_ui->codeEditor->document());
-    if (res.success) {
-        // Compilation successful; load file through standard file loading functions
-        LoadFileParams params;
-        params.filepath = res.outFile;
-        params.type = SourceType::InternalELF;
-        loadFile(params);
-        // Clean up temporary source and output files
-    } else if (!res.aborted) {
-        CompilerErrorDialog errDiag(this);
-        errDiag.setText("Compilation failed. Error output was:");
-        errDiag.setErrorText(CCManager::getError());
-        errDiag.exec();
+    m_reportCompileErrors = true;
+    CCManager::get().compileAsync(m_ui->codeEditor->toPlainText());
+}
+
+void EditTab::compileInBackground() {
+    // As with building, the program should not be replaced whilst the processor is running
+    if (!m_buildAction->isEnabled() || !CCManager::hasValidCC()) {
+        return;
+    }
+    m_reportCompileErrors = false;
+    CCManager::get().compileAsync(m_ui->codeEditor->toPlainText());
+}
+
+void EditTab::compileFinished(CCManager::CCRes res) {
+    // The source type may have been changed whilst compiling, in which case the result is discarded
+    if (m_currentSourceType == SourceType::C) {
+        if (res.success) {
+            // Compilation successful; load file through standard file loading functions
+            LoadFileParams params;
+            params.filepath = res.outFile;
+            params.type = SourceType::InternalELF;
+            m_compiledSourceFile = res.inFile;
+            loadFile(params);
+        } else if (!res.aborted && m_reportCompileErrors) {
+            CompilerErrorDialog errDiag(this);
+            errDiag.setText("Compilation failed. Error output was:");
+            errDiag.setErrorText(res.errorMessage);
+            errDiag.exec();
+        }
     }
+    // Clean up temporary source and output files
     res.clean();
 }
 
@@ -298,46 +353,12 @@ bool EditTab::loadSourceFile(Program&, QFile& file) {
 }
 
 bool EditTab::loadElfFile(Program& program, QFile& file) {
-    ELFIO::elfio reader;
-
     // No file validity checking is performed - it is expected that Loaddialog has done all validity
     // checking.
-    if (!reader.load(file.fileName().toStdString())) {
+    if (!loadElfProgram(program, file.fileName())) {
         assert(false);
     }
 
-    for (const auto& elfSection : reader.sections) {
-        // Do not load .debug sections
-        if (!QString::fromStdString(elfSection->get_name()).startsWith(".debug")) {
-            ProgramSection& section = program.sections.emplace_back();
-            section.name = QString::fromStdString(elfSection->get_name());
-            section.address = elfSection->get_address();
-            // QByteArray performs a deep copy of the data when the data array is initialized at construction
-            section.data = QByteArray(elfSection->get_data(), static_cast<int>(elfSection->get_size()));
-        }
-
-        if (elfSection->get_type() == SHT_SYMTAB) {
-            // Collect function symbols
-            const ELFIO::symbol_section_accessor symbols(reader, elfSection);
-            for (unsigned int j = 0; j < symbols.get_symbols_num(); ++j) {
-                std::string name;
-                ELFIO::Elf64_Addr value;
-                ELFIO::Elf_Xword size;
-                unsigned char bind;
-                unsigned char type;
-                ELFIO::Elf_Half section_index;
-                unsigned char other;
-                symbols.get_symbol(j, name, value, size, bind, type, section_index, other);
-
-                if (type != STT_FUNC)
-                    continue;
-                program.symbols[value] = QString::fromStdString(name);
-            }
-        }
-    }
-
-    program.entryPoint = reader.get_entry();
-
     m_ui->curInputSrcLabel->setText("Executable (ELF)");
     m_ui->inputSrcPath->setText(file.fileName());
 
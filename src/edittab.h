@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "assembler.h"
+#include "ccmanager.h"
 #include "program.h"
 #include "ripestab.h"
 
@@ -49,6 +50,12 @@ signals:
 public slots:
     void updateProgramViewerHighlighting();
 
+    /**
+     * @brief updateSourceLineCycles
+     * Annotates the lines of a compiled C program with the cycles attributed to them by the call profiler.
+     */
+    void updateSourceLineCycles();
+
     void emitProgramChanged();
 
     /**
@@ -71,6 +78,12 @@ private slots:
 private:
     void assemble();
     void compile();
+    /**
+     * @brief compileInBackground
+     * Starts a compilation of the current C program without reporting compilation errors.
+     */
+    void compileInBackground();
+    void compileFinished(CCManager::CCRes res);
 
     void updateProgramViewer();
     bool loadFlatBinaryFile(Program& program, QFile& file, unsigned long entryPoint, unsigned long loadAt);
@@ -90,8 +103,22 @@ private:
 
     std::shared_ptr<Program> m_activeProgram;
 
+    /**
+     * @brief m_compiledSourceFile
+     * Path of the source file which the current program was compiled from. Used for locating the lines of the editor
+     * within the line information of the compiled program.
+     */
+    QString m_compiledSourceFile;
+
     SourceType m_currentSourceType;
 
+    /**
+     * @brief m_reportCompileErrors
+     * Compilation errors are only reported for compilations explicitly requested by the user, and not for background
+     * compilations whilst editing.
+     */
+    bool m_reportCompileErrors = false;
+
     bool m_editorEnabled = true;
 };
 }  // namespace Ripes
@@ -0,0 +1,56 @@
+#include "elfloader.h"
+
+#include "elfio/elfio.hpp"
+
+namespace Ripes {
+
+bool loadElfProgram(Program& program, const QString& path) {
+    ELFIO::elfio reader;
+    if (!reader.load(path.toStdString())) {
+        return false;
+    }
+
+    for (const auto& elfSection : reader.sections) {
+        // Do not load .debug sections
+        if (!QString::fromStdString(elfSection->get_name()).startsWith(".debug")) {
+            ProgramSection& section = program.sections.emplace_back();
+            section.name = QString::fromStdString(elfSection->get_name());
+            section.address = elfSection->get_address();
+            // QByteArray performs a deep copy of the data when the data array is initialized at construction
+            section.data = QByteArray(elfSection->get_data(), static_cast<int>(elfSection->get_size()));
+        }
+
+        if (elfSection->get_type() == SHT_SYMTAB) {
+            // Collect function symbols
+            const ELFIO::symbol_section_accessor symbols(reader, elfSection);
+            for (unsigned int j = 0; j < symbols.get_symbols_num(); ++j) {
+                std::string name;
+                ELFIO::Elf64_Addr value;
+                ELFIO::Elf_Xword size;
+                unsigned char bind;
+                unsigned char type;
+                ELFIO::Elf_Half section_index;
+                unsigned char other;
+                symbols.get_symbol(j, name, value, size, bind, type, section_index, other);
+
+                if (type != STT_FUNC)
+                    continue;
+                program.symbols[value] = QString::fromStdString(name);
+            }
+        }
+    }
+
+    // Build the address to source line index, if the executable was compiled with debug information
+    const auto sectionData = [&](const std::string& name) {
+        const auto* elfSection = reader.sections[name];
+        return elfSection ? QByteArray::fromRawData(elfSection->get_data(), static_cast<int>(elfSection->get_size()))
+                          : QByteArray();
+    };
+    program.lineInfo =
+        DebugLineInfo::parse(sectionData(".debug_line"), sectionData(".debug_line_str"), sectionData(".debug_str"));
+
+    program.entryPoint = reader.get_entry();
+    return true;
+}
+
+}  // namespace Ripes
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QString>
+
+#include "program.h"
+
+namespace Ripes {
+
+/**
+ * @brief loadElfProgram
+ * Loads the ELF executable at @p path into @p program: all but its .debug sections, its function symbols, its address
+ * to source line index (if compiled with debug information) and its entry point.
+ * @returns false if @p path could not be read as an ELF file.
+ */
+bool loadElfProgram(Program& program, const QString& path);
+
+}  // namespace Ripes
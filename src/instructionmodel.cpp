@@ -1,5 +1,6 @@
 #include "instructionmodel.h"
 #include "parser.h"
+#include "selfprofiler.h"
 
 #include <QHeaderView>
 
@@ -21,6 +22,7 @@ int InstructionModel::rowCount(const QModelIndex&) const {
 }
 
 void InstructionModel::processorWasClocked() {
+    RIPES_PROFILE_SCOPE(ModelUpdate);
     // Reload model
     beginResetModel();
     gatherStageInfo();
@@ -28,6 +30,7 @@ void InstructionModel::processorWasClocked() {
 }
 
 void InstructionModel::gatherStageInfo() {
+    RIPES_PROFILE_SCOPE(StageInfo);
     bool firstStageChanged = false;
     for (int i = 0; i < m_stageNames.length(); i++) {
         if (i == 0) {
@@ -8,8 +8,8 @@
 namespace Ripes {
 
 /// Currently supported ISAs
-enum class ISA { RV32IM };
-const static std::map<ISA, QString> ISANames = {{ISA::RV32IM, "RISC-V"}};
+enum class ISA { RV32IMA };
+const static std::map<ISA, QString> ISANames = {{ISA::RV32IMA, "RISC-V"}};
 
 class ISAInfoBase {
 public:
@@ -118,7 +118,7 @@ const static std::map<RVElfFlags, QString> RVELFFlagStrings {{RVC, "RVC"}, {Floa
 }  // namespace
 
 template <>
-class ISAInfo<ISA::RV32IM> : public ISAInfoBase {
+class ISAInfo<ISA::RV32IMA> : public ISAInfoBase {
 public:
     enum SysCall {
         None = 0,
@@ -142,13 +142,13 @@ public:
         brk = 214,
         Open = 1024
     };
-    static const ISAInfo<ISA::RV32IM>* instance() {
-        static ISAInfo<ISA::RV32IM> pr;
+    static const ISAInfo<ISA::RV32IMA>* instance() {
+        static ISAInfo<ISA::RV32IMA> pr;
         return &pr;
     }
 
-    QString name() const override { return "RV32IM"; }
-    ISA isaID() const override { return ISA::RV32IM; }
+    QString name() const override { return "RV32IMA"; }
+    ISA isaID() const override { return ISA::RV32IMA; }
 
     unsigned int regCnt() const override { return 32; }
     QString regName(unsigned i) const override { return RVRegNames.at(i); }
@@ -161,11 +161,11 @@ public:
     int syscallReg() const override { return 17; }
     unsigned elfMachineId() const override { return EM_RISCV; }
 
-    QString CCmarch() const override { return "rv32im"; }
+    QString CCmarch() const override { return "rv32ima"; }
     QString CCmabi() const override { return "ilp32"; }
 
     QString elfSupportsFlags(unsigned flags) const override {
-        /** We expect no flags for RV32IM compiled RISC-V executables.
+        /** We expect no flags for RV32IMA compiled RISC-V executables.
          *  Refer to: https://github.com/riscv/riscv-elf-psabi-doc/blob/master/riscv-elf.md#-elf-object-files
          */
         if (flags == 0)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QStringList>
+#include <QVector>
 
 namespace Ripes {
 
@@ -28,4 +29,123 @@ static QStringList splitQuotes(const QStringList& list) {
     ret.removeAll("");
     return ret;
 }
+
+static inline bool isInRange(QChar c, char low, char high) {
+    return c.unicode() >= static_cast<ushort>(low) && c.unicode() <= static_cast<ushort>(high);
+}
+
+/**
+ * @brief startsWithRegister
+ * @returns whether @p s starts with a register name, as matched by the lookahead of the register splitter regex.
+ */
+static bool startsWithRegister(const QStringRef& s) {
+    const QChar c0 = s.size() > 0 ? s.at(0) : QChar();
+    const QChar c1 = s.size() > 1 ? s.at(1) : QChar();
+    switch (c0.unicode()) {
+        case 'x':
+            return c1.isDigit();
+        case 's':
+            return c1.isDigit() || c1 == 'p';
+        case 't':
+            return isInRange(c1, '0', '6') || c1 == 'p';
+        case 'a':
+            return isInRange(c1, '0', '7');
+        case 'g':
+            return c1 == 'p';
+        case 'z':
+            return s.startsWith(QLatin1String("zero"));
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief endsWithRegister
+ * @returns whether @p s ends with a register name, as matched by the register splitter regex preceding a ')'.
+ */
+static bool endsWithRegister(const QStringRef& s) {
+    const int n = s.size();
+    if (s.endsWith(QLatin1String("zero"))) {
+        return true;
+    }
+    if (n < 2) {
+        return false;
+    }
+    const QChar last = s.at(n - 1);
+    const QChar prev = s.at(n - 2);
+    if (last == 'p') {
+        return prev == 's' || prev == 'g' || prev == 't';
+    }
+    if (!last.isDigit()) {
+        return false;
+    }
+    if (prev == 'x' || prev == 's') {
+        return true;
+    }
+    if (prev == 't') {
+        return isInRange(last, '0', '6');
+    }
+    if (prev == 'a') {
+        return isInRange(last, '0', '7');
+    }
+    if (n >= 3 && prev.isDigit()) {
+        const QChar reg = s.at(n - 3);
+        if (reg == 'x') {
+            return isInRange(prev, '1', '2') || (prev == '3' && isInRange(last, '0', '1'));
+        }
+        if (reg == 's') {
+            return prev == '1' && isInRange(last, '0', '1');
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief tokenizeLineRefs
+ * Single-pass equivalent of splitting @p line by the register splitter regex and thereafter applying splitQuotes().
+ * The line is scanned in place, and the fields are returned as references into @p line, which must outlive them.
+ */
+static QVector<QStringRef> tokenizeLineRefs(const QString& line) {
+    QVector<QStringRef> fields;
+    int start = 0;
+    bool inQuote = false;
+    bool inParen = false;
+    auto appendField = [&](int end) {
+        if (end > start) {
+            fields.append(line.midRef(start, end - start));
+        }
+        start = end + 1;
+    };
+
+    for (int i = 0; i < line.length(); i++) {
+        const QChar c = line.at(i);
+        if (c == '\t' || (c == '(' && startsWithRegister(line.midRef(i + 1))) ||
+            (c == ')' && endsWithRegister(line.midRef(start, i - start)))) {
+            // Splitter regex delimiter; quotes and parentheses are only tracked within each of the split strings
+            appendField(i);
+            inQuote = false;
+            inParen = false;
+            continue;
+        }
+        inQuote ^= c == '"';
+        inParen = (inParen || (c == '(')) && c != ')';
+        if ((c == ' ' || c == ',') && !inQuote && !inParen) {
+            appendField(i);
+        }
+    }
+    appendField(line.length());
+    return fields;
+}
+
+/**
+ * @brief tokenizeLine
+ * As tokenizeLineRefs(), with the fields copied out of @p line.
+ */
+static QStringList tokenizeLine(const QString& line) {
+    QStringList fields;
+    for (const auto& field : tokenizeLineRefs(line)) {
+        fields.append(field.toString());
+    }
+    return fields;
+}
 }  // namespace Ripes
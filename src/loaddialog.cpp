@@ -19,6 +19,7 @@ namespace Ripes {
 
 LoadDialog::TypeButtonID LoadDialog::s_typeIndex = TypeButtonID::ELF;
 QString LoadDialog::s_filePath = QString();
+SyscallABI LoadDialog::s_syscallABI = SyscallABI::Ripes;
 
 LoadDialog::LoadDialog(QWidget* parent) : QDialog(parent), m_ui(new Ui::LoadDialog) {
     m_ui->setupUi(this);
@@ -52,6 +53,9 @@ LoadDialog::LoadDialog(QWidget* parent) : QDialog(parent), m_ui(new Ui::LoadDial
 
     // ELF page
     m_ui->currentISA->setText(ProcessorHandler::get()->currentISA()->name());
+    m_ui->syscallABI->addItem("Ripes", QVariant::fromValue(static_cast<int>(SyscallABI::Ripes)));
+    m_ui->syscallABI->addItem("Linux (newlib)", QVariant::fromValue(static_cast<int>(SyscallABI::Linux)));
+    m_ui->syscallABI->setCurrentIndex(m_ui->syscallABI->findData(static_cast<int>(s_syscallABI)));
 
     // default selection
     m_fileTypeButtons->button(s_typeIndex)->toggle();
@@ -244,6 +248,8 @@ void LoadDialog::accept() {
             break;
         case TypeButtonID::ELF:
             m_params.type = SourceType::ExternalELF;
+            s_syscallABI = static_cast<SyscallABI>(m_ui->syscallABI->currentData().toInt());
+            m_params.syscallABI = s_syscallABI;
             break;
     }
 
@@ -53,6 +53,7 @@ private:
     enum TypeButtonID { Source, FlatBinary, ELF };
     static TypeButtonID s_typeIndex;
     static QString s_filePath;
+    static SyscallABI s_syscallABI;
 
     void setElfInfo(const ELFInfo& info);
     bool fileTypeValidate(const QFile& file);
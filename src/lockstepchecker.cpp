@@ -0,0 +1,138 @@
+#include "lockstepchecker.h"
+
+#include "processorhandler.h"
+
+namespace Ripes {
+
+namespace {
+inline QString hex(uint32_t value) {
+    return "0x" + QString::number(value, 16).rightJustified(8, '0');
+}
+
+inline uint32_t readMemory(uint32_t address, unsigned size) {
+    const uint32_t value = ProcessorHandler::get()->getMemory().readMemConst(address, size);
+    return size >= sizeof(uint32_t) ? value : value & ((1u << (size * CHAR_BIT)) - 1);
+}
+}  // namespace
+
+LockstepChecker::LockstepChecker() : m_reference(readMemory) {
+    connect(ProcessorHandler::get(), &ProcessorHandler::reqProcessorReset, this, &LockstepChecker::processorReset);
+    processorReset();
+}
+
+void LockstepChecker::setEnabled(bool enabled) {
+    m_enabled = enabled;
+    processorReset();
+}
+
+void LockstepChecker::processorReset() {
+    // The processor might have changed. As in CacheSim, (re)connect to the VSRTL design update signals.
+    auto* proc = ProcessorHandler::get()->getProcessorNonConst();
+    proc->designWasClocked.Connect(this, &LockstepChecker::processorWasClocked);
+    proc->designWasReversed.Connect(this, &LockstepChecker::processorWasReversed);
+    proc->designWasReset.Connect(this, &LockstepChecker::processorReset);
+
+    m_divergence = QString();
+    m_instructionsChecked = 0;
+    m_commits.clear();
+
+    // The architectural state of a processor is only known when no instructions are in flight, ie. after reset
+    m_synchronized = m_enabled && proc->getCycleCount() == 0;
+    if (m_synchronized) {
+        m_reference.setPC(proc->getPcForStage(0));
+        for (unsigned i = 0; i < RVReferenceModel::s_nRegs; i++) {
+            m_reference.setReg(i, proc->getRegister(i));
+        }
+        checkNextEdge();
+    }
+}
+
+void LockstepChecker::processorWasClocked() {
+    if (m_synchronized && !hasDiverged()) {
+        checkNextEdge();
+    }
+}
+
+void LockstepChecker::processorWasReversed() {
+    m_synchronized = false;
+}
+
+void LockstepChecker::checkNextEdge() {
+    const auto* proc = ProcessorHandler::get()->getProcessor();
+
+    Retirement retirement;
+    std::optional<MemoryCommit> commit;
+    if (!m_commits.nextEdge(*proc, retirement, commit)) {
+        return;
+    }
+
+    if (retirement.pc != m_reference.pc()) {
+        diverge(retirement.pc, "Retired out of program order; expected the instruction at " + hex(m_reference.pc()));
+        return;
+    }
+
+    const auto fx = m_reference.step();
+    m_instructionsChecked++;
+    if (fx.illegal) {
+        diverge(fx.pc, "Retired an instruction which is not part of RV32IMA: " + hex(fx.instr));
+        return;
+    }
+
+    if (fx.ecall) {
+        // System calls may modify any register
+        for (unsigned i = 0; i < RVReferenceModel::s_nRegs; i++) {
+            m_reference.setReg(i, proc->getRegister(i));
+        }
+    }
+
+    if (retirement.regWrite != fx.regWrite) {
+        diverge(fx.pc, fx.regWrite
+                           ? QString("Did not write x%1; expected %2").arg(fx.reg).arg(hex(fx.regValue))
+                           : QString("Unexpectedly wrote %1 to x%2").arg(hex(retirement.regValue)).arg(retirement.reg));
+        return;
+    }
+    if (fx.regWrite && (retirement.reg != fx.reg || retirement.regValue != fx.regValue)) {
+        diverge(fx.pc, QString("Wrote %1 to x%2; expected %3 to x%4")
+                           .arg(hex(retirement.regValue))
+                           .arg(retirement.reg)
+                           .arg(hex(fx.regValue))
+                           .arg(fx.reg));
+        return;
+    }
+
+    if (commit.has_value() != fx.memWrite) {
+        diverge(fx.pc, fx.memWrite ? QString("Did not write memory; expected %1 byte(s) of %2 to %3")
+                                         .arg(fx.size)
+                                         .arg(hex(fx.memValue))
+                                         .arg(hex(fx.address))
+                                   : QString("Unexpectedly wrote %1 byte(s) of %2 to %3")
+                                         .arg(commit->size)
+                                         .arg(hex(commit->value))
+                                         .arg(hex(commit->address)));
+        return;
+    }
+    if (commit && (commit->address != fx.address || commit->size != fx.size || commit->value != fx.memValue)) {
+        diverge(fx.pc, QString("Wrote %1 byte(s) of %2 to %3; expected %4 byte(s) of %5 to %6")
+                           .arg(commit->size)
+                           .arg(hex(commit->value))
+                           .arg(hex(commit->address))
+                           .arg(fx.size)
+                           .arg(hex(fx.memValue))
+                           .arg(hex(fx.address)));
+        return;
+    }
+}
+
+void LockstepChecker::diverge(uint32_t pc, const QString& reason) {
+    const auto* proc = ProcessorHandler::get()->getProcessor();
+    m_divergence = QString("Processor diverged from the reference model in cycle %1, after %2 verified instructions.\n"
+                           "Instruction at %3: %4\n%5")
+                       .arg(proc->getCycleCount())
+                       .arg(m_instructionsChecked)
+                       .arg(hex(pc))
+                       .arg(ProcessorHandler::get()->parseInstrAt(pc))
+                       .arg(reason);
+    emit diverged(m_divergence);
+}
+
+}  // namespace Ripes
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QObject>
+
+#include "committracker.h"
+#include "rvreferencemodel.h"
+
+namespace Ripes {
+
+/**
+ * @brief The LockstepChecker class
+ * Co-simulates the current processor with the functional reference model in lockstep. Whenever an instruction retires,
+ * the reference model executes the same instruction, and the program counter, register write and memory write of the
+ * two are compared. Memory writes are observed when the processor commits them to memory (ie. in the MEM stage of a
+ * pipeline), and compared when the writing instruction retires.
+ * Checking stops at the first divergence, which is reported through diverged(). The reference model reads memory
+ * directly from the processor; given that every memory write of the processor is verified, memory never needs to be
+ * duplicated. System calls are not modelled; when an ecall retires, the reference model adopts the register state of
+ * the processor.
+ * Checking starts from the reset state of the processor, and is suspended when the processor is reversed.
+ */
+class LockstepChecker : public QObject {
+    Q_OBJECT
+
+public:
+    static LockstepChecker* get() {
+        static auto* checker = new LockstepChecker;
+        return checker;
+    }
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief hasDiverged
+     * @returns true if the processor diverged from the reference model since the processor was last reset.
+     */
+    bool hasDiverged() const { return !m_divergence.isNull(); }
+    const QString& divergence() const { return m_divergence; }
+
+    /** @returns the number of retired instructions which were verified since the processor was last reset */
+    uint64_t instructionsChecked() const { return m_instructionsChecked; }
+
+public slots:
+    void processorReset();
+
+signals:
+    /**
+     * @brief diverged
+     * Emitted, possibly from the simulation thread, when the processor diverged from the reference model. @p diagnostic
+     * describes the diverging instruction.
+     */
+    void diverged(const QString& diagnostic);
+
+private:
+    LockstepChecker();
+
+    void processorWasClocked();
+    void processorWasReversed();
+
+    /**
+     * @brief checkNextEdge
+     * Records the memory write and verifies the instruction retirement which the processor performs on its next clock
+     * edge. Loads are executed by the reference model before any younger instruction has written memory.
+     */
+    void checkNextEdge();
+    void diverge(uint32_t pc, const QString& reason);
+
+    bool m_enabled = false;
+    bool m_synchronized = false;
+    QString m_divergence;
+    uint64_t m_instructionsChecked = 0;
+
+    RVReferenceModel m_reference;
+    CommitTracker m_commits;
+};
+
+}  // namespace Ripes
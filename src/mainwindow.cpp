@@ -1,6 +1,8 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
+#include "callprofiler.h"
+#include "ccmanager.h"
 #include "defines.h"
 #include "edittab.h"
 #include "loaddialog.h"
@@ -11,6 +13,7 @@
 #include "registerwidget.h"
 #include "ripessettings.h"
 #include "savedialog.h"
+#include "selfprofiledialog.h"
 #include "settingsdialog.h"
 #include "syscall/syscallviewer.h"
 #include "syscall/systemio.h"
@@ -75,12 +78,15 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), m_ui(new Ui::Main
     connect(m_ui->tabbar, &FancyTabBar::activeIndexChanged, this, &MainWindow::tabChanged);
     connect(m_ui->tabbar, &FancyTabBar::activeIndexChanged, m_stackedTabs, &QStackedWidget::setCurrentIndex);
     connect(m_ui->tabbar, &FancyTabBar::activeIndexChanged, m_editTab, &EditTab::updateProgramViewerHighlighting);
+    connect(m_ui->tabbar, &FancyTabBar::activeIndexChanged, m_editTab, &EditTab::updateSourceLineCycles);
 
     setupMenus();
 
     // setup and connect widgets
     connect(m_processorTab, &ProcessorTab::update, this, &MainWindow::updateMemoryTab);
     connect(m_processorTab, &ProcessorTab::update, m_editTab, &EditTab::updateProgramViewerHighlighting);
+    connect(m_processorTab, &ProcessorTab::update, m_editTab, &EditTab::updateSourceLineCycles);
+    connect(CallProfiler::get(), &CallProfiler::profileChanged, m_editTab, &EditTab::updateSourceLineCycles);
     connect(this, &MainWindow::update, m_processorTab, &ProcessorTab::restart);
     connect(this, &MainWindow::updateMemoryTab, m_memoryTab, &MemoryTab::update);
     connect(m_stackedTabs, &QStackedWidget::currentChanged, m_memoryTab, &MemoryTab::update);
@@ -107,6 +113,10 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), m_ui(new Ui::Main
         SyscallViewer v;
         v.exec();
     });
+    connect(m_ui->actionSelf_profile, &QAction::triggered, [=] {
+        SelfProfileDialog d;
+        d.exec();
+    });
     connect(m_ui->actionOpen_wiki, &QAction::triggered, this, &MainWindow::wiki);
     connect(m_ui->actionVersion, &QAction::triggered, this, &MainWindow::version);
     connect(m_ui->actionSettings, &QAction::triggered, this, &MainWindow::settingsTriggered);
@@ -131,6 +141,9 @@ void MainWindow::setupStatusBar() {
 
     // Setup systemIO status widget
     setupStatusWidget(SystemIO);
+
+    // Setup compiler status widget
+    setupStatusWidget(CC);
 }
 
 void MainWindow::tabChanged(int index) {
@@ -3,9 +3,26 @@
 #include <QBrush>
 #include <QFont>
 
+#include <algorithm>
+
+#include "selfprofiler.h"
+
 namespace Ripes {
 
-MemoryModel::MemoryModel(QObject* parent) : QAbstractTableModel(parent) {}
+MemoryModel::MemoryModel(QObject* parent) : QAbstractTableModel(parent) {
+    connect(ProcessorHandler::get(), &ProcessorHandler::runStarted, this, [=] { m_live = true; });
+    connect(ProcessorHandler::get(), &ProcessorHandler::runFinished, this, [=] {
+        m_live = false;
+        m_liveWords.clear();
+        reload();
+    });
+    connect(ProcessorHandler::get(), &ProcessorHandler::snapshotUpdated, this, &MemoryModel::liveUpdate);
+    ProcessorHandler::get()->addWriteLogSubscriber();
+}
+
+MemoryModel::~MemoryModel() {
+    ProcessorHandler::get()->removeWriteLogSubscriber();
+}
 
 int MemoryModel::columnCount(const QModelIndex&) const {
     return FIXED_COLUMNS_CNT + ProcessorHandler::get()->currentISA()->bytes() /* byte columns */;
@@ -16,9 +33,65 @@ int MemoryModel::rowCount(const QModelIndex&) const {
 }
 
 void MemoryModel::processorWasClocked() {
-    // Reload model
+    RIPES_PROFILE_SCOPE(ModelUpdate);
+    const auto* proc = ProcessorHandler::get()->getProcessor();
+    WriteSet writes;
+    if (!proc->writesSince(m_writeLogPosition, writes)) {
+        reload();
+        return;
+    }
+
+    // Only update the visible rows which cover a modified memory location
+    const long long bytes = ProcessorHandler::get()->currentISA()->bytes();
+    const long long topAddress = topRowAddress();
+    for (const auto& [address, size] : writes.memory) {
+        // Only the part of the write which overlaps the visible rows is visited, given that (bulk) writes may be large
+        long long firstAligned = std::max<long long>(address, topAddress - (m_rowsVisible - 1) * bytes);
+        firstAligned -= firstAligned % bytes;
+        const long long lastAligned =
+            std::min<long long>(static_cast<long long>(address) + std::max(size, 1u) - 1, topAddress);
+        for (long long aligned = firstAligned; aligned <= lastAligned; aligned += bytes) {
+            const long long row = (topAddress - aligned) / bytes;
+            if (row >= 0 && row < m_rowsVisible) {
+                emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+            }
+        }
+    }
+    m_writeLogPosition = proc->writeLogPosition();
+}
+
+void MemoryModel::liveUpdate(const RunSnapshot& snapshot) {
+    const long long bytes = ProcessorHandler::get()->currentISA()->bytes();
+    const long long topAddress = topRowAddress();
+    for (const auto& [address, value] : snapshot.memoryWords) {
+        // The watched range may lag behind the visible rows, if the view was resized while running.
+        const long long row = (topAddress - address) / bytes;
+        if (row < 0 || row >= m_rowsVisible) {
+            continue;
+        }
+        auto it = m_liveWords.find(address);
+        if (it != m_liveWords.end() && it->second == value) {
+            continue;
+        }
+        m_liveWords[address] = value;
+        emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    }
+}
+
+void MemoryModel::reload() {
     beginResetModel();
     endResetModel();
+    m_writeLogPosition = ProcessorHandler::get()->getProcessor()->writeLogPosition();
+
+    // Live snapshots report the words of the visible rows, from the bottom row upwards
+    const long long bytes = ProcessorHandler::get()->currentISA()->bytes();
+    const long long bottomAddress = std::max<long long>(topRowAddress() - (m_rowsVisible - 1) * bytes, 0);
+    ProcessorHandler::get()->setWatchedMemory(static_cast<uint32_t>(bottomAddress), m_rowsVisible);
+}
+
+long long MemoryModel::topRowAddress() const {
+    const auto bytes = ProcessorHandler::get()->currentISA()->bytes();
+    return static_cast<long long>(m_centralAddress) + ((((m_rowsVisible * bytes) / 2) / bytes) * bytes);
 }
 
 bool MemoryModel::validAddress(long long address) const {
@@ -28,14 +101,14 @@ bool MemoryModel::validAddress(long long address) const {
 void MemoryModel::setCentralAddress(uint32_t address) {
     address = address - (address % ProcessorHandler::get()->currentISA()->bytes());
     m_centralAddress = address;
-    processorWasClocked();
+    reload();
 }
 
 void MemoryModel::offsetCentralAddress(int rowOffset) {
     const int byteOffset = rowOffset * ProcessorHandler::get()->currentISA()->bytes();
     const long long newCenterAddress = static_cast<long long>(m_centralAddress) + byteOffset;
     m_centralAddress = !validAddress(newCenterAddress) ? m_centralAddress : newCenterAddress;
-    processorWasClocked();
+    reload();
 }
 
 QVariant MemoryModel::headerData(int section, Qt::Orientation orientation, int role) const {
@@ -54,7 +127,7 @@ QVariant MemoryModel::headerData(int section, Qt::Orientation orientation, int r
 
 void MemoryModel::setRowsVisible(unsigned rows) {
     m_rowsVisible = rows;
-    processorWasClocked();
+    reload();
 }
 
 QVariant MemoryModel::data(const QModelIndex& index, int role) const {
@@ -70,8 +143,7 @@ QVariant MemoryModel::data(const QModelIndex& index, int role) const {
     }
 
     const auto bytes = ProcessorHandler::get()->currentISA()->bytes();
-    const long long alignedAddress = static_cast<long long>(m_centralAddress) +
-                                     ((((m_rowsVisible * bytes) / 2) / bytes) * bytes) - (index.row() * bytes);
+    const long long alignedAddress = topRowAddress() - (index.row() * bytes);
     const unsigned byteOffset = index.column() - FIXED_COLUMNS_CNT;
 
     if (index.column() == Column::Address) {
@@ -110,7 +182,7 @@ QVariant MemoryModel::data(const QModelIndex& index, int role) const {
 
 void MemoryModel::setRadix(Radix r) {
     m_radix = r;
-    processorWasClocked();
+    reload();
 }
 
 QVariant MemoryModel::addrData(long long address) const {
@@ -129,9 +201,19 @@ QVariant MemoryModel::fgColorData(long long address, unsigned byteOffset) const
     }
 }
 
+const uint32_t* MemoryModel::readWord(long long address) const {
+    if (!m_live) {
+        return nullptr;
+    }
+    auto it = m_liveWords.find(static_cast<uint32_t>(address));
+    return it == m_liveWords.end() ? nullptr : &it->second;
+}
+
 QVariant MemoryModel::byteData(long long address, unsigned byteOffset) const {
     if (!validAddress(address)) {
         return "-";
+    } else if (const auto* liveValue = readWord(address)) {
+        return encodeRadixValue((*liveValue >> (byteOffset * 8)) & 0xFF, m_radix, 8);
     } else if (!ProcessorHandler::get()->getMemory().contains(static_cast<unsigned>(address + byteOffset))) {
         // Dont read the memory (this will create an entry in the memory if done so). Instead, create a "fake" entry in
         // the memory model, containing X's.
@@ -146,6 +228,8 @@ QVariant MemoryModel::byteData(long long address, unsigned byteOffset) const {
 QVariant MemoryModel::wordData(long long address) const {
     if (!validAddress(address)) {
         return "-";
+    } else if (const auto* liveValue = readWord(address)) {
+        return encodeRadixValue(*liveValue, m_radix, ProcessorHandler::get()->currentISA()->bits());
     } else if (!ProcessorHandler::get()->getMemory().contains(static_cast<unsigned>(address))) {
         // Dont read the memory (this will create an entry in the memory if done so). Instead, create a "fake" entry in
         // the memory model, containing X's.
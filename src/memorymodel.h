@@ -2,6 +2,8 @@
 
 #include <QAbstractTableModel>
 
+#include <map>
+
 #include "processorhandler.h"
 #include "radix.h"
 
@@ -12,6 +14,7 @@ class MemoryModel : public QAbstractTableModel {
 public:
     enum Column { Address = 0, WordValue = 1, FIXED_COLUMNS_CNT };
     MemoryModel(QObject* parent = nullptr);
+    ~MemoryModel() override;
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
@@ -29,8 +32,14 @@ public slots:
     void setRowsVisible(unsigned rows);
     void offsetCentralAddress(int rowOffset);
     void setCentralAddress(uint32_t address);
+    void liveUpdate(const RunSnapshot& snapshot);
 
 private:
+    void reload();
+    /** @returns the aligned address of the topmost row of the model */
+    long long topRowAddress() const;
+    /** @returns the word at the aligned @p address, or nullptr if unknown (not yet written to) */
+    const uint32_t* readWord(long long address) const;
     bool validAddress(long long address) const;
     QVariant addrData(long long address) const;
     QVariant byteData(long long address, unsigned byteOffset) const;
@@ -39,7 +48,16 @@ private:
 
     Radix m_radix = Radix::Hex;
 
-    long long m_centralAddress = 4;  // Address at the center of the model
-    unsigned m_rowsVisible = 0;      // Number of rows currently visible in the view associated with the model
+    long long m_centralAddress = 4;   // Address at the center of the model
+    unsigned m_rowsVisible = 0;       // Number of rows currently visible in the view associated with the model
+    uint64_t m_writeLogPosition = 0;  // Position of the processor write log at the last update of the model
+
+    /**
+     * @brief m_liveWords
+     * While the processor is running asynchronously, the visible words which the processor has written, as reported
+     * through live snapshots, are displayed in place of the memory contents at the time the run was started.
+     */
+    bool m_live = false;
+    std::map<uint32_t, uint32_t> m_liveWords;
 };
 }  // namespace Ripes
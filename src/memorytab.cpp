@@ -31,6 +31,8 @@ MemoryTab::MemoryTab(QToolBar* toolbar, QWidget* parent) : RipesTab(toolbar, par
     // During processor running, it should not be possible to interact with the memory viewer or cache widgets
     connect(ProcessorHandler::get(), &ProcessorHandler::runStarted, [=] { setEnabled(false); });
     connect(ProcessorHandler::get(), &ProcessorHandler::runFinished, [=] { setEnabled(true); });
+    connect(ProcessorHandler::get(), &ProcessorHandler::animationFrame, [=] { update(); });
+    connect(ProcessorHandler::get(), &ProcessorHandler::programPatched, [=] { update(); });
 }
 
 void MemoryTab::update() {
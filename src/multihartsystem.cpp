@@ -0,0 +1,118 @@
+#include "multihartsystem.h"
+
+#include <climits>
+
+#include "processorregistry.h"
+
+namespace Ripes {
+
+MultiHartSystem::MultiHartSystem(const Program& program, const CoherentCaches::Config& config) : m_caches(config) {
+    for (const auto& section : program.sections) {
+        for (int i = 0; i < section.data.size(); i++) {
+            m_memory[section.address + i] = static_cast<uint8_t>(section.data.at(i));
+        }
+    }
+
+    const auto* isa = ISAInfo<ISA::RV32IMA>::instance();
+    const auto& defaultRegs = ProcessorRegistry::getDescription(ProcessorID::RVSS).defaultRegisterVals;
+    const auto reader = [this](uint32_t address, unsigned size) { return readMemory(address, size); };
+    m_harts.reserve(config.cores);
+    for (unsigned id = 0; id < config.cores; id++) {
+        m_harts.emplace_back(reader);
+        auto& model = m_harts.back().model;
+        model.setPC(program.entryPoint);
+        for (const auto& kv : defaultRegs) {
+            model.setReg(kv.first, kv.second);
+        }
+        model.setReg(isa->spReg(), model.reg(isa->spReg()) - id * s_stackSize);
+        model.setReg(10 /* a0 */, id);
+    }
+}
+
+uint32_t MultiHartSystem::readMemory(uint32_t address, unsigned size) const {
+    uint32_t value = 0;
+    for (unsigned i = 0; i < size; i++) {
+        const auto it = m_memory.find(address + i);
+        if (it != m_memory.end()) {
+            value |= static_cast<uint32_t>(it->second) << (i * CHAR_BIT);
+        }
+    }
+    return value;
+}
+
+void MultiHartSystem::writeMemory(uint32_t address, unsigned size, uint32_t value) {
+    for (unsigned i = 0; i < size; i++) {
+        m_memory[address + i] = static_cast<uint8_t>(value >> (i * CHAR_BIT));
+    }
+}
+
+bool MultiHartSystem::finished() const {
+    for (const auto& hart : m_harts) {
+        if (hart.running) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MultiHartSystem::step() {
+    if (hasError() || finished()) {
+        return false;
+    }
+    for (unsigned id = 0; id < m_harts.size() && !hasError(); id++) {
+        if (m_harts.at(id).running) {
+            execute(id);
+        }
+    }
+    m_steps++;
+    return !hasError();
+}
+
+bool MultiHartSystem::run(uint64_t maxSteps) {
+    for (uint64_t i = 0; i < maxSteps; i++) {
+        if (!step()) {
+            break;
+        }
+    }
+    return !hasError() && finished();
+}
+
+void MultiHartSystem::execute(unsigned id) {
+    auto& hart = m_harts.at(id);
+    const auto fx = hart.model.step();
+    if (fx.illegal) {
+        m_error = QString("Hart %1 executed an illegal instruction (0x%2) at 0x%3")
+                      .arg(id)
+                      .arg(fx.instr, 8, 16, QChar('0'))
+                      .arg(fx.pc, 8, 16, QChar('0'));
+        return;
+    }
+    hart.instructions++;
+
+    if (fx.memRead || fx.memWrite) {
+        m_caches.access(id, fx.address, fx.memWrite);
+    }
+    if (fx.memWrite) {
+        writeMemory(fx.address, fx.size, fx.memValue);
+        for (unsigned other = 0; other < m_harts.size(); other++) {
+            if (other != id) {
+                m_harts.at(other).model.snoopWrite(fx.address);
+            }
+        }
+    }
+
+    if (fx.ecall) {
+        const auto* isa = ISAInfo<ISA::RV32IMA>::instance();
+        const uint32_t syscall = hart.model.reg(isa->syscallReg());
+        if (syscall == ISAInfo<ISA::RV32IMA>::Exit || syscall == ISAInfo<ISA::RV32IMA>::Exit2) {
+            hart.running = false;
+        } else {
+            m_error = QString("Hart %1 performed an unsupported system call (%2) at 0x%3")
+                          .arg(id)
+                          .arg(syscall)
+                          .arg(fx.pc, 8, 16, QChar('0'));
+        }
+    }
+}
+
+}  // namespace Ripes
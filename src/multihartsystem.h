@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QString>
+
+#include <unordered_map>
+#include <vector>
+
+#include "cachesim/coherentcaches.h"
+#include "program.h"
+#include "rvreferencemodel.h"
+
+namespace Ripes {
+
+/**
+ * @brief The MultiHartSystem class
+ * Functional model of a shared-memory multi-core RV32IMA system, for studying how parallel kernels scale with the
+ * number of cores. Each hart (core) is an instance of the functional reference model, and all harts share a single
+ * memory. Every data memory access of a hart is applied to its private L1 cache in a CoherentCaches model, which
+ * accounts for the hits, misses and coherence traffic of the execution.
+ *
+ * Harts are interleaved at instruction granularity, executing one instruction each per step in order of their hart
+ * ID, which yields a sequentially consistent execution. Stores invalidate the LR/SC reservations of other harts.
+ * The harts start at the entry point of the program, with the default register initialization of the processor models.
+ * Given that CSRs are not modelled, the hart ID is passed in a0, and the stack pointer of each hart is offset by
+ * s_stackSize below that of the previous hart. A hart stops when it performs an exit system call; any other system call
+ * is an error.
+ * Timing is not modelled; the processor models remain single-core.
+ */
+class MultiHartSystem {
+public:
+    static constexpr uint32_t s_stackSize = 0x10000;
+
+    MultiHartSystem(const Program& program, const CoherentCaches::Config& config);
+    MultiHartSystem(const MultiHartSystem&) = delete;
+    MultiHartSystem& operator=(const MultiHartSystem&) = delete;
+
+    /**
+     * @brief step
+     * Executes a single instruction on each running hart. @returns false if no hart is running, or an error occurred.
+     */
+    bool step();
+
+    /**
+     * @brief run
+     * Steps until all harts have exited, an error occurs, or @p maxSteps steps were executed. @returns true if all
+     * harts exited.
+     */
+    bool run(uint64_t maxSteps);
+
+    bool finished() const;
+    bool hasError() const { return !m_error.isNull(); }
+    const QString& error() const { return m_error; }
+
+    unsigned harts() const { return m_harts.size(); }
+    const RVReferenceModel& hart(unsigned id) const { return m_harts.at(id).model; }
+    bool isRunning(unsigned id) const { return m_harts.at(id).running; }
+    uint64_t instructionsRetired(unsigned id) const { return m_harts.at(id).instructions; }
+    uint64_t steps() const { return m_steps; }
+
+    const CoherentCaches& caches() const { return m_caches; }
+
+    /** Returns @p size bytes of memory at @p address, little-endian and zero-extended to 32 bits */
+    uint32_t readMemory(uint32_t address, unsigned size) const;
+
+private:
+    struct Hart {
+        explicit Hart(RVReferenceModel::MemoryReader reader) : model(reader) {}
+        RVReferenceModel model;
+        bool running = true;
+        uint64_t instructions = 0;
+    };
+
+    void execute(unsigned id);
+    void writeMemory(uint32_t address, unsigned size, uint32_t value);
+
+    std::vector<Hart> m_harts;
+    CoherentCaches m_caches;
+    std::unordered_map<uint32_t, uint8_t> m_memory;
+    uint64_t m_steps = 0;
+    QString m_error;
+};
+
+}  // namespace Ripes
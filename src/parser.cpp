@@ -1,11 +1,11 @@
 #include "parser.h"
 #include "defines.h"
 
+#include <algorithm>
 #include <cassert>
 #include <functional>
 #include <iostream>
 
-#include <QDataStream>
 #include <QFile>
 
 #include "binutils.h"
@@ -24,85 +24,117 @@ Parser::Parser() {
 
 Parser::~Parser() {}
 
-QString Parser::disassemble(std::weak_ptr<const Program> program, AddrOffsetMap& addrOffsetMap) const {
-    return stringifyProgram(program, 4,
-                            [this, &program](const std::vector<char>& buffer, uint32_t index) {
-                                // Hardcoded for RV32 for now
-                                uint32_t instr = 0;
-                                for (int i = 0; i < 4; i++) {
-                                    instr |= (buffer[i] & 0xFF) << (CHAR_BIT * i);
-                                }
-                                return disassemble(program, instr, index);
-                            },
-                            addrOffsetMap);
+ProgramIndex::ProgramIndex(const Program& program, unsigned stride) : m_stride(stride) {
+    const auto* textSection = program.getSection(TEXT_SECTION_NAME);
+    if (!textSection) {
+        return;
+    }
+
+    m_textStart = textSection->address;
+    m_textSize = textSection->data.length();
+    const int instructions = (m_textSize + m_stride - 1) / m_stride;
+
+    for (auto it = program.symbols.lower_bound(m_textStart);
+         it != program.symbols.end() && it->first < m_textStart + m_textSize; ++it) {
+        if ((it->first - m_textStart) % m_stride != 0) {
+            // Only symbols at instruction boundaries are displayed
+            continue;
+        }
+        const int row = (it->first - m_textStart) / m_stride + m_symbols.size() * s_symbolRows;
+        m_symbols.push_back({it->first, row, it->second});
+    }
+    m_rowCount = instructions + m_symbols.size() * s_symbolRows;
 }
 
-QString Parser::binarize(std::weak_ptr<const Program> program, AddrOffsetMap& addrOffsetMap) const {
-    return stringifyProgram(
-        program, 4,
-        [](const std::vector<char>& buffer, uint32_t) {
-            QString binaryString;
-            for (auto byte : buffer) {
-                binaryString.prepend(QString().setNum(static_cast<uint8_t>(byte), 2).rightJustified(8, '0'));
-            }
-            return binaryString;
-        },
-        addrOffsetMap);
+int ProgramIndex::rowForAddress(unsigned long address) const {
+    if (address < m_textStart || address >= m_textStart + m_textSize) {
+        return -1;
+    }
+
+    // Number of symbols preceding (or at) the address
+    const auto it = std::upper_bound(m_symbols.begin(), m_symbols.end(), address,
+                                     [](unsigned long addr, const Symbol& symbol) { return addr < symbol.address; });
+    const int symbolsBefore = std::distance(m_symbols.begin(), it);
+    return (address - m_textStart) / m_stride + symbolsBefore * s_symbolRows;
 }
 
-namespace {
-void incrementAddressOffsetMap(const QString& text, AddrOffsetMap& map, int& offsets,
-                               const QString& symbol = QString()) {
-    map[text.count('\n')] = {offsets++, symbol};
+long ProgramIndex::addressForRow(int row) const {
+    if (row < 0 || row >= m_rowCount) {
+        return -1;
+    }
+
+    const auto it = std::upper_bound(m_symbols.begin(), m_symbols.end(), row,
+                                     [](int r, const Symbol& symbol) { return r < symbol.row; });
+    if (it == m_symbols.begin()) {
+        // Row precedes the first symbol; address is directly inferred from the row
+        return m_textStart + row * m_stride;
+    }
+
+    const auto& symbol = *std::prev(it);
+    if (row < symbol.row + s_symbolRows) {
+        return -1;
+    }
+    const int symbolsBefore = std::distance(m_symbols.begin(), it);
+    return m_textStart + (row - symbolsBefore * s_symbolRows) * m_stride;
 }
-}  // namespace
 
-QString Parser::stringifyProgram(std::weak_ptr<const Program> program, unsigned stride,
-                                 std::function<QString(const std::vector<char>&, uint32_t index)> stringifier,
-                                 AddrOffsetMap& addrOffsetMap) const {
-    if (auto sp = program.lock()) {
-        const auto* textSection = sp->getSection(TEXT_SECTION_NAME);
-        if (!textSection)
+const ProgramIndex::Symbol* ProgramIndex::symbolForRow(int row) const {
+    const auto it = std::upper_bound(m_symbols.begin(), m_symbols.end(), row,
+                                     [](int r, const Symbol& symbol) { return r < symbol.row; });
+    if (it == m_symbols.begin()) {
+        return nullptr;
+    }
+    const auto& symbol = *std::prev(it);
+    return row < symbol.row + s_symbolRows ? &symbol : nullptr;
+}
+
+QString Parser::stringifyRow(std::weak_ptr<const Program> program, const ProgramIndex& index, int row,
+                             bool binary) const {
+    if (const auto* symbol = index.symbolForRow(row)) {
+        if (row == symbol->row) {
             return QString();
+        }
+        return QString::number(symbol->address, 16).rightJustified(8, '0') + " <" + symbol->name + ">:";
+    }
 
-        QString out;
-        auto dataStream = QDataStream(textSection->data);
-        std::vector<char> buffer;
-        buffer.resize(stride);
-
-        int infoOffsets = 0;
-
-        for (unsigned long addr = textSection->address; addr < textSection->address + textSection->data.length();
-             addr += stride) {
-            dataStream.readRawData(buffer.data(), stride);
-
-            // symbol label
-            if (sp->symbols.count(addr)) {
-                const auto& symbol = sp->symbols.at(addr);
-                // We are adding non-instruction lines to the output string. Record the line number as well as the sum
-                // of invalid lines up to the given point.
-                incrementAddressOffsetMap(out, addrOffsetMap, infoOffsets);
-                out += "\n";
-                incrementAddressOffsetMap(out, addrOffsetMap, infoOffsets, symbol);
-                out += QString::number(addr, 16).rightJustified(8, '0') + " <" + symbol + ">:\n";
-            }
+    const long addr = index.addressForRow(row);
+    auto sp = program.lock();
+    if (addr < 0 || !sp) {
+        return QString();
+    }
 
-            // Instruction address
-            out += "\t" + QString::number(addr, 16) + ":\t\t";
+    const auto* textSection = sp->getSection(TEXT_SECTION_NAME);
+    if (!textSection) {
+        return QString();
+    }
 
-            // Instruction word
-            QString wordString;
-            for (auto byte : buffer) {
-                wordString.prepend(QString().setNum(static_cast<uint8_t>(byte), 16).rightJustified(2, '0'));
-            }
-            out += wordString + "\t\t";
+    // Read the instruction word. A trailing, partial word is zero-padded.
+    const unsigned offset = addr - textSection->address;
+    std::vector<char> buffer(index.stride(), 0);
+    for (unsigned i = 0; i < index.stride() && offset + i < static_cast<unsigned>(textSection->data.length()); i++) {
+        buffer[i] = textSection->data.at(offset + i);
+    }
+
+    QString wordString;
+    for (auto byte : buffer) {
+        wordString.prepend(QString().setNum(static_cast<uint8_t>(byte), 16).rightJustified(2, '0'));
+    }
 
-            // Stringified instruction
-            out += stringifier(buffer, addr) + "\n";
+    QString instrString;
+    if (binary) {
+        for (auto byte : buffer) {
+            instrString.prepend(QString().setNum(static_cast<uint8_t>(byte), 2).rightJustified(8, '0'));
         }
-        return out;
+    } else {
+        // Hardcoded for RV32 for now
+        uint32_t instr = 0;
+        for (int i = 0; i < 4; i++) {
+            instr |= (buffer[i] & 0xFF) << (CHAR_BIT * i);
+        }
+        instrString = disassemble(program, instr, addr);
     }
-    return QString();
+
+    return "\t" + QString::number(addr, 16) + ":\t\t" + wordString + "\t\t" + instrString;
 }
 
 decode_functor Parser::generateWordParser(std::vector<int> bitFields) {
@@ -161,6 +193,8 @@ QString Parser::disassemble(std::weak_ptr<const Program> program, uint32_t instr
                 return generateOpInstrString(instr);
             case instrType::ECALL:
                 return generateEcallString(instr);
+            case instrType::AMO:
+                return generateAmoString(instr);
             default:
                 return QString("Invalid instruction");
         }
@@ -170,6 +204,53 @@ QString Parser::generateEcallString(uint32_t) const {
     return QString("ecall");
 }
 
+QString Parser::generateAmoString(uint32_t instr) const {
+    std::vector<uint32_t> fields = decodeRInstr(instr);
+    if (fields[3] != 0b010) {
+        return QString("Unknown instruction");
+    }
+
+    // funct5 is held in the upper bits of funct7; the aq and rl bits are not disassembled
+    QString name;
+    switch (fields[0] >> 2) {
+        case 0b00010:
+            return QString("lr.w x%1 (x%2)").arg(fields[4]).arg(fields[2]);
+        case 0b00011:
+            name = "sc.w";
+            break;
+        case 0b00001:
+            name = "amoswap.w";
+            break;
+        case 0b00000:
+            name = "amoadd.w";
+            break;
+        case 0b00100:
+            name = "amoxor.w";
+            break;
+        case 0b01100:
+            name = "amoand.w";
+            break;
+        case 0b01000:
+            name = "amoor.w";
+            break;
+        case 0b10000:
+            name = "amomin.w";
+            break;
+        case 0b10100:
+            name = "amomax.w";
+            break;
+        case 0b11000:
+            name = "amominu.w";
+            break;
+        case 0b11100:
+            name = "amomaxu.w";
+            break;
+        default:
+            return QString("Unknown instruction");
+    }
+    return QString("%1 x%2 x%3 (x%4)").arg(name).arg(fields[4]).arg(fields[1]).arg(fields[2]);
+}
+
 QString Parser::generateOpInstrString(uint32_t instr) const {
     std::vector<uint32_t> fields = decodeRInstr(instr);
     switch (fields[3]) {
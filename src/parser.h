@@ -21,16 +21,45 @@ using namespace std;
 typedef std::function<std::vector<uint32_t>(uint32_t)> decode_functor;
 
 /**
- * AddrOffsetMap
- * To preserve accurate mappings between the program viewers disassembled view - which contains additional lines for
- * marking symbols, and the addresses of the current program, we provide the AddrOffsetMap.
- * Keys represent the editor line number of which an additional line was inserted, in addition to lines corresponding to
- * the disassembled program.
- * The value is a pair containing:
- *  first: # of offset lines up to (not including) the given offset
- *  second: An optional QString() referencing the symbol displayed at the offset.
+ * @brief The ProgramIndex class
+ * Maps between the rows of the textual view of a program and the addresses of its text section. In addition to a row
+ * for each instruction, the view contains two rows ahead of each symbol in the text section; an empty separator row and
+ * a row displaying the symbol. The index records the rows of the symbols, such that mapping between rows and
+ * addresses is a binary search over the symbols of the program, rather than a search of the view itself.
  */
-using AddrOffsetMap = std::map<unsigned long, std::pair<int, QString>>;
+class ProgramIndex {
+public:
+    struct Symbol {
+        unsigned long address;
+        /** Row of the separator preceding the symbol; the symbol is displayed at row + 1 */
+        int row;
+        QString name;
+    };
+
+    ProgramIndex() = default;
+    ProgramIndex(const Program& program, unsigned stride);
+
+    int rowCount() const { return m_rowCount; }
+    unsigned stride() const { return m_stride; }
+    const std::vector<Symbol>& symbols() const { return m_symbols; }
+
+    /** @returns the row of the instruction at @p address, or -1 if the address is outside the text section */
+    int rowForAddress(unsigned long address) const;
+    /** @returns the address of the instruction at @p row, or -1 if the row does not contain an instruction */
+    long addressForRow(int row) const;
+    /** @returns the symbol which @p row is a separator or symbol row of, or nullptr if the row is an instruction */
+    const Symbol* symbolForRow(int row) const;
+
+    static constexpr int s_symbolRows = 2;
+
+private:
+    unsigned long m_textStart = 0;
+    unsigned long m_textSize = 0;
+    unsigned m_stride = 4;
+    int m_rowCount = 0;
+    /** Symbols within the text section, sorted by address (and thereby row) */
+    std::vector<Symbol> m_symbols;
+};
 
 class Parser {
 public:
@@ -49,14 +78,15 @@ public:
     std::vector<uint32_t> decodeRInstr(uint32_t instr) const { return m_decodeRInstr(instr); }
     std::vector<uint32_t> decodeBInstr(uint32_t instr) const { return m_decodeBInstr(instr); }
 
-    QString disassemble(std::weak_ptr<const Program> program, AddrOffsetMap& addrOffsetMap) const;
-    QString binarize(std::weak_ptr<const Program> program, AddrOffsetMap& addrOffsetMap) const;
+    /**
+     * @brief stringifyRow
+     * @returns the text of row @p row of the view of @p program described by @p index. Instruction rows are either
+     * disassembled, or, if @p binary is true, shown as raw binary.
+     */
+    QString stringifyRow(std::weak_ptr<const Program> program, const ProgramIndex& index, int row,
+                         bool binary = false) const;
 
 private:
-    QString stringifyProgram(std::weak_ptr<const Program> program, unsigned stride,
-                             std::function<QString(const std::vector<char>& buffer, uint32_t index)> stringifier,
-                             AddrOffsetMap& addrOffsetMap) const;
-
     Parser();
     ~Parser();
 
@@ -80,5 +110,6 @@ private:
     QString generateOpImmString(uint32_t instr) const;
     QString generateOpInstrString(uint32_t instr) const;
     QString generateEcallString(uint32_t instr) const;
+    QString generateAmoString(uint32_t instr) const;
 };
 }  // namespace Ripes
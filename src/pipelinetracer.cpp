@@ -0,0 +1,216 @@
+#include "pipelinetracer.h"
+
+#include <QFileInfo>
+
+#include "processorhandler.h"
+
+namespace Ripes {
+
+namespace {
+inline QString jsonEscaped(QString str) {
+    return str.replace('\\', "\\\\").replace('"', "\\\"");
+}
+}  // namespace
+
+PipelineTracer::PipelineTracer() {
+    connect(ProcessorHandler::get(), &ProcessorHandler::reqProcessorReset, this, &PipelineTracer::processorReset);
+    processorReset();
+}
+
+PipelineTracer::Format PipelineTracer::formatForFile(const QString& filename) {
+    return QFileInfo(filename).suffix().compare("json", Qt::CaseInsensitive) == 0 ? Format::ChromeTrace
+                                                                                   : Format::Kanata;
+}
+
+bool PipelineTracer::start(const QString& filename, Format format) {
+    stop();
+
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        return false;
+    }
+    m_out.setDevice(&m_file);
+    m_format = format;
+    m_cycle = 0;
+    m_nextId = 0;
+    m_nextRetireId = 0;
+
+    const auto* proc = ProcessorHandler::get()->getProcessor();
+    m_stages = std::vector<InFlight>(proc->stageCount());
+    m_stageNames.clear();
+    for (unsigned i = 0; i < proc->stageCount(); i++) {
+        m_stageNames.push_back(proc->stageName(i));
+    }
+
+    writeHeader();
+    // Record the instructions which are already in flight
+    advance(false);
+    return true;
+}
+
+void PipelineTracer::stop() {
+    if (!isTracing()) {
+        return;
+    }
+    writeFooter();
+    m_out.flush();
+    m_out.setDevice(nullptr);
+    m_file.close();
+    emit traceStopped();
+}
+
+void PipelineTracer::processorReset() {
+    // The processor might have changed. As in CacheSim, (re)connect to the VSRTL design update signals.
+    auto* proc = ProcessorHandler::get()->getProcessorNonConst();
+    proc->designWasClocked.Connect(this, &PipelineTracer::processorWasClocked);
+    proc->designWasReversed.Connect(this, &PipelineTracer::processorWasReversed);
+    proc->designWasReset.Connect(this, &PipelineTracer::processorReset);
+
+    if (isTracing()) {
+        if (proc->stageCount() != m_stages.size()) {
+            // A processor with a different pipeline was selected; the trace cannot be continued
+            stop();
+        } else {
+            advance(true);
+        }
+    }
+}
+
+void PipelineTracer::processorWasClocked() {
+    if (isTracing()) {
+        advance(false);
+    }
+}
+
+void PipelineTracer::processorWasReversed() {
+    if (isTracing()) {
+        advance(true);
+    }
+}
+
+void PipelineTracer::advance(bool resync) {
+    const auto* proc = ProcessorHandler::get()->getProcessor();
+    const unsigned lastStage = m_stages.size() - 1;
+
+    m_cycle++;
+    if (m_format == Format::Kanata) {
+        m_out << "C\t1\n";
+    }
+
+    std::vector<InFlight> current(m_stages.size());
+    std::vector<bool> matched(m_stages.size(), resync);
+
+    // Stages are matched from the back of the pipeline, such that instructions which advance a stage take precedence
+    // over the (new) instruction which may occupy the same stage with the same PC.
+    for (int stage = lastStage; stage >= 0; stage--) {
+        const auto info = proc->stageInfo(stage);
+        if (!info.stage_valid || info.state != StageInfo::State::None) {
+            continue;
+        }
+
+        auto& instr = current.at(stage);
+        if (stage > 0 && !matched.at(stage - 1) && m_stages.at(stage - 1).valid &&
+            m_stages.at(stage - 1).pc == info.pc) {
+            // Instruction advanced from the previous stage
+            matched.at(stage - 1) = true;
+            instr = m_stages.at(stage - 1);
+            writeStageLeave(instr, stage - 1);
+            instr.enterCycle = m_cycle;
+            writeStageEnter(instr, stage);
+        } else if (static_cast<unsigned>(stage) != lastStage && !matched.at(stage) && m_stages.at(stage).valid &&
+                   m_stages.at(stage).pc == info.pc) {
+            // Instruction stalled in its current stage. The last stage can never be stalled, given that an instruction
+            // in the last stage is retired upon the following clock cycle.
+            matched.at(stage) = true;
+            instr = m_stages.at(stage);
+        } else {
+            // Newly fetched instruction
+            instr.valid = true;
+            instr.id = m_nextId++;
+            instr.pc = info.pc;
+            instr.enterCycle = m_cycle;
+            instr.disassembly = ProcessorHandler::get()->parseInstrAt(info.pc);
+            writeFetch(instr, stage);
+        }
+    }
+
+    // Unmatched instructions of the previous cycle have either retired or been flushed from the pipeline
+    for (unsigned stage = 0; stage < m_stages.size(); stage++) {
+        const auto& instr = m_stages.at(stage);
+        if (instr.valid && (resync || !matched.at(stage))) {
+            writeStageLeave(instr, stage);
+            writeRetire(instr, resync || stage != lastStage);
+        }
+    }
+
+    m_stages = std::move(current);
+}
+
+void PipelineTracer::writeHeader() {
+    if (m_format == Format::Kanata) {
+        m_out << "Kanata\t0004\n";
+        m_out << "C=\t0\n";
+    } else {
+        m_out << "[\n";
+        m_firstChromeEvent = true;
+        // Name each stage thread, and order the threads by pipeline position
+        for (unsigned stage = 0; stage < m_stageNames.size(); stage++) {
+            m_out << (m_firstChromeEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+                  << stage << ",\"args\":{\"name\":\"" << jsonEscaped(m_stageNames.at(stage)) << "\"}},\n"
+                  << "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":0,\"tid\":" << stage
+                  << ",\"args\":{\"sort_index\":" << stage << "}}";
+            m_firstChromeEvent = false;
+        }
+    }
+}
+
+void PipelineTracer::writeFooter() {
+    if (m_format == Format::ChromeTrace) {
+        // Close the stage events of the instructions which are still in flight
+        for (unsigned stage = 0; stage < m_stages.size(); stage++) {
+            if (m_stages.at(stage).valid) {
+                writeStageLeave(m_stages.at(stage), stage);
+            }
+        }
+        m_out << "\n]\n";
+    }
+    m_stages.clear();
+}
+
+void PipelineTracer::writeFetch(const InFlight& instr, unsigned stage) {
+    if (m_format == Format::Kanata) {
+        m_out << "I\t" << instr.id << "\t" << instr.id << "\t0\n";
+        m_out << "L\t" << instr.id << "\t0\t" << QString::number(instr.pc, 16) << ": " << instr.disassembly << "\n";
+    }
+    writeStageEnter(instr, stage);
+}
+
+void PipelineTracer::writeStageEnter(const InFlight& instr, unsigned stage) {
+    if (m_format == Format::Kanata) {
+        m_out << "S\t" << instr.id << "\t0\t" << m_stageNames.at(stage) << "\n";
+    }
+}
+
+void PipelineTracer::writeStageLeave(const InFlight& instr, unsigned stage) {
+    if (m_format == Format::Kanata) {
+        m_out << "E\t" << instr.id << "\t0\t" << m_stageNames.at(stage) << "\n";
+    } else {
+        m_out << (m_firstChromeEvent ? "" : ",\n") << "{\"name\":\"" << jsonEscaped(instr.disassembly)
+              << "\",\"cat\":\"" << jsonEscaped(m_stageNames.at(stage)) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << stage
+              << ",\"ts\":" << instr.enterCycle << ",\"dur\":" << m_cycle - instr.enterCycle
+              << ",\"args\":{\"id\":" << instr.id << ",\"pc\":\"0x" << QString::number(instr.pc, 16) << "\"}}";
+        m_firstChromeEvent = false;
+    }
+}
+
+void PipelineTracer::writeRetire(const InFlight& instr, bool flushed) {
+    if (m_format == Format::Kanata) {
+        m_out << "R\t" << instr.id << "\t" << (flushed ? instr.id : m_nextRetireId++) << "\t" << (flushed ? 1 : 0)
+              << "\n";
+    } else if (flushed) {
+        m_out << ",\n{\"name\":\"flush\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,\"tid\":0,\"ts\":" << m_cycle
+              << ",\"args\":{\"id\":" << instr.id << ",\"pc\":\"0x" << QString::number(instr.pc, 16) << "\"}}";
+    }
+}
+
+}  // namespace Ripes
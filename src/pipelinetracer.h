@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QFile>
+#include <QObject>
+#include <QTextStream>
+
+#include <vector>
+
+namespace Ripes {
+
+/**
+ * @brief The PipelineTracer class
+ * Streams the lifetime of each instruction flowing through the pipeline of the current processor to a trace file.
+ * The identity of instructions is followed through the pipeline by inspecting the stageInfo() of all stages after each
+ * clock cycle; an instruction is considered retired when it leaves the last stage, and flushed if it disappears from
+ * any other stage. Only the instructions currently in flight are kept in memory.
+ *
+ * Supported formats are the Kanata log format (as read by the Konata pipeline visualizer) and the Chrome trace event
+ * JSON format (chrome://tracing, Perfetto), wherein each stage is a thread and one cycle is one microsecond.
+ *
+ * Traces are monotonic in time; reversing or resetting the processor is recorded as a flush of all in-flight
+ * instructions, after which tracing continues from the new processor state.
+ */
+class PipelineTracer : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Format { Kanata, ChromeTrace };
+
+    static PipelineTracer* get() {
+        static auto* tracer = new PipelineTracer;
+        return tracer;
+    }
+
+    /**
+     * @brief start
+     * Starts tracing to @p filename, truncating any existing file. @returns false if the file could not be opened.
+     */
+    bool start(const QString& filename, Format format);
+    void stop();
+    bool isTracing() const { return m_file.isOpen(); }
+
+    /**
+     * @brief formatForFile
+     * @returns the trace format implied by the extension of @p filename (.json for Chrome traces).
+     */
+    static Format formatForFile(const QString& filename);
+
+signals:
+    void traceStopped();
+
+public slots:
+    void processorReset();
+
+private:
+    PipelineTracer();
+
+    struct InFlight {
+        bool valid = false;
+        uint64_t id;
+        uint32_t pc;
+        /** Trace cycle at which the instruction entered its current stage */
+        uint64_t enterCycle;
+        QString disassembly;
+    };
+
+    void processorWasClocked();
+    void processorWasReversed();
+
+    /**
+     * @brief advance
+     * Matches the instructions currently present in the pipeline against the in-flight instructions of the previous
+     * cycle, and emits trace events for instructions which were fetched, moved between stages, retired or flushed.
+     * If @p resync is set, all in-flight instructions are considered flushed.
+     */
+    void advance(bool resync);
+
+    void writeFetch(const InFlight& instr, unsigned stage);
+    void writeStageEnter(const InFlight& instr, unsigned stage);
+    void writeStageLeave(const InFlight& instr, unsigned stage);
+    void writeRetire(const InFlight& instr, bool flushed);
+    void writeHeader();
+    void writeFooter();
+
+    QFile m_file;
+    QTextStream m_out;
+    Format m_format = Format::Kanata;
+    bool m_firstChromeEvent = true;
+
+    std::vector<InFlight> m_stages;
+    std::vector<QString> m_stageNames;
+    uint64_t m_cycle = 0;
+    uint64_t m_nextId = 0;
+    uint64_t m_nextRetireId = 0;
+};
+
+}  // namespace Ripes
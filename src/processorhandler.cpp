@@ -1,18 +1,33 @@
 #include "processorhandler.h"
 
+#include "lockstepchecker.h"
 #include "parser.h"
 #include "processorregistry.h"
 #include "program.h"
 #include "ripessettings.h"
+#include "selfprofiler.h"
 #include "statusmanager.h"
 
+#include "syscall/linux_syscall.h"
 #include "syscall/riscv_syscall.h"
 
 #include <QMessageBox>
 #include <QtConcurrent/QtConcurrent>
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <thread>
+
 namespace Ripes {
 
+namespace {
+/** Interval between live snapshots whilst running, in milliseconds */
+constexpr int s_snapshotInterval = 33;
+/** Alignment of the initial program break */
+constexpr uint32_t s_programBreakAlignment = 16;
+}  // namespace
+
 ProcessorHandler::ProcessorHandler() {
     // Contruct the default processor
     if (RipesSettings::value(RIPES_SETTING_PROCESSOR_ID).isNull()) {
@@ -31,7 +46,22 @@ ProcessorHandler::ProcessorHandler() {
     // Update VSRTL reverse stack size to reflect current settings
     m_currentProcessor->setReverseStackSize(RipesSettings::value(RIPES_SETTING_REWINDSTACKSIZE).toUInt());
 
-    m_syscallManager = std::make_unique<RISCVSyscallManager>();
+    m_syscallManager = createSyscallManager(m_syscallABI);
+
+    // Whilst running, request a snapshot from the simulation thread at a fixed rate, and forward the latest available
+    // snapshot to the views.
+    m_snapshotTimer.setInterval(s_snapshotInterval);
+    connect(&m_snapshotTimer, &QTimer::timeout, this, [=] {
+        if (m_liveSnapshot.update()) {
+            emit snapshotUpdated(m_liveSnapshot.front());
+        }
+        m_snapshotRequested.store(true, std::memory_order_relaxed);
+    });
+    connect(this, &ProcessorHandler::runFinished, &m_snapshotTimer, &QTimer::stop);
+    connect(this, &ProcessorHandler::runFinished, this, [=] {
+        m_fastRunning = false;
+        updateWriteLogging();
+    });
 }
 
 void ProcessorHandler::loadProgram(std::shared_ptr<Program> p) {
@@ -45,6 +75,15 @@ void ProcessorHandler::loadProgram(std::shared_ptr<Program> p) {
     auto& mem = m_currentProcessor->getMemory();
 
     m_program = p;
+    m_disassemblyCache.clear();
+    if (p->syscallABI != m_syscallABI) {
+        m_syscallABI = p->syscallABI;
+        m_syscallManager = createSyscallManager(m_syscallABI);
+    }
+    // The heap starts at the first aligned address after the program
+    m_initialProgramBreak = (p->endAddress() + s_programBreakAlignment - 1) & ~(s_programBreakAlignment - 1);
+    resetProgramBreak();
+
     // Memory initializations
     mem.clearInitializationMemories();
     for (const auto& seg : p->sections) {
@@ -70,8 +109,129 @@ void ProcessorHandler::loadProgram(std::shared_ptr<Program> p) {
     emit reqProcessorReset();
 }
 
+bool ProcessorHandler::patchProgram(std::shared_ptr<Program> p) {
+    if (m_runWatcher.isRunning() || !m_program || m_program->entryPoint != p->entryPoint ||
+        m_program->sections.size() != p->sections.size()) {
+        return false;
+    }
+
+    // The memory layout of the programs must be identical, and only the text section may differ
+    for (unsigned i = 0; i < p->sections.size(); i++) {
+        const auto& prevSection = m_program->sections.at(i);
+        const auto& section = p->sections.at(i);
+        if (prevSection.name != section.name || prevSection.address != section.address ||
+            prevSection.data.size() != section.data.size()) {
+            return false;
+        }
+        if (section.name != TEXT_SECTION_NAME && prevSection.data != section.data) {
+            return false;
+        }
+    }
+
+    const auto* textSection = p->getSection(TEXT_SECTION_NAME);
+    const auto* prevTextSection = m_program->getSection(TEXT_SECTION_NAME);
+    if (!textSection || !prevTextSection || textSection->data.size() % 4 != 0) {
+        return false;
+    }
+
+    // Every word of the text section which differs from the loaded program is written to memory
+    const char* text = textSection->data.constData();
+    const char* prevText = prevTextSection->data.constData();
+    for (int offset = 0; offset < textSection->data.size(); offset += 4) {
+        if (std::memcmp(text + offset, prevText + offset, 4) != 0) {
+            uint32_t word;
+            std::memcpy(&word, text + offset, sizeof(word));
+            writeMem(textSection->address + offset, word, sizeof(word));
+        }
+    }
+
+    // Memory initializations, such that the patched program persists across processor resets
+    auto& mem = m_currentProcessor->getMemory();
+    mem.clearInitializationMemories();
+    for (const auto& seg : p->sections) {
+        mem.addInitializationMemory(seg.address, seg.data.data(), seg.data.length());
+    }
+
+    m_program = p;
+    m_disassemblyCache.clear();
+    emit programPatched();
+    return true;
+}
+
 void ProcessorHandler::writeMem(uint32_t address, uint32_t value, int size) {
     m_currentProcessor->getMemory().writeMem(address, value, size);
+    m_currentProcessor->noteMemoryWrite(address, size);
+    m_disassemblyCache.invalidate(address, size);
+}
+
+namespace {
+constexpr uint32_t s_wordBytes = sizeof(uint32_t);
+}  // namespace
+
+QByteArray ProcessorHandler::readMemBlock(uint32_t address, uint32_t size) const {
+    const auto& mem = m_currentProcessor->getMemory();
+    QByteArray data(size, '\0');
+    uint32_t i = 0;
+    // Unaligned head and tail bytes are read individually; all other bytes a word at a time
+    for (; i < size && (address + i) % s_wordBytes != 0; i++) {
+        data[i] = static_cast<char>(mem.readMemConst(address + i, 1) & 0xFF);
+    }
+    for (; i + s_wordBytes <= size; i += s_wordBytes) {
+        const uint32_t word = mem.readMemConst(address + i, s_wordBytes);
+        for (uint32_t b = 0; b < s_wordBytes; b++) {
+            data[i + b] = static_cast<char>((word >> (CHAR_BIT * b)) & 0xFF);
+        }
+    }
+    for (; i < size; i++) {
+        data[i] = static_cast<char>(mem.readMemConst(address + i, 1) & 0xFF);
+    }
+    return data;
+}
+
+void ProcessorHandler::writeMemBlock(uint32_t address, const QByteArray& data) {
+    auto& mem = m_currentProcessor->getMemory();
+    const uint32_t size = data.size();
+    const auto byteAt = [&data](uint32_t i) { return static_cast<uint32_t>(static_cast<uint8_t>(data.at(i))); };
+    uint32_t i = 0;
+    for (; i < size && (address + i) % s_wordBytes != 0; i++) {
+        mem.writeMem(address + i, byteAt(i), 1);
+    }
+    for (; i + s_wordBytes <= size; i += s_wordBytes) {
+        uint32_t word = 0;
+        for (uint32_t b = 0; b < s_wordBytes; b++) {
+            word |= byteAt(i + b) << (CHAR_BIT * b);
+        }
+        mem.writeMem(address + i, word, s_wordBytes);
+    }
+    for (; i < size; i++) {
+        mem.writeMem(address + i, byteAt(i), 1);
+    }
+
+    if (size > 0) {
+        m_currentProcessor->noteMemoryWrite(address, size);
+        m_disassemblyCache.invalidate(address, size);
+    }
+}
+
+bool ProcessorHandler::readCString(uint32_t address, QByteArray& string, uint32_t maxLength) const {
+    const auto& mem = m_currentProcessor->getMemory();
+    string.clear();
+    // Addresses are tracked in 64 bits, such that the scan stops at the top of the address space instead of wrapping
+    uint64_t addr = address;
+    const uint64_t end = std::min(static_cast<uint64_t>(address) + maxLength, uint64_t(1) << 32);
+    while (addr < end) {
+        const uint64_t aligned = addr - addr % s_wordBytes;
+        const uint32_t word = mem.readMemConst(static_cast<uint32_t>(aligned), s_wordBytes);
+        // Scan the remaining bytes of the word
+        for (; addr < std::min(aligned + s_wordBytes, end); addr++) {
+            const char byte = static_cast<char>((word >> (CHAR_BIT * (addr - aligned))) & 0xFF);
+            if (byte == '\0') {
+                return true;
+            }
+            string.append(byte);
+        }
+    }
+    return false;
 }
 
 const vsrtl::core::SparseArray& ProcessorHandler::getMemory() const {
@@ -89,19 +249,43 @@ const vsrtl::core::SparseArray& ProcessorHandler::getRegisters() const {
     return m_currentProcessor->getArchRegisters();
 }
 
-void ProcessorHandler::run() {
+void ProcessorHandler::run(unsigned cyclesPerSecond) {
     ProcessorStatusManager::setStatus("Running...");
     emit runStarted();
     /** We create a cycleFunctor for running the design which will stop further running of the design when:
      * - The user has stopped running the processor (m_stopRunningFlag)
      * - the processor has finished executing
      * - the processor has hit a breakpoint
+     * - the processor diverged from the reference model, if lockstep checking is enabled
      */
+    const auto* lockstep = LockstepChecker::get();
     const auto& cycleFunctor = [=] {
         bool stopRunning = m_stopRunningFlag;
         ProcessorHandler::get()->checkValidExecutionRange();
-        stopRunning |=
-            ProcessorHandler::get()->checkBreakpoint() || m_currentProcessor->finished() || m_stopRunningFlag;
+        stopRunning |= ProcessorHandler::get()->checkBreakpoint() || m_currentProcessor->finished() ||
+                       lockstep->hasDiverged() || m_stopRunningFlag;
+
+        if (m_snapshotRequested.load(std::memory_order_relaxed)) {
+            m_snapshotRequested.store(false, std::memory_order_relaxed);
+            if (m_cyclesPerSecond == 0) {
+                publishSnapshot();
+            } else {
+                presentAnimationFrame();
+            }
+        }
+
+        if (m_cyclesPerSecond != 0 && !stopRunning) {
+            // Pace execution to the requested clock rate. Sleep in short slices to remain responsive to stop requests
+            // at low clock rates.
+            m_pacedCycles++;
+            const std::chrono::duration<double> due(static_cast<double>(m_pacedCycles) / m_cyclesPerSecond);
+            const auto deadline = m_paceStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(due);
+            while (!m_stopRunningFlag && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(
+                    std::min<std::chrono::steady_clock::duration>(deadline - std::chrono::steady_clock::now(),
+                                                                  std::chrono::milliseconds(10)));
+            }
+        }
 
         if (stopRunning) {
             m_vsrtlWidget->stop();
@@ -112,9 +296,98 @@ void ProcessorHandler::run() {
     connect(&m_runWatcher, &QFutureWatcher<void>::finished, this, &ProcessorHandler::runFinished);
     connect(&m_runWatcher, &QFutureWatcher<void>::finished, [=] { ProcessorStatusManager::clearStatus(); });
 
+    m_snapshotRequested = false;
+    m_snapshotTimer.start();
+
+    m_cyclesPerSecond = cyclesPerSecond;
+    // Views are updated through snapshots rather than the write log whilst running as fast as possible
+    m_fastRunning = cyclesPerSecond == 0;
+    updateWriteLogging();
+    m_paceStart = std::chrono::steady_clock::now();
+    m_pacedCycles = 0;
+    // Discard any frame acknowledgement left over from a previously stopped run
+    m_frameDone.tryAcquire(m_frameDone.available());
+
     m_runWatcher.setFuture(m_vsrtlWidget->run(cycleFunctor));
 }
 
+void ProcessorHandler::presentAnimationFrame() {
+    // Hand over to the GUI thread, and wait until the frame has been presented. If running is stopped meanwhile, the
+    // GUI thread may be blocked waiting for this thread to finish, and so we must not wait on the frame.
+    QMetaObject::invokeMethod(
+        this,
+        [=] {
+            emit animationFrame();
+            m_frameDone.release();
+        },
+        Qt::QueuedConnection);
+    while (!m_frameDone.tryAcquire(1, 10)) {
+        if (m_stopRunningFlag) {
+            break;
+        }
+    }
+    m_paceStart = std::chrono::steady_clock::now();
+    m_pacedCycles = 0;
+}
+
+void ProcessorHandler::publishSnapshot() {
+    RIPES_PROFILE_SCOPE(Snapshot);
+    auto& snapshot = m_liveSnapshot.back();
+    snapshot.cycleCount = m_currentProcessor->getCycleCount();
+    snapshot.instructionsRetired = m_currentProcessor->getInstructionsRetired();
+
+    snapshot.stages.resize(m_currentProcessor->stageCount());
+    snapshot.stageInstructions.resize(m_currentProcessor->stageCount());
+    for (unsigned i = 0; i < m_currentProcessor->stageCount(); i++) {
+        snapshot.stages[i] = m_currentProcessor->stageInfo(i);
+        snapshot.stageInstructions[i] =
+            snapshot.stages[i].stage_valid ? parseInstrAt(snapshot.stages[i].pc) : QString();
+    }
+
+    snapshot.registers.resize(currentISA()->regCnt());
+    for (unsigned i = 0; i < currentISA()->regCnt(); i++) {
+        snapshot.registers[i] = m_currentProcessor->getRegister(i);
+    }
+
+    const uint64_t watched = m_watchedMemory.load(std::memory_order_relaxed);
+    const auto& mem = m_currentProcessor->getMemory();
+    snapshot.memoryWords.clear();
+    const uint64_t firstAddress = watched >> 32;
+    const uint64_t lastAddress = std::min<uint64_t>(firstAddress + (watched & 0xFFFFFFFF) * currentISA()->bytes(),
+                                                    uint64_t(1) << 32);
+    for (uint64_t address = firstAddress; address < lastAddress; address += currentISA()->bytes()) {
+        // Uninitialized words are not read, given that reading memory initializes them
+        const auto aligned = static_cast<uint32_t>(address);
+        if (mem.contains(aligned)) {
+            snapshot.memoryWords.push_back({aligned, mem.readMemConst(aligned)});
+        }
+    }
+
+    emit takingSnapshot();
+    m_liveSnapshot.publish();
+}
+
+void ProcessorHandler::setWatchedMemory(uint32_t address, unsigned words) {
+    address -= address % currentISA()->bytes();
+    words = std::min(words, s_maxSnapshotMemoryWords);
+    m_watchedMemory.store(static_cast<uint64_t>(address) << 32 | words, std::memory_order_relaxed);
+}
+
+void ProcessorHandler::addWriteLogSubscriber() {
+    m_writeLogSubscribers++;
+    updateWriteLogging();
+}
+
+void ProcessorHandler::removeWriteLogSubscriber() {
+    Q_ASSERT(m_writeLogSubscribers > 0);
+    m_writeLogSubscribers--;
+    updateWriteLogging();
+}
+
+void ProcessorHandler::updateWriteLogging() {
+    m_currentProcessor->setWriteLogging(m_writeLogSubscribers > 0 && !m_fastRunning);
+}
+
 void ProcessorHandler::setBreakpoint(const uint32_t address, bool enabled) {
     if (enabled && isExecutableAddress(address)) {
         m_breakpoints.insert(address);
@@ -147,15 +420,19 @@ void ProcessorHandler::clearBreakpoints() {
 
 void ProcessorHandler::selectProcessor(const ProcessorID& id, RegisterInitialization setup) {
     m_program = nullptr;
+    m_disassemblyCache.clear();
     m_currentID = id;
     RipesSettings::setValue(RIPES_SETTING_PROCESSOR_ID, id);
 
     // Processor initializations
     m_currentProcessor = ProcessorRegistry::constructProcessor(m_currentID);
     m_currentProcessor->isExecutableAddress = [=](uint32_t address) { return isExecutableAddress(address); };
+    updateWriteLogging();
 
     // Syscall handling initialization
     m_currentProcessor->handleSysCall.Connect(this, &ProcessorHandler::asyncTrap);
+    m_currentProcessor->designWasReset.Connect(this, &ProcessorHandler::resetProgramBreak);
+    m_currentProcessor->designWasReversed.Connect(this, &ProcessorHandler::reverseProgramBreak);
 
     // Register initializations
     auto& regs = m_currentProcessor->getArchRegisters();
@@ -201,26 +478,77 @@ unsigned long ProcessorHandler::getTextStart() const {
 
 QString ProcessorHandler::parseInstrAt(const uint32_t addr) const {
     if (m_program) {
-        return Parser::getParser()->disassemble(m_program, m_currentProcessor->getMemory().readMem(addr), addr);
+        const uint32_t word = m_currentProcessor->getMemory().readMem(addr);
+        QString disassembly;
+        if (!m_disassemblyCache.lookup(addr, word, disassembly)) {
+            disassembly = Parser::getParser()->disassemble(m_program, word, addr);
+            m_disassemblyCache.insert(addr, word, disassembly);
+        }
+        return disassembly;
     } else {
         return QString();
     }
 }
 
 void ProcessorHandler::asyncTrap() {
-    auto futureWatcher = QFutureWatcher<bool>();
-    futureWatcher.setFuture(QtConcurrent::run([=] {
-        const unsigned int function = m_currentProcessor->getRegister(currentISA()->syscallReg());
-        return m_syscallManager->execute(function);
-    }));
-
-    futureWatcher.waitForFinished();
-    if (!futureWatcher.result()) {
+    RIPES_PROFILE_SCOPE(Syscall);
+    const unsigned int function = m_currentProcessor->getRegister(currentISA()->syscallReg());
+
+    bool success;
+    if (m_syscallManager->context(function) == SyscallContext::Inline) {
+        // Fast path; the syscall is executed on the trapping thread without any thread handoff
+        success = m_syscallManager->execute(function);
+    } else {
+        auto futureWatcher = QFutureWatcher<bool>();
+        futureWatcher.setFuture(QtConcurrent::run([=] { return m_syscallManager->execute(function); }));
+        futureWatcher.waitForFinished();
+        success = futureWatcher.result();
+    }
+
+    if (!success) {
         // Syscall handling failed, stop running processor
         setStopRunFlag();
     }
 }
 
+std::unique_ptr<SyscallManager> ProcessorHandler::createSyscallManager(SyscallABI abi) {
+    switch (abi) {
+        case SyscallABI::Ripes:
+            return std::make_unique<RISCVSyscallManager>();
+        case SyscallABI::Linux:
+            return std::make_unique<LinuxSyscallManager>();
+    }
+    Q_UNREACHABLE();
+}
+
+void ProcessorHandler::resetProgramBreak() {
+    m_programBreak = m_initialProgramBreak;
+    m_programBreakHistory.clear();
+}
+
+void ProcessorHandler::reverseProgramBreak() {
+    const long long cycle = m_currentProcessor->getCycleCount();
+    while (!m_programBreakHistory.empty() && m_programBreakHistory.back().first >= cycle) {
+        m_programBreak = m_programBreakHistory.back().second;
+        m_programBreakHistory.pop_back();
+    }
+}
+
+bool ProcessorHandler::setProgramBreak(uint32_t address) {
+    const uint32_t sp = getRegisterValue(currentISA()->spReg());
+    if (address < m_initialProgramBreak || address >= sp) {
+        return false;
+    }
+    if (address != m_programBreak) {
+        m_programBreakHistory.push_back({m_currentProcessor->clockingCycle(), m_programBreak});
+        if (m_programBreakHistory.size() > vsrtl::core::ClockedComponent::reverseStackSize()) {
+            m_programBreakHistory.pop_front();
+        }
+    }
+    m_programBreak = address;
+    return true;
+}
+
 void ProcessorHandler::checkProcessorFinished() {
     if (m_currentProcessor->finished())
         emit exit();
@@ -262,6 +590,7 @@ void ProcessorHandler::checkValidExecutionRange() const {
 
 void ProcessorHandler::setRegisterValue(const unsigned idx, uint32_t value) {
     m_currentProcessor->setRegister(idx, value);
+    m_currentProcessor->noteRegisterWrite(idx);
 }
 
 uint32_t ProcessorHandler::getRegisterValue(const unsigned idx) const {
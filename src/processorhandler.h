@@ -3,9 +3,16 @@
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QObject>
+#include <QTimer>
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+
+#include "disassemblycache.h"
 #include "processorregistry.h"
 #include "program.h"
+#include "snapshotbuffer.h"
 #include "syscall/ripes_syscall.h"
 
 #include "vsrtl_widget.h"
@@ -14,6 +21,20 @@ namespace Ripes {
 
 StatusManager(Processor);
 
+/**
+ * @brief The RunSnapshot struct
+ * Copy of the processor state which is displayed while the processor is running asynchronously.
+ */
+struct RunSnapshot {
+    long long cycleCount = 0;
+    long long instructionsRetired = 0;
+    std::vector<StageInfo> stages;
+    std::vector<QString> stageInstructions;
+    std::vector<uint32_t> registers;
+    /** Aligned address and value of the initialized words within the watched memory range */
+    std::vector<std::pair<uint32_t, uint32_t>> memoryWords;
+};
+
 /**
  * @brief The ProcessorHandler class
  * Manages construction and destruction of a VSRTL processor design, when selecting between processors.
@@ -76,9 +97,11 @@ public:
 
     /**
      * @brief parseInstrAt
-     * @return string representation of the instruction at @param addr
+     * @return string representation of the instruction at @param addr. Disassemblies are memoized in the disassembly
+     * cache.
      */
     QString parseInstrAt(const uint32_t address) const;
+    const DisassemblyCache& getDisassemblyCache() const { return m_disassemblyCache; }
 
     /**
      * @brief getMemory & getRegisters
@@ -102,12 +125,39 @@ public:
      */
     void writeMem(uint32_t address, uint32_t value, int size = sizeof(uint32_t));
 
+    /**
+     * @brief readMemBlock/writeMemBlock
+     * Bulk, binary-safe access to a block of simulator memory starting at @p address. Memory is accessed a word at a
+     * time, and a written block is recorded as a single write in the processor write log.
+     */
+    QByteArray readMemBlock(uint32_t address, uint32_t size) const;
+    void writeMemBlock(uint32_t address, const QByteArray& data);
+
+    static constexpr uint32_t s_maxCStringLength = 1 << 16;
+    /**
+     * @brief readCString
+     * Reads the null-terminated string at @p address into @p string, excluding the null terminator. At most
+     * @p maxLength bytes are read, and reading stops at the top of the address space.
+     * @returns false if no null terminator was found within these bounds; @p string then holds the bytes read.
+     */
+    bool readCString(uint32_t address, QByteArray& string, uint32_t maxLength = s_maxCStringLength) const;
+
     /**
      * @brief getRegisterValue
      * @returns value of register @param idx
      */
     uint32_t getRegisterValue(const unsigned idx) const;
 
+    /**
+     * @brief getProgramBreak/setProgramBreak
+     * The program break is the end of the heap of the current program, as managed by the brk system call. It starts at
+     * the end of the loaded program, and is restored to that whenever the processor is reset. Reversing the cycle in
+     * which the break was moved restores the previous break. setProgramBreak returns false, leaving the break
+     * unchanged, if @p address is below the end of the program or not below the stack pointer.
+     */
+    uint32_t getProgramBreak() const { return m_programBreak; }
+    bool setProgramBreak(uint32_t address);
+
     bool checkBreakpoint();
     void setBreakpoint(const uint32_t address, bool enabled);
     void toggleBreakpoint(const uint32_t address);
@@ -120,8 +170,10 @@ public:
      * Asynchronously runs the current processor. During this, the processor will not be emitting signals for updating
      * its graphical representation. Will break upon hitting a breakpoint, going out of bounds wrt. the allowed
      * execution area or if the stop flag has been set through stop().
+     * If @p cyclesPerSecond is non-zero, the processor is run as an animation: execution is paced to the given clock
+     * rate, and the simulation thread is paused at the display rate to emit animationFrame().
      */
-    void run();
+    void run(unsigned cyclesPerSecond = 0);
 
     /**
      * @brief stopRun
@@ -129,6 +181,29 @@ public:
      */
     void stopRun();
 
+    /**
+     * @brief liveSnapshot
+     * @returns the most recent snapshot of the processor state taken while running. Only valid within the scope of
+     * snapshotUpdated().
+     */
+    const RunSnapshot& liveSnapshot() const { return m_liveSnapshot.front(); }
+
+    /**
+     * @brief setWatchedMemory
+     * Sets the range of memory reported in live snapshots, as @p words words from the aligned @p address. The range is
+     * capped at s_maxSnapshotMemoryWords words.
+     */
+    void setWatchedMemory(uint32_t address, unsigned words);
+    static constexpr unsigned s_maxSnapshotMemoryWords = 256;
+
+    /**
+     * @brief addWriteLogSubscriber/removeWriteLogSubscriber
+     * Views which update incrementally through RipesProcessor::writesSince() subscribe to the write log of the
+     * processor. The processor only records its writes while subscribed to, and not while running as fast as possible.
+     */
+    void addWriteLogSubscriber();
+    void removeWriteLogSubscriber();
+
 signals:
     /**
      * @brief reqProcessorReset
@@ -164,25 +239,68 @@ signals:
     void runStarted();
     void runFinished();
 
+    /**
+     * @brief takingSnapshot
+     * Emitted from the simulation thread whilst running, when a live snapshot is taken. Receivers must connect through
+     * Qt::DirectConnection, and shall only publish copies of their own state (ie. through a SnapshotBuffer).
+     */
+    void takingSnapshot();
+
+    /**
+     * @brief snapshotUpdated
+     * Emitted in the GUI thread at a fixed rate whilst running, whenever a new live snapshot is available.
+     */
+    void snapshotUpdated(const RunSnapshot& snapshot);
+
+    /**
+     * @brief animationFrame
+     * Emitted in the GUI thread at the display rate during animated runs. The simulation thread is paused for the
+     * duration of the signal, such that receivers may access the processor as if it was not running.
+     */
+    void animationFrame();
+
+    /**
+     * @brief programPatched
+     * Emitted when the instructions of the currently loaded program were patched in memory through patchProgram().
+     */
+    void programPatched();
+
 public slots:
     void loadProgram(std::shared_ptr<Program> p);
 
+    /**
+     * @brief patchProgram
+     * Replaces the currently loaded program by @p p without resetting the processor. Only applicable if @p p has the
+     * same memory layout as the current program, and differs from it solely in the contents of the text section. The
+     * words of the text section which differ from the current program are written to memory in place.
+     * @returns false if the program could not be patched, in which case it should be loaded through loadProgram().
+     */
+    bool patchProgram(std::shared_ptr<Program> p);
+
 private slots:
     /**
      * @brief asyncTrap
-     * Connects to the processors system call request interface. Will concurrently run the systemcall manager to handle
-     * the requested functionality, and return once the system call was handled.
+     * Connects to the processors system call request interface. Syscalls which neither block nor require the GUI thread
+     * are handled inline; all others are handled by concurrently running the systemcall manager. Returns once the
+     * system call was handled.
      */
     void asyncTrap();
 
 private:
     void setStopRunFlag();
+    void publishSnapshot();
+    void presentAnimationFrame();
+    void resetProgramBreak();
+    void reverseProgramBreak();
+    void updateWriteLogging();
+    static std::unique_ptr<SyscallManager> createSyscallManager(SyscallABI abi);
 
     ProcessorHandler();
 
     ProcessorID m_currentID;
     std::unique_ptr<vsrtl::core::RipesProcessor> m_currentProcessor;
     std::unique_ptr<SyscallManager> m_syscallManager;
+    SyscallABI m_syscallABI = SyscallABI::Ripes;
 
     /**
      * @brief m_vsrtlWidget
@@ -192,10 +310,40 @@ private:
 
     std::set<uint32_t> m_breakpoints;
     std::shared_ptr<Program> m_program;
+    mutable DisassemblyCache m_disassemblyCache;
+    uint32_t m_initialProgramBreak = 0;
+    uint32_t m_programBreak = 0;
+    /** Clocking cycle and previous break of each move of the program break, within the reverse stack of the processor */
+    std::deque<std::pair<long long, uint32_t>> m_programBreakHistory;
 
     QFutureWatcher<void> m_runWatcher;
     bool m_stopRunningFlag = false;
 
+    /**
+     * @brief m_liveSnapshot
+     * Snapshots are taken by the simulation thread whenever m_snapshotRequested has been set by m_snapshotTimer. This
+     * limits the cost of snapshotting to the display rate, independent of the simulation speed. During animated runs,
+     * the request instead presents an animation frame.
+     */
+    SnapshotBuffer<RunSnapshot> m_liveSnapshot;
+    std::atomic<bool> m_snapshotRequested = false;
+    /** Aligned address (upper 32 bits) and number of words (lower 32 bits) of the watched memory range */
+    std::atomic<uint64_t> m_watchedMemory = 0;
+    QTimer m_snapshotTimer;
+
+    /**
+     * @brief m_cyclesPerSecond
+     * Clock rate of the current animated run, or 0 if running as fast as possible. Animated runs are paced against
+     * m_paceStart; the time spent presenting animation frames is excluded from the pacing.
+     */
+    unsigned m_cyclesPerSecond = 0;
+    std::chrono::steady_clock::time_point m_paceStart;
+    unsigned long long m_pacedCycles = 0;
+    QSemaphore m_frameDone;
+
+    unsigned m_writeLogSubscribers = 0;
+    bool m_fastRunning = false;
+
     /**
      * @brief m_sem
      * Semaphore handling locking simulator thread execution whilst trapping to the execution environment.
@@ -23,7 +23,10 @@ Enum(RVInstr, NOP,
      ORI, ANDI, SLLI, SRLI, SRAI, ADD, SUB, SLL, SLT, SLTU, XOR, SRL, SRA, OR, AND, ECALL,
 
      /* RV32M Standard Extension */
-     MUL, MULH, MULHSU, MULHU, DIV, DIVU, REM, REMU);
+     MUL, MULH, MULHSU, MULHU, DIV, DIVU, REM, REMU,
+
+     /* RV32A Standard Extension */
+     LR_W, SC_W, AMOSWAP_W, AMOADD_W, AMOXOR_W, AMOAND_W, AMOOR_W, AMOMIN_W, AMOMAX_W, AMOMINU_W, AMOMAXU_W);
 
 /** Datapath enumerations */
 Enum(ALUOp, NOP, ADD, SUB, MUL, DIV, AND, OR, XOR, SL, SRA, SRL, LUI, LT, LTU, EQ, MULH, MULHU, MULHSU, DIVU, REM,
@@ -32,7 +35,8 @@ Enum(RegWrSrc, MEMREAD, ALURES, PC4);
 Enum(AluSrc1, REG1, PC);
 Enum(AluSrc2, REG2, IMM);
 Enum(CompOp, NOP, EQ, NE, LT, LTU, GE, GEU);
-Enum(MemOp, NOP, LB, LH, LW, LBU, LHU, SB, SH, SW);
+Enum(MemOp, NOP, LB, LH, LW, LBU, LHU, SB, SH, SW, LR, SC, AMOSWAP, AMOADD, AMOXOR, AMOAND, AMOOR, AMOMIN, AMOMAX,
+     AMOMINU, AMOMAXU);
 Enum(ECALL, none, print_int = 1, print_char = 2, print_string = 4, exit = 10);
 Enum(PcSrc, PC4 = 0, ALU = 1);
 
@@ -18,6 +18,7 @@
 #include "../rv_immediate.h"
 #include "../rv_memory.h"
 #include "../rv_registerfile.h"
+#include "../rvprocessor.h"
 
 // Stage separating registers
 #include "rv5s_no_fw_hz_exmem.h"
@@ -29,10 +30,10 @@ namespace vsrtl {
 namespace core {
 using namespace Ripes;
 
-class RV5S_NO_FW_HZ : public RipesProcessor {
+class RV5S_NO_FW_HZ : public RV5StageProcessor<RV5S_NO_FW_HZ> {
 public:
     enum Stage { IF = 0, ID = 1, EX = 2, MEM = 3, WB = 4, STAGECOUNT };
-    RV5S_NO_FW_HZ() : RipesProcessor("5-Stage RISC-V Processor without forwarding or hazard detection") {
+    RV5S_NO_FW_HZ() : RV5StageProcessor("5-Stage RISC-V Processor without forwarding or hazard detection") {
         // -----------------------------------------------------------------------
         // Program counter
         pc_reg->out >> pc_4->op1;
@@ -241,7 +242,7 @@ public:
     SUBCOMPONENT(ecallChecker, EcallChecker);
 
     // Ripes interface compliance
-    virtual const ISAInfoBase* implementsISA() const override { return ISAInfo<ISA::RV32IM>::instance(); }
+    virtual const ISAInfoBase* implementsISA() const override { return ISAInfo<ISA::RV32IMA>::instance(); }
     unsigned int stageCount() const override { return STAGECOUNT; }
     unsigned int getPcForStage(unsigned int idx) const override {
         // clang-format off
@@ -365,16 +366,6 @@ public:
     }
     void setRegister(unsigned i, uint32_t v) override { setSynchronousValue(registerFile->_wr_mem, i, v); }
 
-    void clock() override {
-        // An instruction has been retired if the instruction in the WB stage is valid and the PC is within the
-        // executable range of the program
-        if (memwb_reg->valid_out.uValue() != 0 && isExecutableAddress(memwb_reg->pc_out.uValue())) {
-            m_instructionsRetired++;
-        }
-
-        RipesProcessor::clock();
-    }
-
     void reverse() override {
         if (m_syscallExitCycle != -1 && (m_cycleCount - 1) == m_syscallExitCycle) {
             // We are about to undo an exit syscall instruction. In this case, the syscall exiting sequence should be
@@ -383,7 +374,7 @@ public:
             m_syscallExitCycle = -1;
         }
         RipesProcessor::reverse();
-        if (memwb_reg->valid_out.uValue() != 0 && isExecutableAddress(memwb_reg->pc_out.uValue())) {
+        if (retiringFromWB()) {
             m_instructionsRetired--;
         }
     }
@@ -52,6 +52,17 @@ public:
                 case RVInstr::LW: return MemOp::LW;
                 case RVInstr::LBU: return MemOp::LBU;
                 case RVInstr::LHU: return MemOp::LHU;
+                case RVInstr::LR_W: return MemOp::LR;
+                case RVInstr::SC_W: return MemOp::SC;
+                case RVInstr::AMOSWAP_W: return MemOp::AMOSWAP;
+                case RVInstr::AMOADD_W: return MemOp::AMOADD;
+                case RVInstr::AMOXOR_W: return MemOp::AMOXOR;
+                case RVInstr::AMOAND_W: return MemOp::AMOAND;
+                case RVInstr::AMOOR_W: return MemOp::AMOOR;
+                case RVInstr::AMOMIN_W: return MemOp::AMOMIN;
+                case RVInstr::AMOMAX_W: return MemOp::AMOMAX;
+                case RVInstr::AMOMINU_W: return MemOp::AMOMINU;
+                case RVInstr::AMOMAXU_W: return MemOp::AMOMAXU;
                 default:
                     return MemOp::NOP;
             }
@@ -77,6 +88,11 @@ public:
                 // Load instructions
                 case RVInstr::LB: case RVInstr::LH: case RVInstr::LW: case RVInstr::LBU: case RVInstr::LHU:
 
+                // Atomic instructions
+                case RVInstr::LR_W: case RVInstr::SC_W: case RVInstr::AMOSWAP_W: case RVInstr::AMOADD_W:
+                case RVInstr::AMOXOR_W: case RVInstr::AMOAND_W: case RVInstr::AMOOR_W: case RVInstr::AMOMIN_W:
+                case RVInstr::AMOMAX_W: case RVInstr::AMOMINU_W: case RVInstr::AMOMAXU_W:
+
                 // Jump instructions
                 case RVInstr::JALR:
                 case RVInstr::JAL:
@@ -91,6 +107,12 @@ public:
                 case RVInstr::LB: case RVInstr::LH: case RVInstr::LW: case RVInstr::LBU: case RVInstr::LHU:
                     return RegWrSrc::MEMREAD;
 
+                // Atomic instructions; the memory stage yields the loaded value, or the SC.W result
+                case RVInstr::LR_W: case RVInstr::SC_W: case RVInstr::AMOSWAP_W: case RVInstr::AMOADD_W:
+                case RVInstr::AMOXOR_W: case RVInstr::AMOAND_W: case RVInstr::AMOOR_W: case RVInstr::AMOMIN_W:
+                case RVInstr::AMOMAX_W: case RVInstr::AMOMINU_W: case RVInstr::AMOMAXU_W:
+                    return RegWrSrc::MEMREAD;
+
                 // Jump instructions
                 case RVInstr::JALR:
                 case RVInstr::JAL:
@@ -137,6 +159,12 @@ public:
             case RVInstr::SB: case RVInstr::SH: case RVInstr::SW:
                 return AluSrc2::IMM;
 
+            // Atomic instructions
+            case RVInstr::LR_W: case RVInstr::SC_W: case RVInstr::AMOSWAP_W: case RVInstr::AMOADD_W:
+            case RVInstr::AMOXOR_W: case RVInstr::AMOAND_W: case RVInstr::AMOOR_W: case RVInstr::AMOMIN_W:
+            case RVInstr::AMOMAX_W: case RVInstr::AMOMINU_W: case RVInstr::AMOMAXU_W:
+                return AluSrc2::IMM;
+
             // Branch instructions
             case RVInstr::BEQ: case RVInstr::BNE: case RVInstr::BLT:
             case RVInstr::BGE: case RVInstr::BLTU: case RVInstr::BGEU:
@@ -156,6 +184,9 @@ public:
             switch(opcode.uValue()) {
                 case RVInstr::LB: case RVInstr::LH: case RVInstr::LW: case RVInstr::LBU: case RVInstr::LHU:
                 case RVInstr::SB: case RVInstr::SH: case RVInstr::SW:
+                case RVInstr::LR_W: case RVInstr::SC_W: case RVInstr::AMOSWAP_W: case RVInstr::AMOADD_W:
+                case RVInstr::AMOXOR_W: case RVInstr::AMOAND_W: case RVInstr::AMOOR_W: case RVInstr::AMOMIN_W:
+                case RVInstr::AMOMAX_W: case RVInstr::AMOMINU_W: case RVInstr::AMOMAXU_W:
                     return ALUOp::ADD;
                 case RVInstr::LUI:
                     return ALUOp::LUI;
@@ -206,6 +237,12 @@ public:
             switch(opcode.uValue()) {
                 case RVInstr::SB: case RVInstr::SH: case RVInstr::SW:
                     return 1;
+
+                // Atomic instructions; the memory only commits an SC.W holding a valid reservation
+                case RVInstr::SC_W: case RVInstr::AMOSWAP_W: case RVInstr::AMOADD_W:
+                case RVInstr::AMOXOR_W: case RVInstr::AMOAND_W: case RVInstr::AMOOR_W: case RVInstr::AMOMIN_W:
+                case RVInstr::AMOMAX_W: case RVInstr::AMOMINU_W: case RVInstr::AMOMAXU_W:
+                    return 1;
                 default: return 0;
             }
         };
@@ -214,6 +251,12 @@ public:
             switch(opcode.uValue()) {
                 case RVInstr::LB: case RVInstr::LH: case RVInstr::LW: case RVInstr::LBU: case RVInstr::LHU:
                     return 1;
+
+                // Atomic instructions produce their result in the memory stage, as loads do
+                case RVInstr::LR_W: case RVInstr::SC_W: case RVInstr::AMOSWAP_W: case RVInstr::AMOADD_W:
+                case RVInstr::AMOXOR_W: case RVInstr::AMOAND_W: case RVInstr::AMOOR_W: case RVInstr::AMOMIN_W:
+                case RVInstr::AMOMAX_W: case RVInstr::AMOMINU_W: case RVInstr::AMOMAXU_W:
+                    return 1;
                 default: return 0;
             }
         };
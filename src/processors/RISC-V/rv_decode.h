@@ -113,6 +113,29 @@ public:
                 break;
             }
 
+            case 0b0101111: {
+                // RV32A Standard extension; the aq and rl bits do not affect an in-order, single-hart processor
+                const auto fields = RVInstrParser::getParser()->decodeRInstr(instr.uValue());
+                if (fields[3] != 0b010) {
+                    break;
+                }
+                switch (fields[0] >> 2) {
+                    case 0b00010: return fields[1] == 0 ? RVInstr::LR_W : RVInstr::NOP;
+                    case 0b00011: return RVInstr::SC_W;
+                    case 0b00001: return RVInstr::AMOSWAP_W;
+                    case 0b00000: return RVInstr::AMOADD_W;
+                    case 0b00100: return RVInstr::AMOXOR_W;
+                    case 0b01100: return RVInstr::AMOAND_W;
+                    case 0b01000: return RVInstr::AMOOR_W;
+                    case 0b10000: return RVInstr::AMOMIN_W;
+                    case 0b10100: return RVInstr::AMOMAX_W;
+                    case 0b11000: return RVInstr::AMOMINU_W;
+                    case 0b11100: return RVInstr::AMOMAXU_W;
+                    default: break;
+                }
+                break;
+            }
+
             case 0b1100011: {
                 // Branch instruction
                 const auto fields = RVInstrParser::getParser()->decodeBInstr(instr.uValue());
@@ -55,6 +55,19 @@ public:
                     return static_cast<unsigned>(signextend<int32_t, 12>(((instr.uValue() & 0xfe000000)) >> 20) |
                                                  ((instr.uValue() & 0xf80) >> 7));
                 }
+                case RVInstr::LR_W:
+                case RVInstr::SC_W:
+                case RVInstr::AMOSWAP_W:
+                case RVInstr::AMOADD_W:
+                case RVInstr::AMOXOR_W:
+                case RVInstr::AMOAND_W:
+                case RVInstr::AMOOR_W:
+                case RVInstr::AMOMIN_W:
+                case RVInstr::AMOMAX_W:
+                case RVInstr::AMOMINU_W:
+                case RVInstr::AMOMAXU_W:
+                    // Atomics address memory through rs1 alone
+                    return unsigned(0);
                 default:
                     return unsigned(0xDEADBEEF);
             }
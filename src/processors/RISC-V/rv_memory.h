@@ -1,6 +1,7 @@
 #pragma once
 
 #include "VSRTL/core/vsrtl_memory.h"
+#include "VSRTL/core/vsrtl_register.h"
 #include "VSRTL/core/vsrtl_wire.h"
 #include "riscv.h"
 
@@ -8,14 +9,80 @@ namespace vsrtl {
 namespace core {
 using namespace Ripes;
 
+/**
+ * @brief The RVMemory class
+ * Data memory of the RISC-V processor models. Besides loads and stores, it executes the RV32A atomics: an AMO reads the
+ * old value, which is output, and writes the result of the operation applied to the old value and data_in within the
+ * same cycle. LR.W registers a reservation on its address, which a subsequent SC.W consumes; the SC.W only writes
+ * memory if the reservation is valid for its address, and outputs 0 on success and 1 on failure.
+ */
 template <unsigned int addrWidth, unsigned int dataWidth>
 class RVMemory : public Component {
 public:
     SetGraphicsType(ClockedComponent);
     RVMemory(std::string name, SimComponent* parent) : Component(name, parent) {
         addr >> mem->addr;
-        wr_en >> mem->wr_en;
-        data_in >> mem->data_in;
+
+        mem_wr_en->setSensitiveTo(&wr_en);
+        mem_wr_en->setSensitiveTo(&op);
+        mem_wr_en->setSensitiveTo(&addr);
+        mem_wr_en->setSensitiveTo(&reservation_valid->out);
+        mem_wr_en->setSensitiveTo(&reservation_addr->out);
+        mem_wr_en->out << [=] { return wr_en.uValue() && (op.uValue() != MemOp::SC || scSucceeds()); };
+        mem_wr_en->out >> mem->wr_en;
+
+        mem_data_in->setSensitiveTo(&op);
+        mem_data_in->setSensitiveTo(&data_in);
+        mem_data_in->setSensitiveTo(&mem->data_out);
+        mem_data_in->out << [=] {
+            const uint32_t loaded = mem->data_out.uValue();
+            const uint32_t src = data_in.uValue();
+            switch (op.uValue()) {
+                case MemOp::AMOADD:
+                    return loaded + src;
+                case MemOp::AMOXOR:
+                    return loaded ^ src;
+                case MemOp::AMOAND:
+                    return loaded & src;
+                case MemOp::AMOOR:
+                    return loaded | src;
+                case MemOp::AMOMIN:
+                    return static_cast<int32_t>(loaded) < static_cast<int32_t>(src) ? loaded : src;
+                case MemOp::AMOMAX:
+                    return static_cast<int32_t>(loaded) > static_cast<int32_t>(src) ? loaded : src;
+                case MemOp::AMOMINU:
+                    return loaded < src ? loaded : src;
+                case MemOp::AMOMAXU:
+                    return loaded > src ? loaded : src;
+                default:
+                    // Stores, SC.W and AMOSWAP.W write data_in as is
+                    return src;
+            }
+        };
+        mem_data_in->out >> mem->data_in;
+
+        // LR.W sets the reservation, and SC.W clears it whether or not it succeeds
+        reservation_valid_next->setSensitiveTo(&op);
+        reservation_valid_next->setSensitiveTo(&reservation_valid->out);
+        reservation_valid_next->out << [=] {
+            switch (op.uValue()) {
+                case MemOp::LR:
+                    return 1u;
+                case MemOp::SC:
+                    return 0u;
+                default:
+                    return static_cast<unsigned>(reservation_valid->out.uValue());
+            }
+        };
+        reservation_valid_next->out >> reservation_valid->in;
+
+        reservation_addr_next->setSensitiveTo(&op);
+        reservation_addr_next->setSensitiveTo(&addr);
+        reservation_addr_next->setSensitiveTo(&reservation_addr->out);
+        reservation_addr_next->out << [=] {
+            return op.uValue() == MemOp::LR ? addr.uValue() : reservation_addr->out.uValue();
+        };
+        reservation_addr_next->out >> reservation_addr->in;
 
         wr_width->setSensitiveTo(&op);
         wr_width->out << [=] {
@@ -25,6 +92,16 @@ public:
                 case MemOp::SH:
                     return 2;
                 case MemOp::SW:
+                case MemOp::SC:
+                case MemOp::AMOSWAP:
+                case MemOp::AMOADD:
+                case MemOp::AMOXOR:
+                case MemOp::AMOAND:
+                case MemOp::AMOOR:
+                case MemOp::AMOMIN:
+                case MemOp::AMOMAX:
+                case MemOp::AMOMINU:
+                case MemOp::AMOMAXU:
                     return 4;
                 default:
                     return 0;
@@ -44,6 +121,8 @@ public:
                     return mem->data_out.uValue() & 0xFFFF;
                 case MemOp::LW:
                     return mem->data_out.uValue();
+                case MemOp::SC:
+                    return scSucceeds() ? 0u : 1u;
                 default:
                     return mem->data_out.uValue();
             }
@@ -51,14 +130,25 @@ public:
     }
 
     SUBCOMPONENT(mem, TYPE(MemoryAsyncRd<RV_REG_WIDTH, RV_REG_WIDTH>));
+    SUBCOMPONENT(reservation_valid, Register<1>);
+    SUBCOMPONENT(reservation_addr, Register<addrWidth>);
 
     WIRE(wr_width, ceillog2(RV_REG_WIDTH / 8 + 1));
+    WIRE(mem_wr_en, 1);
+    WIRE(mem_data_in, dataWidth);
+    WIRE(reservation_valid_next, 1);
+    WIRE(reservation_addr_next, addrWidth);
 
     INPUTPORT(addr, addrWidth);
     INPUTPORT(data_in, dataWidth);
     INPUTPORT(wr_en, 1);
     INPUTPORT_ENUM(op, MemOp);
     OUTPUTPORT(data_out, dataWidth);
+
+private:
+    bool scSucceeds() const {
+        return reservation_valid->out.uValue() && reservation_addr->out.uValue() == addr.uValue();
+    }
 };
 
 }  // namespace core
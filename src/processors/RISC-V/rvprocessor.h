@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../ripesprocessor.h"
+#include "riscv.h"
+
+namespace vsrtl {
+namespace core {
+using namespace Ripes;
+
+/**
+ * @brief The RVProcessor class
+ * Common base of the RISC-V processor models. Implements the parts of the RipesProcessor interface which only depend
+ * on the register file and data memory, which all models name registerFile and data_mem.
+ * @tparam Derived: the processor model (CRTP)
+ */
+template <typename Derived>
+class RVProcessor : public RipesProcessor {
+public:
+    RVProcessor(std::string name) : RipesProcessor(name) {}
+
+protected:
+    void pendingWrites(std::vector<StateWrite>& writes) const override {
+        const auto& registerFile = self()->registerFile;
+        const auto& data_mem = self()->data_mem;
+        if (registerFile->wr_en.uValue() && registerFile->wr_addr.uValue() != 0) {
+            writes.push_back({StateWrite::Kind::Register, static_cast<uint32_t>(registerFile->wr_addr.uValue()),
+                              RV_REG_WIDTH / 8});
+        }
+        if (data_mem->mem_wr_en->out.uValue()) {
+            writes.push_back({StateWrite::Kind::Memory, static_cast<uint32_t>(data_mem->addr.uValue()),
+                              static_cast<unsigned>(data_mem->wr_width->out.uValue())});
+        }
+    }
+
+    const Derived* self() const { return static_cast<const Derived*>(this); }
+};
+
+/**
+ * @brief The RV5StageProcessor class
+ * Common base of the five-stage pipelined RISC-V processor models. Instructions retire from the WB stage and write
+ * memory from the MEM stage, through the pipeline registers which all models name memwb_reg and exmem_reg.
+ * @tparam Derived: the processor model (CRTP)
+ */
+template <typename Derived>
+class RV5StageProcessor : public RVProcessor<Derived> {
+public:
+    RV5StageProcessor(std::string name) : RVProcessor<Derived>(name) {}
+
+    bool retiringInstruction(Retirement& retirement) const override {
+        // The instruction in the WB stage retires, unless it is a bubble or outside of the program
+        if (!retiringFromWB()) {
+            return false;
+        }
+        const auto& registerFile = this->self()->registerFile;
+        retirement.pc = this->self()->memwb_reg->pc_out.uValue();
+        retirement.reg = registerFile->wr_addr.uValue();
+        retirement.regWrite = registerFile->wr_en.uValue() && retirement.reg != 0;
+        retirement.regValue = registerFile->data_in.uValue();
+        return true;
+    }
+
+    bool committingMemoryWrite(MemoryCommit& commit) const override {
+        const auto& data_mem = this->self()->data_mem;
+        // An SC.W without a valid reservation does not write memory
+        if (!data_mem->mem_wr_en->out.uValue()) {
+            return false;
+        }
+        commit.pc = this->self()->exmem_reg->pc_out.uValue();
+        commit.address = data_mem->addr.uValue();
+        commit.size = data_mem->wr_width->out.uValue();
+        commit.value = data_mem->mem_data_in->out.uValue() & generateBitmask(commit.size * CHAR_BIT);
+        return true;
+    }
+
+    void clock() override {
+        if (retiringFromWB()) {
+            this->m_instructionsRetired++;
+        }
+
+        RipesProcessor::clock();
+    }
+
+protected:
+    /**
+     * @brief retiringFromWB
+     * @returns true if the instruction in the WB stage is valid and the PC is within the executable range of the
+     * program, ie. it retires on the next clock edge.
+     */
+    bool retiringFromWB() const {
+        const auto& memwb_reg = this->self()->memwb_reg;
+        return memwb_reg->valid_out.uValue() != 0 && this->isExecutableAddress(memwb_reg->pc_out.uValue());
+    }
+};
+
+}  // namespace core
+}  // namespace vsrtl
@@ -17,14 +17,15 @@
 #include "../rv_immediate.h"
 #include "../rv_memory.h"
 #include "../rv_registerfile.h"
+#include "../rvprocessor.h"
 
 namespace vsrtl {
 namespace core {
 using namespace Ripes;
 
-class RVSS : public RipesProcessor {
+class RVSS : public RVProcessor<RVSS> {
 public:
-    RVSS() : RipesProcessor("Single Cycle RISC-V Processor") {
+    RVSS() : RVProcessor("Single Cycle RISC-V Processor") {
         // -----------------------------------------------------------------------
         // Program counter
         pc_reg->out >> pc_4->op1;
@@ -145,7 +146,7 @@ public:
     SUBCOMPONENT(ecallChecker, EcallChecker);
 
     // Ripes interface compliance
-    virtual const ISAInfoBase* implementsISA() const override { return ISAInfo<ISA::RV32IM>::instance(); }
+    virtual const ISAInfoBase* implementsISA() const override { return ISAInfo<ISA::RV32IMA>::instance(); }
     unsigned int stageCount() const override { return 1; }
     unsigned int getPcForStage(unsigned int) const override { return pc_reg->out.uValue(); }
     unsigned int nextFetchedAddress() const override { return pc_src->out.uValue(); }
@@ -174,6 +175,29 @@ public:
 
     void setRegister(unsigned i, uint32_t v) override { setSynchronousValue(registerFile->_wr_mem, i, v); }
 
+    bool retiringInstruction(Retirement& retirement) const override {
+        if (m_finished || !isExecutableAddress(pc_reg->out.uValue())) {
+            return false;
+        }
+        retirement.pc = pc_reg->out.uValue();
+        retirement.reg = registerFile->wr_addr.uValue();
+        retirement.regWrite = registerFile->wr_en.uValue() && retirement.reg != 0;
+        retirement.regValue = registerFile->data_in.uValue();
+        return true;
+    }
+
+    bool committingMemoryWrite(MemoryCommit& commit) const override {
+        // An SC.W without a valid reservation does not write memory
+        if (!data_mem->mem_wr_en->out.uValue()) {
+            return false;
+        }
+        commit.pc = pc_reg->out.uValue();
+        commit.address = data_mem->addr.uValue();
+        commit.size = data_mem->wr_width->out.uValue();
+        commit.value = data_mem->mem_data_in->out.uValue() & generateBitmask(commit.size * CHAR_BIT);
+        return true;
+    }
+
     void clock() override {
         // Single cycle processor; 1 instruction retired per cycle!
         m_instructionsRetired++;
@@ -2,11 +2,17 @@
 
 #include <QString>
 
+#include <atomic>
+#include <climits>
+#include <deque>
 #include <map>
+#include <set>
+#include <vector>
 #include "Signals/Signal.h"
 #include "VSRTL/core/vsrtl_design.h"
 
 #include "../isainfo.h"
+#include "../selfprofiler.h"
 
 namespace Ripes {
 
@@ -32,6 +38,51 @@ struct FinalizeReason {
     bool any() const { return exitedExecutableRegion || exitSyscall; }
 };
 
+/**
+ * @brief The StateWrite struct
+ * A register or memory location which is modified by the processor. @p address is the register index for register
+ * writes, and the byte address for memory writes. Unknown writes indicate that any state may have been modified.
+ */
+struct StateWrite {
+    enum class Kind { Register, Memory, Unknown };
+    Kind kind;
+    uint32_t address = 0;
+    unsigned size = 0;
+};
+
+/**
+ * @brief The WriteSet struct
+ * The registers and memory locations which were modified within some interval of processor updates.
+ */
+struct WriteSet {
+    std::set<unsigned> registers;
+    /** Byte address and size of each modified memory location */
+    std::vector<std::pair<uint32_t, unsigned>> memory;
+};
+
+/**
+ * @brief The Retirement struct
+ * An instruction which retires on the next clock edge, and the register which it writes upon retiring.
+ */
+struct Retirement {
+    uint32_t pc = 0;
+    bool regWrite = false;
+    unsigned reg = 0;
+    uint32_t regValue = 0;
+};
+
+/**
+ * @brief The MemoryCommit struct
+ * A memory write performed on the next clock edge by the instruction at @p pc. In pipelined processors, memory is
+ * written before the writing instruction retires.
+ */
+struct MemoryCommit {
+    uint32_t pc = 0;
+    uint32_t address = 0;
+    unsigned size = 0;
+    uint32_t value = 0;
+};
+
 }  // namespace Ripes
 
 namespace vsrtl {
@@ -40,7 +91,7 @@ using namespace Ripes;
 
 class RipesProcessor : public Design {
 public:
-    RipesProcessor(std::string name) : Design(name) {}
+    RipesProcessor(std::string name) : Design(name), m_writeLogValidFrom(s_writeSeq + 1) {}
 
     /**
      * @brief implementsISA
@@ -124,11 +175,110 @@ public:
      */
     virtual void setPCInitialValue(uint32_t address) = 0;
 
+    void clock() override {
+        s_writeSeq++;
+        m_clockingCycle = getCycleCount();
+        if (m_writeLogging.load(std::memory_order_relaxed)) {
+            m_pendingWrites.clear();
+            pendingWrites(m_pendingWrites);
+            for (const auto& write : m_pendingWrites) {
+                logWrite(write, true);
+            }
+        } else {
+            // Positions preceding this cycle, and reversing this cycle, are no longer covered by the logs
+            m_writeLogValidFrom = s_writeSeq + 1;
+            m_undoLogValidFrom = m_clockingCycle + 1;
+        }
+        // Writes performed by the environment during the clock (ie. by system calls) are attributed to this cycle
+        m_inClock = true;
+        {
+            RIPES_PROFILE_SCOPE(Clock);
+            Design::clock();
+        }
+        m_inClock = false;
+    }
+
+    void reverse() override {
+        s_writeSeq++;
+        const long long undoneCycle = getCycleCount() - 1;
+        if (undoneCycle < m_undoLogValidFrom) {
+            logWrite({StateWrite::Kind::Unknown}, false);
+        } else {
+            while (!m_undoLog.empty() && m_undoLog.back().cycle == undoneCycle) {
+                logWrite(m_undoLog.back().write, false);
+                m_undoLog.pop_back();
+            }
+        }
+        Design::reverse();
+    }
+
     void reset() override {
         Design::reset();
         m_instructionsRetired = 0;
+        m_writeLog.clear();
+        m_writeLogValidFrom = ++s_writeSeq + 1;
+        m_undoLog.clear();
+        m_undoLogValidFrom = 0;
     }
 
+    /**
+     * @brief setWriteLogging
+     * Enables recording the registers and memory locations written in each clocked cycle. While disabled, the write
+     * and undo logs are invalidated upon each clock rather than recorded, and writesSince() thereby reports that all
+     * state may have been modified. Disabled by default, given that only incrementally updated views consume the logs.
+     * May be called while the processor is clocked on another thread.
+     */
+    void setWriteLogging(bool enabled) { m_writeLogging.store(enabled, std::memory_order_relaxed); }
+
+    /**
+     * @brief clockingCycle
+     * @returns the cycle which is being clocked, or was most recently clocked. Modifications made by the environment
+     * during a clock (ie. by system calls) are undone when reversing this cycle.
+     */
+    long long clockingCycle() const { return m_clockingCycle; }
+
+    /**
+     * @brief writeLogPosition
+     * @returns the current position of the write log. Passing this value to writesSince() at a later point will yield
+     * the state modified in between.
+     */
+    uint64_t writeLogPosition() const { return s_writeSeq; }
+
+    /**
+     * @brief writesSince
+     * Accumulates into @p ws the registers and memory locations which were modified by clocking or reversing the
+     * processor since the write log was at @p position. Memory writes are accumulated in order of most recent first.
+     * @returns false if the write log does not fully cover @p position (ie. the processor was reset, or too many cycles
+     * passed), in which case the caller must assume that all state has been modified. @p ws will still contain the
+     * most recent writes which the log does cover.
+     */
+    bool writesSince(uint64_t position, WriteSet& ws) const {
+        if (position > s_writeSeq) {
+            return false;
+        }
+        for (auto it = m_writeLog.rbegin(); it != m_writeLog.rend() && it->seq > position; it++) {
+            switch (it->write.kind) {
+                case StateWrite::Kind::Register:
+                    ws.registers.insert(it->write.address);
+                    break;
+                case StateWrite::Kind::Memory:
+                    ws.memory.push_back({it->write.address, it->write.size});
+                    break;
+                case StateWrite::Kind::Unknown:
+                    return false;
+            }
+        }
+        return position + 1 >= m_writeLogValidFrom;
+    }
+
+    /**
+     * @brief noteRegisterWrite/noteMemoryWrite
+     * Called by the environment when modifying the state of the processor outside of the processor datapath (ie.
+     * system calls or user edits), to have the modification reflected in the write log.
+     */
+    void noteRegisterWrite(unsigned i) { noteWrite({StateWrite::Kind::Register, i, 0}); }
+    void noteMemoryWrite(uint32_t address, unsigned size) { noteWrite({StateWrite::Kind::Memory, address, size}); }
+
     /**
      * @brief isExecutableAddress
      * Callback registerred by the environment instantiating the processor. The environment shall return whether the @p
@@ -161,6 +311,20 @@ public:
      */
     virtual bool finished() const = 0;
 
+    /**
+     * @brief retiringInstruction
+     * @returns true if an instruction retires on the next clock edge, given the current state of the processor, in
+     * which case @p retirement describes the instruction.
+     */
+    virtual bool retiringInstruction(Retirement& retirement) const = 0;
+
+    /**
+     * @brief committingMemoryWrite
+     * @returns true if memory is written on the next clock edge, given the current state of the processor, in which
+     * case @p commit describes the write.
+     */
+    virtual bool committingMemoryWrite(MemoryCommit& commit) const = 0;
+
     /**
      * @brief getInstructionsRetired
      * @returns the number of instructions which has retired (ie. executed and no longer in the pipeline).
@@ -168,8 +332,69 @@ public:
     long long getInstructionsRetired() const { return m_instructionsRetired; }
 
 protected:
+    /**
+     * @brief pendingWrites
+     * Appends to @p writes the registers and memory locations which the datapath will write upon the next clock edge,
+     * given the current state of the processor.
+     */
+    virtual void pendingWrites(std::vector<StateWrite>& writes) const = 0;
+
     // Statistics
     long long m_instructionsRetired = 0;
+
+private:
+    void noteWrite(const StateWrite& write) {
+        if (!m_inClock) {
+            s_writeSeq++;
+        }
+        if (!m_writeLogging.load(std::memory_order_relaxed)) {
+            m_writeLogValidFrom = s_writeSeq + 1;
+            return;
+        }
+        logWrite(write, m_inClock);
+    }
+
+    void logWrite(const StateWrite& write, bool undoable) {
+        m_writeLog.push_back({s_writeSeq, write});
+        if (m_writeLog.size() > s_maxWriteLogSize) {
+            m_writeLogValidFrom = m_writeLog.front().seq + 1;
+            m_writeLog.pop_front();
+        }
+        if (undoable) {
+            m_undoLog.push_back({m_clockingCycle, write});
+            if (m_undoLog.size() > s_maxWriteLogSize) {
+                m_undoLogValidFrom = m_undoLog.front().cycle + 1;
+                m_undoLog.pop_front();
+            }
+        }
+    }
+
+    struct WriteLogEntry {
+        uint64_t seq;
+        StateWrite write;
+    };
+    struct UndoLogEntry {
+        long long cycle;
+        StateWrite write;
+    };
+
+    static constexpr size_t s_maxWriteLogSize = 4096;
+    /**
+     * Shared between processor instances, such that log positions of a replaced processor are never valid. Atomic, given
+     * that processors may be clocked on other threads than the one creating new processor instances.
+     */
+    static inline std::atomic<uint64_t> s_writeSeq = 0;
+
+    std::deque<WriteLogEntry> m_writeLog;
+    uint64_t m_writeLogValidFrom;
+    /** Writes of each clocked cycle, replayed into the write log when the cycle is reversed */
+    std::deque<UndoLogEntry> m_undoLog;
+    long long m_undoLogValidFrom = 0;
+
+    std::vector<StateWrite> m_pendingWrites;
+    long long m_clockingCycle = 0;
+    bool m_inClock = false;
+    std::atomic<bool> m_writeLogging = false;
 };
 
 }  // namespace core
@@ -2,14 +2,19 @@
 #include "ui_processortab.h"
 
 #include <QDir>
+#include <QFileDialog>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QScrollBar>
 #include <QSpinBox>
 #include <QTemporaryFile>
 
+#include "callprofiler.h"
+#include "commitlogger.h"
 #include "instructionmodel.h"
+#include "lockstepchecker.h"
 #include "parser.h"
+#include "pipelinetracer.h"
 #include "processorhandler.h"
 #include "processorregistry.h"
 #include "processorselectiondialog.h"
@@ -93,10 +98,11 @@ ProcessorTab::ProcessorTab(QToolBar* controlToolbar, QToolBar* additionalToolbar
 
     setupSimulatorActions(controlToolbar);
 
-    // Setup statistics update timer
-    m_statUpdateTimer = new QTimer(this);
-    m_statUpdateTimer->setInterval(100);
-    connect(m_statUpdateTimer, &QTimer::timeout, this, &ProcessorTab::updateStatistics);
+    // Whilst running, statistics and stage instructions are updated from the live snapshots of the processor. During
+    // animated runs, all views are updated upon each animation frame.
+    connect(ProcessorHandler::get(), &ProcessorHandler::snapshotUpdated, this, &ProcessorTab::liveUpdate);
+    connect(ProcessorHandler::get(), &ProcessorHandler::animationFrame, this, &ProcessorTab::update);
+    connect(ProcessorHandler::get(), &ProcessorHandler::programPatched, this, &ProcessorTab::update);
 
     connect(m_ui->clearConsoleButton, &QPushButton::clicked, m_ui->console, &Console::clearConsole);
     m_ui->clearConsoleButton->setIcon(QIcon(":/icons/clear.svg"));
@@ -223,6 +229,23 @@ void ProcessorTab::setupSimulatorActions(QToolBar* controlToolbar) {
     connect(m_runAction, &QAction::toggled, this, &ProcessorTab::run);
     controlToolbar->addAction(m_runAction);
 
+    m_animatedRunAction = new QAction(runIcon, "Animated run (F7)", this);
+    m_animatedRunAction->setShortcut(QKeySequence("F7"));
+    m_animatedRunAction->setCheckable(true);
+    m_animatedRunAction->setChecked(false);
+    m_animatedRunAction->setToolTip(
+        "Execute simulator at the selected clock rate, redrawing the UI at the display rate (F7).\n Running will stop "
+        "once the program exits or a breakpoint is hit.");
+    connect(m_animatedRunAction, &QAction::toggled, this, &ProcessorTab::animatedRun);
+    controlToolbar->addAction(m_animatedRunAction);
+
+    m_animatedRunRate = new QSpinBox(this);
+    m_animatedRunRate->setRange(1, 100000000);
+    m_animatedRunRate->setSuffix(" Hz");
+    m_animatedRunRate->setToolTip("Animated run clock rate");
+    m_animatedRunRate->setValue(1000);
+    controlToolbar->addWidget(m_animatedRunRate);
+
     // Setup processor-tab only actions
     const QIcon tagIcon = QIcon(":/icons/tag.svg");
     m_displayValuesAction = new QAction(tagIcon, "Display signal values", this);
@@ -235,15 +258,86 @@ void ProcessorTab::setupSimulatorActions(QToolBar* controlToolbar) {
     m_stageTableAction = new QAction(tableIcon, "Show stage table", this);
     connect(m_stageTableAction, &QAction::triggered, this, &ProcessorTab::showStageTable);
     m_toolbar->addAction(m_stageTableAction);
+
+    const QIcon profileIcon = QIcon(":/icons/graph.svg");
+    m_profileAction = new QAction(profileIcon, "Profile function calls", this);
+    m_profileAction->setCheckable(true);
+    m_profileAction->setChecked(false);
+    m_profileAction->setToolTip(
+        "Profile function calls.\nCycles and retired instructions are attributed to functions of the program, starting "
+        "from the current cycle.");
+    connect(m_profileAction, &QAction::toggled, [=](bool checked) {
+        CallProfiler::get()->setEnabled(checked);
+        m_exportProfileAction->setEnabled(checked);
+    });
+    m_toolbar->addAction(m_profileAction);
+
+    const QIcon exportProfileIcon = QIcon(":/icons/saveas.svg");
+    m_exportProfileAction = new QAction(exportProfileIcon, "Export call profile", this);
+    m_exportProfileAction->setToolTip("Export the function call profile in the callgrind format");
+    m_exportProfileAction->setEnabled(false);
+    connect(m_exportProfileAction, &QAction::triggered, this, &ProcessorTab::exportCallProfile);
+    m_toolbar->addAction(m_exportProfileAction);
+
+    const QIcon pipelineTraceIcon = QIcon(":/icons/documents.svg");
+    m_pipelineTraceAction = new QAction(pipelineTraceIcon, "Record pipeline trace", this);
+    m_pipelineTraceAction->setCheckable(true);
+    m_pipelineTraceAction->setChecked(false);
+    m_pipelineTraceAction->setToolTip(
+        "Record the lifetime of each instruction in the pipeline to a file.\nTraces may be recorded in the Kanata "
+        "(Konata) or Chrome trace event (.json) formats.");
+    connect(m_pipelineTraceAction, &QAction::toggled, this, &ProcessorTab::togglePipelineTrace);
+    connect(PipelineTracer::get(), &PipelineTracer::traceStopped, [=] {
+        QSignalBlocker blocker(m_pipelineTraceAction);
+        m_pipelineTraceAction->setChecked(false);
+    });
+    m_toolbar->addAction(m_pipelineTraceAction);
+
+    const QIcon commitLogIcon = QIcon(":/icons/notepad.svg");
+    m_commitLogAction = new QAction(commitLogIcon, "Log retired instructions", this);
+    m_commitLogAction->setCheckable(true);
+    m_commitLogAction->setChecked(false);
+    m_commitLogAction->setToolTip(
+        "Log each retired instruction, and the register and memory location it writes, to a file.\nThe log follows the "
+        "format of Spike's --log-commits, for comparing executions with other simulators.");
+    connect(m_commitLogAction, &QAction::toggled, this, &ProcessorTab::toggleCommitLog);
+    connect(CommitLogger::get(), &CommitLogger::logStopped, [=] {
+        QSignalBlocker blocker(m_commitLogAction);
+        m_commitLogAction->setChecked(false);
+    });
+    m_toolbar->addAction(m_commitLogAction);
+
+    const QIcon lockstepIcon = QIcon(":/icons/crosshair.svg");
+    m_lockstepAction = new QAction(lockstepIcon, "Lockstep checking", this);
+    m_lockstepAction->setCheckable(true);
+    m_lockstepAction->setChecked(false);
+    m_lockstepAction->setToolTip(
+        "Verify each retired instruction against a functional reference model of the ISA.\nExecution stops at the first "
+        "divergence. Checking starts when the processor is reset.");
+    connect(m_lockstepAction, &QAction::toggled, [=](bool checked) { LockstepChecker::get()->setEnabled(checked); });
+    // Divergences may be detected in the simulation thread; the connection is queued to this (GUI) thread.
+    connect(LockstepChecker::get(), &LockstepChecker::diverged, this,
+            [=](const QString& diagnostic) { QMessageBox::warning(this, "Lockstep divergence", diagnostic); });
+    m_toolbar->addAction(m_lockstepAction);
 }
 
 void ProcessorTab::updateStatistics() {
+    showStatistics(ProcessorHandler::get()->getProcessor()->getCycleCount(),
+                   ProcessorHandler::get()->getProcessor()->getInstructionsRetired());
+}
+
+void ProcessorTab::liveUpdate(const RunSnapshot& snapshot) {
+    showStatistics(snapshot.cycleCount, snapshot.instructionsRetired);
+    for (unsigned i = 0; i < snapshot.stages.size(); i++) {
+        setStageInstructionLabel(i, snapshot.stages.at(i), snapshot.stageInstructions.at(i));
+    }
+}
+
+void ProcessorTab::showStatistics(long long cycleCount, long long instrsRetired) {
     static auto lastUpdateTime = std::chrono::system_clock::now();
-    static long long lastCycleCount = ProcessorHandler::get()->getProcessor()->getCycleCount();
+    static long long lastCycleCount = cycleCount;
 
     const auto timeNow = std::chrono::system_clock::now();
-    const auto cycleCount = ProcessorHandler::get()->getProcessor()->getCycleCount();
-    const auto instrsRetired = ProcessorHandler::get()->getProcessor()->getInstructionsRetired();
     const auto timeDiff =
         std::chrono::duration_cast<std::chrono::milliseconds>(timeNow - lastUpdateTime).count() / 1000.0;  // in seconds
     const auto cycleDiff = cycleCount - lastCycleCount;
@@ -275,6 +369,7 @@ void ProcessorTab::updateStatistics() {
 void ProcessorTab::pause() {
     m_autoClockAction->setChecked(false);
     m_runAction->setChecked(false);
+    m_animatedRunAction->setChecked(false);
     m_reverseAction->setEnabled(m_vsrtlWidget->isReversible());
 }
 
@@ -365,6 +460,9 @@ void ProcessorTab::restart() {
 }
 
 ProcessorTab::~ProcessorTab() {
+    // Ensure that any trace or log being recorded is flushed to disk
+    PipelineTracer::get()->stop();
+    CommitLogger::get()->stop();
     delete m_ui;
 }
 
@@ -375,12 +473,15 @@ void ProcessorTab::processorFinished() {
     m_autoClockAction->setEnabled(false);
     m_runAction->setEnabled(false);
     m_runAction->setChecked(false);
+    m_animatedRunAction->setEnabled(false);
+    m_animatedRunAction->setChecked(false);
 }
 
 void ProcessorTab::enableSimulatorControls() {
     m_clockAction->setEnabled(true);
     m_autoClockAction->setEnabled(true);
     m_runAction->setEnabled(true);
+    m_animatedRunAction->setEnabled(true);
     m_reverseAction->setEnabled(m_vsrtlWidget->isReversible());
     m_resetAction->setEnabled(true);
     m_stageTableAction->setEnabled(!m_hasRun);
@@ -389,22 +490,27 @@ void ProcessorTab::enableSimulatorControls() {
 void ProcessorTab::updateInstructionLabels() {
     const auto& proc = ProcessorHandler::get()->getProcessor();
     for (unsigned i = 0; i < proc->stageCount(); i++) {
-        if (!m_stageInstructionLabels.count(i))
-            continue;
         const auto stageInfo = proc->stageInfo(i);
-        auto* instrLabel = m_stageInstructionLabels.at(i);
-        QString instrString;
-        if (stageInfo.state != StageInfo::State::None) {
-            instrString = stageInfo.state == StageInfo::State::Flushed ? "nop (flush)" : "nop (stall)";
-            instrLabel->setDefaultTextColor(Qt::red);
-        } else if (stageInfo.stage_valid) {
-            instrString = ProcessorHandler::get()->parseInstrAt(stageInfo.pc);
-            instrLabel->setDefaultTextColor(QColor());
-        }
-        instrLabel->setText(instrString);
+        setStageInstructionLabel(
+            i, stageInfo, stageInfo.stage_valid ? ProcessorHandler::get()->parseInstrAt(stageInfo.pc) : QString());
     }
 }
 
+void ProcessorTab::setStageInstructionLabel(unsigned stage, const StageInfo& stageInfo, const QString& instruction) {
+    if (!m_stageInstructionLabels.count(stage))
+        return;
+    auto* instrLabel = m_stageInstructionLabels.at(stage);
+    QString instrString;
+    if (stageInfo.state != StageInfo::State::None) {
+        instrString = stageInfo.state == StageInfo::State::Flushed ? "nop (flush)" : "nop (stall)";
+        instrLabel->setDefaultTextColor(Qt::red);
+    } else if (stageInfo.stage_valid) {
+        instrString = instruction;
+        instrLabel->setDefaultTextColor(QColor());
+    }
+    instrLabel->setText(instrString);
+}
+
 void ProcessorTab::reset() {
     m_hasRun = false;
     m_autoClockAction->setChecked(false);
@@ -437,25 +543,34 @@ void ProcessorTab::setInstructionViewCenterAddr(uint32_t address) {
 void ProcessorTab::runFinished() {
     pause();
     ProcessorHandler::get()->checkProcessorFinished();
-    m_statUpdateTimer->stop();
     emit update();
 }
 
 void ProcessorTab::run(bool state) {
+    setRunning(state, 0);
+}
+
+void ProcessorTab::animatedRun(bool state) {
+    setRunning(state, m_animatedRunRate->value());
+}
+
+void ProcessorTab::setRunning(bool state, unsigned cyclesPerSecond) {
     m_hasRun = true;
     // Stop any currently exeuting auto-clocking
     if (m_autoClockAction->isChecked()) {
         m_autoClockAction->setChecked(false);
     }
     if (state) {
-        ProcessorHandler::get()->run();
-        m_statUpdateTimer->start();
+        ProcessorHandler::get()->run(cyclesPerSecond);
     } else {
         ProcessorHandler::get()->stopRun();
-        m_statUpdateTimer->stop();
     }
 
-    // Enable/Disable all actions based on whether the processor is running.
+    // Enable/Disable all actions based on whether the processor is running. Only the action which started the run may
+    // be used to stop it.
+    m_runAction->setEnabled(!state || cyclesPerSecond == 0);
+    m_animatedRunAction->setEnabled(!state || cyclesPerSecond != 0);
+    m_animatedRunRate->setEnabled(!state);
     m_selectProcessorAction->setEnabled(!state);
     m_clockAction->setEnabled(!state);
     m_autoClockAction->setEnabled(!state);
@@ -463,10 +578,15 @@ void ProcessorTab::run(bool state) {
     m_resetAction->setEnabled(!state);
     m_displayValuesAction->setEnabled(!state);
     m_stageTableAction->setEnabled(false);
-
-    // Disable widgets which are not updated when running the processor
+    m_profileAction->setEnabled(!state);
+    m_exportProfileAction->setEnabled(!state && m_profileAction->isChecked());
+    m_pipelineTraceAction->setEnabled(!state);
+    m_commitLogAction->setEnabled(!state);
+    m_lockstepAction->setEnabled(!state);
+
+    // Disable widgets which are not updated when running the processor. The register view is kept live (and read-only)
+    // through snapshots of the running processor.
     m_vsrtlWidget->setEnabled(!state);
-    m_ui->registerWidget->setEnabled(!state);
     m_ui->instructionView->setEnabled(!state);
 }
 
@@ -492,4 +612,57 @@ void ProcessorTab::showStageTable() {
     auto w = StageTableWidget(m_stageModel);
     w.exec();
 }
+
+void ProcessorTab::exportCallProfile() {
+    const QString filename = QFileDialog::getSaveFileName(this, "Export call profile", "callgrind.out.ripes",
+                                                          "Callgrind files (callgrind.out.*);;All files (*)");
+    if (filename.isEmpty())
+        return;
+
+    if (!CallProfiler::get()->exportCallgrind(filename)) {
+        QMessageBox::warning(this, "Error", "Could not write call profile to " + filename);
+    }
+}
+
+void ProcessorTab::togglePipelineTrace(bool enabled) {
+    if (!enabled) {
+        PipelineTracer::get()->stop();
+        return;
+    }
+
+    const QString filename = QFileDialog::getSaveFileName(this, "Record pipeline trace", "pipeline.log",
+                                                          "Kanata log (*.log);;Chrome trace event (*.json)");
+    bool started = false;
+    if (!filename.isEmpty()) {
+        started = PipelineTracer::get()->start(filename, PipelineTracer::formatForFile(filename));
+        if (!started) {
+            QMessageBox::warning(this, "Error", "Could not open " + filename + " for writing");
+        }
+    }
+    if (!started) {
+        QSignalBlocker blocker(m_pipelineTraceAction);
+        m_pipelineTraceAction->setChecked(false);
+    }
+}
+
+void ProcessorTab::toggleCommitLog(bool enabled) {
+    if (!enabled) {
+        CommitLogger::get()->stop();
+        return;
+    }
+
+    const QString filename =
+        QFileDialog::getSaveFileName(this, "Log retired instructions", "commits.log", "Commit log (*.log)");
+    bool started = false;
+    if (!filename.isEmpty()) {
+        started = CommitLogger::get()->start(filename);
+        if (!started) {
+            QMessageBox::warning(this, "Error", "Could not open " + filename + " for writing");
+        }
+    }
+    if (!started) {
+        QSignalBlocker blocker(m_commitLogAction);
+        m_commitLogAction->setChecked(false);
+    }
+}
 }  // namespace Ripes
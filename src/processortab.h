@@ -24,6 +24,8 @@ class InstructionModel;
 class RegisterModel;
 class StageTableModel;
 struct Layout;
+struct RunSnapshot;
+struct StageInfo;
 
 class ProcessorTab : public RipesTab {
     friend class RunDialog;
@@ -49,15 +51,20 @@ public slots:
     void runFinished();
     void updateStatistics();
     void updateInstructionLabels();
+    void liveUpdate(const RunSnapshot& snapshot);
     void fitToView();
 
     void processorSelection();
 
 private slots:
     void run(bool state);
+    void animatedRun(bool state);
     void clock();
     void setInstructionViewCenterAddr(uint32_t address);
     void showStageTable();
+    void exportCallProfile();
+    void togglePipelineTrace(bool enabled);
+    void toggleCommitLog(bool enabled);
 
 private:
     void setupSimulatorActions(QToolBar* controlToolbar);
@@ -66,6 +73,9 @@ private:
     void updateRegisterModel();
     void loadLayout(const Layout&);
     void loadProcessorToWidget(const Layout&);
+    void setRunning(bool state, unsigned cyclesPerSecond);
+    void showStatistics(long long cycleCount, long long instrsRetired);
+    void setStageInstructionLabel(unsigned stage, const StageInfo& stageInfo, const QString& instruction);
 
     Ui::ProcessorTab* m_ui = nullptr;
     InstructionModel* m_instrModel = nullptr;
@@ -75,19 +85,24 @@ private:
 
     std::map<unsigned, vsrtl::Label*> m_stageInstructionLabels;
 
-    QTimer* m_statUpdateTimer;
-
     // Actions
     QAction* m_selectProcessorAction = nullptr;
     QAction* m_clockAction = nullptr;
     QAction* m_autoClockAction = nullptr;
     QAction* m_runAction = nullptr;
+    QAction* m_animatedRunAction = nullptr;
     QAction* m_displayValuesAction = nullptr;
     QAction* m_stageTableAction = nullptr;
+    QAction* m_profileAction = nullptr;
+    QAction* m_exportProfileAction = nullptr;
+    QAction* m_pipelineTraceAction = nullptr;
+    QAction* m_commitLogAction = nullptr;
+    QAction* m_lockstepAction = nullptr;
     QAction* m_reverseAction = nullptr;
     QAction* m_resetAction = nullptr;
 
     QSpinBox* m_autoClockInterval = nullptr;
+    QSpinBox* m_animatedRunRate = nullptr;
 
     /**
      * @brief m_hasRun
@@ -3,8 +3,11 @@
 #include <QByteArray>
 #include <QMap>
 #include <QString>
+#include <algorithm>
 #include <vector>
 
+#include "debuglineinfo.h"
+
 namespace Ripes {
 
 enum class SourceType {
@@ -20,6 +23,17 @@ enum class SourceType {
     InternalELF
 };
 
+/**
+ * @brief The SyscallABI enum
+ * System call numbering which a program is compiled against.
+ */
+enum class SyscallABI {
+    /** RARS-style system calls (PrintInt, Exit, ...), as used by assembly programs and the bundled examples */
+    Ripes,
+    /** RISC-V Linux system call numbering, as used by newlib executables compiled with a stock toolchain */
+    Linux
+};
+
 #define TEXT_SECTION_NAME ".text"
 
 struct LoadFileParams {
@@ -27,6 +41,7 @@ struct LoadFileParams {
     SourceType type;
     unsigned long binaryEntryPoint;
     unsigned long binaryLoadAt;
+    SyscallABI syscallABI = SyscallABI::Ripes;
 };
 
 struct ProgramSection {
@@ -44,6 +59,21 @@ struct Program {
     unsigned long entryPoint = 0;
     std::vector<ProgramSection> sections;
     std::map<unsigned long, QString> symbols;
+    /** Address to source line mapping; only available for executables containing DWARF line information */
+    DebugLineInfo lineInfo;
+    SyscallABI syscallABI = SyscallABI::Ripes;
+
+    /**
+     * @brief endAddress
+     * @returns the first address after the highest addressed section of the program
+     */
+    unsigned long endAddress() const {
+        unsigned long end = 0;
+        for (const auto& section : sections) {
+            end = std::max(end, section.address + section.data.size());
+        }
+        return end;
+    }
 
     const ProgramSection* getSection(const QString& name) const {
         const auto secIter =
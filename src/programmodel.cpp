@@ -0,0 +1,38 @@
+#include "programmodel.h"
+
+namespace Ripes {
+
+ProgramModel::ProgramModel(QObject* parent) : QAbstractListModel(parent) {}
+
+int ProgramModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_index.rowCount();
+}
+
+Qt::ItemFlags ProgramModel::flags(const QModelIndex& index) const {
+    return index.isValid() ? Qt::ItemIsEnabled | Qt::ItemIsSelectable : Qt::NoItemFlags;
+}
+
+QVariant ProgramModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    return Parser::getParser()->stringifyRow(m_program, m_index, index.row(), m_binary);
+}
+
+void ProgramModel::setProgram(std::weak_ptr<const Program> program, unsigned stride, bool binary) {
+    beginResetModel();
+    m_program = program;
+    m_binary = binary;
+    if (auto sp = program.lock()) {
+        m_index = ProgramIndex(*sp, stride);
+    } else {
+        m_index = ProgramIndex();
+    }
+    endResetModel();
+}
+
+void ProgramModel::clear() {
+    setProgram({}, m_index.stride(), m_binary);
+}
+
+}  // namespace Ripes
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QAbstractListModel>
+
+#include <memory>
+
+#include "parser.h"
+#include "program.h"
+
+namespace Ripes {
+
+/**
+ * @brief The ProgramModel class
+ * Row model of the textual view of a program. Rows are stringified on demand whenever they are requested by a view,
+ * such that only the visible part of a program is ever disassembled.
+ */
+class ProgramModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    ProgramModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    /**
+     * @brief setProgram
+     * Indexes @p program and resets the model. If @p binary is true, instructions are displayed as raw binary in place
+     * of their disassembly.
+     */
+    void setProgram(std::weak_ptr<const Program> program, unsigned stride, bool binary);
+    void clear();
+
+    const ProgramIndex& programIndex() const { return m_index; }
+
+private:
+    std::weak_ptr<const Program> m_program;
+    ProgramIndex m_index;
+    bool m_binary = false;
+};
+
+}  // namespace Ripes
@@ -8,26 +8,34 @@
 #include <QEvent>
 #include <QFontMetricsF>
 #include <QMenu>
-#include <QTextBlock>
+#include <QPainter>
+#include <QTextOption>
+
+#include <algorithm>
 
 namespace Ripes {
 
-ProgramViewer::ProgramViewer(QWidget* parent) : QPlainTextEdit(parent) {
+ProgramViewer::ProgramViewer(QWidget* parent) : QListView(parent) {
     m_breakpointArea = new BreakpointArea(this);
+    m_model = new ProgramModel(this);
+    setModel(m_model);
+    setItemDelegate(new ProgramViewerDelegate(this));
 
-    connect(this, &QPlainTextEdit::blockCountChanged, this, &ProgramViewer::updateSidebarWidth);
-    connect(this, &QPlainTextEdit::updateRequest, this, &ProgramViewer::updateSidebar);
-    updateSidebarWidth(0);
+    // All rows share the same height, which allows the view to lay out rows without querying each of them
+    setUniformItemSizes(true);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, m_breakpointArea, QOverload<>::of(&QWidget::update));
+    m_sidebarWidth = m_breakpointArea->width();
+    setViewportMargins(m_sidebarWidth, 0, 0, 0);
 
     // Set font for the entire widget. calls to fontMetrics() will get the
     // dimensions of the currently set font
     m_font = QFont("Inconsolata", 11);
     setFont(m_font);
     m_fontTimer.setSingleShot(true);
-
-    setTabStopDistance(QFontMetricsF(m_font).width(' ') * 4);
-
-    setLineWrapMode(QPlainTextEdit::NoWrap);
 }
 
 void ProgramViewer::clearBreakpoints() {
@@ -35,7 +43,7 @@ void ProgramViewer::clearBreakpoints() {
 }
 
 void ProgramViewer::resizeEvent(QResizeEvent* e) {
-    QPlainTextEdit::resizeEvent(e);
+    QListView::resizeEvent(e);
 
     const QRect cr = contentsRect();
     m_breakpointArea->setGeometry(cr.left(), cr.top(), m_breakpointArea->width(), cr.height());
@@ -46,37 +54,25 @@ void ProgramViewer::resizeEvent(QResizeEvent* e) {
 }
 
 void ProgramViewer::updateProgram(bool binary) {
-    m_labelAddrOffsetMap.clear();
-    const QString text =
-        binary ? Parser::getParser()->binarize(ProcessorHandler::get()->getProgram(), m_labelAddrOffsetMap)
-               : Parser::getParser()->disassemble(ProcessorHandler::get()->getProgram(), m_labelAddrOffsetMap);
-
-    // A memory occurs within QPlainTextEdit::clear if extra selections has been set. This is most possibly a bug,
-    // but seems to be fixed if we manually clear the selections before we clear (and add new text) to the text
-    // edit.
-    setExtraSelections({});
-
-    setPlainText(text);
+    m_model->setProgram(ProcessorHandler::get()->getProgram(), ProcessorHandler::get()->currentISA()->bytes(), binary);
     updateHighlightedAddresses();
+    m_breakpointArea->update();
 }
 
-void ProgramViewer::updateSidebar(const QRect& rect, int dy) {
-    m_breakpointArea->update(0, rect.y(), m_breakpointArea->width(), rect.height());
-
-    if (rect.contains(viewport()->rect()))
-        updateSidebarWidth(0);
-}
-
-void ProgramViewer::updateSidebarWidth(int /* newBlockCount */) {
-    // Set margins of the text edit area
-    m_sidebarWidth = m_breakpointArea->width();
-    setViewportMargins(m_sidebarWidth, 0, 0, 0);
+void ProgramViewer::clear() {
+    m_model->clear();
+    m_highlightedRows.clear();
+    m_breakpointArea->update();
 }
 
 void ProgramViewer::setCenterAddress(const long address) {
-    auto block = blockForAddress(address);
-    setTextCursor(QTextCursor(block));
-    ensureCursorVisible();
+    const int row = programIndex().rowForAddress(address);
+    if (row < 0) {
+        return;
+    }
+    const auto index = m_model->index(row);
+    setCurrentIndex(index);
+    scrollTo(index, QAbstractItemView::EnsureVisible);
 }
 
 void ProgramViewer::updateCenterAddressFromProcessor() {
@@ -97,70 +93,37 @@ void ProgramViewer::updateHighlightedAddresses() {
     const unsigned stages = ProcessorHandler::get()->getProcessor()->stageCount();
     QColor bg = QColor(Qt::red).lighter(120);
     const int decRatio = 100 + 80 / stages;
-    QList<QTextEdit::ExtraSelection> highlights;
-    std::set<unsigned long> highlightedPCs;
-    m_highlightedBlocksText.clear();
+    m_highlightedRows.clear();
 
     for (unsigned sid = 0; sid < stages; sid++) {
         const auto stageInfo = ProcessorHandler::get()->getProcessor()->stageInfo(sid);
         if (stageInfo.stage_valid) {
-            auto block = blockForAddress(stageInfo.pc);
-            if (!block.isValid())
+            const int row = programIndex().rowForAddress(stageInfo.pc);
+            if (row < 0)
                 continue;
 
-            // Record the stage name for the highlighted block for later painting
-            m_highlightedBlocksText[block] << ProcessorHandler::get()->getProcessor()->stageName(sid);
-
             // If a stage has already been highlighted (ie. an instruction exists in more than 1 stage at once), keep
             // the already set highlighting.
-            if (highlightedPCs.count(stageInfo.pc)) {
-                continue;
+            auto& highlight = m_highlightedRows[row];
+            if (highlight.stageNames.isEmpty()) {
+                highlight.color = bg;
             }
-
-            QTextEdit::ExtraSelection es;
-            es.cursor = QTextCursor(block);
-            es.format.setProperty(QTextFormat::FullWidthSelection, true);
-
-            const auto bbr = blockBoundingRect(block);
-            QLinearGradient grad(bbr.topLeft(), bbr.bottomRight());
-            grad.setColorAt(0, palette().base().color());
-            grad.setColorAt(1, bg);
-            es.format.setBackground(grad);
-
-            highlights << es;
-            highlightedPCs.insert(stageInfo.pc);
+            // Record the stage name for the highlighted row for later painting
+            highlight.stageNames << ProcessorHandler::get()->getProcessor()->stageName(sid);
         }
         bg = bg.lighter(decRatio);
     }
-    setExtraSelections(highlights);
+    viewport()->update();
 
     if (m_following) {
         updateCenterAddressFromProcessor();
     }
 }
 
-void ProgramViewer::paintEvent(QPaintEvent* event) {
-    QPlainTextEdit::paintEvent(event);
-
-    // Draw stage names for highlighted addresses
-    QPainter painter(viewport());
-
-    for (const auto& hb : m_highlightedBlocksText) {
-        const QString stageString = hb.second.join('/');
-        const auto bbr = blockBoundingGeometry(hb.first);
-        painter.setFont(font());
-        painter.drawText(bbr.width() - painter.fontMetrics().boundingRect(stageString).width() - /*padding*/ 10,
-                         bbr.top() + bbr.height(), stageString);
-    }
-    painter.end();
-}
-
 void ProgramViewer::breakpointAreaPaintEvent(QPaintEvent* event) {
     QPainter painter(m_breakpointArea);
 
-    // When caret flashes in QPlainTextEdit a paint event is sent to this widget,
-    // with a height of a line in the edit. We override this paint event by always
-    // redrawing the visible breakpoint area
+    // Always redraw the visible breakpoint area
     auto area = m_breakpointArea->rect();
     QLinearGradient gradient = QLinearGradient(area.topLeft(), area.bottomRight());
     gradient.setColorAt(0, QColor(Colors::FoundersRock).lighter(120));
@@ -168,134 +131,28 @@ void ProgramViewer::breakpointAreaPaintEvent(QPaintEvent* event) {
 
     painter.fillRect(area, gradient);
 
-    QTextBlock block = firstVisibleBlock();
-    int top = static_cast<int>(blockBoundingGeometry(block).translated(contentOffset()).top());
-    int bottom = top + static_cast<int>(blockBoundingRect(block).height());
-
-    while (block.isValid() && top <= event->rect().bottom()) {
-        if (block.isVisible() && bottom >= event->rect().top()) {
-            const long address = addressForBlock(block);
-            if (address >= 0) {
-                if (ProcessorHandler::get()->hasBreakpoint(address)) {
-                    painter.drawPixmap(m_breakpointArea->padding, top, m_breakpointArea->imageWidth,
-                                       m_breakpointArea->imageHeight, m_breakpointArea->m_breakpoint);
-                }
-            }
+    // Only the visible rows are visited
+    for (QModelIndex index = indexAt(QPoint(0, event->rect().top())); index.isValid();
+         index = m_model->index(index.row() + 1)) {
+        const QRect rowRect = visualRect(index);
+        if (rowRect.top() > event->rect().bottom()) {
+            break;
         }
-
-        block = block.next();
-        top = bottom;
-        bottom = top + static_cast<int>(blockBoundingRect(block).height());
-    }
-}
-
-namespace {}
-
-QTextBlock ProgramViewer::blockForAddress(unsigned long addr) const {
-    const long adjustedLineNumber =
-        (addr - ProcessorHandler::get()->getTextStart()) / ProcessorHandler::get()->currentISA()->bytes();
-
-    if (m_labelAddrOffsetMap.empty()) {
-        return document()->findBlockByNumber(adjustedLineNumber);
-    }
-
-    long lineNumber = adjustedLineNumber;
-    auto low = m_labelAddrOffsetMap.lower_bound(lineNumber);
-
-    if (lineNumber < low->first && (low == m_labelAddrOffsetMap.begin())) {
-        // The line number is less that the position of the first offset block; block is directly inferred from
-        // linenumber.
-        return document()->findBlockByNumber(adjustedLineNumber);
-    }
-
-    auto high = low;
-    if (low != m_labelAddrOffsetMap.begin()) {
-        low = std::prev(m_labelAddrOffsetMap.lower_bound(lineNumber));
-    }
-    high = std::next(low);
-
-    auto validBlockRange = [this, adjustedLineNumber](auto& low, auto& high, long lineNumber) {
-        if (m_labelAddrOffsetMap.count(lineNumber))
-            return false;
-
-        bool valid = true;
-        valid &= (low->first - low->second.first) <= adjustedLineNumber;
-        if (high != m_labelAddrOffsetMap.end()) {
-            valid &= adjustedLineNumber < (high->first - high->second.first);
+        const long address = programIndex().addressForRow(index.row());
+        if (address >= 0 && ProcessorHandler::get()->hasBreakpoint(address)) {
+            painter.drawPixmap(m_breakpointArea->padding, rowRect.top(), m_breakpointArea->imageWidth,
+                               m_breakpointArea->imageHeight, m_breakpointArea->m_breakpoint);
         }
-        return valid;
-    };
-
-    // Adjust low and high iterators to locate the range bounds of the address
-    while (!validBlockRange(low, high, lineNumber)) {
-        low = m_labelAddrOffsetMap.lower_bound(lineNumber);
-        high = std::next(low);
-        lineNumber = low->first + 1;
-    }
-
-    const int offsetSum = high == m_labelAddrOffsetMap.end() ? low->second.first + 1 : high->second.first;
-    lineNumber = offsetSum + adjustedLineNumber;
-
-    return document()->findBlockByNumber(lineNumber);
-}
-
-long ProgramViewer::addressForBlock(QTextBlock block) const {
-    const static auto calcAddressFunc = [](int lineNumber) {
-        return lineNumber * ProcessorHandler::get()->currentISA()->bytes() + ProcessorHandler::get()->getTextStart();
-    };
-
-    const int lineNumber = block.blockNumber();
-
-    // Clicking an invalid line? (non-instruction line)
-    if (m_labelAddrOffsetMap.count(lineNumber)) {
-        return -1;
-    }
-
-    // To identify the program address corresponding to the selected line, we find the lower bound of the selected block
-    // in the m_labelAddrOffsetMap and subtract the invalid line count up to the given point.
-    int adjustedLineNumber = lineNumber;
-
-    if (m_labelAddrOffsetMap.empty())
-        return calcAddressFunc(adjustedLineNumber);
-
-    auto low = m_labelAddrOffsetMap.lower_bound(lineNumber);
-
-    if ((low == m_labelAddrOffsetMap.begin()) && lineNumber < low->first) {
-        // The line number is less that the position of the first offset block; address is directly inferred from
-        // linenumber.
-        return calcAddressFunc(adjustedLineNumber);
-    }
-
-    if (low != m_labelAddrOffsetMap.begin()) {
-        low = std::prev(m_labelAddrOffsetMap.lower_bound(lineNumber));
     }
-
-    adjustedLineNumber -= (low->second.first + 1);
-    return calcAddressFunc(adjustedLineNumber);
 }
 
 long ProgramViewer::addressForPos(const QPoint& pos) const {
-    // Get line height
-    QTextBlock block = firstVisibleBlock();
-
-    const auto height = blockBoundingRect(block).height();
-
-    // Find block index in the ProgramViewer
-    int index;
-    if (block == document()->findBlockByLineNumber(0)) {
-        index = static_cast<int>((pos.y() - contentOffset().y()) / height);
-    } else {
-        index = static_cast<int>((pos.y() + contentOffset().y()) / height);
-    }
-    // Get actual block index
-    while (index > 0) {
-        block = block.next();
-        index--;
-    }
-    if (!block.isValid())
+    // The breakpoint area and the viewport share their vertical coordinates
+    const QModelIndex index = indexAt(QPoint(0, pos.y()));
+    if (!index.isValid())
         return -1;
 
-    return addressForBlock(block);
+    return programIndex().addressForRow(index.row());
 }
 
 bool ProgramViewer::hasBreakpoint(const QPoint& pos) const {
@@ -306,8 +163,51 @@ void ProgramViewer::breakpointClick(const QPoint& pos) {
     const auto address = addressForPos(pos);
     if (!(address < 0)) {
         ProcessorHandler::get()->toggleBreakpoint(static_cast<unsigned>(address));
-        repaint();
+        m_breakpointArea->repaint();
+    }
+}
+
+// -------------- delegate -----------------------------------------
+
+ProgramViewerDelegate::ProgramViewerDelegate(ProgramViewer* viewer) : QStyledItemDelegate(viewer), m_viewer(viewer) {}
+
+QSize ProgramViewerDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex&) const {
+    // Wide enough for the longest rows (symbol names aside); rows are not measured individually
+    const QFontMetrics fm(option.font);
+    return QSize(fm.width(' ') * 100, std::max(fm.height(), m_viewer->m_breakpointArea->imageHeight));
+}
+
+void ProgramViewerDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
+                                  const QModelIndex& index) const {
+    painter->save();
+    const QRect rowRect(option.rect.left(), option.rect.top(), m_viewer->viewport()->width(), option.rect.height());
+
+    const auto highlight = m_viewer->m_highlightedRows.find(index.row());
+    if (highlight != m_viewer->m_highlightedRows.end()) {
+        QLinearGradient grad(rowRect.topLeft(), rowRect.bottomRight());
+        grad.setColorAt(0, option.palette.base().color());
+        grad.setColorAt(1, highlight->second.color);
+        painter->fillRect(rowRect, grad);
+    } else if (option.state & QStyle::State_Selected) {
+        painter->fillRect(rowRect, option.palette.alternateBase());
+    }
+
+    // Expand tabs as the text editor would, with a tab stop distance of 4 characters
+    const QFontMetricsF fm(option.font);
+    QTextOption textOption(Qt::AlignLeft | Qt::AlignVCenter);
+    textOption.setWrapMode(QTextOption::NoWrap);
+    textOption.setTabStopDistance(fm.width(' ') * 4);
+    painter->setFont(option.font);
+    painter->setPen(option.palette.text().color());
+    painter->drawText(option.rect, index.data().toString(), textOption);
+
+    // Draw stage names for highlighted addresses
+    if (highlight != m_viewer->m_highlightedRows.end()) {
+        const QString stageString = highlight->second.stageNames.join('/');
+        painter->drawText(rowRect.adjusted(0, 0, -/*padding*/ 10, 0), stageString,
+                          QTextOption(Qt::AlignRight | Qt::AlignVCenter));
     }
+    painter->restore();
 }
 
 // -------------- breakpoint area ----------------------------------
@@ -1,24 +1,32 @@
 #pragma once
 
 #include <QFont>
+#include <QListView>
 #include <QObject>
-#include <QPlainTextEdit>
 #include <QScrollBar>
+#include <QStyledItemDelegate>
 #include <QTimer>
 
 #include "parser.h"
 #include "processorhandler.h"
 #include "program.h"
+#include "programmodel.h"
 
 namespace Ripes {
 
 class BreakpointArea;
 
-class ProgramViewer : public QPlainTextEdit {
+/**
+ * @brief The ProgramViewer class
+ * View of the disassembled (or binary) program. The view is backed by a ProgramModel, so only the rows which are
+ * visible are ever stringified; rows are mapped to addresses through the model's ProgramIndex.
+ */
+class ProgramViewer : public QListView {
     Q_OBJECT
+    friend class ProgramViewerDelegate;
+
 public:
     ProgramViewer(QWidget* parent = nullptr);
-    void paintEvent(QPaintEvent* e) override;
 
     void breakpointAreaPaintEvent(QPaintEvent* event);
     void breakpointClick(const QPoint& pos);
@@ -27,11 +35,9 @@ public:
     void setFollowEnabled(bool enabled);
 
     long addressForPos(const QPoint& pos) const;
-    long addressForBlock(QTextBlock block) const;
-    QTextBlock blockForAddress(unsigned long) const;
     void setCenterAddress(const long address);
 
-    const AddrOffsetMap& addressOffsetMap() const { return m_labelAddrOffsetMap; }
+    const ProgramIndex& programIndex() const { return m_model->programIndex(); }
 
     ///
     /// \brief updateProgram
@@ -39,6 +45,7 @@ public:
     /// true) show the raw binary version of the loaded program.
     ///
     void updateProgram(bool binary = false);
+    void clear();
 
 public slots:
     void updateHighlightedAddresses();
@@ -46,10 +53,6 @@ public slots:
 protected:
     void resizeEvent(QResizeEvent* event) override;
 
-private slots:
-    void updateSidebar(const QRect&, int);
-    void updateSidebarWidth(int newBlockCount);
-
 private:
     /**
      * @brief updateCenterAddress
@@ -69,16 +72,29 @@ private:
     int m_sidebarWidth;
 
     BreakpointArea* m_breakpointArea;
+    ProgramModel* m_model;
+
+    struct RowHighlight {
+        QColor color;
+        QStringList stageNames;
+    };
+    /** Rows currently holding instructions of the processor, painted by ProgramViewerDelegate */
+    std::map<int, RowHighlight> m_highlightedRows;
+};
 
-    /**
-     * @brief m_labelAddrOffsetMap
-     * To correctly correlate a line index with program address location whilst accounting for additional output in the
-     * disassembled view of a program, we provide the AddrOffsetMap. Key in this map indicate line numbers (starting
-     * from 0) which does >not< correspond with an address. The value of the key corresponds to the total sum of
-     * non-address lines encountered up to and including the given label.
-     */
-    AddrOffsetMap m_labelAddrOffsetMap;
-    std::map<QTextBlock, QStringList> m_highlightedBlocksText;
+/**
+ * @brief The ProgramViewerDelegate class
+ * Paints the rows of a ProgramViewer, expanding tabs like a text editor would, and highlighting rows holding instructions
+ * of the processor with a gradient along with the names of the stages.
+ */
+class ProgramViewerDelegate : public QStyledItemDelegate {
+public:
+    ProgramViewerDelegate(ProgramViewer* viewer);
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+private:
+    ProgramViewer* m_viewer;
 };
 
 class BreakpointArea : public QWidget {
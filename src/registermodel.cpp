@@ -3,12 +3,22 @@
 #include <QHeaderView>
 
 #include "processorhandler.h"
+#include "selfprofiler.h"
 
 namespace Ripes {
 
 using namespace vsrtl;
 
-RegisterModel::RegisterModel(QObject* parent) : QAbstractTableModel(parent) {}
+RegisterModel::RegisterModel(QObject* parent) : QAbstractTableModel(parent) {
+    connect(ProcessorHandler::get(), &ProcessorHandler::runStarted, this, [=] { m_live = true; });
+    connect(ProcessorHandler::get(), &ProcessorHandler::runFinished, this, [=] { m_live = false; });
+    connect(ProcessorHandler::get(), &ProcessorHandler::snapshotUpdated, this, &RegisterModel::liveUpdate);
+    ProcessorHandler::get()->addWriteLogSubscriber();
+}
+
+RegisterModel::~RegisterModel() {
+    ProcessorHandler::get()->removeWriteLogSubscriber();
+}
 
 std::vector<uint32_t> RegisterModel::gatherRegisterValues() {
     std::vector<uint32_t> vals;
@@ -27,7 +37,51 @@ int RegisterModel::rowCount(const QModelIndex&) const {
 }
 
 void RegisterModel::processorWasClocked() {
-    // Reload model
+    RIPES_PROFILE_SCOPE(ModelUpdate);
+    const auto* proc = ProcessorHandler::get()->getProcessor();
+    WriteSet writes;
+    if (m_regValues.size() != static_cast<unsigned>(rowCount()) ||
+        !proc->writesSince(m_writeLogPosition, writes)) {
+        reload();
+    } else {
+        // Only update the registers which were written since the last update
+        bool highlightMoved = false;
+        for (const auto& i : writes.registers) {
+            if (i >= m_regValues.size()) {
+                continue;
+            }
+            const uint32_t value = ProcessorHandler::get()->getRegisterValue(i);
+            if (value != m_regValues[i]) {
+                m_regValues[i] = value;
+                if (!highlightMoved) {
+                    highlightMoved = true;
+                    if (m_mostRecentlyModifiedReg >= 0 && m_mostRecentlyModifiedReg != static_cast<int>(i)) {
+                        emit dataChanged(index(m_mostRecentlyModifiedReg, 0),
+                                         index(m_mostRecentlyModifiedReg, NColumns - 1));
+                    }
+                    m_mostRecentlyModifiedReg = i;
+                    emit registerChanged(i);
+                }
+            }
+            emit dataChanged(index(i, 0), index(i, NColumns - 1));
+        }
+    }
+    m_writeLogPosition = proc->writeLogPosition();
+}
+
+void RegisterModel::liveUpdate(const RunSnapshot& snapshot) {
+    if (snapshot.registers.size() != m_regValues.size()) {
+        return;
+    }
+    for (unsigned i = 0; i < m_regValues.size(); i++) {
+        if (m_regValues[i] != snapshot.registers[i]) {
+            m_regValues[i] = snapshot.registers[i];
+            emit dataChanged(index(i, Column::Value), index(i, Column::Value));
+        }
+    }
+}
+
+void RegisterModel::reload() {
     beginResetModel();
     endResetModel();
     const auto newRegValues = gatherRegisterValues();
@@ -118,7 +172,7 @@ QVariant RegisterModel::data(const QModelIndex& index, int role) const {
 
 void RegisterModel::setRadix(Ripes::Radix r) {
     m_radix = r;
-    processorWasClocked();
+    reload();
 }
 
 QVariant RegisterModel::nameData(unsigned idx) const {
@@ -134,13 +188,16 @@ QVariant RegisterModel::tooltipData(unsigned idx) const {
 }
 
 QVariant RegisterModel::valueData(unsigned idx) const {
+    if (m_live && idx < m_regValues.size()) {
+        return encodeRadixValue(m_regValues[idx], m_radix);
+    }
     return encodeRadixValue(ProcessorHandler::get()->getRegisterValue(idx), m_radix);
 }
 
 Qt::ItemFlags RegisterModel::flags(const QModelIndex& index) const {
     const auto def =
         ProcessorHandler::get()->currentISA()->regIsReadOnly(index.row()) ? Qt::NoItemFlags : Qt::ItemIsEnabled;
-    if (index.column() == Column::Value)
+    if (index.column() == Column::Value && !m_live)
         return Qt::ItemIsEditable | def;
     return def;
 }
@@ -11,11 +11,14 @@
 
 namespace Ripes {
 
+struct RunSnapshot;
+
 class RegisterModel : public QAbstractTableModel {
     Q_OBJECT
 public:
     enum Column { Name, Alias, Value, NColumns };
     RegisterModel(QObject* parent = nullptr);
+    ~RegisterModel() override;
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
@@ -31,6 +34,7 @@ public:
 
 public slots:
     void processorWasClocked();
+    void liveUpdate(const RunSnapshot& snapshot);
 
 signals:
     /**
@@ -41,6 +45,7 @@ signals:
 
 private:
     std::vector<uint32_t> gatherRegisterValues();
+    void reload();
 
     QVariant nameData(unsigned idx) const;
     QVariant aliasData(unsigned idx) const;
@@ -49,7 +54,15 @@ private:
 
     Radix m_radix = Radix::Hex;
 
+    /**
+     * @brief m_live
+     * Set while the processor is running asynchronously. In this case, register values are displayed from the latest
+     * live snapshot (m_regValues) rather than read from the processor.
+     */
+    bool m_live = false;
     int m_mostRecentlyModifiedReg = -1;
     std::vector<uint32_t> m_regValues;
+    /** Position of the processor write log at the last update of the model */
+    uint64_t m_writeLogPosition = 0;
 };
 }  // namespace Ripes
@@ -12,10 +12,15 @@ namespace Ripes {
 #define RIPES_SETTING_CCPATH ("compiler_path")
 #define RIPES_SETTING_CCARGS ("compiler_args")
 #define RIPES_SETTING_LDARGS ("linker_args")
+#define RIPES_SETTING_CCBACKGROUND ("compiler_background")
 #define RIPES_SETTING_CONSOLEECHO ("console_echo")
 #define RIPES_SETTING_CONSOLEBG ("console_bg_color")
 #define RIPES_SETTING_CONSOLEFONTCOLOR ("console_font_color")
 #define RIPES_SETTING_CONSOLEFONT ("console_font")
+#define RIPES_SETTING_STDIN_REDIRECT ("stdin_redirect")
+#define RIPES_SETTING_STDOUT_REDIRECT ("stdout_redirect")
+#define RIPES_SETTING_STDERR_REDIRECT ("stderr_redirect")
+#define RIPES_SETTING_PIPELINEDIAGRAM_MAXCYCLES ("pipelinediagram_maxcycles")
 
 // Program state preserving settings
 #define RIPES_SETTING_SETTING_TAB ("settings_tab")
@@ -31,11 +36,16 @@ const static std::map<QString, QVariant> s_defaultSettings = {
     {RIPES_SETTING_CCPATH, ""},
     {RIPES_SETTING_CCARGS, "-O0"},
     {RIPES_SETTING_LDARGS, "-static-libgcc -lm"},  // Ensure statically linked executable + link with math library
+    {RIPES_SETTING_CCBACKGROUND, "false"},
     {RIPES_SETTING_CONSOLEECHO, "true"},
     {RIPES_SETTING_CONSOLEBG, QColor(Qt::white)},
     {RIPES_SETTING_CONSOLEFONTCOLOR, QColor(Qt::black)},
     {RIPES_SETTING_CONSOLEFONT, QVariant() /* Let Console define its own default font */},
     {RIPES_SETTING_CONSOLEFONT, QColor(Qt::black)},
+    {RIPES_SETTING_STDIN_REDIRECT, ""},
+    {RIPES_SETTING_STDOUT_REDIRECT, ""},
+    {RIPES_SETTING_STDERR_REDIRECT, ""},
+    {RIPES_SETTING_PIPELINEDIAGRAM_MAXCYCLES, 100000},
 
     // Program state preserving settings
     {RIPES_SETTING_SETTING_TAB, 0},
@@ -0,0 +1,360 @@
+#include "rvreferencemodel.h"
+
+#include <climits>
+
+namespace Ripes {
+
+namespace {
+constexpr uint32_t c_lui = 0b0110111;
+constexpr uint32_t c_auipc = 0b0010111;
+constexpr uint32_t c_jal = 0b1101111;
+constexpr uint32_t c_jalr = 0b1100111;
+constexpr uint32_t c_branch = 0b1100011;
+constexpr uint32_t c_load = 0b0000011;
+constexpr uint32_t c_store = 0b0100011;
+constexpr uint32_t c_opImm = 0b0010011;
+constexpr uint32_t c_op = 0b0110011;
+constexpr uint32_t c_amo = 0b0101111;
+constexpr uint32_t c_ecall = 0x00000073;
+
+inline int32_t immI(uint32_t instr) {
+    return static_cast<int32_t>(instr) >> 20;
+}
+
+inline int32_t immS(uint32_t instr) {
+    return static_cast<int32_t>(((static_cast<int32_t>(instr) >> 25) << 5) | ((instr >> 7) & 0x1F));
+}
+
+inline int32_t immB(uint32_t instr) {
+    return static_cast<int32_t>(((static_cast<int32_t>(instr) >> 31) << 12) | ((instr & 0x80) << 4) |
+                                ((instr >> 20) & 0x7E0) | ((instr >> 7) & 0x1E));
+}
+
+inline int32_t immJ(uint32_t instr) {
+    return static_cast<int32_t>(((static_cast<int32_t>(instr) >> 31) << 20) | (instr & 0xFF000) |
+                                ((instr >> 9) & 0x800) | ((instr >> 20) & 0x7FE));
+}
+
+inline uint32_t signExtend(uint32_t value, unsigned bits) {
+    const unsigned shift = sizeof(uint32_t) * CHAR_BIT - bits;
+    return static_cast<uint32_t>(static_cast<int32_t>(value << shift) >> shift);
+}
+
+/** RV32M; division by zero and overflow yield the results mandated by the specification, without trapping */
+bool executeM(unsigned funct3, uint32_t a, uint32_t b, uint32_t& res) {
+    const auto sa = static_cast<int32_t>(a);
+    const auto sb = static_cast<int32_t>(b);
+    const bool overflow = sa == INT32_MIN && sb == -1;
+    switch (funct3) {
+        case 0b000:
+            res = a * b;
+            return true;
+        case 0b001:
+            res = static_cast<uint32_t>((static_cast<int64_t>(sa) * static_cast<int64_t>(sb)) >> 32);
+            return true;
+        case 0b010:
+            res = static_cast<uint32_t>((static_cast<int64_t>(sa) * static_cast<int64_t>(static_cast<uint64_t>(b))) >>
+                                        32);
+            return true;
+        case 0b011:
+            res = static_cast<uint32_t>((static_cast<uint64_t>(a) * static_cast<uint64_t>(b)) >> 32);
+            return true;
+        case 0b100:
+            res = b == 0 ? UINT32_MAX : overflow ? a : static_cast<uint32_t>(sa / sb);
+            return true;
+        case 0b101:
+            res = b == 0 ? UINT32_MAX : a / b;
+            return true;
+        case 0b110:
+            res = b == 0 ? a : overflow ? 0 : static_cast<uint32_t>(sa % sb);
+            return true;
+        case 0b111:
+            res = b == 0 ? a : a % b;
+            return true;
+    }
+    return false;
+}
+
+/** Register-register and register-immediate ALU operations of RV32I. @p alt is bit 30 of the instruction. */
+bool executeALU(unsigned funct3, bool alt, uint32_t a, uint32_t b, uint32_t& res) {
+    const unsigned shamt = b & 0x1F;
+    switch (funct3) {
+        case 0b000:
+            res = alt ? a - b : a + b;
+            return true;
+        case 0b001:
+            res = a << shamt;
+            return true;
+        case 0b010:
+            res = static_cast<int32_t>(a) < static_cast<int32_t>(b) ? 1 : 0;
+            return true;
+        case 0b011:
+            res = a < b ? 1 : 0;
+            return true;
+        case 0b100:
+            res = a ^ b;
+            return true;
+        case 0b101:
+            res = alt ? static_cast<uint32_t>(static_cast<int32_t>(a) >> shamt) : a >> shamt;
+            return true;
+        case 0b110:
+            res = a | b;
+            return true;
+        case 0b111:
+            res = a & b;
+            return true;
+    }
+    return false;
+}
+}  // namespace
+
+void RVReferenceModel::executeAMO(uint32_t instr, Effects& fx) {
+    const unsigned rd = (instr >> 7) & 0x1F;
+    const unsigned funct3 = (instr >> 12) & 0x7;
+    const unsigned funct5 = instr >> 27;
+    const unsigned rs2Idx = (instr >> 20) & 0x1F;
+    const uint32_t address = m_regs[(instr >> 15) & 0x1F];
+    const uint32_t rs2 = m_regs[rs2Idx];
+
+    // Only word-sized atomics exist in RV32A
+    if (funct3 != 0b010 || (address & 0x3) != 0) {
+        fx.illegal = true;
+        return;
+    }
+
+    fx.address = address;
+    fx.size = sizeof(uint32_t);
+    fx.regWrite = rd != 0;
+    fx.reg = rd;
+
+    switch (funct5) {
+        case 0b00010: {  // LR.W
+            if (rs2Idx != 0) {
+                fx.illegal = true;
+                return;
+            }
+            fx.memRead = true;
+            fx.regValue = m_readMem(address, sizeof(uint32_t));
+            m_reserved = true;
+            m_reservation = address;
+            return;
+        }
+        case 0b00011: {  // SC.W
+            // The reservation is consumed regardless of whether the store succeeds
+            const bool success = m_reserved && m_reservation == address;
+            m_reserved = false;
+            fx.memWrite = success;
+            fx.memValue = rs2;
+            fx.regValue = success ? 0 : 1;
+            return;
+        }
+        default:
+            break;
+    }
+
+    const uint32_t loaded = m_readMem(address, sizeof(uint32_t));
+    const auto sLoaded = static_cast<int32_t>(loaded);
+    const auto sRs2 = static_cast<int32_t>(rs2);
+    uint32_t stored;
+    switch (funct5) {
+        case 0b00001:
+            stored = rs2;
+            break;
+        case 0b00000:
+            stored = loaded + rs2;
+            break;
+        case 0b00100:
+            stored = loaded ^ rs2;
+            break;
+        case 0b01100:
+            stored = loaded & rs2;
+            break;
+        case 0b01000:
+            stored = loaded | rs2;
+            break;
+        case 0b10000:
+            stored = sLoaded < sRs2 ? loaded : rs2;
+            break;
+        case 0b10100:
+            stored = sLoaded > sRs2 ? loaded : rs2;
+            break;
+        case 0b11000:
+            stored = loaded < rs2 ? loaded : rs2;
+            break;
+        case 0b11100:
+            stored = loaded > rs2 ? loaded : rs2;
+            break;
+        default:
+            fx.illegal = true;
+            return;
+    }
+    fx.memRead = true;
+    fx.memWrite = true;
+    fx.memValue = stored;
+    fx.regValue = loaded;
+}
+
+RVReferenceModel::Effects RVReferenceModel::step() {
+    Effects fx;
+    fx.pc = m_pc;
+    fx.instr = m_readMem(m_pc, sizeof(uint32_t));
+    fx.nextPC = m_pc + sizeof(uint32_t);
+
+    const uint32_t instr = fx.instr;
+    const unsigned rd = (instr >> 7) & 0x1F;
+    const unsigned funct3 = (instr >> 12) & 0x7;
+    const unsigned funct7 = instr >> 25;
+    const uint32_t rs1 = m_regs[(instr >> 15) & 0x1F];
+    const uint32_t rs2 = m_regs[(instr >> 20) & 0x1F];
+
+    const auto writeRd = [&](uint32_t value) {
+        fx.regWrite = rd != 0;
+        fx.reg = rd;
+        fx.regValue = value;
+    };
+
+    switch (instr & 0x7F) {
+        case c_lui:
+            writeRd(instr & 0xFFFFF000);
+            break;
+        case c_auipc:
+            writeRd(m_pc + (instr & 0xFFFFF000));
+            break;
+        case c_jal:
+            writeRd(m_pc + sizeof(uint32_t));
+            fx.nextPC = m_pc + immJ(instr);
+            break;
+        case c_jalr:
+            if (funct3 != 0) {
+                fx.illegal = true;
+                break;
+            }
+            writeRd(m_pc + sizeof(uint32_t));
+            fx.nextPC = (rs1 + immI(instr)) & ~1u;
+            break;
+        case c_branch: {
+            bool taken;
+            switch (funct3) {
+                case 0b000:
+                    taken = rs1 == rs2;
+                    break;
+                case 0b001:
+                    taken = rs1 != rs2;
+                    break;
+                case 0b100:
+                    taken = static_cast<int32_t>(rs1) < static_cast<int32_t>(rs2);
+                    break;
+                case 0b101:
+                    taken = static_cast<int32_t>(rs1) >= static_cast<int32_t>(rs2);
+                    break;
+                case 0b110:
+                    taken = rs1 < rs2;
+                    break;
+                case 0b111:
+                    taken = rs1 >= rs2;
+                    break;
+                default:
+                    fx.illegal = true;
+                    taken = false;
+                    break;
+            }
+            if (taken) {
+                fx.nextPC = m_pc + immB(instr);
+            }
+            break;
+        }
+        case c_load: {
+            const uint32_t address = rs1 + immI(instr);
+            fx.memRead = true;
+            fx.address = address;
+            fx.size = 1u << (funct3 & 0b11);
+            switch (funct3) {
+                case 0b000:
+                    writeRd(signExtend(m_readMem(address, 1), 8));
+                    break;
+                case 0b001:
+                    writeRd(signExtend(m_readMem(address, 2), 16));
+                    break;
+                case 0b010:
+                    writeRd(m_readMem(address, 4));
+                    break;
+                case 0b100:
+                    writeRd(m_readMem(address, 1));
+                    break;
+                case 0b101:
+                    writeRd(m_readMem(address, 2));
+                    break;
+                default:
+                    fx.illegal = true;
+                    break;
+            }
+            break;
+        }
+        case c_store: {
+            if (funct3 > 0b010) {
+                fx.illegal = true;
+                break;
+            }
+            fx.memWrite = true;
+            fx.address = rs1 + immS(instr);
+            fx.size = 1u << funct3;
+            fx.memValue = fx.size == sizeof(uint32_t) ? rs2 : rs2 & ((1u << (fx.size * CHAR_BIT)) - 1);
+            break;
+        }
+        case c_opImm: {
+            // Shift immediates encode their shift type in the upper bits of the immediate
+            const bool isShift = funct3 == 0b001 || funct3 == 0b101;
+            if (isShift && funct7 != 0 && !(funct3 == 0b101 && funct7 == 0b0100000)) {
+                fx.illegal = true;
+                break;
+            }
+            uint32_t res;
+            executeALU(funct3, isShift && funct7 != 0, rs1, static_cast<uint32_t>(immI(instr)), res);
+            writeRd(res);
+            break;
+        }
+        case c_op: {
+            uint32_t res;
+            bool valid;
+            if (funct7 == 0b0000001) {
+                valid = executeM(funct3, rs1, rs2, res);
+            } else if (funct7 == 0 || (funct7 == 0b0100000 && (funct3 == 0b000 || funct3 == 0b101))) {
+                valid = executeALU(funct3, funct7 != 0, rs1, rs2, res);
+            } else {
+                valid = false;
+            }
+            if (valid) {
+                writeRd(res);
+            } else {
+                fx.illegal = true;
+            }
+            break;
+        }
+        case c_amo:
+            executeAMO(instr, fx);
+            break;
+        default:
+            if (instr == c_ecall) {
+                fx.ecall = true;
+            } else {
+                fx.illegal = true;
+            }
+            break;
+    }
+
+    if (fx.illegal) {
+        fx.regWrite = false;
+        fx.memRead = false;
+        fx.memWrite = false;
+        fx.nextPC = m_pc;
+        return fx;
+    }
+
+    if (fx.regWrite) {
+        m_regs[fx.reg] = fx.regValue;
+    }
+    m_pc = fx.nextPC;
+    return fx;
+}
+
+}  // namespace Ripes
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+namespace Ripes {
+
+/**
+ * @brief The RVReferenceModel class
+ * Functional (instruction-at-a-time) model of the RV32IMA ISA, independent of the datapath components of the processor
+ * models. It serves as the golden model against which processor models are verified.
+ * The model owns the register file and program counter, but not memory: instruction fetches and loads go through the
+ * memory reader given at construction, and stores are returned to the caller in the effects of the executing
+ * instruction rather than being performed. System calls are not executed; the caller must apply their effects.
+ *
+ * The load reservation of LR/SC is held by the model. A caller modelling several harts on a shared memory must call
+ * snoopWrite() on every other hart whenever a hart writes memory. Given that traps are not modelled, misaligned atomic
+ * memory operations are reported as illegal instructions.
+ */
+class RVReferenceModel {
+public:
+    static constexpr unsigned s_nRegs = 32;
+
+    /** Returns @p size bytes of memory at @p address, little-endian and zero-extended to 32 bits */
+    using MemoryReader = std::function<uint32_t(uint32_t address, unsigned size)>;
+
+    /**
+     * @brief The Effects struct
+     * The architectural effects of executing a single instruction.
+     */
+    struct Effects {
+        uint32_t pc = 0;
+        uint32_t instr = 0;
+        uint32_t nextPC = 0;
+
+        bool regWrite = false;
+        unsigned reg = 0;
+        uint32_t regValue = 0;
+
+        /** Loads, LR and AMOs read memory, stores, successful SCs and AMOs write memory, both at address */
+        bool memRead = false;
+        bool memWrite = false;
+        uint32_t address = 0;
+        unsigned size = 0;
+        uint32_t memValue = 0;
+
+        bool ecall = false;
+        /** The instruction is not part of RV32IMA. No state was modified, and the program counter was not advanced. */
+        bool illegal = false;
+    };
+
+    explicit RVReferenceModel(MemoryReader readMem) : m_readMem(readMem) {}
+
+    uint32_t pc() const { return m_pc; }
+    void setPC(uint32_t pc) { m_pc = pc; }
+
+    uint32_t reg(unsigned i) const { return m_regs[i]; }
+    void setReg(unsigned i, uint32_t value) {
+        if (i != 0) {
+            m_regs[i] = value;
+        }
+    }
+
+    /**
+     * @brief step
+     * Executes the instruction at the current program counter, updating the register file and program counter.
+     */
+    Effects step();
+
+    bool hasReservation() const { return m_reserved; }
+    /**
+     * @brief snoopWrite
+     * Notifies the model of a write to @p address by another hart, which invalidates a reservation of the same word.
+     */
+    void snoopWrite(uint32_t address) {
+        if (m_reserved && (address & ~0x3u) == m_reservation) {
+            m_reserved = false;
+        }
+    }
+
+private:
+    void executeAMO(uint32_t instr, Effects& fx);
+
+    MemoryReader m_readMem;
+    std::array<uint32_t, s_nRegs> m_regs{};
+    uint32_t m_pc = 0;
+
+    bool m_reserved = false;
+    uint32_t m_reservation = 0;
+};
+
+}  // namespace Ripes
@@ -0,0 +1,83 @@
+#include "selfprofiledialog.h"
+#include "ui_selfprofiledialog.h"
+
+#include <QFile>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QMessageBox>
+
+#include "selfprofiler.h"
+
+namespace Ripes {
+
+SelfProfileDialog::SelfProfileDialog(QWidget* parent) : QDialog(parent), m_ui(new Ui::SelfProfileDialog) {
+    m_ui->setupUi(this);
+
+    setWindowTitle("Simulator self-profile");
+
+    auto& profiler = SelfProfiler::get();
+    if (SelfProfiler::isAvailable()) {
+        m_ui->infoText->setText(
+            "Host time spent in the hot paths of the simulator. Time spent in nested categories (ie. cache simulation "
+            "whilst clocking the processor) is only accounted to the innermost category.");
+    } else {
+        m_ui->infoText->setText("This build of Ripes does not include self-profiling instrumentation. Rebuild with "
+                                "RIPES_WITH_SELFPROFILE=ON to enable it.");
+    }
+    m_ui->enableProfiling->setEnabled(SelfProfiler::isAvailable());
+    m_ui->enableProfiling->setChecked(profiler.isEnabled());
+    connect(m_ui->enableProfiling, &QCheckBox::toggled, [&profiler](bool enabled) { profiler.setEnabled(enabled); });
+
+    m_ui->table->setColumnCount(SelfProfiler::tableHeader().size());
+    m_ui->table->setRowCount(SelfProfiler::s_nCategories);
+    m_ui->table->setHorizontalHeaderLabels(SelfProfiler::tableHeader());
+    m_ui->table->horizontalHeader()->setStretchLastSection(true);
+    m_ui->table->verticalHeader()->hide();
+
+    connect(m_ui->resetButton, &QPushButton::clicked, [=] {
+        SelfProfiler::get().reset();
+        updateTable();
+    });
+    connect(m_ui->dumpButton, &QPushButton::clicked, this, &SelfProfileDialog::dump);
+
+    m_refreshTimer.setInterval(s_refreshInterval);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &SelfProfileDialog::updateTable);
+    m_refreshTimer.start();
+    updateTable();
+}
+
+void SelfProfileDialog::updateTable() {
+    const auto rows = SelfProfiler::get().tableRows();
+    for (unsigned i = 0; i < rows.size(); i++) {
+        const QStringList& columns = rows.at(i);
+        for (int col = 0; col < columns.size(); col++) {
+            auto* item = m_ui->table->item(i, col);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_ui->table->setItem(i, col, item);
+            }
+            item->setText(columns.at(col));
+        }
+    }
+    m_ui->table->resizeColumnToContents(0);
+}
+
+void SelfProfileDialog::dump() {
+    const QString filename =
+        QFileDialog::getSaveFileName(this, "Dump self-profile", "ripes-profile.txt", "Text files (*.txt)");
+    if (filename.isEmpty()) {
+        return;
+    }
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        QMessageBox::warning(this, "Error", "Error: Could not open file " + filename);
+        return;
+    }
+    file.write(SelfProfiler::get().dump().toUtf8());
+}
+
+SelfProfileDialog::~SelfProfileDialog() {
+    delete m_ui;
+}
+
+}  // namespace Ripes
@@ -0,0 +1,33 @@
+#pragma once
+#include <QDialog>
+#include <QTimer>
+
+namespace Ripes {
+namespace Ui {
+class SelfProfileDialog;
+}
+
+/**
+ * @brief The SelfProfileDialog class
+ * Displays the host time spent per SelfProfiler category, refreshed periodically whilst the dialog is open, and allows
+ * for dumping the profile to a file.
+ */
+class SelfProfileDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit SelfProfileDialog(QWidget* parent = nullptr);
+    ~SelfProfileDialog();
+
+private:
+    void updateTable();
+    void dump();
+
+    /** Interval between table refreshes, in milliseconds */
+    static constexpr int s_refreshInterval = 500;
+
+    Ui::SelfProfileDialog* m_ui;
+    QTimer m_refreshTimer;
+};
+
+}  // namespace Ripes
@@ -0,0 +1,80 @@
+#include "selfprofiler.h"
+
+#include <QTextStream>
+
+namespace Ripes {
+
+thread_local ScopedProfile* ScopedProfile::s_current = nullptr;
+
+QString SelfProfiler::categoryName(Category category) {
+    switch (category) {
+        case Category::Clock:
+            return "Propagation (clocking)";
+        case Category::CacheSim:
+            return "Cache simulation";
+        case Category::StageInfo:
+            return "Stage info gathering";
+        case Category::Syscall:
+            return "System calls";
+        case Category::ModelUpdate:
+            return "Model updates";
+        case Category::Snapshot:
+            return "Live snapshots";
+        case Category::NCategories:
+            break;
+    }
+    Q_UNREACHABLE();
+}
+
+SelfProfiler::Stat SelfProfiler::stat(Category category) const {
+    const auto& counter = m_counters[static_cast<unsigned>(category)];
+    return {counter.ns.load(std::memory_order_relaxed), counter.count.load(std::memory_order_relaxed)};
+}
+
+void SelfProfiler::reset() {
+    for (auto& counter : m_counters) {
+        counter.ns.store(0, std::memory_order_relaxed);
+        counter.count.store(0, std::memory_order_relaxed);
+    }
+}
+
+QStringList SelfProfiler::tableHeader() {
+    return {"Category", "Time (ms)", "Share (%)", "Calls", "Avg. (ns)"};
+}
+
+std::vector<QStringList> SelfProfiler::tableRows() const {
+    uint64_t totalNs = 0;
+    for (unsigned i = 0; i < s_nCategories; i++) {
+        totalNs += stat(static_cast<Category>(i)).ns;
+    }
+
+    std::vector<QStringList> rows;
+    for (unsigned i = 0; i < s_nCategories; i++) {
+        const auto category = static_cast<Category>(i);
+        const Stat s = stat(category);
+        rows.push_back({categoryName(category), QString::number(s.ns / 1e6, 'f', 3),
+                        QString::number(totalNs == 0 ? 0 : 100.0 * s.ns / totalNs, 'f', 1), QString::number(s.count),
+                        QString::number(s.count == 0 ? 0 : s.ns / s.count)});
+    }
+    return rows;
+}
+
+QString SelfProfiler::dump() const {
+    QString out;
+    QTextStream stream(&out);
+    const auto writeRow = [&stream](const QStringList& row) {
+        stream << qSetFieldWidth(24) << left << row.at(0) << qSetFieldWidth(14) << right;
+        for (int col = 1; col < row.size(); col++) {
+            stream << row.at(col);
+        }
+        stream << qSetFieldWidth(0) << "\n";
+    };
+
+    writeRow(tableHeader());
+    for (const auto& row : tableRows()) {
+        writeRow(row);
+    }
+    return out;
+}
+
+}  // namespace Ripes
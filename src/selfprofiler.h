@@ -0,0 +1,142 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace Ripes {
+
+/**
+ * @brief The SelfProfiler class
+ * Accumulates the host time spent in the hot paths of the simulator, per category. Time is recorded by
+ * RIPES_PROFILE_SCOPE, which is compiled out unless Ripes is built with RIPES_SELFPROFILE, and which only samples the
+ * clock while profiling is enabled at runtime. Scopes may nest (ie. cache simulation is performed whilst clocking the
+ * processor); the time of a scope is recorded exclusive of the time of its nested scopes.
+ */
+class SelfProfiler {
+public:
+    enum class Category { Clock, CacheSim, StageInfo, Syscall, ModelUpdate, Snapshot, NCategories };
+    static constexpr unsigned s_nCategories = static_cast<unsigned>(Category::NCategories);
+
+    struct Stat {
+        uint64_t ns = 0;
+        uint64_t count = 0;
+    };
+
+    static SelfProfiler& get() {
+        static SelfProfiler profiler;
+        return profiler;
+    }
+
+    /**
+     * @brief isAvailable
+     * @returns true if Ripes was built with the instrumentation compiled in.
+     */
+    static constexpr bool isAvailable() {
+#ifdef RIPES_SELFPROFILE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static QString categoryName(Category category);
+
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+    void record(Category category, uint64_t ns) {
+        auto& counter = m_counters[static_cast<unsigned>(category)];
+        counter.ns.fetch_add(ns, std::memory_order_relaxed);
+        counter.count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Stat stat(Category category) const;
+    void reset();
+
+    /**
+     * @brief tableHeader
+     * @returns the column names of the rows of tableRows().
+     */
+    static QStringList tableHeader();
+
+    /**
+     * @brief tableRows
+     * @returns a row per category, with the category name, time (ms), share of the total time (%), number of calls and
+     * average time per call (ns), formatted for display.
+     */
+    std::vector<QStringList> tableRows() const;
+
+    /**
+     * @brief dump
+     * @returns a plain text table of the time spent per category.
+     */
+    QString dump() const;
+
+private:
+    SelfProfiler() {}
+
+    struct Counter {
+        std::atomic<uint64_t> ns{0};
+        std::atomic<uint64_t> count{0};
+    };
+    std::array<Counter, s_nCategories> m_counters;
+    std::atomic<bool> m_enabled{false};
+};
+
+/**
+ * @brief The ScopedProfile class
+ * Records the time from construction to destruction under a SelfProfiler category. Use through RIPES_PROFILE_SCOPE.
+ */
+class ScopedProfile {
+public:
+    explicit ScopedProfile(SelfProfiler::Category category)
+        : m_category(category), m_active(SelfProfiler::get().isEnabled()) {
+        if (m_active) {
+            m_parent = s_current;
+            s_current = this;
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedProfile() {
+        if (m_active) {
+            const uint64_t total =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start)
+                    .count();
+            SelfProfiler::get().record(m_category, total - std::min(total, m_nestedNs));
+            if (m_parent) {
+                m_parent->m_nestedNs += total;
+            }
+            s_current = m_parent;
+        }
+    }
+
+    ScopedProfile(const ScopedProfile&) = delete;
+    ScopedProfile& operator=(const ScopedProfile&) = delete;
+
+private:
+    static thread_local ScopedProfile* s_current;
+
+    SelfProfiler::Category m_category;
+    bool m_active;
+    ScopedProfile* m_parent = nullptr;
+    uint64_t m_nestedNs = 0;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+}  // namespace Ripes
+
+#ifdef RIPES_SELFPROFILE
+#define RIPES_PROFILE_CONCAT_IMPL(a, b) a##b
+#define RIPES_PROFILE_CONCAT(a, b) RIPES_PROFILE_CONCAT_IMPL(a, b)
+#define RIPES_PROFILE_SCOPE(category) \
+    ::Ripes::ScopedProfile RIPES_PROFILE_CONCAT(_profileScope, __LINE__)(::Ripes::SelfProfiler::Category::category)
+#else
+#define RIPES_PROFILE_SCOPE(category)
+#endif
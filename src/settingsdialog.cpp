@@ -189,6 +189,17 @@ QWidget* SettingsDialog::createEditorPage() {
     CCLayout->addLayout(LDArgHLayout);
     connect(ldArgs, &QLineEdit::textChanged, [=, ccpath = ccpath] { emit ccpath->textChanged(ccpath->text()); });
 
+    // Setting: RIPES_SETTING_CCBACKGROUND
+    auto [backgroundLabel, backgroundCheckbox] =
+        createSettingsWidgets<QCheckBox>(RIPES_SETTING_CCBACKGROUND, "Compile while editing:");
+    backgroundCheckbox->setToolTip("Compile C programs in the background whenever the program is edited, as is done "
+                                   "for assembly programs.");
+    auto* backgroundHLayout = new QHBoxLayout();
+    backgroundHLayout->addWidget(backgroundLabel);
+    backgroundHLayout->addWidget(backgroundCheckbox);
+    backgroundHLayout->addStretch();
+    CCLayout->addLayout(backgroundHLayout);
+
     // Add effective compile command line view
     auto* CCCLineHLayout = new QHBoxLayout();
     m_compileInfoHeader = new QLabel();
@@ -241,6 +252,15 @@ QWidget* SettingsDialog::createSimulatorPage() {
     pageLayout->addWidget(rewindLabel, 0, 0);
     pageLayout->addWidget(rewindSpinbox, 0, 1);
 
+    // Setting: RIPES_SETTING_PIPELINEDIAGRAM_MAXCYCLES
+    auto [stageTableLabel, stageTableSpinbox] =
+        createSettingsWidgets<QSpinBox>(RIPES_SETTING_PIPELINEDIAGRAM_MAXCYCLES, "Max. stage table cycles:");
+    stageTableSpinbox->setRange(1, INT_MAX);
+    stageTableSpinbox->setToolTip("Number of most recent cycles which are retained in the stage table");
+
+    pageLayout->addWidget(stageTableLabel, 1, 0);
+    pageLayout->addWidget(stageTableSpinbox, 1, 1);
+
     return pageWidget;
 }
 
@@ -276,6 +296,31 @@ QWidget* SettingsDialog::createEnvironmentPage() {
 
     pageLayout->addWidget(consoleGroupBox);
 
+    auto* redirectGroupBox = new QGroupBox("Redirection");
+    auto* redirectLayout = new QGridLayout();
+    redirectGroupBox->setLayout(redirectLayout);
+    redirectGroupBox->setToolTip(
+        "Host files or named pipes which the standard streams of the simulated program are redirected to.\n"
+        "Leave empty to use the console. Changes take effect when the processor is reset.");
+
+    // Setting: RIPES_SETTING_STDIN_REDIRECT
+    auto [stdinLabel, stdinPath] = createSettingsWidgets<QLineEdit>(RIPES_SETTING_STDIN_REDIRECT, "Standard input:");
+    redirectLayout->addWidget(stdinLabel, 0, 0);
+    redirectLayout->addWidget(stdinPath, 0, 1);
+
+    // Setting: RIPES_SETTING_STDOUT_REDIRECT
+    auto [stdoutLabel, stdoutPath] =
+        createSettingsWidgets<QLineEdit>(RIPES_SETTING_STDOUT_REDIRECT, "Standard output:");
+    redirectLayout->addWidget(stdoutLabel, 1, 0);
+    redirectLayout->addWidget(stdoutPath, 1, 1);
+
+    // Setting: RIPES_SETTING_STDERR_REDIRECT
+    auto [stderrLabel, stderrPath] = createSettingsWidgets<QLineEdit>(RIPES_SETTING_STDERR_REDIRECT, "Standard error:");
+    redirectLayout->addWidget(stderrLabel, 2, 0);
+    redirectLayout->addWidget(stderrPath, 2, 1);
+
+    pageLayout->addWidget(redirectGroupBox);
+
     return pageWidget;
 }
 
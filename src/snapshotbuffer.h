@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace Ripes {
+
+/**
+ * @brief The SnapshotBuffer class
+ * Lock-free single producer, single consumer buffer for handing snapshots of state from the simulation thread to the
+ * GUI thread. The producer fills back() and publishes it, whereafter the consumer may acquire the most recently
+ * published snapshot through update(). Three buffers are used (the front and back buffers of double buffering, plus
+ * the handover buffer), such that neither side ever waits on the other; snapshots which are published before the
+ * consumer gets to them are dropped.
+ */
+template <typename T>
+class SnapshotBuffer {
+public:
+    /**
+     * @brief back
+     * Producer side: @returns the buffer to be written before calling publish(). The buffer retains the contents it had
+     * when it was last published, ie. it is not guaranteed to hold the most recent snapshot.
+     */
+    T& back() { return m_buffers[m_back]; }
+
+    /**
+     * @brief publish
+     * Producer side: makes the contents of back() available to the consumer.
+     */
+    void publish() { m_back = m_handover.exchange(m_back | s_fresh, std::memory_order_acq_rel) & s_indexMask; }
+
+    /**
+     * @brief update
+     * Consumer side: acquires the most recently published snapshot as front().
+     * @returns false if nothing was published since the last update.
+     */
+    bool update() {
+        if ((m_handover.load(std::memory_order_relaxed) & s_fresh) == 0) {
+            return false;
+        }
+        m_front = m_handover.exchange(m_front, std::memory_order_acq_rel) & s_indexMask;
+        return true;
+    }
+
+    /**
+     * @brief front
+     * Consumer side: @returns the snapshot acquired by the latest call to update().
+     */
+    const T& front() const { return m_buffers[m_front]; }
+
+private:
+    static constexpr unsigned s_indexMask = 0b011;
+    static constexpr unsigned s_fresh = 0b100;
+
+    std::array<T, 3> m_buffers;
+    unsigned m_back = 0;
+    unsigned m_front = 1;
+    std::atomic<unsigned> m_handover{2};
+};
+
+}  // namespace Ripes
@@ -1,6 +1,8 @@
 #include "stagetablemodel.h"
 
 #include "parser.h"
+#include "ripessettings.h"
+#include "selfprofiler.h"
 
 #include <vector>
 
@@ -13,17 +15,33 @@ static inline uint32_t indexToAddress(unsigned index) {
     return 0;
 }
 
-StageTableModel::StageTableModel(QObject* parent) : QAbstractTableModel(parent) {}
+StageTableModel::StageTableModel(QObject* parent) : QAbstractTableModel(parent) {
+    // Changes to the retention window are applied upon the next reset
+    reset();
+}
+
+int StageTableModel::rowForAddress(uint32_t address) const {
+    if (!ProcessorHandler::get()->isExecutableAddress(address)) {
+        return s_invalidRow;
+    }
+    return (address - ProcessorHandler::get()->getTextStart()) / ProcessorHandler::get()->currentISA()->bytes();
+}
 
 QVariant StageTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
     if (role != Qt::DisplayRole)
         return QVariant();
     if (orientation == Qt::Horizontal) {
         // Cycle number
-        return QString::number(section);
+        return QString::number(m_firstCycle + section);
     } else {
-        const auto addr = indexToAddress(section);
-        return ProcessorHandler::get()->parseInstrAt(addr);
+        if (m_rowHeaders.size() != static_cast<unsigned>(rowCount())) {
+            m_rowHeaders = std::vector<QString>(rowCount());
+        }
+        auto& header = m_rowHeaders.at(section);
+        if (header.isNull()) {
+            header = ProcessorHandler::get()->parseInstrAt(indexToAddress(section));
+        }
+        return header;
     }
 }
 
@@ -32,7 +50,7 @@ int StageTableModel::rowCount(const QModelIndex&) const {
 }
 
 int StageTableModel::columnCount(const QModelIndex&) const {
-    return m_cycleStageInfos.size();
+    return static_cast<int>(m_lastCycle - m_firstCycle + 1);
 }
 
 void StageTableModel::processorWasClocked() {
@@ -41,14 +59,47 @@ void StageTableModel::processorWasClocked() {
 
 void StageTableModel::reset() {
     beginResetModel();
-    m_cycleStageInfos.clear();
+    m_stages = ProcessorHandler::get()->getProcessor()->stageCount();
+    m_capacity = std::max(1U, RipesSettings::value(RIPES_SETTING_PIPELINEDIAGRAM_MAXCYCLES).toUInt());
+    m_firstCycle = 0;
+    m_lastCycle = -1;
+    m_rows = std::vector<int>(m_capacity * m_stages, s_invalidRow);
+    m_flags = std::vector<uint8_t>(m_capacity * m_stages, 0);
+    m_rowHeaders.clear();
     endResetModel();
 }
 
 void StageTableModel::gatherStageInfo() {
-    for (unsigned i = 0; i < ProcessorHandler::get()->getProcessor()->stageCount(); i++) {
-        m_cycleStageInfos[ProcessorHandler::get()->getProcessor()->getCycleCount()][i] =
-            ProcessorHandler::get()->getProcessor()->stageInfo(i);
+    RIPES_PROFILE_SCOPE(StageInfo);
+    const auto* proc = ProcessorHandler::get()->getProcessor();
+    if (proc->stageCount() != m_stages) {
+        // Processor was changed without the model being reset
+        reset();
+    }
+    const long long cycle = proc->getCycleCount();
+
+    if (cycle < m_firstCycle || cycle > m_lastCycle + 1) {
+        // Non-contiguous with the recorded history (ie. reversed past the retention window); restart the recording
+        m_firstCycle = cycle;
+    } else if (cycle - m_firstCycle >= m_capacity) {
+        // Retention window is full; drop the oldest cycle
+        m_firstCycle++;
+    }
+    // Reversing the processor discards any recorded cycles after the current cycle
+    m_lastCycle = cycle;
+
+    const size_t base = slot(cycle);
+    const bool hasPrev = cycle > m_firstCycle;
+    const size_t prevBase = hasPrev ? slot(cycle - 1) : 0;
+    for (unsigned i = 0; i < m_stages; i++) {
+        const auto stageInfo = proc->stageInfo(i);
+        m_rows[base + i] = rowForAddress(stageInfo.pc);
+        uint8_t flags = stageInfo.stage_valid ? Valid : 0;
+        if (stageInfo.stage_valid && hasPrev && (m_flags[prevBase + i] & Valid) &&
+            m_rows[prevBase + i] == m_rows[base + i]) {
+            flags |= Repeated;
+        }
+        m_flags[base + i] = flags;
     }
 }
 
@@ -63,23 +114,16 @@ QVariant StageTableModel::data(const QModelIndex& index, int role) const {
     if (role != Qt::DisplayRole)
         return QVariant();
 
-    if (!m_cycleStageInfos.count(index.column()))
+    const long long cycle = m_firstCycle + index.column();
+    if (cycle > m_lastCycle)
         return QVariant();
 
-    const uint32_t addr = indexToAddress(index.row());
-    const auto& stageInfo = m_cycleStageInfos.at(index.column());
-
+    const size_t base = slot(cycle);
     QStringList stagesForAddr;
-    for (const auto& si : stageInfo) {
-        if (si.second.pc == addr && si.second.stage_valid) {
-            if (m_cycleStageInfos.count(index.column() - 1)) {
-                const auto& prevCycleStageInfo = m_cycleStageInfos.at(index.column() - 1);
-                if (prevCycleStageInfo.at(si.first).stage_valid && prevCycleStageInfo.at(si.first).pc == si.second.pc) {
-                    stagesForAddr << "-";
-                    continue;
-                }
-            }
-            stagesForAddr << ProcessorHandler::get()->getProcessor()->stageName(si.first);
+    for (unsigned i = 0; i < m_stages; i++) {
+        if (m_rows[base + i] == index.row() && (m_flags[base + i] & Valid)) {
+            stagesForAddr << ((m_flags[base + i] & Repeated) ? QStringLiteral("-")
+                                                              : ProcessorHandler::get()->getProcessor()->stageName(i));
         }
     }
 
@@ -2,14 +2,23 @@
 
 #include <QAbstractTableModel>
 
+#include <vector>
+
 #include "processorhandler.h"
 
 namespace Ripes {
 
+/**
+ * @brief The StageTableModel class
+ * Model of the pipeline diagram: rows are the instructions of the program, columns are clock cycles.
+ * Stage occupancy is recorded in a columnar ring buffer which retains the most recent
+ * RIPES_SETTING_PIPELINEDIAGRAM_MAXCYCLES cycles. For each recorded cycle and stage, the instruction (row) index and
+ * the stage state is stored, along with whether the stage contains the same instruction as in the previous cycle.
+ * Looking up a cell is thus constant time wrt. the number of recorded cycles.
+ */
 class StageTableModel : public QAbstractTableModel {
     Q_OBJECT
 public:
-    enum Column { Breakpoint = 0, PC = 1, Stage = 2, Instruction = 3, NColumns };
     StageTableModel(QObject* parent = nullptr);
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
@@ -23,12 +32,37 @@ public slots:
     void reset();
 
 private:
+    /** Stage cell flags */
+    enum Flags : uint8_t { Valid = 0b1, Repeated = 0b10 };
+    static constexpr int s_invalidRow = -1;
+
     void gatherStageInfo();
 
     /**
-     * @brief m_cycleStageInfos
-     * map<cycle, map<stageId, stageInfo>>
+     * @brief slot
+     * @returns the index of the first stage cell of @p cycle within the ring buffer
+     */
+    size_t slot(long long cycle) const { return static_cast<size_t>(cycle % m_capacity) * m_stages; }
+    int rowForAddress(uint32_t address) const;
+
+    unsigned m_stages = 0;
+    long long m_capacity = 0;
+
+    /**
+     * @brief m_firstCycle/m_lastCycle
+     * The range of cycles currently recorded. The model is empty when m_lastCycle < m_firstCycle.
+     */
+    long long m_firstCycle = 0;
+    long long m_lastCycle = -1;
+
+    std::vector<int> m_rows;
+    std::vector<uint8_t> m_flags;
+
+    /**
+     * @brief m_rowHeaders
+     * Cache of the disassembled instruction of each row. The cache is invalidated when the model is reset, ie. when
+     * the program or processor changes.
      */
-    std::map<long long, std::map<unsigned, StageInfo>> m_cycleStageInfos;
+    mutable std::vector<QString> m_rowHeaders;
 };
 }  // namespace Ripes
@@ -8,7 +8,7 @@
 
 namespace Ripes {
 
-SymbolNavigator::SymbolNavigator(const AddrOffsetMap& symbolmap, QWidget* parent)
+SymbolNavigator::SymbolNavigator(const std::vector<ProgramIndex::Symbol>& symbols, QWidget* parent)
     : QDialog(parent), m_ui(new Ui::SymbolNavigator) {
     m_ui->setupUi(this);
 
@@ -22,12 +22,8 @@ SymbolNavigator::SymbolNavigator(const AddrOffsetMap& symbolmap, QWidget* parent
     m_ui->symbolTable->horizontalHeader()->setStretchLastSection(true);
     m_ui->buttonBox->button(QDialogButtonBox::Ok)->setText("Go to symbol");
 
-    for (const auto& iter : symbolmap) {
-        if (!iter.second.second.isEmpty()) {
-            const long address = (iter.first - iter.second.first) * ProcessorHandler::get()->currentISA()->bytes() +
-                                 ProcessorHandler::get()->getTextStart();
-            addSymbol(address, iter.second.second);
-        }
+    for (const auto& symbol : symbols) {
+        addSymbol(symbol.address, symbol.name);
     }
     m_ui->symbolTable->selectRow(0);
 }
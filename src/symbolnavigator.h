@@ -14,7 +14,7 @@ class SymbolNavigator : public QDialog {
     Q_OBJECT
 
 public:
-    SymbolNavigator(const AddrOffsetMap& symbolmap, QWidget* parent = nullptr);
+    SymbolNavigator(const std::vector<ProgramIndex::Symbol>& symbols, QWidget* parent = nullptr);
     ~SymbolNavigator();
 
     long getSelectedSymbolAddress() const;
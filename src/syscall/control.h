@@ -46,12 +46,15 @@ public:
               "brk",
               "Change the location of the program break, which defines the end of the process's data segment (i.e., "
               "the program break is the first location after the end of the uninitialized data segment).",
-              {{0, "sets the end of the data segment to the specified address"}},
-              {{0, "On success, brk() returns zero.  On error, -1 is returned, and errno is set to ENOMEM"}}) {}
+              {{0, "the requested end of the data segment, or 0 to query the current program break"}},
+              {{0, "the new program break on success. On error, the current program break is returned"}}) {}
 
     void execute() {
-        // Nothing to do
-        return;
+        // As with the Linux system call (not the libc wrapper), an invalid request leaves the break unchanged, which the
+        // caller detects by the returned break differing from the requested one.
+        auto* handler = ProcessorHandler::get();
+        handler->setProgramBreak(BaseSyscall::getArg(0));
+        BaseSyscall::setRet(0, handler->getProgramBreak());
     }
 };
 
@@ -8,6 +8,9 @@
 
 namespace Ripes {
 
+/** Paths without a null terminator within the PATH_MAX of Linux are rejected */
+static constexpr uint32_t s_maxPathLength = 4096;
+
 template <typename BaseSyscall>
 class OpenSyscall : public BaseSyscall {
     static_assert(std::is_base_of<Syscall, BaseSyscall>::value);
@@ -20,20 +23,49 @@ public:
     void execute() {
         const uint32_t arg0 = BaseSyscall::getArg(0);
         const uint32_t arg1 = BaseSyscall::getArg(1);
-        QByteArray string;
-        char byte;
-        unsigned int address = arg0;
-        do {
-            byte = static_cast<char>(ProcessorHandler::get()->getMemory().readMemConst(address++, 1) & 0xFF);
-            string.append(byte);
-        } while (byte != '\0');
+        QByteArray path;
+        if (!ProcessorHandler::get()->readCString(arg0, path, s_maxPathLength)) {
+            BaseSyscall::setRet(0, -1);
+            return;
+        }
 
-        int ret = SystemIO::openFile(QString::fromUtf8(string), arg1);
+        int ret = SystemIO::openFile(QString::fromUtf8(path), arg1);
 
         BaseSyscall::setRet(0, ret);
     }
 };
 
+template <typename BaseSyscall>
+class OpenAtSyscall : public BaseSyscall {
+    static_assert(std::is_base_of<Syscall, BaseSyscall>::value);
+
+public:
+    OpenAtSyscall()
+        : BaseSyscall("OpenAt", "Opens a file from a path, relative to the current working directory",
+                      {{0, "the directory file descriptor; only AT_FDCWD (-100) is supported for relative paths"},
+                       {1, "Pointer to null terminated string for the path"},
+                       {2, "flags"}},
+                      {{0, "the file decriptor or -1 if an error occurred"}}) {}
+    void execute() {
+        const int dirfd = BaseSyscall::getArg(0);
+        QByteArray pathBytes;
+        if (!ProcessorHandler::get()->readCString(BaseSyscall::getArg(1), pathBytes, s_maxPathLength)) {
+            BaseSyscall::setRet(0, -1);
+            return;
+        }
+        const QString path = QString::fromUtf8(pathBytes);
+
+        if (dirfd != s_atFdCwd && QDir::isRelativePath(path)) {
+            BaseSyscall::setRet(0, -1);
+            return;
+        }
+        BaseSyscall::setRet(0, SystemIO::openFile(path, BaseSyscall::getArg(2)));
+    }
+
+private:
+    static constexpr int s_atFdCwd = -100;
+};
+
 template <typename BaseSyscall>
 class CloseSyscall : public BaseSyscall {
     static_assert(std::is_base_of<Syscall, BaseSyscall>::value);
@@ -74,22 +106,21 @@ public:
               "Read", "Read from a file descriptor into a buffer",
               {{0, "the file descriptor"}, {1, "address of the buffer"}, {2, "maximum number of bytes to read"}},
               {{0, "number of read bytes or -1 if an error occurred"}}) {}
+    // Reading from stdin blocks until the user has provided input
+    SyscallContext context() const override { return SyscallContext::Blocking; }
     void execute() {
         const int fd = BaseSyscall::getArg(0);
-        int byteAddress = BaseSyscall::getArg(1);  // destination of characters read from file
+        const uint32_t byteAddress = BaseSyscall::getArg(1);  // destination of bytes read from file
         const int length = BaseSyscall::getArg(2);
         QByteArray buffer;
 
-        int retLength = SystemIO::readFromFile(fd, buffer, length);
+        const int retLength = SystemIO::readFromFile(fd, buffer, length);
         BaseSyscall::setRet(0, retLength);
 
-        if (retLength != -1) {
-            // copy bytes from returned buffer into memory
-            const char* dataptr = buffer.constData();  // QString::data contains a possible null termination '\0'
-                                                       // character (present if reading from stdin and not from a file)
-            while (retLength-- > 0) {
-                ProcessorHandler::get()->writeMem(byteAddress++, *dataptr++, sizeof(char));
-            }
+        if (retLength > 0) {
+            // copy bytes from returned buffer into memory. Reads from stdin may return more than the requested number
+            // of bytes, which are truncated.
+            ProcessorHandler::get()->writeMemBlock(byteAddress, buffer.left(retLength));
         }
     }
 };
@@ -104,21 +135,15 @@ public:
                       {{0, "the file descriptor"}, {1, "address of the buffer"}, {2, "number of bytes to write"}},
                       {{0, "the number of bytes written"}}) {}
     void execute() {
-        const int byteAddress = BaseSyscall::getArg(1);  // source of characters to write to file
-        const int reqLength = BaseSyscall::getArg(2);    // user-requested length
+        const uint32_t byteAddress = BaseSyscall::getArg(1);  // source of bytes to write to file
+        const int reqLength = BaseSyscall::getArg(2);         // user-requested length
         if (reqLength < 0) {
             BaseSyscall::setRet(0, -1);
             return;
         }
-        int index = 0;
-        QString myBuffer;
-
-        do {
-            myBuffer.append(
-                static_cast<char>(ProcessorHandler::get()->getMemory().readMemConst(byteAddress + index++, 1) & 0xFF));
-        } while (index < reqLength);
+        const QByteArray myBuffer = ProcessorHandler::get()->readMemBlock(byteAddress, reqLength);
 
-        const int retValue = SystemIO::writeToFile(BaseSyscall::getArg(0), myBuffer, reqLength);
+        const int retValue = SystemIO::writeToFile(BaseSyscall::getArg(0), myBuffer);
         BaseSyscall::setRet(0, retValue);
     }
 };
@@ -133,11 +158,10 @@ public:
                       {{0, "the buffer to write into"}, {1, "the length of the buffer"}},
                       {{0, "-1 if the path is longer than the buffer"}}) {}
     void execute() {
-        const int byteAddress = BaseSyscall::getArg(0);  // destination of characters read from file
-        int index = 0;
+        const uint32_t byteAddress = BaseSyscall::getArg(0);  // destination of the path
         const int bufferSize = BaseSyscall::getArg(1);
 
-        const QString pwd = QDir::currentPath();
+        QByteArray pwd = QDir::currentPath().toUtf8();
 
         if (pwd.length() > bufferSize) {
             BaseSyscall::setRet(0, -1);
@@ -146,10 +170,11 @@ public:
             BaseSyscall::setRet(0, pwd.length());
         }
 
-        // copy bytes from returned buffer into memory
-        while (index < pwd.length()) {
-            ProcessorHandler::get()->writeMem(byteAddress, pwd.at(index++).toLatin1(), sizeof(char));
+        // copy the path into memory, null-terminated if the buffer has room for it
+        if (pwd.length() < bufferSize) {
+            pwd.append('\0');
         }
+        ProcessorHandler::get()->writeMemBlock(byteAddress, pwd);
     }
 };
 
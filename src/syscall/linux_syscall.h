@@ -0,0 +1,53 @@
+#pragma once
+
+#include "riscv_syscall.h"
+
+namespace Ripes {
+
+/**
+ * @brief The LinuxSyscallManager class
+ * System calls following the RISC-V Linux numbering, as emitted by newlib (libgloss) for executables compiled with a
+ * stock riscv*-unknown-elf toolchain. Arguments are passed in a0-a5, the system call number in a7, and the result is
+ * returned in a0; the argument passing of RISCVSyscall is therefore reused.
+ */
+class LinuxSyscallManager : public SyscallManagerT<RISCVSyscall> {
+public:
+    enum SysCall {
+        GetCWD = 17,
+        OpenAt = 56,
+        Close = 57,
+        LSeek = 62,
+        Read = 63,
+        Write = 64,
+        FStat = 80,
+        Exit = 93,
+        ExitGroup = 94,
+        Times = 153,
+        GetTimeOfDay = 169,
+        Brk = 214,
+        Open = 1024
+    };
+
+    LinuxSyscallManager() {
+        // Control syscalls
+        emplace<Exit2Syscall<RISCVSyscall>>(Exit);
+        emplace<Exit2Syscall<RISCVSyscall>>(ExitGroup);
+        emplace<BrkSyscall<RISCVSyscall>>(Brk);
+
+        // File syscalls
+        emplace<OpenSyscall<RISCVSyscall>>(Open);
+        emplace<OpenAtSyscall<RISCVSyscall>>(OpenAt);
+        emplace<CloseSyscall<RISCVSyscall>>(Close);
+        emplace<LSeekSyscall<RISCVSyscall>>(LSeek);
+        emplace<ReadSyscall<RISCVSyscall>>(Read);
+        emplace<WriteSyscall<RISCVSyscall>>(Write);
+        emplace<GetCWDSyscall<RISCVSyscall>>(GetCWD);
+        emplace<FStatSyscall<RISCVSyscall>>(FStat);
+
+        // Time syscalls
+        emplace<TimesSyscall<RISCVSyscall>>(Times);
+        emplace<GetTimeOfDaySyscall<RISCVSyscall>>(GetTimeOfDay);
+    }
+};
+
+}  // namespace Ripes
@@ -41,13 +41,9 @@ public:
     PrintStrSyscall() : BaseSyscall("PrintString", "Prints a null-terminated string", {{0, "address of the string"}}) {}
     void execute() {
         const uint32_t arg0 = BaseSyscall::getArg(0);
+        // A string without a null terminator is printed up to the read bound
         QByteArray string;
-        char byte;
-        unsigned int address = arg0;
-        do {
-            byte = static_cast<char>(ProcessorHandler::get()->getMemory().readMemConst(address++) & 0xFF);
-            string.append(byte);
-        } while (byte != '\0');
+        ProcessorHandler::get()->readCString(arg0, string);
         SystemIO::printString(QString::fromUtf8(string));
     }
 };
@@ -17,9 +17,16 @@ bool SyscallManager::execute(int id) {
         return false;
     } else {
         const auto& syscall = m_syscalls.at(id);
-        SyscallStatusManager::setStatus("Handling system call: " + syscall->name() + " (" + QString::number(id) + ")");
+        // Inline syscalls complete immediately; posting status messages for them would only add overhead to each ecall
+        const bool showStatus = syscall->context() != SyscallContext::Inline;
+        if (showStatus) {
+            SyscallStatusManager::setStatus("Handling system call: " + syscall->name() + " (" + QString::number(id) +
+                                            ")");
+        }
         syscall->execute();
-        SyscallStatusManager::clearStatus();
+        if (showStatus) {
+            SyscallStatusManager::clearStatus();
+        }
         return true;
     }
 }
@@ -15,6 +15,19 @@
 
 namespace Ripes {
 
+/**
+ * @brief The SyscallContext enum
+ * Classifies where a system call must be executed.
+ */
+enum class SyscallContext {
+    /** May be executed inline on the thread which trapped, ie. the simulation thread */
+    Inline,
+    /** May block, ie. while waiting for input, and is therefore executed on a separate thread */
+    Blocking,
+    /** Requires interaction with the GUI thread, and is therefore executed on a separate thread */
+    GUI
+};
+
 /**
  * @brief The Syscall class
  * Base class for all system calls. Must be specialized by an ISA/ABI specific system call class. This class shall
@@ -37,6 +50,13 @@ public:
 
     virtual void execute() = 0;
 
+    /**
+     * @brief context
+     * @returns the context in which the system call must be executed. Most system calls do not block, and do not
+     * interact with the GUI other than through queued signals (ie. SystemIO::printString), so this defaults to Inline.
+     */
+    virtual SyscallContext context() const { return SyscallContext::Inline; }
+
     /**
      * @brief getArg
      * ABI/ISA specific specialization of returning an argument register value.
@@ -79,6 +99,16 @@ public:
      */
     bool execute(int id);
 
+    /**
+     * @brief context
+     * @returns the context in which syscall @p id must be executed. Unknown syscalls are reported through the GUI
+     * thread.
+     */
+    SyscallContext context(int id) const {
+        const auto it = m_syscalls.find(id);
+        return it == m_syscalls.end() ? SyscallContext::GUI : it->second->context();
+    }
+
     const std::map<int, std::unique_ptr<Syscall>>& getSyscalls() const { return m_syscalls; }
 
 protected:
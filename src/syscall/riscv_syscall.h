@@ -38,31 +38,31 @@ class RISCVSyscallManager : public SyscallManagerT<RISCVSyscall> {
 public:
     RISCVSyscallManager() {
         // Print syscalls
-        emplace<PrintIntSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::PrintInt);
-        emplace<PrintFloatSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::PrintFloat);
-        emplace<PrintStrSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::PrintStr);
-        emplace<PrintCharSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::PrintChar);
-        emplace<PrintHexSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::PrintIntHex);
-        emplace<PrintBinarySyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::PrintIntBinary);
-        emplace<PrintUnsignedSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::PrintIntUnsigned);
+        emplace<PrintIntSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::PrintInt);
+        emplace<PrintFloatSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::PrintFloat);
+        emplace<PrintStrSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::PrintStr);
+        emplace<PrintCharSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::PrintChar);
+        emplace<PrintHexSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::PrintIntHex);
+        emplace<PrintBinarySyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::PrintIntBinary);
+        emplace<PrintUnsignedSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::PrintIntUnsigned);
 
         // Control syscalls
-        emplace<ExitSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::Exit);
-        emplace<Exit2Syscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::Exit2);
-        emplace<BrkSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::brk);
+        emplace<ExitSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::Exit);
+        emplace<Exit2Syscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::Exit2);
+        emplace<BrkSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::brk);
 
         // File syscalls
-        emplace<CloseSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::Close);
-        emplace<LSeekSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::LSeek);
-        emplace<ReadSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::Read);
-        emplace<OpenSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::Open);
-        emplace<WriteSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::Write);
-        emplace<GetCWDSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::GetCWD);
-        emplace<FStatSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::FStat);
+        emplace<CloseSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::Close);
+        emplace<LSeekSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::LSeek);
+        emplace<ReadSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::Read);
+        emplace<OpenSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::Open);
+        emplace<WriteSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::Write);
+        emplace<GetCWDSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::GetCWD);
+        emplace<FStatSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::FStat);
 
         // Time syscalls
-        emplace<CyclesSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::Cycles);
-        emplace<TimeMsSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IM>::TimeMs);
+        emplace<CyclesSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::Cycles);
+        emplace<TimeMsSyscall<RISCVSyscall>>(ISAInfo<ISA::RV32IMA>::TimeMs);
     }
 };
 
@@ -40,4 +40,49 @@ public:
     }
 };
 
+template <typename BaseSyscall>
+class GetTimeOfDaySyscall : public BaseSyscall {
+    static_assert(std::is_base_of<Syscall, BaseSyscall>::value);
+
+public:
+    GetTimeOfDaySyscall()
+        : BaseSyscall("gettimeofday", "Get the current time since epoch",
+                      {{0, "pointer to a struct timeval {int64_t tv_sec; int32_t tv_usec;} to write the time into"}},
+                      {{0, "0 on success"}}) {}
+    void execute() {
+        const uint32_t address = BaseSyscall::getArg(0);
+        const long long us = QDateTime::currentMSecsSinceEpoch() * 1000;
+        const long long sec = us / 1000000;
+        ProcessorHandler::get()->writeMem(address, sec & 0xFFFFFFFF, sizeof(uint32_t));
+        ProcessorHandler::get()->writeMem(address + 4, (sec >> 32) & 0xFFFFFFFF, sizeof(uint32_t));
+        ProcessorHandler::get()->writeMem(address + 8, us % 1000000, sizeof(uint32_t));
+        BaseSyscall::setRet(0, 0);
+    }
+};
+
+template <typename BaseSyscall>
+class TimesSyscall : public BaseSyscall {
+    static_assert(std::is_base_of<Syscall, BaseSyscall>::value);
+
+public:
+    TimesSyscall()
+        : BaseSyscall("times",
+                      "Get process times. Time is measured in processor cycles, such that clock() reports the number of "
+                      "cycles executed by the program",
+                      {{0, "pointer to a struct tms {clock_t tms_utime, tms_stime, tms_cutime, tms_cstime;}"}},
+                      {{0, "the number of cycles elapsed since program start"}}) {}
+    void execute() {
+        const uint32_t address = BaseSyscall::getArg(0);
+        const uint32_t cycles = ProcessorHandler::get()->getProcessor()->getCycleCount() & 0xFFFFFFFF;
+        if (address != 0) {
+            // All time is accounted as user time
+            ProcessorHandler::get()->writeMem(address, cycles, sizeof(uint32_t));
+            for (unsigned i = 1; i < 4; i++) {
+                ProcessorHandler::get()->writeMem(address + i * 4, 0, sizeof(uint32_t));
+            }
+        }
+        BaseSyscall::setRet(0, cycles);
+    }
+};
+
 }  // namespace Ripes
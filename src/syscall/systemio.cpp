@@ -1,14 +1,129 @@
 #include "systemio.h"
 
+#include <QTextCodec>
+
+#include <thread>
+
 namespace Ripes {
 QString SystemIO::s_fileErrorString;
 
 std::map<int, QString> SystemIO::FileIOData::fileNames;
 std::map<int, unsigned> SystemIO::FileIOData::fileFlags;
-std::map<int, QTextStream> SystemIO::FileIOData::streams;
 std::map<int, QFile> SystemIO::FileIOData::files;
+std::map<int, QString> SystemIO::FileIOData::stdioRedirects;
 QByteArray SystemIO::FileIOData::s_stdinBuffer;
+bool SystemIO::FileIOData::s_stdinEOF = false;
+unsigned SystemIO::FileIOData::s_stdinGeneration = 0;
+bool SystemIO::FileIOData::s_stdinReaderStarted = false;
 QMutex SystemIO::FileIOData::s_stdioMutex;
 QWaitCondition SystemIO::FileIOData::s_stdinBufferEmpty;
+QWaitCondition SystemIO::FileIOData::s_stdinBufferDrained;
 bool SystemIO::s_abortSyscall = false;
+
+SystemIO::SystemIO() {
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(s_outputFlushInterval);
+    connect(&m_flushTimer, &QTimer::timeout, this, &SystemIO::flushOutput);
+    FileIOData::resetFiles();
+}
+
+void SystemIO::reset() {
+    FileIOData::resetFiles();
+
+    auto& sio = get();
+    QMutexLocker locker(&sio.m_outputMutex);
+    sio.m_outputBuffer.clear();
+    sio.m_outputDecoders.clear();
+}
+
+void SystemIO::printString(const QString& string) {
+    auto& sio = get();
+    QMutexLocker locker(&sio.m_outputMutex);
+    sio.appendOutput(string);
+}
+
+void SystemIO::printBytes(int fd, const QByteArray& bytes) {
+    auto& sio = get();
+    QMutexLocker locker(&sio.m_outputMutex);
+    auto& decoder = sio.m_outputDecoders[fd];
+    if (!decoder) {
+        decoder = std::make_unique<QTextDecoder>(QTextCodec::codecForName("UTF-8"));
+    }
+    sio.appendOutput(decoder->toUnicode(bytes));
+}
+
+void SystemIO::appendOutput(const QString& string) {
+    m_outputBuffer.append(string);
+    if (m_outputBuffer.size() > s_maxBufferedOutput) {
+        m_outputBuffer.remove(0, m_outputBuffer.size() - s_maxBufferedOutput);
+    }
+
+    if (!m_flushPending) {
+        // The flush timer lives in the GUI thread, and must be started from there
+        m_flushPending = true;
+        QMetaObject::invokeMethod(
+            this, [this] { m_flushTimer.start(); }, Qt::QueuedConnection);
+    }
+}
+
+void SystemIO::flushOutput() {
+    QString output;
+    {
+        QMutexLocker locker(&m_outputMutex);
+        output.swap(m_outputBuffer);
+        m_flushPending = false;
+    }
+    if (!output.isEmpty()) {
+        emit doPrint(output);
+    }
+}
+
+void SystemIO::startStdinReader() {
+    FileIOData::s_stdinReaderStarted = true;
+    const unsigned generation = FileIOData::s_stdinGeneration;
+    const QString source = FileIOData::stdioRedirects[STDIN];
+
+    // A detached thread is used, given that a read from an idle named pipe may block indefinitely; a stale reader is
+    // left to finish on its own once stdio has been reset.
+    std::thread([source, generation] {
+        QFile file(source);
+        const bool opened = file.open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+        bool eof = !opened;
+        while (true) {
+            QByteArray chunk;
+            if (!eof) {
+                {
+                    // Pause reading while the buffer is full, until the program has consumed some of it
+                    QMutexLocker locker(&FileIOData::s_stdioMutex);
+                    while (generation == FileIOData::s_stdinGeneration &&
+                           FileIOData::s_stdinBuffer.size() >= s_maxBufferedStdin) {
+                        FileIOData::s_stdinBufferDrained.wait(&FileIOData::s_stdioMutex);
+                    }
+                    if (generation != FileIOData::s_stdinGeneration) {
+                        return;
+                    }
+                }
+                // Regular files are read in large chunks. Reads from a pipe return upon each line, such that the
+                // program is woken as soon as input is available rather than when a full chunk has been received.
+                chunk = file.isSequential() ? file.readLine(s_stdinChunkSize) : file.read(s_stdinChunkSize);
+                eof = chunk.isEmpty();
+            }
+
+            QMutexLocker locker(&FileIOData::s_stdioMutex);
+            if (generation != FileIOData::s_stdinGeneration) {
+                return;
+            }
+            if (!opened) {
+                s_fileErrorString = "Could not open " + source + " for reading: " + file.errorString();
+            }
+            FileIOData::s_stdinBuffer.append(chunk);
+            FileIOData::s_stdinEOF = eof;
+            FileIOData::s_stdinBufferEmpty.wakeAll();
+            if (eof) {
+                return;
+            }
+        }
+    }).detach();
+}
+
 }  // namespace Ripes
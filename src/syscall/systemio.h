@@ -7,12 +7,15 @@
 #include <QMutex>
 #include <QObject>
 #include <QTemporaryFile>
-#include <QTextStream>
+#include <QTextDecoder>
+#include <QTimer>
 #include <QWaitCondition>
 
 #include <sys/stat.h>
+#include <memory>
 #include <stdexcept>
 
+#include "ripessettings.h"
 #include "statusmanager.h"
 
 namespace Ripes {
@@ -66,7 +69,7 @@ private:
     // String used for description of file error
     static QString s_fileErrorString;  // = ("File operation OK");
 
-    // Flag used for aborting waiting for I/O
+    // Flag used for aborting waiting for I/O. Guarded by FileIOData::s_stdioMutex.
     static bool s_abortSyscall;
 
     // Standard I/O Channels
@@ -77,6 +80,7 @@ private:
     // Maximum number of files that can be open
     static constexpr int SYSCALL_MAXFILES = 32;
 
+    static constexpr int ACCESS_MODE_MASK = 0x00000003;
     static constexpr int O_RDONLY = 0x00000000;
     static constexpr int O_WRONLY = 0x00000001;
     static constexpr int O_RDWR = 0x00000002;
@@ -93,20 +97,28 @@ private:
         static std::map<int, QString> fileNames;
         // The flags of this file, 0=READ, 1=WRITE. Invalid if this file descriptor is not in use.
         static std::map<int, unsigned> fileFlags;
-        // The streams in use, associated with the filenames
-        static std::map<int, QTextStream> streams;
-        // The file pointers in use
+        // The file pointers in use. Files are accessed in binary mode. STDOUT and STDERR have a file when redirected.
         static std::map<int, QFile> files;
-        // QByteArray to use as a stdin buffer
+        // Host files or named pipes which STDIN, STDOUT and STDERR are redirected to. Empty if using the console.
+        static std::map<int, QString> stdioRedirects;
+        // Buffer of stdin data which has not yet been read by the program
         static QByteArray s_stdinBuffer;
+        // Set when a redirected stdin source has reached its end
+        static bool s_stdinEOF;
+        // Incremented whenever stdio is reset, such that a stale stdin reader discards its data
+        static unsigned s_stdinGeneration;
+        static bool s_stdinReaderStarted;
 
         /**
          * @brief s_stdioMutex
          * Used for implementing the waitCondition between the producer/consumer scenario where ecall handling is
-         * blocking while waiting for the stdinBuffer to be non-empty.
+         * blocking while waiting for the stdinBuffer to be non-empty. The producers (console input, the stdin reader of
+         * a redirected stdin and syscall aborts) wake the consumer; no polling is involved. Likewise, the consumer wakes
+         * the stdin reader through s_stdinBufferDrained once it has consumed data from a full buffer.
          */
         static QMutex s_stdioMutex;
         static QWaitCondition s_stdinBufferEmpty;
+        static QWaitCondition s_stdinBufferDrained;
 
         // Reset all file information. Closes any open files and resets the arrays
         static void resetFiles() {
@@ -124,32 +136,77 @@ private:
             fileFlags[STDOUT] = SystemIO::O_WRONLY;
             fileFlags[STDERR] = SystemIO::O_WRONLY;
 
-            if (streams.count(STDIN) == 0) {
-                // stdin stream has not yet been created
-                streams.emplace(STDIN, &s_stdinBuffer);
-            } else {
-                // Clear stdin stream and reset stream
+            {
+                QMutexLocker locker(&s_stdioMutex);
                 s_stdinBuffer.clear();
-                auto success = streams[STDIN].seek(0);
-                Q_ASSERT(success);
+                s_stdinEOF = false;
+                s_stdinGeneration++;
+                s_stdinReaderStarted = false;
+            }
+            // Wake a stdin reader waiting for the buffer to drain, such that it observes the reset and finishes
+            s_stdinBufferDrained.wakeAll();
+
+            // Redirection targets are opened upon first use, given that opening a named pipe blocks until its other
+            // end is opened. Non-redirected stdout/stderr are handled via. signal/slots internally in the application.
+            files.erase(STDOUT);
+            files.erase(STDERR);
+            stdioRedirects.clear();
+            const std::map<int, const char*> redirectSettings = {{STDIN, RIPES_SETTING_STDIN_REDIRECT},
+                                                                 {STDOUT, RIPES_SETTING_STDOUT_REDIRECT},
+                                                                 {STDERR, RIPES_SETTING_STDERR_REDIRECT}};
+            for (const auto& [fd, setting] : redirectSettings) {
+                const QString path = RipesSettings::value(setting).toString();
+                if (!path.isEmpty()) {
+                    stdioRedirects[fd] = path;
+                }
             }
+        }
 
-            // stdout/stderr will be handled via. signal/slots internally in the application
-            // streams.emplace(STDOUT, stdout);
-            // streams.emplace(STDERR, stderr);
+        /**
+         * @brief writeRedirected
+         * Writes @p data to the host file which @p fd (STDOUT or STDERR) is redirected to. If both are redirected to
+         * the same file, they share a single file handle.
+         * @return number of bytes written, or -1 on error
+         */
+        static int writeRedirected(int fd, const QByteArray& data) {
+            if (fd == STDERR && stdioRedirects.count(STDOUT) && stdioRedirects[STDOUT] == stdioRedirects[STDERR]) {
+                fd = STDOUT;
+            }
+            auto& file = files[fd];
+            if (!file.isOpen()) {
+                file.setFileName(stdioRedirects[fd]);
+                if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                    s_fileErrorString = "Could not open " + stdioRedirects[fd] + " for writing: " + file.errorString();
+                    return -1;
+                }
+            }
+            const int written = static_cast<int>(file.write(data));
+            // Flushed upon every write, such that the output is visible to a reader of the file while the program runs
+            file.flush();
+            return written;
         }
 
-        // Open a file stream assigned to the given file descriptor
+        // Open a file assigned to the given file descriptor
         static void openFilestream(int fd, const QString& filename) {
             auto file = files.emplace(fd, filename);
 
             const auto flags = fileFlags[fd];
-            const auto qtOpenFlags =  // Translate from stdlib file flags to Qt flags
-                (flags & O_RDONLY ? QIODevice::ReadOnly : QIODevice::NotOpen) |
-                (flags & O_WRONLY ? QIODevice::WriteOnly : QIODevice::NotOpen) |
-                (flags & O_RDWR ? QIODevice::ReadWrite : QIODevice::NotOpen) |
-                (flags & O_TRUNC ? QIODevice::Truncate : QIODevice::Append) |
-                (flags & O_EXCL ? QIODevice::NewOnly : QIODevice::NotOpen);
+            // Translate from stdlib file flags to Qt flags. Files are opened in binary mode (no QIODevice::Text).
+            QIODevice::OpenMode qtOpenFlags;
+            switch (flags & ACCESS_MODE_MASK) {
+                case O_WRONLY:
+                    qtOpenFlags = QIODevice::WriteOnly;
+                    break;
+                case O_RDWR:
+                    qtOpenFlags = QIODevice::ReadWrite;
+                    break;
+                default:
+                    qtOpenFlags = QIODevice::ReadOnly;
+                    break;
+            }
+            qtOpenFlags |= (flags & O_APPEND ? QIODevice::Append : QIODevice::NotOpen) |
+                           (flags & O_TRUNC ? QIODevice::Truncate : QIODevice::NotOpen) |
+                           (flags & O_EXCL ? QIODevice::NewOnly : QIODevice::NotOpen);
 
             // Try to open file with the given flags
             files[fd].open(qtOpenFlags);
@@ -168,13 +225,8 @@ private:
                 files.erase(fd);
                 throw std::runtime_error("File could not be opened");
             }
-
-            streams.emplace(fd, &files[fd]);
         }
 
-        // Retrieve a stream for use
-        static QTextStream& getStreamInUse(int fd) { return streams[fd]; }
-
         // Determine whether a given filename is already in use.
         static bool filenameInUse(const QString& requestedFilename) {
             for (int i = 0; i < SYSCALL_MAXFILES; i++) {
@@ -206,7 +258,6 @@ private:
 
             fileFlags[fd] = -1;
             files[fd].close();
-            streams.erase(fd);
             files.erase(fd);
             fileNames.erase(fd);
         }
@@ -265,8 +316,9 @@ public:
 
         try {
             FileIOData::openFilestream(fdToUse, filename);
-        } catch (int) {
-            s_fileErrorString = "File " + filename + " could not be opened.";
+        } catch (const std::runtime_error& e) {
+            s_fileErrorString = "File " + filename + " could not be opened: " + e.what();
+            FileIOData::close(fdToUse);
             retValue = -1;
         }
 
@@ -288,14 +340,14 @@ public:
             s_fileErrorString = "File descriptor " + QString::number(fd) + " is not open for reading";
             return -1;
         }
-        if (fd < 0 || fd >= SYSCALL_MAXFILES)
+        if (fd < STDIO_END || fd >= SYSCALL_MAXFILES)
             return -1;
-        auto& stream = FileIOData::getStreamInUse(fd);
+        auto& file = FileIOData::files[fd];
 
         if (base == SEEK_SET) {
             offset += 0;
         } else if (base == SEEK_CUR) {
-            offset += stream.pos();
+            offset += file.pos();
         } else if (base == SEEK_END) {
             offset += FileIOData::files[fd].size();
         } else {
@@ -304,7 +356,7 @@ public:
         if (offset < 0) {
             return -1;
         }
-        stream.seek(offset);
+        file.seek(offset);
         return offset;
     }
 
@@ -312,13 +364,12 @@ public:
      * Read bytes from file.
      *
      * @param fd              file descriptor
-     * @param myBuffer        QString to contain bytes read
+     * @param myBuffer        QByteArray to contain bytes read
      * @param lengthRequested number of bytes to read
      * @return number of bytes read, 0 on EOF, or -1 on error
      */
     static int readFromFile(int fd, QByteArray& myBuffer, int lengthRequested) {
         SystemIO::get();  // Ensure that SystemIO is constructed
-        int retValue = -1;
         /////////////// DPS 8-Jan-2013  //////////////////////////////////////////////////
         /// Read from STDIN file descriptor while using IDE - get input from Messages pane.
         if (!FileIOData::fdInUse(fd, O_RDONLY))  // Check the existence of the "read" fd
@@ -326,45 +377,36 @@ public:
             s_fileErrorString = "File descriptor " + QString::number(fd) + " is not open for reading";
             return -1;
         }
-        // retrieve FileInputStream from storage
-        auto& InputStream = FileIOData::getStreamInUse(fd);
-
         if (fd == STDIN) {
-            SystemIOStatusManager::setStatus("Waiting for user input...");
-            while (myBuffer.size() == 0) {
-                // Lock the stdio objects and try to read from stdio. If no data is present, wait until so.
-                FileIOData::s_stdioMutex.lock();
-                while (myBuffer.size() == 0) {
-                    /** We spin on a wait condition with a timeout. The timeout is required to ensure that we may
-                     * observe any abort flags (ie. if execution is stopped while waiting for IO */
-                    const bool dataInStdinStrm = FileIOData::s_stdinBufferEmpty.wait(&FileIOData::s_stdioMutex, 100);
-                    if (s_abortSyscall) {
-                        FileIOData::s_stdioMutex.unlock();
-                        s_abortSyscall = false;
-                        SystemIOStatusManager::clearStatus();
-                        return -1;
-                    }
-                    if (dataInStdinStrm) {
-                        myBuffer = InputStream.read(lengthRequested).toUtf8();
-                    }
-                }
-                FileIOData::s_stdioMutex.unlock();
+            // Lock the stdio objects and try to read from stdin. If no data is present, wait until data arrives, the
+            // end of a redirected stdin is reached, or the syscall is aborted (ie. execution is stopped).
+            QMutexLocker locker(&FileIOData::s_stdioMutex);
+            if (FileIOData::stdioRedirects.count(STDIN) && !FileIOData::s_stdinReaderStarted) {
+                startStdinReader();
             }
-        } else {
-            // Reads up to lengthRequested bytes of data from this Input stream into an array of bytes.
-            myBuffer = InputStream.read(lengthRequested).toUtf8();
-        }
-
-        if (myBuffer.size() == 0) {
-            if (fd == STDIN) {
-                Q_ASSERT(false);  // EOF should never be possible for STDIN
-            } else {
-                // End of file - write EOF file character into buffer
-                myBuffer.append(sizeof(int), EOF);
+            const bool waiting = FileIOData::s_stdinBuffer.isEmpty() && !FileIOData::s_stdinEOF;
+            if (waiting) {
+                SystemIOStatusManager::setStatus("Waiting for user input...");
             }
+            while (FileIOData::s_stdinBuffer.isEmpty() && !FileIOData::s_stdinEOF && !s_abortSyscall) {
+                FileIOData::s_stdinBufferEmpty.wait(&FileIOData::s_stdioMutex);
+            }
+            if (waiting) {
+                SystemIOStatusManager::clearStatus();
+            }
+            if (FileIOData::s_stdinBuffer.isEmpty() && s_abortSyscall) {
+                s_abortSyscall = false;
+                return -1;
+            }
+            // 0 bytes are read at the end of a redirected stdin
+            myBuffer = FileIOData::s_stdinBuffer.left(std::max(lengthRequested, 0));
+            FileIOData::s_stdinBuffer.remove(0, myBuffer.size());
+            FileIOData::s_stdinBufferDrained.wakeAll();
+        } else {
+            // Reads up to lengthRequested bytes of data from the file, without any decoding. 0 bytes are read at EOF.
+            myBuffer = FileIOData::files[fd].read(std::max(lengthRequested, 0));
         }
 
-        SystemIOStatusManager::clearStatus();
         return myBuffer.size();
 
     }  // end readFromFile
@@ -373,29 +415,27 @@ public:
      * Write bytes to file.
      *
      * @param fd              file descriptor
-     * @param myBuffer        byte array containing characters to write
-     * @param lengthRequested number of bytes to write
+     * @param myBuffer        byte array containing the bytes to write
      * @return number of bytes written, or -1 on error
      */
 
-    static int writeToFile(int fd, const QString& myBuffer, int lengthRequested) {
+    static int writeToFile(int fd, const QByteArray& myBuffer) {
         SystemIO::get();  // Ensure that SystemIO is constructed
         if (fd == STDOUT || fd == STDERR) {
-            emit get().doPrint(myBuffer);
+            if (FileIOData::stdioRedirects.count(fd)) {
+                return FileIOData::writeRedirected(fd, myBuffer);
+            }
+            printBytes(fd, myBuffer);
             return myBuffer.size();
         }
 
-        if (!FileIOData::fdInUse(fd, O_WRONLY | O_RDWR))  // Check the existence of the "write" fd
+        // Check the existence of the "write" fd
+        if (!FileIOData::fdInUse(fd, O_WRONLY) && !FileIOData::fdInUse(fd, O_RDWR))
         {
             s_fileErrorString = "File descriptor " + QString::number(fd) + " is not open for writing";
             return -1;
         }
-        // retrieve FileOutputStream from storage
-        auto& outputStream = FileIOData::getStreamInUse(fd);
-
-        outputStream << myBuffer;
-        outputStream.flush();
-        return lengthRequested;
+        return static_cast<int>(FileIOData::files[fd].write(myBuffer));
 
     }  // end writeToFile
 
@@ -406,11 +446,36 @@ public:
      */
     static void closeFile(int fd) { FileIOData::close(fd); }
 
-    static void printString(const QString& string) { emit get().doPrint(string); }
-    static void reset() { FileIOData::resetFiles(); }
-    static void abortSyscall(bool state) { s_abortSyscall = state; }
+    /**
+     * @brief printString
+     * Appends @p string to the output buffer. May be called from any thread. The buffer is flushed through doPrint at
+     * most every s_outputFlushInterval ms, such that programs printing in small pieces (ie. a character per ecall) do
+     * not flood the GUI thread with events.
+     */
+    static void printString(const QString& string);
+    /**
+     * @brief printBytes
+     * Decodes @p bytes written to @p fd (stdout or stderr) as UTF-8 and prints them. A decoder is kept per file
+     * descriptor, such that a multi-byte character split across writes is printed once complete.
+     */
+    static void printBytes(int fd, const QByteArray& bytes);
+    /**
+     * @brief reset
+     * Resets the files and discards any output of the previous execution which has not yet been flushed.
+     */
+    static void reset();
+    static void abortSyscall(bool state) {
+        QMutexLocker locker(&FileIOData::s_stdioMutex);
+        s_abortSyscall = state;
+        // Wake any syscall which is waiting for input, such that it may observe the abort
+        FileIOData::s_stdinBufferEmpty.wakeAll();
+    }
 
 signals:
+    /**
+     * @brief doPrint
+     * Emitted in the GUI thread with the output buffered since the last flush.
+     */
     void doPrint(const QString&);
 
 public slots:
@@ -426,7 +491,40 @@ public slots:
     }
 
 private:
-    SystemIO() { reset(); }
+    SystemIO();
+    void flushOutput();
+    /** Appends @p string to the output buffer. Must be called with m_outputMutex locked. */
+    void appendOutput(const QString& string);
+
+    /**
+     * @brief startStdinReader
+     * Starts a thread which reads the host file or named pipe that stdin is redirected to into the stdin buffer, waking
+     * any syscall waiting for input. Reading is paused while s_maxBufferedStdin bytes or more are buffered. Must be
+     * called with FileIOData::s_stdioMutex locked.
+     */
+    static void startStdinReader();
+
+    /** Size of the chunks in which a redirected stdin file is read */
+    static constexpr int s_stdinChunkSize = 1 << 16;
+    /**
+     * Number of buffered stdin bytes above which the stdin reader stops reading, until the program has consumed some of
+     * the buffered input. Bounds the memory used when stdin is redirected to a large file or a fast producer.
+     */
+    static constexpr int s_maxBufferedStdin = 16 * s_stdinChunkSize;
+
+    /** Interval between flushes of the output buffer, in milliseconds */
+    static constexpr int s_outputFlushInterval = 10;
+    /**
+     * Maximum number of buffered output characters. When exceeded, the oldest output is dropped, given that it would
+     * scroll out of the console anyway.
+     */
+    static constexpr int s_maxBufferedOutput = 1 << 16;
+
+    QMutex m_outputMutex;
+    QString m_outputBuffer;
+    std::map<int, std::unique_ptr<QTextDecoder>> m_outputDecoders;
+    bool m_flushPending = false;
+    QTimer m_flushTimer;
 };
 
 }  // namespace Ripes
@@ -0,0 +1,554 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QTextDocument>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+#include "assembler.h"
+#include "cachesim/cachesim.h"
+#include "ccmanager.h"
+#include "commitlogger.h"
+#include "elfloader.h"
+#include "loaddialog.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "version/version.h"
+
+/** Simulator performance benchmark harness
+ *
+ * Runs a set of workloads on every processor model, for each of a set of cache configurations, and reports simulator
+ * speed (host wall time, simulated cycles per second) and simulated performance (CPI, cache hit rates) as JSON. The
+ * workloads are integer kernels (sorting, matrix multiply, CRC, string search) plus the bundled examples: the assembly
+ * examples, the prebuilt ELF examples and, if a RISC-V compiler is found, the C examples.
+ *
+ * The result computed by each kernel is checked after each run, and reported as "correct". Processor models without
+ * hazard detection may not execute the kernels correctly, and are bounded by --max-cycles; such runs are reported with
+ * "finished": false.
+ *
+ * With --log-commits, each workload is additionally run on each processor without caches while writing a commit log
+ * (in the format of Spike's --log-commits), for offline comparison with other simulators. These runs are not timed.
+ */
+
+using namespace Ripes;
+
+namespace {
+
+struct Workload {
+    QString name;
+    /** Assembly source, or path of the C source or ELF executable */
+    QString source;
+    SourceType type = SourceType::Assembly;
+    /** Checks the result of the workload in the state of the finished processor. Not set for the examples. */
+    std::function<bool(const Program&)> check;
+};
+
+struct CacheConfig {
+    QString name;
+    bool enabled;
+    CacheSim::CachePreset preset;
+};
+
+struct RunResult {
+    bool finished = false;
+    bool correct = false;
+    long long cycles = 0;
+    long long instructions = 0;
+    qint64 wallTimeNs = 0;
+    double dataCacheHitRate = 0;
+    double instrCacheHitRate = 0;
+};
+
+const QString s_exit = "li a7, 10\necall\n";
+
+uint32_t symbolAddress(const Program& program, const QString& name) {
+    for (const auto& [address, symbol] : program.symbols) {
+        if (symbol == name) {
+            return address;
+        }
+    }
+    return 0;
+}
+
+std::vector<uint32_t> readWords(uint32_t address, int count) {
+    const QByteArray bytes = ProcessorHandler::get()->readMemBlock(address, count * 4);
+    std::vector<uint32_t> words(count);
+    for (int i = 0; i < count; i++) {
+        for (int b = 3; b >= 0; b--) {
+            words[i] = words[i] << 8 | static_cast<uint8_t>(bytes.at(i * 4 + b));
+        }
+    }
+    return words;
+}
+
+bool checkSort(const Program& program) {
+    const auto array = readWords(symbolAddress(program, "array"), 256);
+    return std::is_sorted(array.begin(), array.end(),
+                          [](uint32_t a, uint32_t b) { return static_cast<int32_t>(a) < static_cast<int32_t>(b); });
+}
+
+bool checkMatmul(const Program& program) {
+    constexpr int n = 20;
+    const auto mc = readWords(symbolAddress(program, "mc"), n * n);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            int32_t expected = 0;
+            for (int k = 0; k < n; k++) {
+                expected += (i + k) * (k - j);
+            }
+            if (static_cast<int32_t>(mc[i * n + j]) != expected) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool checkCrc(const Program&) {
+    uint32_t seed = 1;
+    uint32_t crc = 0xFFFFFFFF;
+    for (int i = 0; i < 1024; i++) {
+        seed = seed * 1103515245 + 12345;
+        crc ^= (seed >> 16) & 0xFF;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+    }
+    return ProcessorHandler::get()->getRegisterValue(10) == ~crc;
+}
+
+bool checkStringSearch(const Program&) {
+    return ProcessorHandler::get()->getRegisterValue(18) == 100;
+}
+
+QString sortKernel() {
+    // Bubble sort of 256 pseudo-random words
+    return QString(".data\n"
+                   "array: .zero 1024\n"
+                   ".text\n"
+                   "la s0, array\n"
+                   "li s1, 256\n"
+                   "li t0, 12345\n"
+                   "li t1, 1103515245\n"
+                   "li t2, 12345\n"
+                   "mv t3, s0\n"
+                   "mv t4, s1\n"
+                   "fill:\n"
+                   "mul t0, t0, t1\n"
+                   "add t0, t0, t2\n"
+                   "sw t0, 0(t3)\n"
+                   "addi t3, t3, 4\n"
+                   "addi t4, t4, -1\n"
+                   "bnez t4, fill\n"
+                   "addi s2, s1, -1\n"
+                   "outer:\n"
+                   "mv t3, s0\n"
+                   "mv t4, s2\n"
+                   "inner:\n"
+                   "lw a0, 0(t3)\n"
+                   "lw a1, 4(t3)\n"
+                   "ble a0, a1, noswap\n"
+                   "sw a1, 0(t3)\n"
+                   "sw a0, 4(t3)\n"
+                   "noswap:\n"
+                   "addi t3, t3, 4\n"
+                   "addi t4, t4, -1\n"
+                   "bnez t4, inner\n"
+                   "addi s2, s2, -1\n"
+                   "bnez s2, outer\n") +
+           s_exit;
+}
+
+QString matmulKernel() {
+    // 20x20 integer matrix multiplication, as in examples/C/matrixmul.c
+    return QString(".data\n"
+                   "ma: .zero 1600\n"
+                   "mb: .zero 1600\n"
+                   "mc: .zero 1600\n"
+                   ".text\n"
+                   "li s1, 20\n"
+                   "la s2, ma\n"
+                   "la s3, mb\n"
+                   "la s4, mc\n"
+                   "li t0, 0\n"
+                   "init_i:\n"
+                   "li t1, 0\n"
+                   "init_j:\n"
+                   "mul t2, t0, s1\n"
+                   "add t2, t2, t1\n"
+                   "slli t2, t2, 2\n"
+                   "add t3, t0, t1\n"
+                   "add t4, s2, t2\n"
+                   "sw t3, 0(t4)\n"
+                   "sub t3, t0, t1\n"
+                   "add t4, s3, t2\n"
+                   "sw t3, 0(t4)\n"
+                   "addi t1, t1, 1\n"
+                   "blt t1, s1, init_j\n"
+                   "addi t0, t0, 1\n"
+                   "blt t0, s1, init_i\n"
+                   "li t0, 0\n"
+                   "mm_row:\n"
+                   "li t1, 0\n"
+                   "mm_col:\n"
+                   "li t5, 0\n"
+                   "li t2, 0\n"
+                   "mm_k:\n"
+                   "mul t3, t0, s1\n"
+                   "add t3, t3, t2\n"
+                   "slli t3, t3, 2\n"
+                   "add t3, t3, s2\n"
+                   "lw a0, 0(t3)\n"
+                   "mul t4, t2, s1\n"
+                   "add t4, t4, t1\n"
+                   "slli t4, t4, 2\n"
+                   "add t4, t4, s3\n"
+                   "lw a1, 0(t4)\n"
+                   "mul a0, a0, a1\n"
+                   "add t5, t5, a0\n"
+                   "addi t2, t2, 1\n"
+                   "blt t2, s1, mm_k\n"
+                   "mul t3, t0, s1\n"
+                   "add t3, t3, t1\n"
+                   "slli t3, t3, 2\n"
+                   "add t3, t3, s4\n"
+                   "sw t5, 0(t3)\n"
+                   "addi t1, t1, 1\n"
+                   "blt t1, s1, mm_col\n"
+                   "addi t0, t0, 1\n"
+                   "blt t0, s1, mm_row\n") +
+           s_exit;
+}
+
+QString crcKernel() {
+    // Bitwise CRC-32 of 1 KiB of pseudo-random bytes
+    return QString(".data\n"
+                   "buf: .zero 1024\n"
+                   ".text\n"
+                   "la s0, buf\n"
+                   "li s1, 1024\n"
+                   "li t0, 1\n"
+                   "li t1, 1103515245\n"
+                   "li t2, 12345\n"
+                   "mv t3, s0\n"
+                   "mv t4, s1\n"
+                   "fill:\n"
+                   "mul t0, t0, t1\n"
+                   "add t0, t0, t2\n"
+                   "srli t5, t0, 16\n"
+                   "sb t5, 0(t3)\n"
+                   "addi t3, t3, 1\n"
+                   "addi t4, t4, -1\n"
+                   "bnez t4, fill\n"
+                   "li a0, -1\n"
+                   "li s2, 0xEDB88320\n"
+                   "mv t3, s0\n"
+                   "mv t4, s1\n"
+                   "byte:\n"
+                   "lbu t5, 0(t3)\n"
+                   "xor a0, a0, t5\n"
+                   "li t6, 8\n"
+                   "bit:\n"
+                   "andi a1, a0, 1\n"
+                   "srli a0, a0, 1\n"
+                   "beqz a1, nopoly\n"
+                   "xor a0, a0, s2\n"
+                   "nopoly:\n"
+                   "addi t6, t6, -1\n"
+                   "bnez t6, bit\n"
+                   "addi t3, t3, 1\n"
+                   "addi t4, t4, -1\n"
+                   "bnez t4, byte\n"
+                   "not a0, a0\n") +
+           s_exit;
+}
+
+QString stringSearchKernel() {
+    // Naive search counting the occurrences of a pattern in a ~4.5 KiB text
+    const QString text = QString("the quick brown fox jumps over the haystack; ").repeated(100);
+    return QString(".data\n"
+                   "text: .string \"%1\"\n"
+                   "pattern: .string \"haystack\"\n"
+                   ".text\n"
+                   "la s0, text\n"
+                   "la s1, pattern\n"
+                   "li s2, 0\n"
+                   "outer:\n"
+                   "lbu t0, 0(s0)\n"
+                   "beqz t0, done\n"
+                   "mv t1, s0\n"
+                   "mv t2, s1\n"
+                   "cmp:\n"
+                   "lbu t4, 0(t2)\n"
+                   "beqz t4, match\n"
+                   "lbu t3, 0(t1)\n"
+                   "bne t3, t4, next\n"
+                   "addi t1, t1, 1\n"
+                   "addi t2, t2, 1\n"
+                   "j cmp\n"
+                   "match:\n"
+                   "addi s2, s2, 1\n"
+                   "next:\n"
+                   "addi s0, s0, 1\n"
+                   "j outer\n"
+                   "done:\n")
+               .arg(text) +
+           s_exit;
+}
+
+std::vector<Workload> workloads() {
+    std::vector<Workload> w = {{"sort", sortKernel(), SourceType::Assembly, checkSort},
+                               {"matmul", matmulKernel(), SourceType::Assembly, checkMatmul},
+                               {"crc32", crcKernel(), SourceType::Assembly, checkCrc},
+                               {"strsearch", stringSearchKernel(), SourceType::Assembly, checkStringSearch}};
+
+    const QDir examplesDir(RIPES_EXAMPLES_DIR);
+    const QDir assemblyDir(examplesDir.filePath("assembly"));
+    for (const auto& example : assemblyDir.entryList(QDir::Files, QDir::Name)) {
+        QFile file(assemblyDir.filePath(example));
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            w.push_back({"example: " + example, QString::fromUtf8(file.readAll())});
+        }
+    }
+
+    const QDir elfDir(examplesDir.filePath("ELF"));
+    for (const auto& example : elfDir.entryList(QDir::Files, QDir::Name)) {
+        const QString path = elfDir.filePath(example);
+        if (LoadDialog::validateELFFile(QFile(path)).valid) {
+            w.push_back({"example: " + example + " (ELF)", path, SourceType::ExternalELF});
+        }
+    }
+
+    const QDir cDir(examplesDir.filePath("C"));
+    const QStringList cExamples = cDir.entryList({"*.c"}, QDir::Files, QDir::Name);
+    if (CCManager::hasValidCC()) {
+        for (const auto& example : cExamples) {
+            w.push_back({"example: " + example, cDir.filePath(example), SourceType::C});
+        }
+    } else if (!cExamples.isEmpty()) {
+        std::cerr << "Skipping the C examples: no RISC-V compiler was found" << std::endl;
+    }
+    return w;
+}
+
+/**
+ * @brief loadWorkload
+ * Assembles, compiles or loads the program of @p workload. @returns nullptr if this failed.
+ */
+std::shared_ptr<Program> loadWorkload(const Workload& workload) {
+    switch (workload.type) {
+        case SourceType::Assembly: {
+            QTextDocument doc;
+            doc.setPlainText(workload.source);
+            Assembler assembler;
+            assembler.assemble(doc);
+            return assembler.hasError() ? nullptr : assembler.getProgram();
+        }
+        case SourceType::C: {
+            const auto res = CCManager::get().compile(workload.source, QString(), false);
+            auto program = std::make_shared<Program>();
+            return res.success && loadElfProgram(*program, res.outFile) ? program : nullptr;
+        }
+        case SourceType::InternalELF:
+        case SourceType::ExternalELF: {
+            auto program = std::make_shared<Program>();
+            return loadElfProgram(*program, workload.source) ? program : nullptr;
+        }
+        case SourceType::FlatBinary:
+            break;
+    }
+    return nullptr;
+}
+
+std::vector<CacheConfig> cacheConfigs() {
+    CacheSim::CachePreset preset;
+    preset.wrPolicy = CacheSim::WritePolicy::WriteBack;
+    preset.wrAllocPolicy = CacheSim::WriteAllocPolicy::WriteAllocate;
+    preset.replPolicy = CacheSim::ReplPolicy::LRU;
+
+    std::vector<CacheConfig> configs;
+    configs.push_back({"none", false, preset});
+
+    preset.blocks = 2;
+    preset.lines = 5;
+    preset.ways = 0;
+    configs.push_back({"32-entry 4-word direct-mapped", true, preset});
+
+    preset.blocks = 2;
+    preset.lines = 4;
+    preset.ways = 1;
+    configs.push_back({"32-entry 4-word 2-way set associative", true, preset});
+    return configs;
+}
+
+RunResult run(ProcessorID id, const std::shared_ptr<Program>& program, const CacheConfig& config,
+              const std::function<bool(const Program&)>& check, long long maxCycles,
+              const QString& commitLog = QString()) {
+    auto* handler = ProcessorHandler::get();
+    handler->selectProcessor(id, ProcessorRegistry::getDescription(id).defaultRegisterVals);
+
+    std::unique_ptr<CacheSim> dataCache;
+    std::unique_ptr<CacheSim> instrCache;
+    if (config.enabled) {
+        dataCache = std::make_unique<CacheSim>(nullptr);
+        dataCache->setType(CacheSim::CacheType::DataCache);
+        dataCache->setPreset(config.preset);
+        instrCache = std::make_unique<CacheSim>(nullptr);
+        instrCache->setType(CacheSim::CacheType::InstrCache);
+        instrCache->setPreset(config.preset);
+    }
+
+    // Resets the processor and caches
+    handler->loadProgram(program);
+    if (!commitLog.isEmpty() && !CommitLogger::get()->start(commitLog)) {
+        std::cerr << "Could not open " << commitLog.toStdString() << " for writing" << std::endl;
+    }
+
+    auto* proc = handler->getProcessorNonConst();
+    QElapsedTimer timer;
+    timer.start();
+    while (!proc->finished() && proc->getCycleCount() < maxCycles) {
+        proc->clock();
+    }
+
+    RunResult result;
+    result.wallTimeNs = timer.nsecsElapsed();
+    CommitLogger::get()->stop();
+    result.finished = proc->finished();
+    result.correct = result.finished && check && check(*program);
+    result.cycles = proc->getCycleCount();
+    result.instructions = proc->getInstructionsRetired();
+    if (config.enabled) {
+        result.dataCacheHitRate = dataCache->getHitRate();
+        result.instrCacheHitRate = instrCache->getHitRate();
+    }
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Ripes simulator performance benchmarks");
+    parser.addHelpOption();
+    const QCommandLineOption outputOption({"o", "output"}, "Write the JSON report to <file> instead of stdout.",
+                                          "file");
+    const QCommandLineOption filterOption({"f", "filter"}, "Only run workloads matching <regex>.", "regex");
+    const QCommandLineOption repeatOption({"r", "repeat"},
+                                          "Run each benchmark <n> times, reporting the fastest run. Default: 1.", "n",
+                                          "1");
+    const QCommandLineOption maxCyclesOption("max-cycles", "Stop runs after <n> cycles. Default: 10000000.", "n",
+                                             "10000000");
+    const QCommandLineOption commitLogOption(
+        "log-commits",
+        "Write a Spike-compatible commit log of each workload on each processor to <dir>. Logged runs are not timed.",
+        "dir");
+    const QCommandLineOption writeLogOption(
+        "write-log", "Record the state written in each cycle, as when stepping with register or memory views open.");
+    parser.addOptions({outputOption, filterOption, repeatOption, maxCyclesOption, commitLogOption, writeLogOption});
+    parser.process(app);
+
+    const QRegularExpression filter(parser.value(filterOption));
+    const int repeat = std::max(parser.value(repeatOption).toInt(), 1);
+    const long long maxCycles = parser.value(maxCyclesOption).toLongLong();
+    const QString commitLogDir = parser.value(commitLogOption);
+    if (!commitLogDir.isEmpty()) {
+        QDir().mkpath(commitLogDir);
+    }
+
+    const bool writeLog = parser.isSet(writeLogOption);
+    if (writeLog) {
+        ProcessorHandler::get()->addWriteLogSubscriber();
+    }
+
+    // As in the GUI, processor reset requests are handled by resetting the processor
+    QObject::connect(ProcessorHandler::get(), &ProcessorHandler::reqProcessorReset,
+                     [] { ProcessorHandler::get()->getProcessorNonConst()->reset(); });
+
+    QJsonArray results;
+    for (const auto& workload : workloads()) {
+        if (!filter.match(workload.name).hasMatch()) {
+            continue;
+        }
+
+        const auto program = loadWorkload(workload);
+        if (!program) {
+            std::cerr << "Skipping workload '" << workload.name.toStdString() << "': "
+                      << (workload.type == SourceType::C ? "compilation" : "loading") << " failed" << std::endl;
+            continue;
+        }
+
+        for (int id = 0; id < ProcessorID::NUM_PROCESSORS; id++) {
+            const auto processorID = static_cast<ProcessorID>(id);
+            if (!commitLogDir.isEmpty()) {
+                QString logName =
+                    QString("%1_%2.log").arg(workload.name).arg(ProcessorRegistry::getDescription(processorID).name);
+                logName.replace(QRegularExpression("[^A-Za-z0-9_.-]"), "_");
+                run(processorID, program, cacheConfigs().front(), workload.check, maxCycles,
+                    QDir(commitLogDir).filePath(logName));
+            }
+            for (const auto& config : cacheConfigs()) {
+                RunResult best;
+                for (int i = 0; i < repeat; i++) {
+                    const RunResult r = run(processorID, program, config, workload.check, maxCycles);
+                    if (i == 0 || r.wallTimeNs < best.wallTimeNs) {
+                        best = r;
+                    }
+                }
+
+                const double wallTimeS = best.wallTimeNs / 1e9;
+                QJsonObject result;
+                result["workload"] = workload.name;
+                result["processor"] = ProcessorRegistry::getDescription(processorID).name;
+                result["cache"] = config.name;
+                result["finished"] = best.finished;
+                if (workload.check) {
+                    result["correct"] = best.correct;
+                }
+                result["cycles"] = best.cycles;
+                result["instructions"] = best.instructions;
+                result["cpi"] = best.instructions == 0 ? 0 : static_cast<double>(best.cycles) / best.instructions;
+                result["wallTimeMs"] = best.wallTimeNs / 1e6;
+                result["cyclesPerSecond"] = wallTimeS == 0 ? 0 : best.cycles / wallTimeS;
+                if (config.enabled) {
+                    result["dataCacheHitRate"] = best.dataCacheHitRate;
+                    result["instrCacheHitRate"] = best.instrCacheHitRate;
+                }
+                results.append(result);
+                std::cerr << "." << std::flush;
+            }
+        }
+    }
+    std::cerr << std::endl;
+
+    QJsonObject report;
+    report["version"] = getRipesVersion();
+    report["writeLog"] = writeLog;
+    report["results"] = results;
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile out(parser.value(outputOption));
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << "Could not open " << out.fileName().toStdString() << " for writing" << std::endl;
+            return 1;
+        }
+        out.write(json);
+    } else {
+        std::cout << json.constData();
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+.text
+main:
+  #-------------------------------------------------------------
+  # Atomic memory operation tests
+  #-------------------------------------------------------------
+
+ addi x5, sp, -16
+
+test_2:
+ li x1, 0x80000000
+ sw x1, 0(x5)
+ li x2, 0xfffff800
+ amoswap.w x30, x2, (x5)
+ li x29, 0x80000000
+ li gp, 2
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0xfffff800
+ bne x30, x29, fail
+
+
+test_3:
+ li x1, 0x80000000
+ sw x1, 0(x5)
+ li x2, 0xfffff800
+ amoadd.w x30, x2, (x5)
+ li x29, 0x80000000
+ li gp, 3
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0x7ffff800
+ bne x30, x29, fail
+
+
+test_4:
+ li x1, 0x7fffffff
+ sw x1, 0(x5)
+ li x2, 0x00000001
+ amoadd.w x30, x2, (x5)
+ li x29, 0x7fffffff
+ li gp, 4
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0x80000000
+ bne x30, x29, fail
+
+
+test_5:
+ li x1, 0xff00ff00
+ sw x1, 0(x5)
+ li x2, 0x0ff00ff0
+ amoxor.w x30, x2, (x5)
+ li x29, 0xff00ff00
+ li gp, 5
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0xf0f0f0f0
+ bne x30, x29, fail
+
+
+test_6:
+ li x1, 0xff00ff00
+ sw x1, 0(x5)
+ li x2, 0x0ff00ff0
+ amoand.w x30, x2, (x5)
+ li x29, 0xff00ff00
+ li gp, 6
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0x0f000f00
+ bne x30, x29, fail
+
+
+test_7:
+ li x1, 0xff00ff00
+ sw x1, 0(x5)
+ li x2, 0x0ff00ff0
+ amoor.w x30, x2, (x5)
+ li x29, 0xff00ff00
+ li gp, 7
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0xfff0fff0
+ bne x30, x29, fail
+
+
+test_8:
+ li x1, 0x80000000
+ sw x1, 0(x5)
+ li x2, 0x00000001
+ amomin.w x30, x2, (x5)
+ li x29, 0x80000000
+ li gp, 8
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0x80000000
+ bne x30, x29, fail
+
+
+test_9:
+ li x1, 0x00000005
+ sw x1, 0(x5)
+ li x2, 0x00000003
+ amomin.w x30, x2, (x5)
+ li x29, 0x00000005
+ li gp, 9
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0x00000003
+ bne x30, x29, fail
+
+
+test_10:
+ li x1, 0x80000000
+ sw x1, 0(x5)
+ li x2, 0x00000001
+ amomax.w x30, x2, (x5)
+ li x29, 0x80000000
+ li gp, 10
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0x00000001
+ bne x30, x29, fail
+
+
+test_11:
+ li x1, 0xfffffffe
+ sw x1, 0(x5)
+ li x2, 0xffffffff
+ amomax.w x30, x2, (x5)
+ li x29, 0xfffffffe
+ li gp, 11
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0xffffffff
+ bne x30, x29, fail
+
+
+test_12:
+ li x1, 0x80000000
+ sw x1, 0(x5)
+ li x2, 0x00000001
+ amominu.w x30, x2, (x5)
+ li x29, 0x80000000
+ li gp, 12
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0x00000001
+ bne x30, x29, fail
+
+
+test_13:
+ li x1, 0x80000000
+ sw x1, 0(x5)
+ li x2, 0x00000001
+ amomaxu.w x30, x2, (x5)
+ li x29, 0x80000000
+ li gp, 13
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0x80000000
+ bne x30, x29, fail
+
+
+test_14:
+ li x1, 0x00000003
+ sw x1, 0(x5)
+ li x2, 0x00000004
+ amoadd.w x2, x2, (x5)
+ li x29, 0x00000003
+ li gp, 14
+ bne x2, x29, fail
+ lw x30, 0(x5)
+ li x29, 0x00000007
+ bne x30, x29, fail
+
+
+pass:
+	li a0, 42
+	li a7, 93
+	ecall
+fail:
+	li a0, 0
+	li a7, 93
+	ecall
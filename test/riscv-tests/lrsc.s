@@ -0,0 +1,71 @@
+.text
+main:
+  #-------------------------------------------------------------
+  # Load-reserved/store-conditional tests
+  #-------------------------------------------------------------
+
+ addi x5, sp, -16
+ addi x6, sp, -12
+
+test_2:
+ li x1, 0x00000011
+ sw x1, 0(x5)
+ lr.w x30, (x5)
+ li x29, 0x00000011
+ li gp, 2
+ bne x30, x29, fail
+ li x2, 0x00000022
+ sc.w x30, x2, (x5)
+ bne x30, zero, fail
+ lw x30, 0(x5)
+ li x29, 0x00000022
+ bne x30, x29, fail
+
+
+test_3:
+ li x2, 0x00000033
+ sc.w x30, x2, (x5)
+ li x29, 0x00000001
+ li gp, 3
+ bne x30, x29, fail
+ lw x30, 0(x5)
+ li x29, 0x00000022
+ bne x30, x29, fail
+
+
+test_4:
+ sw zero, 0(x6)
+ lr.w x30, (x5)
+ li x2, 0x00000044
+ sc.w x30, x2, (x6)
+ li x29, 0x00000001
+ li gp, 4
+ bne x30, x29, fail
+ lw x30, 0(x6)
+ bne x30, zero, fail
+
+
+test_5:
+ sw zero, 0(x5)
+ li x1, 10
+loop_5:
+ lr.w x30, (x5)
+ addi x30, x30, 1
+ sc.w x31, x30, (x5)
+ bne x31, zero, loop_5
+ addi x1, x1, -1
+ bne x1, zero, loop_5
+ lw x30, 0(x5)
+ li x29, 10
+ li gp, 5
+ bne x30, x29, fail
+
+
+pass:
+	li a0, 42
+	li a7, 93
+	ecall
+fail:
+	li a0, 0
+	li a7, 93
+	ecall
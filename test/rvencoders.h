@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QByteArray>
+
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+/** RV32IMA instruction encoders shared by the tests which generate programs directly as machine code */
+
+namespace Ripes {
+namespace RVEncoders {
+
+constexpr uint32_t c_lui = 0b0110111;
+constexpr uint32_t c_auipc = 0b0010111;
+constexpr uint32_t c_jal = 0b1101111;
+constexpr uint32_t c_jalr = 0b1100111;
+constexpr uint32_t c_branch = 0b1100011;
+constexpr uint32_t c_load = 0b0000011;
+constexpr uint32_t c_store = 0b0100011;
+constexpr uint32_t c_opImm = 0b0010011;
+constexpr uint32_t c_op = 0b0110011;
+constexpr uint32_t c_amo = 0b0101111;
+constexpr uint32_t c_ecall = 0x00000073;
+
+inline uint32_t encodeR(uint32_t opcode, unsigned funct3, unsigned funct7, unsigned rd, unsigned rs1, unsigned rs2) {
+    return funct7 << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode;
+}
+
+inline uint32_t encodeI(uint32_t opcode, unsigned funct3, unsigned rd, unsigned rs1, int32_t imm) {
+    return (static_cast<uint32_t>(imm) & 0xFFF) << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode;
+}
+
+inline uint32_t encodeS(unsigned funct3, unsigned rs1, unsigned rs2, int32_t imm) {
+    const auto uimm = static_cast<uint32_t>(imm);
+    return ((uimm >> 5) & 0x7F) << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | (uimm & 0x1F) << 7 | c_store;
+}
+
+inline uint32_t encodeB(unsigned funct3, unsigned rs1, unsigned rs2, int32_t offset) {
+    const auto uoff = static_cast<uint32_t>(offset);
+    return ((uoff >> 12) & 0x1) << 31 | ((uoff >> 5) & 0x3F) << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 |
+           ((uoff >> 1) & 0xF) << 8 | ((uoff >> 11) & 0x1) << 7 | c_branch;
+}
+
+inline uint32_t encodeU(uint32_t opcode, unsigned rd, uint32_t imm20) {
+    return (imm20 & 0xFFFFF) << 12 | rd << 7 | opcode;
+}
+
+inline uint32_t encodeJ(unsigned rd, int32_t offset) {
+    const auto uoff = static_cast<uint32_t>(offset);
+    return ((uoff >> 20) & 0x1) << 31 | ((uoff >> 1) & 0x3FF) << 21 | ((uoff >> 11) & 0x1) << 20 |
+           ((uoff >> 12) & 0xFF) << 12 | rd << 7 | c_jal;
+}
+
+/** Word sized atomic memory operation; aq and rl are cleared */
+inline uint32_t encodeAMO(unsigned funct5, unsigned rd, unsigned rs1, unsigned rs2) {
+    return encodeR(c_amo, 0b010, funct5 << 2, rd, rs1, rs2);
+}
+
+inline uint32_t lui(unsigned rd, uint32_t imm20) {
+    return encodeU(c_lui, rd, imm20);
+}
+inline uint32_t addi(unsigned rd, unsigned rs1, int32_t imm) {
+    return encodeI(c_opImm, 0b000, rd, rs1, imm);
+}
+inline uint32_t slli(unsigned rd, unsigned rs1, unsigned shamt) {
+    return encodeI(c_opImm, 0b001, rd, rs1, shamt);
+}
+inline uint32_t add(unsigned rd, unsigned rs1, unsigned rs2) {
+    return encodeR(c_op, 0b000, 0, rd, rs1, rs2);
+}
+inline uint32_t lw(unsigned rd, unsigned rs1, int32_t imm) {
+    return encodeI(c_load, 0b010, rd, rs1, imm);
+}
+inline uint32_t sw(unsigned rs2, unsigned rs1, int32_t imm) {
+    return encodeS(0b010, rs1, rs2, imm);
+}
+inline uint32_t bne(unsigned rs1, unsigned rs2, int32_t offset) {
+    return encodeB(0b001, rs1, rs2, offset);
+}
+inline uint32_t amoaddw(unsigned rd, unsigned rs2, unsigned rs1) {
+    return encodeAMO(0b00000, rd, rs1, rs2);
+}
+inline uint32_t lrw(unsigned rd, unsigned rs1) {
+    return encodeAMO(0b00010, rd, rs1, 0);
+}
+inline uint32_t scw(unsigned rd, unsigned rs2, unsigned rs1) {
+    return encodeAMO(0b00011, rd, rs1, rs2);
+}
+
+/** Packs instruction words into a little-endian text section */
+inline QByteArray packInstructions(const std::vector<uint32_t>& instructions) {
+    QByteArray bytes;
+    bytes.reserve(instructions.size() * sizeof(uint32_t));
+    for (const uint32_t instr : instructions) {
+        for (unsigned i = 0; i < sizeof(uint32_t); i++) {
+            bytes.append(static_cast<char>((instr >> (i * CHAR_BIT)) & 0xFF));
+        }
+    }
+    return bytes;
+}
+
+}  // namespace RVEncoders
+}  // namespace Ripes
@@ -0,0 +1,267 @@
+#include <QTextDocument>
+#include <QTextStream>
+#include <QtTest/QTest>
+
+#include "assembler.h"
+#include "defines.h"
+#include "lexerutilities.h"
+#include "parser.h"
+
+/** Assembler tests and benchmarks
+ *
+ * The benchmarks assemble a fixed, generated program of s_benchmarkLines lines, exercising all instruction formats,
+ * label references, pseudo-ops and data directives. Run with ie. '-iterations 10' for stable timings, and compare
+ * against the timings of a previous build to measure changes to the assembler.
+ */
+
+using namespace Ripes;
+
+static constexpr int s_benchmarkLines = 100000;
+
+class tst_Assembler : public QObject {
+    Q_OBJECT
+
+private:
+    QString generateProgram(int lines, int variant = 0) const;
+    uint32_t textWord(Assembler& assembler, int index) const;
+
+private slots:
+    void testEncodings();
+    void testTokenizer();
+    void testIncrementalAssembly();
+    void testPseudoOps();
+    void testAtomics();
+    void benchmarkAssemble();
+    void benchmarkReassemble();
+};
+
+QString tst_Assembler::generateProgram(int lines, int variant) const {
+    QString program;
+    QTextStream out(&program);
+    out << ".data\n";
+    out << "buffer: .word 1, 2, 3, 4\n";
+    out << "msg: .string \"Hello, world\"\n";
+    out << ".text\n";
+
+    for (int i = 0; i < lines; i++) {
+        const int imm = i % 2048 - 1024;
+        const int label = i / 16;
+        switch (i % 16) {
+            case 0:
+                out << "l" << label << ":\n";
+                break;
+            case 1:
+                out << "\taddi t0, t1, " << imm << "\n";
+                break;
+            case 2:
+                out << "\tadd a0, a1, a2 # comment\n";
+                break;
+            case 3:
+                out << "\tlw a0, " << (i % 512) * 4 << "(sp)\n";
+                break;
+            case 4:
+                out << "\tsw a1, " << (i % 512) * 4 << "(sp)\n";
+                break;
+            case 5:
+                out << "\tli t2, 0x" << QString::number(i * 4099, 16) << "\n";
+                break;
+            case 6:
+                out << "\tla a3, buffer\n";
+                break;
+            case 7:
+                out << "\tmul s1, s2, s3\n";
+                break;
+            case 8:
+                out << "\tbeq a0, a1, l" << label << "\n";
+                break;
+            case 9:
+                out << "\tsrai t3, t4, " << i % 32 << "\n";
+                break;
+            case 10:
+                out << "\tbnez a4, l" << label << "\n";
+                break;
+            case 11:
+                out << "\tmv a5, a6\n";
+                break;
+            case 12:
+                out << "\tlui s4, " << i % 4096 << "\n";
+                break;
+            case 13:
+                out << "\txori s5, s6, " << imm << "\n";
+                break;
+            case 14:
+                out << "\tjal ra, l" << label << "\n";
+                break;
+            case 15:
+                out << "\tecall\n";
+                break;
+        }
+    }
+
+    if (variant != 0) {
+        // Single line edit at the end of the program
+        out << "\taddi a7, zero, " << variant << "\n";
+    } else {
+        out << "\tnop\n";
+    }
+    return program;
+}
+
+uint32_t tst_Assembler::textWord(Assembler& assembler, int index) const {
+    const QByteArray& text = assembler.getTextSegment();
+    uint32_t word = 0;
+    for (int i = 3; i >= 0; i--) {
+        word = word << 8 | static_cast<uint8_t>(text.at(index * 4 + i));
+    }
+    return word;
+}
+
+void tst_Assembler::testEncodings() {
+    QTextDocument doc;
+    doc.setPlainText("addi a0, zero, 5\n"
+                     "add a0, a1, a2\n"
+                     "sub t0, t1, t2\n"
+                     "lw a0, 8(sp)\n"
+                     "sw a0, 12(sp)\n"
+                     "srai a1, a1, 3\n"
+                     "ecall\n"
+                     "loop: beq a0, zero, loop\n"
+                     "jal ra, loop\n");
+
+    Assembler assembler;
+    assembler.assemble(doc);
+    QVERIFY(!assembler.hasError());
+    QCOMPARE(assembler.getTextSegment().size(), 9 * 4);
+
+    const std::vector<uint32_t> expected = {0x00500513, 0x00c58533, 0x407302b3, 0x00812503, 0x00a12623,
+                                            0x4035d593, 0x00000073, 0x00050063, 0xffdff0ef};
+    for (unsigned i = 0; i < expected.size(); i++) {
+        QCOMPARE(textWord(assembler, i), expected.at(i));
+    }
+}
+
+void tst_Assembler::testTokenizer() {
+    // The single-pass tokenizer must be equivalent to splitting by the register splitter regex followed by
+    // splitQuotes().
+    const QStringList lines = {"addi a0, a1, 1",
+                               "\tlw a0, 4(sp)",
+                               "sw\tx31,-8(x10)",
+                               "label: add a0,a1 ,a2 # a comment",
+                               "msg: .string \"Hello, world (1)\"",
+                               "lb s11, 0(s1)",
+                               "lb s1, (1 + 2)(a7)",
+                               "jalr x0, 0(zero)",
+                               ".word 1, 2, 3,4",
+                               "x45) (x2",
+                               ""};
+    for (const auto& line : lines) {
+        QStringList reference = line.split(splitter);
+        reference.removeAll("");
+        reference = splitQuotes(reference);
+        QCOMPARE(tokenizeLine(line), reference);
+    }
+}
+
+void tst_Assembler::testIncrementalAssembly() {
+    // Reassembling after an edit must yield the same program as assembling from scratch. Inserting a line moves the
+    // labels following it, and thereby changes the encodings of unedited lines which refer to these labels.
+    const QStringList edits = {"", "\tnop", "\tla a0, msg", "msg2: .string \"moved\"", ".data", "\tli a0, 0x12345"};
+    Assembler incremental;
+    for (const auto& edit : edits) {
+        QString program = generateProgram(256);
+        program.insert(program.indexOf("l8:"), edit + "\n");
+        QTextDocument doc;
+        doc.setPlainText(program);
+
+        incremental.assemble(doc);
+        Assembler fresh;
+        fresh.assemble(doc);
+        QVERIFY(!incremental.hasError());
+        QCOMPARE(incremental.getTextSegment(), fresh.getTextSegment());
+        QCOMPARE(incremental.getDataSegment(), fresh.getDataSegment());
+        QCOMPARE(incremental.getProgram()->symbols, fresh.getProgram()->symbols);
+    }
+}
+
+void tst_Assembler::testPseudoOps() {
+    QTextDocument doc;
+    doc.setPlainText(".data\n"
+                     "buffer: .word 1, 2\n"
+                     "msg: .string \"Hi\"\n"
+                     ".text\n"
+                     "li t2, 0x12345\n"
+                     "li t3, -5\n"
+                     "mv a5, a6\n"
+                     "bnez a4, end\n"
+                     "nop\n"
+                     "end: ecall\n");
+
+    Assembler assembler;
+    assembler.assemble(doc);
+    QVERIFY(!assembler.hasError());
+    QCOMPARE(assembler.getTextSegment().size(), 7 * 4);
+
+    const std::vector<uint32_t> expected = {0x000123b7, 0x34538393, 0xffb00e13, 0x00080793,
+                                            0x00071463, 0x00000013, 0x00000073};
+    for (unsigned i = 0; i < expected.size(); i++) {
+        QCOMPARE(textWord(assembler, i), expected.at(i));
+    }
+
+    // Strings are null-terminated, and data directives are padded to a word boundary
+    QCOMPARE(assembler.getDataSegment(), QByteArray("\x01\0\0\0\x02\0\0\0Hi\0\0", 12));
+}
+
+void tst_Assembler::testAtomics() {
+    QTextDocument doc;
+    doc.setPlainText("lr.w a0, (a1)\n"
+                     "sc.w a2, a3, (a1)\n"
+                     "amoswap.w t0, t1, (sp)\n"
+                     "amoadd.w zero, a0, (a1)\n"
+                     "amomaxu.w x31, x30, (x29)\n");
+
+    Assembler assembler;
+    assembler.assemble(doc);
+    QVERIFY(!assembler.hasError());
+    QCOMPARE(assembler.getTextSegment().size(), 5 * 4);
+
+    const std::vector<uint32_t> expected = {0x1005a52f, 0x18d5a62f, 0x086122af, 0x00a5a02f, 0xe1eeafaf};
+    const QStringList disassembly = {"lr.w x10 (x11)", "sc.w x12 x13 (x11)", "amoswap.w x5 x6 (x2)",
+                                     "amoadd.w x0 x10 (x11)", "amomaxu.w x31 x30 (x29)"};
+    const auto program = assembler.getProgram();
+    for (unsigned i = 0; i < expected.size(); i++) {
+        QCOMPARE(textWord(assembler, i), expected.at(i));
+        QCOMPARE(Parser::getParser()->disassemble(program, expected.at(i), i * 4), disassembly.at(i));
+    }
+}
+
+void tst_Assembler::benchmarkAssemble() {
+    QTextDocument doc;
+    doc.setPlainText(generateProgram(s_benchmarkLines));
+
+    QBENCHMARK {
+        Assembler assembler;
+        assembler.assemble(doc);
+        QVERIFY(!assembler.hasError());
+    }
+}
+
+void tst_Assembler::benchmarkReassemble() {
+    // Alternates between two programs differing in a single line, as when editing a program in the editor. The
+    // assembler is reused across assemblies, such that it may reuse the unedited blocks.
+    QTextDocument docA;
+    QTextDocument docB;
+    docA.setPlainText(generateProgram(s_benchmarkLines, 1));
+    docB.setPlainText(generateProgram(s_benchmarkLines, 2));
+
+    bool useB = true;
+    Assembler assembler;
+    assembler.assemble(docA);
+    QBENCHMARK {
+        assembler.assemble(useB ? docB : docA);
+        QVERIFY(!assembler.hasError());
+        useB = !useB;
+    }
+}
+
+QTEST_MAIN(tst_Assembler)
+#include "tst_assembler.moc"
@@ -0,0 +1,131 @@
+#include <QtTest/QTest>
+
+#include "debuglineinfo.h"
+
+/** DWARF line table tests
+ *
+ * Parses hand-assembled .debug_line sections, and verifies the address to source file:line mapping.
+ */
+
+using namespace Ripes;
+
+namespace {
+// DWARF constants, as specified in the DWARF 5 standard, section 7.22
+constexpr int DW_LNS_copy = 0x01;
+constexpr int DW_LNS_advance_pc = 0x02;
+constexpr int DW_LNS_advance_line = 0x03;
+constexpr int DW_LNS_set_file = 0x04;
+constexpr int DW_LNE_end_sequence = 0x01;
+constexpr int DW_LNE_set_address = 0x02;
+constexpr int DW_LNCT_path = 0x01;
+constexpr int DW_LNCT_directory_index = 0x02;
+constexpr int DW_FORM_string = 0x08;
+constexpr int DW_FORM_udata = 0x0f;
+
+void appendU(QByteArray& data, uint64_t value, unsigned bytes) {
+    for (unsigned i = 0; i < bytes; i++) {
+        data.append(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+void appendBytes(QByteArray& data, std::initializer_list<int> bytes) {
+    for (const int byte : bytes) {
+        data.append(static_cast<char>(byte));
+    }
+}
+
+void appendString(QByteArray& data, const char* str) {
+    data.append(str);
+    data.append('\0');
+}
+
+void setAddress(QByteArray& program, uint32_t address) {
+    appendBytes(program, {0, 5, DW_LNE_set_address});
+    appendU(program, address, 4);
+}
+
+void endSequence(QByteArray& program) {
+    appendBytes(program, {0, 1, DW_LNE_end_sequence});
+}
+
+/**
+ * @brief dwarf5Unit
+ * Wraps @p program in a DWARF 5 line table unit, with directory "/src" and the files a.c (file 0) and b.c (file 1).
+ */
+QByteArray dwarf5Unit(const QByteArray& program) {
+    QByteArray header;
+    // Minimum instruction length, maximum operations per instruction, default is_stmt, line base, line range and
+    // opcode base, followed by the standard opcode lengths
+    appendBytes(header, {1, 1, 1, -5, 14, 13});
+    appendBytes(header, {0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1});
+
+    // Directory and file tables
+    appendBytes(header, {1, DW_LNCT_path, DW_FORM_string, 1});
+    appendString(header, "/src");
+    appendBytes(header, {2, DW_LNCT_path, DW_FORM_string, DW_LNCT_directory_index, DW_FORM_udata, 2});
+    appendString(header, "a.c");
+    appendBytes(header, {0});
+    appendString(header, "b.c");
+    appendBytes(header, {0});
+
+    QByteArray unit;
+    appendU(unit, 5, 2);        // version
+    appendBytes(unit, {4, 0});  // address size, segment selector size
+    appendU(unit, header.size(), 4);
+    unit.append(header);
+    unit.append(program);
+
+    QByteArray section;
+    appendU(section, unit.size(), 4);
+    section.append(unit);
+    return section;
+}
+}  // namespace
+
+class tst_DebugLineInfo : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testDWARF5InitialFile();
+};
+
+void tst_DebugLineInfo::testDWARF5InitialFile() {
+    QByteArray program;
+    // The file register is initially 1, also under DWARF 5
+    setAddress(program, 0x100);
+    appendBytes(program, {DW_LNS_copy});
+    appendBytes(program, {DW_LNS_set_file, 0});
+    appendBytes(program, {DW_LNS_advance_pc, 4});
+    appendBytes(program, {DW_LNS_advance_line, 2});
+    appendBytes(program, {DW_LNS_copy});
+    appendBytes(program, {DW_LNS_advance_pc, 4});
+    endSequence(program);
+
+    // Ending a sequence resets the file register to 1
+    setAddress(program, 0x200);
+    appendBytes(program, {DW_LNS_copy});
+    appendBytes(program, {DW_LNS_advance_pc, 4});
+    endSequence(program);
+
+    const auto info = DebugLineInfo::parse(dwarf5Unit(program));
+    QVERIFY(!info.isEmpty());
+
+    const auto* row = info.lookup(0x100);
+    QVERIFY(row != nullptr);
+    QCOMPARE(info.fileName(row->file), QString("/src/b.c"));
+    QCOMPARE(row->line, 1u);
+
+    row = info.lookup(0x104);
+    QVERIFY(row != nullptr);
+    QCOMPARE(info.fileName(row->file), QString("/src/a.c"));
+    QCOMPARE(row->line, 3u);
+
+    QVERIFY(info.lookup(0x108) == nullptr);
+
+    row = info.lookup(0x200);
+    QVERIFY(row != nullptr);
+    QCOMPARE(info.fileName(row->file), QString("/src/b.c"));
+}
+
+QTEST_APPLESS_MAIN(tst_DebugLineInfo)
+#include "tst_debuglineinfo.moc"
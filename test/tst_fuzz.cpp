@@ -0,0 +1,500 @@
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <map>
+#include <random>
+
+#include "commitlogger.h"
+#include "isainfo.h"
+#include "lockstepchecker.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "rvencoders.h"
+
+/** Random instruction stream fuzzer
+ *
+ * Generates random, valid RV32IMA programs directly as Program objects, and executes each program on several processor
+ * models with lockstep checking enabled. Besides verifying every retired instruction against the reference model, the
+ * final register and memory state of all processors are compared, as are their cycle counts, and the CPI of each
+ * processor is reported.
+ *
+ * The hazard density of the generated programs is controllable: the probability of consuming the result of the most
+ * recent load (load-use chains), the probability of a branch directly following a branch, and the density of system
+ * calls. Given that not all processors detect hazards, each fuzzing profile constrains the distance between a producing
+ * and a consuming instruction, and only executes on the processors which resolve the remaining hazards:
+ * - dense: unconstrained; RVSS and RV5S.
+ * - forwarding: a load is not consumed by the instruction directly following it, and the operands of an ecall are not
+ *   written by the 2 preceding instructions; additionally RV5S_NO_HZ.
+ * - hazard-free: no result is consumed by the 2 following instructions; all processors.
+ * Control flow is forward only (branches, jal and jalr relative to x0), such that every program terminates. Atomics
+ * all access the first word of the data section; an SC.W thereby succeeds if an LR.W was executed since the previous
+ * SC.W, and fails otherwise.
+ *
+ * Set RIPES_FUZZ_SEED and RIPES_FUZZ_PROGRAMS to control the seed and the number of programs per test. Program i is
+ * generated from seed + i; a failing program is reproduced by setting RIPES_FUZZ_SEED to its reported seed and
+ * RIPES_FUZZ_PROGRAMS to 1.
+ */
+
+using namespace Ripes;
+using namespace Ripes::RVEncoders;
+
+static constexpr uint32_t s_defaultSeed = 0x5eed;
+static constexpr unsigned s_defaultPrograms = 50;
+
+// Generated programs
+static constexpr unsigned s_bodyLength = 200;
+static constexpr unsigned s_maxBranchDistance = 16;
+static constexpr uint32_t s_dataBase = 0x10000000;
+static constexpr unsigned s_dataSize = 256;
+static constexpr unsigned s_maxCycles = 10000;
+
+// Reserved registers; x31 holds the base address of the data section, and a7 the print syscall number
+static constexpr unsigned s_dataReg = 31;
+static constexpr unsigned s_a0 = 10;
+static constexpr unsigned s_a7 = 17;
+
+struct FuzzProfile {
+    const char* name;
+    /** Minimum number of instructions between a producing and a consuming instruction */
+    unsigned useDistance;
+    /** Minimum number of instructions between a load and an instruction consuming the loaded value */
+    unsigned loadUseDistance;
+    /** Minimum number of instructions between the last write of an ecall operand and the ecall */
+    unsigned ecallDistance;
+    std::vector<ProcessorID> processors;
+};
+
+static const std::array<FuzzProfile, 3> s_profiles = {{
+    {"dense", 0, 0, 0, {ProcessorID::RVSS, ProcessorID::RV5S}},
+    {"forwarding", 0, 1, 2, {ProcessorID::RVSS, ProcessorID::RV5S, ProcessorID::RV5S_NO_HZ}},
+    {"hazard-free", 2, 2, 2,
+     {ProcessorID::RVSS, ProcessorID::RV5S, ProcessorID::RV5S_NO_HZ, ProcessorID::RV5S_NO_FW_HZ}},
+}};
+
+/** Hazard densities; probabilities per generated instruction */
+struct FuzzDensity {
+    double loadUse;
+    double branch;
+    double backToBackBranch;
+    double ecall;
+};
+
+namespace {
+unsigned envOrDefault(const char* name, unsigned defaultValue) {
+    bool ok;
+    const unsigned value = qgetenv(name).toUInt(&ok, 0);
+    return ok ? value : defaultValue;
+}
+}  // namespace
+
+/**
+ * @brief The ProgramGenerator class
+ * Generates a random program of s_bodyLength instructions between a prologue, which initializes the reserved registers,
+ * and an epilogue, which exits through an ecall. The last writer of each register is tracked such that the operands of
+ * each instruction respect the distances of the fuzzing profile. Forward control flow only skips instructions, so
+ * tracking the last writer in program order is conservative; flushing a taken branch furthermore delays the target.
+ */
+class ProgramGenerator {
+public:
+    ProgramGenerator(const FuzzProfile& profile, const FuzzDensity& density, uint32_t seed)
+        : m_profile(profile), m_density(density), m_rng(seed) {
+        m_lastWrite.fill(INT_MIN / 2);
+        m_lastWriteIsLoad.fill(false);
+    }
+
+    std::shared_ptr<Program> generate() {
+        // Prologue
+        append(encodeU(c_lui, s_dataReg, s_dataBase >> 12), s_dataReg);
+        append(encodeI(c_opImm, 0b000, s_a7, 0, ISAInfo<ISA::RV32IMA>::PrintInt), s_a7);
+        padUntilReady({s_dataReg, s_a7}, 0, s_a7);
+
+        const unsigned bodyStart = index();
+        m_bodyEnd = bodyStart + s_bodyLength;
+        while (index() < m_bodyEnd) {
+            const double r = uniform();
+            if (r < m_density.ecall) {
+                genEcall();
+            } else if (r < m_density.ecall + m_density.branch) {
+                do {
+                    genBranch();
+                } while (index() < m_bodyEnd && uniform() < m_density.backToBackBranch);
+            } else {
+                const double op = uniform();
+                if (op < 0.2) {
+                    genLoad();
+                } else if (op < 0.3) {
+                    genStore();
+                } else if (op < 0.35) {
+                    genAtomic();
+                } else {
+                    genALU();
+                }
+            }
+        }
+
+        // Epilogue
+        append(encodeI(c_opImm, 0b000, s_a7, 0, ISAInfo<ISA::RV32IMA>::Exit), s_a7);
+        padUntilReady({s_a7}, m_profile.ecallDistance, s_a7);
+        append(c_ecall);
+
+        auto program = std::make_shared<Program>();
+        QByteArray data;
+        for (unsigned i = 0; i < s_dataSize; i++) {
+            data.append(static_cast<char>(m_rng() & 0xFF));
+        }
+        program->sections.push_back({TEXT_SECTION_NAME, 0, packInstructions(m_text)});
+        program->sections.push_back({".data", s_dataBase, data});
+        return program;
+    }
+
+private:
+    unsigned index() const { return m_text.size(); }
+    double uniform() { return std::uniform_real_distribution<double>(0.0, 1.0)(m_rng); }
+    unsigned random(unsigned lo, unsigned hi) { return std::uniform_int_distribution<unsigned>(lo, hi)(m_rng); }
+
+    void append(uint32_t instr, unsigned rd = 0, bool isLoad = false) {
+        if (rd != 0) {
+            m_lastWrite[rd] = index();
+            m_lastWriteIsLoad[rd] = isLoad;
+            if (isLoad) {
+                m_lastLoadReg = rd;
+            }
+        }
+        m_text.push_back(instr);
+    }
+
+    bool ready(unsigned reg, unsigned distance) const {
+        const unsigned required =
+            m_lastWriteIsLoad[reg] ? std::max(m_profile.useDistance, m_profile.loadUseDistance) : m_profile.useDistance;
+        return static_cast<int>(index()) - m_lastWrite[reg] > static_cast<int>(std::max(distance, required));
+    }
+
+    /** Any register may be read; the result of the most recent load is preferred with the load-use density */
+    unsigned srcReg() {
+        if (m_lastLoadReg != 0 && uniform() < m_density.loadUse && ready(m_lastLoadReg, 0)) {
+            return m_lastLoadReg;
+        }
+        for (unsigned attempt = 0; attempt < 8; attempt++) {
+            const unsigned reg = random(0, 31);
+            if (ready(reg, 0)) {
+                return reg;
+            }
+        }
+        return 0;
+    }
+
+    /** Any register but the reserved registers may be written, including x0 */
+    unsigned dstReg(unsigned exclude = 0) {
+        unsigned reg;
+        do {
+            reg = random(0, 30);
+        } while (reg == s_a7 || (exclude != 0 && reg == exclude));
+        return reg;
+    }
+
+    void genALU(unsigned exclude = 0) {
+        const unsigned rd = dstReg(exclude);
+        const unsigned kind = random(0, 9);
+        if (kind == 0) {
+            append(encodeU(c_lui, rd, m_rng()), rd);
+        } else if (kind == 1) {
+            append(encodeU(c_auipc, rd, m_rng()), rd);
+        } else if (kind <= 5) {
+            // RV32I register-register operations and RV32M
+            static const std::array<std::pair<unsigned, unsigned>, 18> ops = {{{0b000, 0b0000000},
+                                                                               {0b000, 0b0100000},
+                                                                               {0b001, 0b0000000},
+                                                                               {0b010, 0b0000000},
+                                                                               {0b011, 0b0000000},
+                                                                               {0b100, 0b0000000},
+                                                                               {0b101, 0b0000000},
+                                                                               {0b101, 0b0100000},
+                                                                               {0b110, 0b0000000},
+                                                                               {0b111, 0b0000000},
+                                                                               {0b000, 0b0000001},
+                                                                               {0b001, 0b0000001},
+                                                                               {0b010, 0b0000001},
+                                                                               {0b011, 0b0000001},
+                                                                               {0b100, 0b0000001},
+                                                                               {0b101, 0b0000001},
+                                                                               {0b110, 0b0000001},
+                                                                               {0b111, 0b0000001}}};
+            const auto& op = ops.at(random(0, ops.size() - 1));
+            const unsigned rs1 = srcReg();
+            const unsigned rs2 = srcReg();
+            append(encodeR(c_op, op.first, op.second, rd, rs1, rs2), rd);
+        } else {
+            const unsigned funct3 = random(0, 7);
+            const unsigned rs1 = srcReg();
+            int32_t imm;
+            if (funct3 == 0b001) {
+                imm = random(0, 31);
+            } else if (funct3 == 0b101) {
+                imm = random(0, 31) | (random(0, 1) ? 0x400 : 0);
+            } else {
+                imm = static_cast<int32_t>(random(0, 0xFFF) << 20) >> 20;
+            }
+            append(encodeI(c_opImm, funct3, rd, rs1, imm), rd);
+        }
+    }
+
+    void genLoad() {
+        static const std::array<unsigned, 5> funct3s = {0b000, 0b001, 0b010, 0b100, 0b101};
+        const unsigned funct3 = funct3s.at(random(0, funct3s.size() - 1));
+        const unsigned size = 1u << (funct3 & 0b11);
+        const unsigned rd = dstReg();
+        append(encodeI(c_load, funct3, rd, s_dataReg, random(0, s_dataSize / size - 1) * size), rd, true);
+    }
+
+    void genStore() {
+        const unsigned funct3 = random(0, 2);
+        const unsigned size = 1u << funct3;
+        append(encodeS(funct3, s_dataReg, srcReg(), random(0, s_dataSize / size - 1) * size));
+    }
+
+    /** Atomics produce their result in the memory stage, and are thereby subject to the load-use distance */
+    void genAtomic() {
+        static const std::array<unsigned, 11> funct5s = {0b00010, 0b00011, 0b00001, 0b00000, 0b00100, 0b01100,
+                                                         0b01000, 0b10000, 0b10100, 0b11000, 0b11100};
+        const unsigned funct5 = funct5s.at(random(0, funct5s.size() - 1));
+        const unsigned rd = dstReg();
+        // LR.W requires rs2 to be x0
+        const unsigned rs2 = funct5 == 0b00010 ? 0 : srcReg();
+        append(encodeAMO(funct5, rd, s_dataReg, rs2), rd, true);
+    }
+
+    void genBranch() {
+        const unsigned target = std::min(index() + random(1, s_maxBranchDistance), m_bodyEnd);
+        const int32_t offset = (target - index()) * sizeof(uint32_t);
+        const unsigned kind = random(0, 9);
+        if (kind == 0) {
+            const unsigned rd = dstReg();
+            append(encodeJ(rd, offset), rd);
+        } else if (kind == 1) {
+            // The text section is located at address 0, so jalr relative to x0 is an absolute jump
+            const unsigned rd = dstReg();
+            append(encodeI(c_jalr, 0b000, rd, 0, target * sizeof(uint32_t)), rd);
+        } else {
+            static const std::array<unsigned, 6> funct3s = {0b000, 0b001, 0b100, 0b101, 0b110, 0b111};
+            const unsigned rs1 = srcReg();
+            const unsigned rs2 = srcReg();
+            append(encodeB(funct3s.at(random(0, funct3s.size() - 1)), rs1, rs2, offset));
+        }
+    }
+
+    /** Prints a0. Skipped if the ecall and the instructions required to satisfy its operands do not fit the body. */
+    void genEcall() {
+        if (index() + m_profile.ecallDistance + 1 > m_bodyEnd) {
+            genALU();
+            return;
+        }
+        padUntilReady({s_a0, s_a7}, m_profile.ecallDistance, s_a0);
+        if (index() < m_bodyEnd) {
+            append(c_ecall);
+        }
+    }
+
+    /** Emits ALU instructions, not writing @p exclude, until @p regs may be read at @p distance */
+    void padUntilReady(const std::vector<unsigned>& regs, unsigned distance, unsigned exclude) {
+        while (!std::all_of(regs.begin(), regs.end(), [&](unsigned reg) { return ready(reg, distance); })) {
+            genALU(exclude);
+        }
+    }
+
+    const FuzzProfile& m_profile;
+    const FuzzDensity m_density;
+    std::mt19937 m_rng;
+
+    std::vector<uint32_t> m_text;
+    unsigned m_bodyEnd = 0;
+    std::array<int, 32> m_lastWrite;
+    std::array<bool, 32> m_lastWriteIsLoad;
+    unsigned m_lastLoadReg = 0;
+};
+
+struct FuzzResult {
+    QString error;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    std::vector<uint32_t> regs;
+    std::vector<uint32_t> data;
+};
+
+class tst_Fuzz : public QObject {
+    Q_OBJECT
+
+private:
+    FuzzResult execute(ProcessorID id, const std::shared_ptr<Program>& program);
+
+    uint32_t m_seed = s_defaultSeed;
+    unsigned m_programs = s_defaultPrograms;
+
+private slots:
+    void initTestCase();
+    void testFuzz_data();
+    void testFuzz();
+    void testCommitLogReversal();
+};
+
+void tst_Fuzz::initTestCase() {
+    connect(ProcessorHandler::get(), &ProcessorHandler::reqProcessorReset,
+            [=] { ProcessorHandler::get()->getProcessorNonConst()->reset(); });
+    LockstepChecker::get()->setEnabled(true);
+
+    m_seed = envOrDefault("RIPES_FUZZ_SEED", s_defaultSeed);
+    m_programs = envOrDefault("RIPES_FUZZ_PROGRAMS", s_defaultPrograms);
+    qInfo().noquote() << QString("Fuzzing %1 programs per test from seed %2").arg(m_programs).arg(m_seed);
+}
+
+FuzzResult tst_Fuzz::execute(ProcessorID id, const std::shared_ptr<Program>& program) {
+    ProcessorHandler::get()->selectProcessor(id);
+    // Loading the program resets the processor, and synchronizes the lockstep checker with it
+    ProcessorHandler::get()->loadProgram(program);
+
+    FuzzResult result;
+    auto* proc = ProcessorHandler::get()->getProcessorNonConst();
+    const auto* lockstep = LockstepChecker::get();
+    while (!proc->finished() && result.cycles < s_maxCycles && !lockstep->hasDiverged()) {
+        proc->clock();
+        result.cycles++;
+    }
+
+    if (lockstep->hasDiverged()) {
+        result.error = lockstep->divergence();
+    } else if (!proc->finished()) {
+        result.error = "Maximum cycle count reached";
+    }
+
+    result.instructions = lockstep->instructionsChecked();
+    for (unsigned i = 0; i < RVReferenceModel::s_nRegs; i++) {
+        result.regs.push_back(proc->getRegister(i));
+    }
+    for (unsigned i = 0; i < s_dataSize; i += sizeof(uint32_t)) {
+        result.data.push_back(ProcessorHandler::get()->getMemory().readMemConst(s_dataBase + i, sizeof(uint32_t)));
+    }
+    return result;
+}
+
+void tst_Fuzz::testFuzz_data() {
+    QTest::addColumn<int>("profile");
+    QTest::addColumn<double>("loadUse");
+    QTest::addColumn<double>("branch");
+    QTest::addColumn<double>("backToBackBranch");
+    QTest::addColumn<double>("ecall");
+
+    for (unsigned i = 0; i < s_profiles.size(); i++) {
+        const QString name = s_profiles.at(i).name;
+        QTest::newRow(qPrintable(name + "/sparse")) << static_cast<int>(i) << 0.1 << 0.05 << 0.0 << 0.01;
+        QTest::newRow(qPrintable(name + "/dense")) << static_cast<int>(i) << 0.8 << 0.15 << 0.5 << 0.05;
+    }
+}
+
+void tst_Fuzz::testFuzz() {
+    QFETCH(int, profile);
+    QFETCH(double, loadUse);
+    QFETCH(double, branch);
+    QFETCH(double, backToBackBranch);
+    QFETCH(double, ecall);
+
+    const FuzzProfile& fuzzProfile = s_profiles.at(profile);
+    const FuzzDensity density = {loadUse, branch, backToBackBranch, ecall};
+    std::map<ProcessorID, uint64_t> totalCycles;
+    uint64_t totalInstructions = 0;
+
+    for (unsigned p = 0; p < m_programs; p++) {
+        const uint32_t seed = m_seed + p;
+        const auto program = ProgramGenerator(fuzzProfile, density, seed).generate();
+        const QString context = QString("Program with seed %1: ").arg(seed);
+
+        std::map<ProcessorID, FuzzResult> results;
+        for (const auto id : fuzzProfile.processors) {
+            const QString processor = ProcessorRegistry::getDescription(id).name;
+            const auto& result = results[id] = execute(id, program);
+            if (!result.error.isNull()) {
+                QFAIL(qPrintable(context + processor + " failed: " + result.error));
+            }
+        }
+
+        // All processors must agree on the architectural results of the program
+        const auto& reference = results.at(ProcessorID::RVSS);
+        for (const auto& it : results) {
+            const QString processor = ProcessorRegistry::getDescription(it.first).name;
+            const auto& result = it.second;
+            QVERIFY2(result.instructions == reference.instructions,
+                     qPrintable(context + processor + " retired a different number of instructions"));
+            for (unsigned i = 0; i < result.regs.size(); i++) {
+                QVERIFY2(result.regs.at(i) == reference.regs.at(i),
+                         qPrintable(context + processor + QString(" differs in x%1").arg(i)));
+            }
+            for (unsigned i = 0; i < result.data.size(); i++) {
+                QVERIFY2(result.data.at(i) == reference.data.at(i),
+                         qPrintable(context + processor +
+                                    QString(" differs in memory at 0x%1").arg(s_dataBase + i * 4, 0, 16)));
+            }
+            // Pipelining never reduces the number of cycles
+            QVERIFY2(result.cycles >= reference.cycles,
+                     qPrintable(context + processor + " finished in fewer cycles than the single cycle processor"));
+            totalCycles[it.first] += result.cycles;
+        }
+        totalInstructions += reference.instructions;
+
+        // Hazard detection only ever adds stalls, and forwarding does not change the timing of hazard-free programs
+        if (results.count(ProcessorID::RV5S_NO_HZ)) {
+            QVERIFY2(results.at(ProcessorID::RV5S).cycles >= results.at(ProcessorID::RV5S_NO_HZ).cycles,
+                     qPrintable(context + "hazard detection reduced the number of cycles"));
+        }
+        if (results.count(ProcessorID::RV5S_NO_FW_HZ)) {
+            QVERIFY2(results.at(ProcessorID::RV5S_NO_HZ).cycles == results.at(ProcessorID::RV5S_NO_FW_HZ).cycles,
+                     qPrintable(context + "forwarding changed the number of cycles of a hazard-free program"));
+        }
+    }
+
+    for (const auto& it : totalCycles) {
+        qInfo().noquote() << QString("%1: %2 instructions, %3 cycles, CPI %4")
+                                 .arg(ProcessorRegistry::getDescription(it.first).name)
+                                 .arg(totalInstructions)
+                                 .arg(it.second)
+                                 .arg(static_cast<double>(it.second) / totalInstructions, 0, 'f', 3);
+    }
+}
+
+void tst_Fuzz::testCommitLogReversal() {
+    // Reversing the processor and clocking it forward again must leave the commit log as if the program had executed
+    // without reversal, including the memory writes of stores which were in flight when reversing.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const auto program = ProgramGenerator(s_profiles.at(0), {0.8, 0.15, 0.5, 0.05}, m_seed).generate();
+    ProcessorHandler::get()->selectProcessor(ProcessorID::RV5S);
+
+    auto log = [&](const QString& name, bool reverse) {
+        ProcessorHandler::get()->loadProgram(program);
+        const QString path = dir.filePath(name);
+        if (!CommitLogger::get()->start(path)) {
+            return QByteArray();
+        }
+        auto* proc = ProcessorHandler::get()->getProcessorNonConst();
+        unsigned cycles = 0;
+        while (!proc->finished() && cycles++ < s_maxCycles) {
+            proc->clock();
+            if (reverse && cycles % 7 == 0) {
+                for (unsigned i = 0; i < 3; i++) {
+                    proc->reverse();
+                }
+            }
+        }
+        CommitLogger::get()->stop();
+        QFile file(path);
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    };
+
+    const QByteArray forward = log("forward.log", false);
+    QVERIFY(!forward.isEmpty());
+    QVERIFY(forward.contains(" mem 0x"));
+    QCOMPARE(log("reversed.log", true), forward);
+}
+
+QTEST_MAIN(tst_Fuzz)
+#include "tst_fuzz.moc"
@@ -0,0 +1,209 @@
+#include <QtTest/QTest>
+
+#include "cachesim/coherentcaches.h"
+#include "isainfo.h"
+#include "multihartsystem.h"
+#include "rvencoders.h"
+
+/** Multi-core tests
+ *
+ * Verifies the MSI and MESI coherence protocols of CoherentCaches, and executes parallel kernels on a
+ * MultiHartSystem: shared counters incremented through AMOs and through LR/SC loops, and private counters which either
+ * share a cache line (false sharing) or are padded to separate lines. The cache and coherence statistics of each kernel
+ * are reported.
+ */
+
+using namespace Ripes;
+using namespace Ripes::RVEncoders;
+
+using Protocol = CoherentCaches::Protocol;
+using State = CoherentCaches::State;
+
+static constexpr uint32_t s_dataBase = 0x10000000;
+static constexpr unsigned s_iterations = 100;
+static constexpr uint64_t s_maxSteps = 100000;
+
+// Registers used by the kernels
+static constexpr unsigned s_a0 = 10;
+static constexpr unsigned s_a7 = 17;
+static constexpr unsigned s_t0 = 5;
+static constexpr unsigned s_t1 = 6;
+static constexpr unsigned s_t2 = 7;
+static constexpr unsigned s_t3 = 28;
+
+namespace {
+std::vector<uint32_t> exitSequence() {
+    return {addi(s_a7, 0, ISAInfo<ISA::RV32IMA>::Exit), c_ecall};
+}
+
+std::shared_ptr<Program> makeProgram(std::vector<uint32_t> text) {
+    for (const uint32_t instr : exitSequence()) {
+        text.push_back(instr);
+    }
+    auto program = std::make_shared<Program>();
+    program->sections.push_back({TEXT_SECTION_NAME, 0, packInstructions(text)});
+    return program;
+}
+
+/** Each hart increments the counter at s_dataBase s_iterations times through amoadd.w */
+std::shared_ptr<Program> amoCounter() {
+    return makeProgram({lui(s_t0, s_dataBase >> 12), addi(s_t1, 0, s_iterations), addi(s_t2, 0, 1),
+                        /* loop: */ amoaddw(0, s_t2, s_t0), addi(s_t1, s_t1, -1), bne(s_t1, 0, -8)});
+}
+
+/** Each hart increments the counter at s_dataBase s_iterations times through an LR/SC loop */
+std::shared_ptr<Program> lrscCounter() {
+    return makeProgram({lui(s_t0, s_dataBase >> 12), addi(s_t1, 0, s_iterations),
+                        /* loop: */ lrw(s_t2, s_t0), addi(s_t2, s_t2, 1), scw(s_t3, s_t2, s_t0), bne(s_t3, 0, -12),
+                        addi(s_t1, s_t1, -1), bne(s_t1, 0, -20)});
+}
+
+/** Each hart increments its private counter, located at s_dataBase + (hart ID << @p strideShift), through lw/sw */
+std::shared_ptr<Program> privateCounters(unsigned strideShift) {
+    return makeProgram({lui(s_t0, s_dataBase >> 12), slli(s_t3, s_a0, strideShift), add(s_t0, s_t0, s_t3),
+                        addi(s_t1, 0, s_iterations),
+                        /* loop: */ lw(s_t2, s_t0, 0), addi(s_t2, s_t2, 1), sw(s_t2, s_t0, 0),
+                        addi(s_t1, s_t1, -1), bne(s_t1, 0, -16)});
+}
+
+CoherentCaches::Config cacheConfig(unsigned cores, Protocol protocol) {
+    CoherentCaches::Config config;
+    config.cores = cores;
+    config.protocol = protocol;
+    return config;
+}
+}  // namespace
+
+class tst_Multicore : public QObject {
+    Q_OBJECT
+
+private:
+    void report(const MultiHartSystem& system);
+
+private slots:
+    void testMESI();
+    void testMSI();
+    void testSharedCounter_data();
+    void testSharedCounter();
+    void testFalseSharing();
+};
+
+void tst_Multicore::report(const MultiHartSystem& system) {
+    const auto& caches = system.caches();
+    for (unsigned core = 0; core < system.harts(); core++) {
+        const auto& stats = caches.coreStats(core);
+        qInfo().noquote() << QString("Core %1: %2 instructions, %3 accesses, hit rate %4, %5 invalidations")
+                                 .arg(core)
+                                 .arg(system.instructionsRetired(core))
+                                 .arg(stats.reads + stats.writes)
+                                 .arg(stats.hitRate(), 0, 'f', 3)
+                                 .arg(stats.invalidations);
+    }
+    const auto& bus = caches.busStats();
+    qInfo().noquote() << QString("Bus: %1 BusRd, %2 BusRdX, %3 BusUpgr, %4 cache-to-cache transfers")
+                             .arg(bus.busRd)
+                             .arg(bus.busRdX)
+                             .arg(bus.busUpgr)
+                             .arg(bus.cacheToCache);
+}
+
+void tst_Multicore::testMESI() {
+    CoherentCaches caches(cacheConfig(2, Protocol::MESI));
+
+    // A line read without other sharers is exclusive, and is written without a bus transaction
+    caches.access(0, s_dataBase, false);
+    QCOMPARE(caches.state(0, s_dataBase), State::Exclusive);
+    caches.access(0, s_dataBase + 4, true);
+    QCOMPARE(caches.state(0, s_dataBase), State::Modified);
+    QCOMPARE(caches.busStats().transactions(), uint64_t(1));
+
+    // Reading a modified line of another core flushes it
+    caches.access(1, s_dataBase, false);
+    QCOMPARE(caches.state(0, s_dataBase), State::Shared);
+    QCOMPARE(caches.state(1, s_dataBase), State::Shared);
+    QCOMPARE(caches.busStats().cacheToCache, uint64_t(1));
+    QCOMPARE(caches.coreStats(0).interventions, uint64_t(1));
+
+    // Writing a shared line invalidates all other copies
+    caches.access(1, s_dataBase, true);
+    QCOMPARE(caches.state(0, s_dataBase), State::Invalid);
+    QCOMPARE(caches.state(1, s_dataBase), State::Modified);
+    QCOMPARE(caches.busStats().busUpgr, uint64_t(1));
+    QCOMPARE(caches.coreStats(0).invalidations, uint64_t(1));
+
+    // Writing an invalidated line fetches it exclusively from the modifying core
+    caches.access(0, s_dataBase, true);
+    QCOMPARE(caches.state(0, s_dataBase), State::Modified);
+    QCOMPARE(caches.state(1, s_dataBase), State::Invalid);
+    QCOMPARE(caches.busStats().busRdX, uint64_t(1));
+    QCOMPARE(caches.busStats().cacheToCache, uint64_t(2));
+    QCOMPARE(caches.coreStats(0).misses, uint64_t(2));
+    QCOMPARE(caches.busStats().memoryReads, uint64_t(1));
+}
+
+void tst_Multicore::testMSI() {
+    CoherentCaches caches(cacheConfig(2, Protocol::MSI));
+
+    // Without the exclusive state, writing a line which was just read requires a bus upgrade
+    caches.access(0, s_dataBase, false);
+    QCOMPARE(caches.state(0, s_dataBase), State::Shared);
+    caches.access(0, s_dataBase, true);
+    QCOMPARE(caches.state(0, s_dataBase), State::Modified);
+    QCOMPARE(caches.busStats().busUpgr, uint64_t(1));
+    QCOMPARE(caches.coreStats(0).invalidations, uint64_t(0));
+
+    // Evicting a modified line writes it back
+    const uint32_t conflicting = s_dataBase + (1u << (2 + caches.config().blocks + caches.config().lines));
+    caches.access(0, conflicting, false);
+    QCOMPARE(caches.state(0, s_dataBase), State::Invalid);
+    QCOMPARE(caches.coreStats(0).writebacks, uint64_t(1));
+    QCOMPARE(caches.busStats().memoryWrites, uint64_t(1));
+}
+
+void tst_Multicore::testSharedCounter_data() {
+    QTest::addColumn<bool>("lrsc");
+    QTest::addColumn<unsigned>("harts");
+
+    for (const unsigned harts : {1, 2, 4}) {
+        QTest::newRow(qPrintable(QString("amoadd/%1").arg(harts))) << false << harts;
+        QTest::newRow(qPrintable(QString("lr-sc/%1").arg(harts))) << true << harts;
+    }
+}
+
+void tst_Multicore::testSharedCounter() {
+    QFETCH(bool, lrsc);
+    QFETCH(unsigned, harts);
+
+    MultiHartSystem system(*(lrsc ? lrscCounter() : amoCounter()), cacheConfig(harts, Protocol::MESI));
+    QVERIFY2(system.run(s_maxSteps), qPrintable(system.error()));
+    QCOMPARE(system.readMemory(s_dataBase, sizeof(uint32_t)), harts * s_iterations);
+    report(system);
+}
+
+void tst_Multicore::testFalseSharing() {
+    constexpr unsigned harts = 4;
+
+    // Adjacent counters share a cache line, and each write invalidates the copies of the other cores
+    MultiHartSystem shared(*privateCounters(2), cacheConfig(harts, Protocol::MESI));
+    QVERIFY2(shared.run(s_maxSteps), qPrintable(shared.error()));
+    report(shared);
+
+    // Counters padded to separate lines are never invalidated, and only miss on their first access
+    const unsigned lineShift = 2 + shared.caches().config().blocks;
+    MultiHartSystem padded(*privateCounters(lineShift), cacheConfig(harts, Protocol::MESI));
+    QVERIFY2(padded.run(s_maxSteps), qPrintable(padded.error()));
+    report(padded);
+
+    for (unsigned hart = 0; hart < harts; hart++) {
+        QCOMPARE(shared.readMemory(s_dataBase + (hart << 2), sizeof(uint32_t)), s_iterations);
+        QCOMPARE(padded.readMemory(s_dataBase + (hart << lineShift), sizeof(uint32_t)), s_iterations);
+        QVERIFY(shared.caches().coreStats(hart).invalidations > 0);
+        QCOMPARE(padded.caches().coreStats(hart).invalidations, uint64_t(0));
+        QCOMPARE(padded.caches().coreStats(hart).misses, uint64_t(1));
+    }
+    QVERIFY(shared.caches().busStats().cacheToCache > 0);
+    QCOMPARE(padded.caches().busStats().cacheToCache, uint64_t(0));
+}
+
+QTEST_APPLESS_MAIN(tst_Multicore)
+#include "tst_multicore.moc"
@@ -1,8 +1,17 @@
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QProcess>
 #include <QStringList>
+#include <QThread>
 #include <QtTest/QTest>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "lockstepchecker.h"
 #include "processorhandler.h"
 #include "processorregistry.h"
 
@@ -10,12 +19,22 @@
 static_assert(false, "VSRTL_RISCV_TEST_DIR must be defined");
 #endif
 
+#ifndef RIPES_RISCV_TEST_CACHE_DIR
+static_assert(false, "RIPES_RISCV_TEST_CACHE_DIR must be defined");
+#endif
+
 /** RISC-V test suite
  *
  * For now, the following assumptions are made:
  * - When compiling, it is assumed that the entry point address is 0x0
  * - No .data segment is contained within the resulting .ELF file
  * As such, we directly copy the .text segment into the simulator memory and execute the test.
+ *
+ * Compiled tests are cached across runs in RIPES_RISCV_TEST_CACHE_DIR, keyed by a hash of the test source and the
+ * compilation commands. Each processor is tested by a separate test function, which CMake registers as a separate
+ * test; run ctest -j to test the processors in parallel.
+ * All tests are executed with lockstep checking enabled, such that a processor is verified against the reference model
+ * on each retired instruction, and not only through the final result of a test.
  */
 
 using namespace Ripes;
@@ -23,9 +42,11 @@ using namespace vsrtl::core;
 
 // Compilation tools & directories
 const QString s_testdir = VSRTL_RISCV_TEST_DIR;
-const QString s_outdir = s_testdir + QDir::separator() + "build";
+const QString s_cachedir = RIPES_RISCV_TEST_CACHE_DIR;
 const QString s_assembler = "riscv64-unknown-elf-as";
+const QStringList s_assemblerArgs = {"-march=rv32ima"};
 const QString s_objcopy = "riscv64-unknown-elf-objcopy";
+const QStringList s_objcopyArgs = {"-O", "binary", "--only-section=.text"};
 const QString s_linkerScript = "rvtest.ld";
 
 // Ecall status codes
@@ -42,23 +63,64 @@ static constexpr unsigned s_maxCycles = 10000;
 // Tests which contains instructions or assembler directives not yet supported
 const auto s_excludedTests = {"f", "ldst", "move", "recoding", /* fails on CI, unknown as of know */ "memory"};
 
-QString compileTestFile(const QString& testfile) {
-    QProcess exec;
+QByteArray cacheKey(const QString& testfile) {
+    QFile source(s_testdir + QDir::separator() + testfile);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
 
-    const QString outElf = s_outdir + QDir::separator() + testfile + ".out";
-    const QString outBin = s_outdir + QDir::separator() + testfile + ".bin";
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(source.readAll());
+    for (const auto& part : QStringList{s_assembler, s_assemblerArgs.join(' '), s_objcopy, s_objcopyArgs.join(' ')}) {
+        hash.addData(part.toUtf8());
+        hash.addData("\0", 1);
+    }
+    return hash.result().toHex();
+}
+
+QString compileTestFile(const QString& testfile) {
+    const QByteArray key = cacheKey(testfile);
+    if (key.isEmpty()) {
+        return QString();
+    }
 
-    if (!QDir(s_outdir).exists()) {
-        QDir().mkdir(s_outdir);
+    const QString cachedBin = s_cachedir + QDir::separator() + testfile + "." + key + ".bin";
+    if (QFileInfo::exists(cachedBin)) {
+        return cachedBin;
     }
 
+    // Several test processes may share the cache directory, so build into process-unique files and move the result
+    // into the cache once complete.
+    QDir().mkpath(s_cachedir);
+    const QString outBase =
+        s_cachedir + QDir::separator() + testfile + "." + QString::number(QCoreApplication::applicationPid());
+    const QString outElf = outBase + ".out";
+    const QString outBin = outBase + ".tmp";
+
     // Build
-    bool error = exec.execute(s_assembler, {"-march=rv32im", s_testdir + QDir::separator() + testfile, "-o", outElf});
+    bool error = QProcess::execute(s_assembler, QStringList(s_assemblerArgs)
+                                                    << s_testdir + QDir::separator() + testfile << "-o" << outElf) != 0;
 
     // Extract .text segment
-    error = exec.execute(s_objcopy, {"-O", "binary", "--only-section=.text", outElf, outBin});
+    if (!error) {
+        error = QProcess::execute(s_objcopy, QStringList(s_objcopyArgs) << outElf << outBin) != 0;
+    }
 
-    return error ? QString() : outBin;
+    QFile::remove(outElf);
+    if (error || !QFile::rename(outBin, cachedBin)) {
+        QFile::remove(outBin);
+        // Renaming fails if another test process cached the binary first
+        return QFileInfo::exists(cachedBin) ? cachedBin : QString();
+    }
+
+    // Remove stale cache entries of previous versions of the test
+    const QDir cacheDir(s_cachedir);
+    for (const auto& entry : cacheDir.entryList({testfile + ".*.bin"}, QDir::Files)) {
+        if (entry != QFileInfo(cachedBin).fileName()) {
+            QFile::remove(cacheDir.filePath(entry));
+        }
+    }
+    return cachedBin;
 }
 
 class tst_RISCV : public QObject {
@@ -71,26 +133,68 @@ private:
     QString dumpRegs();
 
     QString m_currentTest;
+    QString m_currentBinFile;
 
     void runTests(const ProcessorID& id);
 
     void handleSysCall();
 
+    /** (test file, compiled binary) pairs of the tests to run */
+    std::vector<std::pair<QString, QString>> m_tests;
+
     bool m_stop = false;
+    unsigned m_cycles = 0;
     std::shared_ptr<Program> m_program;
     QString m_err;
 
 private slots:
+    void initTestCase();
 
     void testRVSingleCycle() { runTests(ProcessorID::RVSS); }
     void testRV5StagePipeline() { runTests(ProcessorID::RV5S); }
-
-    void cleanupTestCase();
 };
 
-void tst_RISCV::cleanupTestCase() {
-    auto buildDir = QDir(s_outdir);
-    buildDir.removeRecursively();
+void tst_RISCV::initTestCase() {
+    // The simulator is connected to the current test once; each test reloads the program into the processor.
+    connect(ProcessorHandler::get(), &ProcessorHandler::reqReloadProgram, [=] {
+        if (!m_currentBinFile.isNull()) {
+            loadBinaryToSimulator(m_currentBinFile);
+        }
+    });
+    connect(ProcessorHandler::get(), &ProcessorHandler::reqProcessorReset,
+            [=] { ProcessorHandler::get()->getProcessorNonConst()->reset(); });
+    LockstepChecker::get()->setEnabled(true);
+
+    QStringList testFiles;
+    for (const auto& test : QDir(s_testdir).entryList({"*.s"})) {
+        if (!skipTest(test)) {
+            testFiles << test;
+        }
+    }
+
+    // Compile (or fetch from the cache) all tests up front, in parallel
+    std::vector<QString> binFiles(testFiles.size());
+    std::atomic<int> next{0};
+    std::vector<std::thread> workers;
+    const int nWorkers = std::max(1, std::min(QThread::idealThreadCount(), testFiles.size()));
+    for (int i = 0; i < nWorkers; i++) {
+        workers.emplace_back([&] {
+            for (int t = next++; t < testFiles.size(); t = next++) {
+                binFiles[t] = compileTestFile(testFiles[t]);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (int i = 0; i < testFiles.size(); i++) {
+        if (binFiles[i].isNull()) {
+            QString err = "Test: '" + testFiles[i] + "' failed: Could not compile test file.";
+            QFAIL(err.toStdString().c_str());
+        }
+        m_tests.push_back({testFiles[i], binFiles[i]});
+    }
 }
 
 bool tst_RISCV::skipTest(const QString& test) {
@@ -142,16 +246,22 @@ QString tst_RISCV::executeSimulator() {
     m_stop = false;
     m_err = QString();
     bool maxCyclesReached = false;
-    unsigned cycles = 0;
+    m_cycles = 0;
     do {
         ProcessorHandler::get()->getProcessorNonConst()->clock();
 
-        cycles++;
+        m_cycles++;
 
-        maxCyclesReached |= cycles >= s_maxCycles;
-        m_stop |= maxCyclesReached;
+        maxCyclesReached |= m_cycles >= s_maxCycles;
+        m_stop |= maxCyclesReached || LockstepChecker::get()->hasDiverged();
     } while (!m_stop);
 
+    if (LockstepChecker::get()->hasDiverged()) {
+        m_err = "Test: '" + m_currentTest + "' failed: " + LockstepChecker::get()->divergence();
+        m_err += dumpRegs();
+        return m_err;
+    }
+
     if (maxCyclesReached) {
         m_err = "Test: '" + m_currentTest + "' failed: Maximum cycle count reached\n\t test number: " +
                 QString::number(ProcessorHandler::get()->getProcessor()->getRegister(s_statusreg));
@@ -163,39 +273,39 @@ QString tst_RISCV::executeSimulator() {
 }
 
 void tst_RISCV::runTests(const ProcessorID& id) {
-    const auto dir = QDir(s_testdir);
-    const auto testFiles = dir.entryList({"*.s"});
-
-    for (const auto& test : testFiles) {
-        m_currentTest = test;
-
-        if (skipTest(m_currentTest))
-            continue;
-
-        qInfo() << "Running test: " << m_currentTest;
-
-        // Compile test file
-        const auto binFile = compileTestFile(test);
-        if (binFile.isNull()) {
-            QString err = "Test: '" + test + "' failed: Could not compile test file.";
-            QFAIL(err.toStdString().c_str());
-        }
-
-        connect(ProcessorHandler::get(), &ProcessorHandler::reqReloadProgram, [=] { loadBinaryToSimulator(binFile); });
-        connect(ProcessorHandler::get(), &ProcessorHandler::reqProcessorReset,
-                [=] { ProcessorHandler::get()->getProcessorNonConst()->reset(); });
-
-        ProcessorHandler::get()->selectProcessor(id);
-        // Override the ProcessorHandler's ECALL handling
-        ProcessorHandler::get()->getProcessorNonConst()->handleSysCall.Connect(this, &tst_RISCV::handleSysCall);
-
+    m_currentBinFile = QString();
+    ProcessorHandler::get()->selectProcessor(id);
+    // Override the ProcessorHandler's ECALL handling
+    ProcessorHandler::get()->getProcessorNonConst()->handleSysCall.Connect(this, &tst_RISCV::handleSysCall);
+
+    QElapsedTimer timer;
+    uint64_t totalCycles = 0;
+    qint64 totalNs = 0;
+    for (const auto& test : m_tests) {
+        m_currentTest = test.first;
+        m_currentBinFile = test.second;
+
+        // Loading the program resets the processor
+        timer.start();
+        loadBinaryToSimulator(m_currentBinFile);
         const QString err = executeSimulator();
+        const qint64 elapsedNs = timer.nsecsElapsed();
         if (!err.isNull()) {
+            // Fail fast; remaining tests are not run
             QFAIL(err.toStdString().c_str());
         }
 
-        qInfo() << "Test '" << m_currentTest << "' succeeded.";
+        totalCycles += m_cycles;
+        totalNs += elapsedNs;
+        qInfo().noquote() << QString("Test '%1' succeeded: %2 cycles, %3 ms")
+                                 .arg(m_currentTest)
+                                 .arg(m_cycles)
+                                 .arg(elapsedNs / 1e6, 0, 'f', 3);
     }
+    qInfo().noquote() << QString("%1 tests succeeded: %2 cycles, %3 ms")
+                             .arg(m_tests.size())
+                             .arg(totalCycles)
+                             .arg(totalNs / 1e6, 0, 'f', 3);
 }
 
 QTEST_APPLESS_MAIN(tst_RISCV)
@@ -0,0 +1,271 @@
+#include <QTemporaryDir>
+#include <QTextDocument>
+#include <QtConcurrent/QtConcurrent>
+#include <QtTest/QTest>
+
+#include "assembler.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "syscall/linux_syscall.h"
+#include "syscall/systemio.h"
+
+/** System call micro-benchmarks
+ *
+ * Executes programs which perform s_benchmarkEcalls system calls in a tight loop on the single-cycle processor. The
+ * handoff benchmark measures the cost of the thread handoff which non-inline system calls are subject to. Run with ie.
+ * '-iterations 10' for stable timings.
+ */
+
+using namespace Ripes;
+
+static constexpr int s_benchmarkEcalls = 10000;
+static constexpr unsigned s_maxCycles = s_benchmarkEcalls * 16;
+
+class tst_Syscall : public QObject {
+    Q_OBJECT
+
+private:
+    void loadSyscallLoop(int syscall);
+    unsigned execute();
+
+    std::shared_ptr<Program> m_program;
+
+private slots:
+    void initTestCase();
+    void testSyscallContexts();
+    void testLinuxBrk();
+    void testFileBinaryRoundTrip();
+    void testCStringBounds();
+    void benchmarkPrintInt();
+    void benchmarkCycles();
+    void benchmarkThreadHandoff();
+};
+
+void tst_Syscall::initTestCase() {
+    connect(ProcessorHandler::get(), &ProcessorHandler::reqProcessorReset,
+            [=] { ProcessorHandler::get()->getProcessorNonConst()->reset(); });
+    ProcessorHandler::get()->selectProcessor(ProcessorID::RVSS);
+}
+
+void tst_Syscall::loadSyscallLoop(int syscall) {
+    QTextDocument doc;
+    doc.setPlainText(QString("li s0, %1\n"
+                             "loop:\n"
+                             "li a7, %2\n"
+                             "mv a0, s0\n"
+                             "ecall\n"
+                             "addi s0, s0, -1\n"
+                             "bnez s0, loop\n"
+                             "li a7, %3\n"
+                             "ecall\n")
+                         .arg(s_benchmarkEcalls)
+                         .arg(syscall)
+                         .arg(ISAInfo<ISA::RV32IMA>::Exit));
+
+    Assembler assembler;
+    assembler.assemble(doc);
+    QVERIFY(!assembler.hasError());
+    m_program = assembler.getProgram();
+    ProcessorHandler::get()->loadProgram(m_program);
+}
+
+unsigned tst_Syscall::execute() {
+    auto* proc = ProcessorHandler::get()->getProcessorNonConst();
+    unsigned cycles = 0;
+    while (!proc->finished() && cycles < s_maxCycles) {
+        proc->clock();
+        cycles++;
+    }
+    return cycles;
+}
+
+void tst_Syscall::testSyscallContexts() {
+    const auto& manager = ProcessorHandler::get()->getSyscallManager();
+    QCOMPARE(manager.context(ISAInfo<ISA::RV32IMA>::PrintInt), SyscallContext::Inline);
+    QCOMPARE(manager.context(ISAInfo<ISA::RV32IMA>::Cycles), SyscallContext::Inline);
+    QCOMPARE(manager.context(ISAInfo<ISA::RV32IMA>::Read), SyscallContext::Blocking);
+    QCOMPARE(manager.context(-1), SyscallContext::GUI);
+}
+
+void tst_Syscall::testLinuxBrk() {
+    // Queries the break, grows the heap, and attempts to move the break below the end of the program
+    QTextDocument doc;
+    doc.setPlainText(QString("li a7, %1\n"
+                             "li a0, 0\n"
+                             "ecall\n"
+                             "mv s0, a0\n"
+                             "addi a0, s0, 256\n"
+                             "ecall\n"
+                             "mv s1, a0\n"
+                             "li a0, 16\n"
+                             "ecall\n"
+                             "mv s2, a0\n"
+                             "li a7, %2\n"
+                             "li a0, 0\n"
+                             "ecall\n")
+                         .arg(LinuxSyscallManager::Brk)
+                         .arg(LinuxSyscallManager::Exit));
+
+    Assembler assembler;
+    assembler.assemble(doc);
+    QVERIFY(!assembler.hasError());
+    m_program = assembler.getProgram();
+    m_program->syscallABI = SyscallABI::Linux;
+    ProcessorHandler::get()->loadProgram(m_program);
+    QVERIFY(execute() < s_maxCycles);
+
+    const uint32_t initialBreak = (m_program->endAddress() + 15) & ~15;
+    QCOMPARE(ProcessorHandler::get()->getRegisterValue(8), initialBreak);
+    QCOMPARE(ProcessorHandler::get()->getRegisterValue(9), initialBreak + 256);
+    QCOMPARE(ProcessorHandler::get()->getRegisterValue(18), initialBreak + 256);
+
+    // Reversing past the brk calls restores the break, and clocking forward again moves it anew
+    auto* proc = ProcessorHandler::get()->getProcessorNonConst();
+    const auto cycles = proc->getCycleCount();
+    while (proc->getCycleCount() > 0) {
+        proc->reverse();
+    }
+    QCOMPARE(ProcessorHandler::get()->getProgramBreak(), initialBreak);
+    while (proc->getCycleCount() < cycles) {
+        proc->clock();
+    }
+    QCOMPARE(ProcessorHandler::get()->getProgramBreak(), initialBreak + 256);
+
+    // The heap is released upon reset
+    ProcessorHandler::get()->getProcessorNonConst()->reset();
+    QCOMPARE(ProcessorHandler::get()->getProgramBreak(), initialBreak);
+}
+
+void tst_Syscall::testFileBinaryRoundTrip() {
+    // Writes all byte values, including 0x00 and bytes which are invalid UTF-8, to a file, reads them back and
+    // verifies that they are neither decoded nor truncated on their way through the file syscalls.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("bytes.bin");
+
+    QTextDocument doc;
+    doc.setPlainText(QString(".data\n"
+                             "path: .string \"%1\"\n"
+                             "src: .zero 256\n"
+                             "dst: .zero 256\n"
+                             ".text\n"
+                             "la t0, src\n"
+                             "li t1, 0\n"
+                             "li t2, 256\n"
+                             "fill:\n"
+                             "add t3, t0, t1\n"
+                             "sb t1, 0(t3)\n"
+                             "addi t1, t1, 1\n"
+                             "bne t1, t2, fill\n"
+                             "li a7, %2\n"
+                             "la a0, path\n"
+                             "li a1, %3\n"
+                             "ecall\n"
+                             "mv s0, a0\n"
+                             "li a7, %4\n"
+                             "mv a0, s0\n"
+                             "la a1, src\n"
+                             "li a2, 256\n"
+                             "ecall\n"
+                             "mv s1, a0\n"
+                             "li a7, %5\n"
+                             "mv a0, s0\n"
+                             "ecall\n"
+                             "li a7, %2\n"
+                             "la a0, path\n"
+                             "li a1, %6\n"
+                             "ecall\n"
+                             "mv s0, a0\n"
+                             "li a7, %7\n"
+                             "mv a0, s0\n"
+                             "la a1, dst\n"
+                             "li a2, 256\n"
+                             "ecall\n"
+                             "mv s2, a0\n"
+                             "li a7, %5\n"
+                             "mv a0, s0\n"
+                             "ecall\n"
+                             "li a7, %8\n"
+                             "ecall\n")
+                         .arg(path)
+                         .arg(ISAInfo<ISA::RV32IMA>::Open)
+                         .arg(SystemIO::O_WRONLY | SystemIO::O_CREAT | SystemIO::O_TRUNC)
+                         .arg(ISAInfo<ISA::RV32IMA>::Write)
+                         .arg(ISAInfo<ISA::RV32IMA>::Close)
+                         .arg(SystemIO::O_RDONLY)
+                         .arg(ISAInfo<ISA::RV32IMA>::Read)
+                         .arg(ISAInfo<ISA::RV32IMA>::Exit));
+
+    Assembler assembler;
+    assembler.assemble(doc);
+    QVERIFY(!assembler.hasError());
+    m_program = assembler.getProgram();
+    ProcessorHandler::get()->loadProgram(m_program);
+    QVERIFY(execute() < s_maxCycles);
+
+    QByteArray expected;
+    for (int i = 0; i < 256; i++) {
+        expected.append(static_cast<char>(i));
+    }
+    QCOMPARE(ProcessorHandler::get()->getRegisterValue(9), 256u);
+    QCOMPARE(ProcessorHandler::get()->getRegisterValue(18), 256u);
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), expected);
+
+    const auto dst = std::find_if(m_program->symbols.begin(), m_program->symbols.end(),
+                                  [](const auto& symbol) { return symbol.second == "dst"; });
+    QVERIFY(dst != m_program->symbols.end());
+    QCOMPARE(ProcessorHandler::get()->readMemBlock(dst->first, 256), expected);
+}
+
+void tst_Syscall::testCStringBounds() {
+    // Strings without a null terminator are bounded by the read limit and by the top of the address space
+    loadSyscallLoop(ISAInfo<ISA::RV32IMA>::PrintInt);
+    auto* handler = ProcessorHandler::get();
+    const QByteArray unterminated(16, 'a');
+    handler->writeMemBlock(0xFFFFFFF0, unterminated);
+    handler->writeMemBlock(0x10000000, unterminated);
+
+    QByteArray string;
+    QVERIFY(!handler->readCString(0xFFFFFFF0, string));
+    QCOMPARE(string, unterminated);
+    QVERIFY(!handler->readCString(0xFFFFFFFE, string));
+    QCOMPARE(string, QByteArray(2, 'a'));
+    QVERIFY(!handler->readCString(0x10000000, string, 8));
+    QCOMPARE(string, QByteArray(8, 'a'));
+
+    handler->writeMem(0x10000008, 0, 1);
+    QVERIFY(handler->readCString(0x10000002, string));
+    QCOMPARE(string, QByteArray(6, 'a'));
+}
+
+void tst_Syscall::benchmarkPrintInt() {
+    loadSyscallLoop(ISAInfo<ISA::RV32IMA>::PrintInt);
+    QBENCHMARK {
+        ProcessorHandler::get()->getProcessorNonConst()->reset();
+        QVERIFY(execute() < s_maxCycles);
+    }
+}
+
+void tst_Syscall::benchmarkCycles() {
+    loadSyscallLoop(ISAInfo<ISA::RV32IMA>::Cycles);
+    QBENCHMARK {
+        ProcessorHandler::get()->getProcessorNonConst()->reset();
+        QVERIFY(execute() < s_maxCycles);
+    }
+}
+
+void tst_Syscall::benchmarkThreadHandoff() {
+    QBENCHMARK {
+        for (int i = 0; i < s_benchmarkEcalls; i++) {
+            auto futureWatcher = QFutureWatcher<bool>();
+            futureWatcher.setFuture(QtConcurrent::run([] { return true; }));
+            futureWatcher.waitForFinished();
+        }
+    }
+}
+
+QTEST_MAIN(tst_Syscall)
+#include "tst_syscall.moc"